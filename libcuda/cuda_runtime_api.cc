@@ -138,6 +138,7 @@
 #include "../src/gpgpu-sim/gpu-sim.h"
 #include "../src/cuda-sim/ptx_loader.h"
 #include "../src/cuda-sim/cuda-sim.h"
+#include "../src/cuda-sim/ptx_cache.h"
 #include "../src/cuda-sim/ptx_ir.h"
 #include "../src/cuda-sim/ptx_parser.h"
 #include "../src/gpgpusim_entrypoint.h"
@@ -948,6 +949,7 @@ cudaError_t cudaLaunchInternal(const char *hostFun,
   kernel_info_t *grid = ctx->api->gpgpu_cuda_ptx_sim_init_grid(
       hostFun, config.get_args(), config.grid_dim(), config.block_dim(),
       context);
+  grid->set_dynamic_smem(config.shared_mem());
   // do dynamic PDOM analysis for performance simulation scenario
   std::string kname = grid->name();
   function_info *kernel_func_info = grid->entry();
@@ -965,7 +967,7 @@ cudaError_t cudaLaunchInternal(const char *hostFun,
 
   gpgpu_t *gpu = context->get_device()->get_gpgpu();
   checkpoint *g_checkpoint;
-  g_checkpoint = new checkpoint();
+  g_checkpoint = new checkpoint(gpu->checkpoint_binary);
   class memory_space *global_mem;
   global_mem = gpu->get_global_memory();
 
@@ -1000,6 +1002,8 @@ cudaError_t cudaLaunchInternal(const char *hostFun,
       "blockDim = (%u,%u,%u) \n",
       kname.c_str(), stream ? stream->get_uid() : 0, gridDim.x, gridDim.y,
       gridDim.z, blockDim.x, blockDim.y, blockDim.z);
+  if (grid->get_uid() == ctx->the_gpgpusim->g_the_gpu_config->sweep_kernel())
+    ctx->config_sweep();
   stream_operation op(grid, ctx->func_sim->g_ptx_sim_mode, stream);
   ctx->the_gpgpusim->g_stream_manager->push(op);
   ctx->api->g_cuda_launch_stack.pop_back();
@@ -3000,33 +3004,66 @@ void cuda_runtime_api::extract_ptx_files_using_cuobjdump(CUctx_st *context) {
     app_binary = std::string(pytorch_bin);
   }
 
-  // only want file names
-  snprintf(command, 1000,
-           "$CUDA_INSTALL_PATH/bin/cuobjdump -lptx %s  | cut -d \":\" -f 2 | "
-           "awk '{$1=$1}1' > %s",
-           app_binary.c_str(), ptx_list_file_name);
-  if (system(command) != 0) {
-    printf("WARNING: Failed to execute cuobjdump to get list of ptx files \n");
-    exit(0);
-  }
-  if (!gpgpu_ctx->device_runtime->g_cdp_enabled) {
-    // based on the list above, dump ptx files individually. Format of dumped
-    // ptx file is prog_name.unique_no.sm_<>.ptx
-
-    std::ifstream infile(ptx_list_file_name);
-    std::string line;
-    while (std::getline(infile, line)) {
-      // int pos = line.find(std::string(get_app_binary_name(app_binary)));
-      const char *ptx_file = line.c_str();
-      printf("Extracting specific PTX file named %s \n", ptx_file);
-      snprintf(command, 1000, "$CUDA_INSTALL_PATH/bin/cuobjdump -xptx %s %s",
-               ptx_file, app_binary.c_str());
-      if (system(command) != 0) {
-        printf("ERROR: command: %s failed \n", command);
-        exit(0);
+  // the list and the files extracted depend on the binary, the cuobjdump
+  // release and on whether CDP is enabled
+  bool cdp = gpgpu_ctx->device_runtime->g_cdp_enabled;
+  ptx_cache cache(gpgpu_ctx->ptx_cache_dir());
+  unsigned long long key = ptx_cache::hash(cdp ? "cdp" : "");
+  ptx_cache::files_t extracted;
+  bool keyed = cache.enabled() && ptx_cache::hash_tool("cuobjdump", key) &&
+               ptx_cache::hash_file(app_binary.c_str(), key);
+  bool cached =
+      keyed && cache.load("cuobjdump", key, extracted) && !extracted.empty();
+  if (cached) {
+    // the list first, then the PTX files
+    printf("GPGPU-Sim PTX: PTX of %s found in %s\n", app_binary.c_str(),
+           gpgpu_ctx->ptx_cache_dir());
+    for (size_t i = 0; i < extracted.size(); i++) {
+      const char *fname = i ? extracted[i].first.c_str() : ptx_list_file_name;
+      if (!ptx_cache::write_file(fname, extracted[i].second)) {
+        printf("ERROR: cannot write %s\n", fname);
+        exit(1);
+      }
+    }
+    context->no_of_ptx += extracted.size() - 1;
+  } else {
+    // only want file names
+    snprintf(command, 1000,
+             "$CUDA_INSTALL_PATH/bin/cuobjdump -lptx %s  | cut -d \":\" -f 2 "
+             "| awk '{$1=$1}1' > %s",
+             app_binary.c_str(), ptx_list_file_name);
+    if (system(command) != 0) {
+      printf(
+          "WARNING: Failed to execute cuobjdump to get list of ptx files \n");
+      exit(0);
+    }
+    extracted.push_back(std::make_pair(ptx_list_file_name, std::string()));
+    if (!cdp) {
+      // based on the list above, dump ptx files individually. Format of
+      // dumped ptx file is prog_name.unique_no.sm_<>.ptx
+
+      std::ifstream infile(ptx_list_file_name);
+      std::string line;
+      while (std::getline(infile, line)) {
+        // int pos = line.find(std::string(get_app_binary_name(app_binary)));
+        const char *ptx_file = line.c_str();
+        printf("Extracting specific PTX file named %s \n", ptx_file);
+        snprintf(command, 1000,
+                 "$CUDA_INSTALL_PATH/bin/cuobjdump -xptx %s %s", ptx_file,
+                 app_binary.c_str());
+        if (system(command) != 0) {
+          printf("ERROR: command: %s failed \n", command);
+          exit(0);
+        }
+        context->no_of_ptx++;
+        extracted.push_back(std::make_pair(line, std::string()));
       }
-      context->no_of_ptx++;
     }
+    bool complete = keyed;
+    for (size_t i = 0; complete && i < extracted.size(); i++)
+      complete = ptx_cache::read_file(extracted[i].first.c_str(),
+                                      extracted[i].second);
+    if (complete) cache.save("cuobjdump", key, extracted);
   }
 
   if (!context->no_of_ptx) {
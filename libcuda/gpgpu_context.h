@@ -72,8 +72,13 @@ class gpgpu_context {
   class symbol_table *init_parser(const char *);
   class gpgpu_sim *gpgpu_ptx_sim_init_perf();
   void start_sim_thread(int api);
+  // -gpgpu_sweep_kernel: forks the sweep points and returns in each of
+  // them; the parent waits for all of them and exits
+  void config_sweep();
   struct _cuda_device_id *GPGPUSim_Init();
   void ptx_reg_options(option_parser_t opp);
+  // -gpgpu_ptx_cache_dir, NULL when caching is off
+  const char *ptx_cache_dir() const;
   const ptx_instruction *pc_to_instruction(unsigned pc);
   const warp_inst_t *ptx_fetch_inst(address_type pc);
   unsigned translate_pc_to_ptxlineno(unsigned pc);
@@ -27,6 +27,7 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "abstract_hardware_model.h"
+#include <stdio.h>
 #include <sys/stat.h>
 #include <algorithm>
 #include <iostream>
@@ -36,13 +37,17 @@
 #include "cuda-sim/memory.h"
 #include "cuda-sim/ptx-stats.h"
 #include "cuda-sim/ptx_ir.h"
+#include "cuda-sim/warp_simd.h"
 #include "gpgpu-sim/gpu-sim.h"
 #include "gpgpusim_entrypoint.h"
 #include "option_parser.h"
 
 void mem_access_t::init(gpgpu_context *ctx) {
   gpgpu_ctx = ctx;
-  m_uid = ++(gpgpu_ctx->sm_next_access_uid);
+  // L2 write backs and the clusters allocate from worker threads with
+  // -gpgpu_sim_threads
+  m_uid = __atomic_add_fetch(&gpgpu_ctx->sm_next_access_uid, 1,
+                             __ATOMIC_RELAXED);
   m_addr = 0;
   m_req_size = 0;
 }
@@ -51,7 +56,9 @@ void warp_inst_t::issue(const active_mask_t &mask, unsigned warp_id,
                         int sch_id) {
   m_warp_active_mask = mask;
   m_warp_issued_mask = mask;
-  m_uid = ++(m_config->gpgpu_ctx->warp_inst_sm_next_uid);
+  // the clusters issue at once with -gpgpu_sim_threads
+  m_uid = __atomic_add_fetch(&m_config->gpgpu_ctx->warp_inst_sm_next_uid, 1,
+                             __ATOMIC_RELAXED);
   m_warp_id = warp_id;
   m_dynamic_warp_id = dynamic_warp_id;
   issue_cycle = cycle;
@@ -61,7 +68,8 @@ void warp_inst_t::issue(const active_mask_t &mask, unsigned warp_id,
   m_scheduler_id = sch_id;
 }
 
-checkpoint::checkpoint() {
+checkpoint::checkpoint(bool binary) {
+  m_binary = binary;
   struct stat st = {0};
 
   if (stat("checkpoint_files", &st) == -1) {
@@ -69,6 +77,23 @@ checkpoint::checkpoint() {
   }
 }
 void checkpoint::load_global_mem(class memory_space *temp_mem, char *f1name) {
+  if (mem_page_image::is_image(f1name)) {
+    temp_mem->load_pages(mem_page_image(f1name));
+    return;
+  }
+  if (m_binary) {
+    // text files are converted once into an image next to them, which is
+    // redone when the text file is newer
+    std::string image_name = std::string(f1name) + ".img";
+    struct stat text_st, image_st;
+    if (stat(f1name, &text_st) || stat(image_name.c_str(), &image_st) ||
+        image_st.st_mtime < text_st.st_mtime ||
+        !mem_page_image::is_image(image_name.c_str()))
+      convert_global_mem(f1name, image_name.c_str(), temp_mem->page_size());
+    temp_mem->load_pages(mem_page_image(image_name.c_str()));
+    return;
+  }
+
   FILE *fp2 = fopen(f1name, "r");
   assert(fp2 != NULL);
   char line[128]; /* or other suitable maximum line size */
@@ -101,12 +126,72 @@ void checkpoint::load_global_mem(class memory_space *temp_mem, char *f1name) {
 
 void checkpoint::store_global_mem(class memory_space *mem, char *fname,
                                   char *format) {
-  FILE *fp3 = fopen(fname, "w");
+  FILE *fp3 = fopen(fname, m_binary ? "wb" : "w");
+  assert(fp3 != NULL);
+  if (m_binary)
+    mem->store_pages(fp3);
+  else
+    mem->print(format, fp3);
+  fclose(fp3);
+}
+
+void checkpoint::store_empty_mem(unsigned page_size, char *fname) {
+  FILE *fp3 = fopen(fname, m_binary ? "wb" : "w");
   assert(fp3 != NULL);
-  mem->print(format, fp3);
+  if (m_binary)
+    mem_page_image::write(fp3, page_size, mem_page_image::pages_t());
   fclose(fp3);
 }
 
+void checkpoint::convert_global_mem(const char *fname, const char *image_name,
+                                    unsigned page_size) {
+  FILE *fp = fopen(fname, "r");
+  if (!fp) {
+    printf("GPGPU-Sim PTX: ERROR ** cannot open checkpoint %s\n", fname);
+    abort();
+  }
+  // memory_space::print(): "<space> <page>:" then the page's words in hex;
+  // a space that was never written prints nothing
+  std::vector<std::pair<mem_addr_t, std::vector<unsigned> > > words;
+  char tok[64];
+  while (fscanf(fp, "%63s", tok) == 1) {
+    if (tok[0] == 'g' || tok[0] == 's' || tok[0] == 'l') {
+      unsigned index = 0;
+      if (fscanf(fp, "%x:", &index) != 1) break;
+      words.push_back(std::make_pair(index, std::vector<unsigned>()));
+    } else if (!words.empty()) {
+      words.back().second.push_back(strtoul(tok, NULL, 16));
+    }
+  }
+  fclose(fp);
+
+  mem_page_image::pages_t pages;
+  for (unsigned i = 0; i < words.size(); i++) {
+    if (words[i].second.size() * 4 != page_size) {
+      printf(
+          "GPGPU-Sim PTX: ERROR ** checkpoint %s: page %llx has %zu words, "
+          "expected %u\n",
+          fname, words[i].first, words[i].second.size(), page_size / 4);
+      abort();
+    }
+    pages.push_back(std::make_pair(
+        words[i].first, (const unsigned char *)&words[i].second[0]));
+  }
+  std::sort(pages.begin(), pages.end());
+
+  std::string tmp = std::string(image_name) + ".tmp";
+  FILE *out = fopen(tmp.c_str(), "wb");
+  assert(out != NULL);
+  mem_page_image::write(out, page_size, pages);
+  if (fclose(out) || rename(tmp.c_str(), image_name)) {
+    printf("GPGPU-Sim PTX: ERROR ** cannot write checkpoint %s\n",
+           image_name);
+    abort();
+  }
+  printf("GPGPU-Sim PTX: converted checkpoint %s to the page image %s\n",
+         fname, image_name);
+}
+
 void move_warp(warp_inst_t *&dst, warp_inst_t *&src) {
   assert(dst->empty());
   warp_inst_t *temp = dst;
@@ -149,6 +234,11 @@ void gpgpu_functional_sim_config::reg_options(class OptionParser *opp) {
                          " resume from which CTA ", "0");
   option_parser_register(opp, "-checkpoint_insn_Y", OPT_INT32,
                          &checkpoint_insn_Y, " resume from which CTA ", "0");
+  option_parser_register(
+      opp, "-checkpoint_binary", OPT_BOOL, &checkpoint_binary,
+      " store memory checkpoints as binary page images; text ones are "
+      "converted into <file>.img when resumed from (1=on, 0=off)",
+      "0");
 
   option_parser_register(
       opp, "-gpgpu_ptx_convert_to_ptxplus", OPT_BOOL, &m_ptx_convert_to_ptxplus,
@@ -156,6 +246,38 @@ void gpgpu_functional_sim_config::reg_options(class OptionParser *opp) {
   option_parser_register(opp, "-gpgpu_ptx_force_max_capability", OPT_UINT32,
                          &m_ptx_force_max_capability,
                          "Force maximum compute capability", "0");
+  option_parser_register(
+      opp, "-gpgpu_ptx_warp_simd", OPT_INT32, &m_ptx_warp_simd,
+      "Execute common ALU instructions for a whole warp at once (0=off, "
+      "1=on, 2=on and compared against per-thread execution)",
+      "0");
+  option_parser_register(
+      opp, "-gpgpu_ptx_mma_emu", OPT_INT32, &m_ptx_mma_emu,
+      "Tensor core mma arithmetic (0=loop over half, 1=blocked f32 kernel, "
+      "2=kernel compared against the loop)",
+      "1");
+  option_parser_register(
+      opp, "-gpgpu_flat_global_mem", OPT_UINT32, &m_flat_global_mem,
+      "GB of global memory addresses mapped directly into host memory, "
+      "the rest goes through a page table (0 = hash map of pages)",
+      "16");
+  option_parser_register(
+      opp, "-gpgpu_functional_threads", OPT_UINT32, &m_functional_threads,
+      "Host threads running the CTAs of a kernel concurrently in functional "
+      "simulation (needs -gpgpu_flat_global_mem)",
+      "1");
+  option_parser_register(
+      opp, "-gpgpu_functional_deterministic", OPT_BOOL,
+      &m_functional_deterministic,
+      "With -gpgpu_functional_threads, perform global atomics in CTA order "
+      "so results match a single-threaded run",
+      "0");
+  option_parser_register(
+      opp, "-gpgpu_kernel_memo", OPT_UINT32, &m_kernel_memo,
+      "MB of results of functional kernel launches kept to replay later "
+      "launches of the same kernel, grid and parameters on unchanged global "
+      "memory (needs -gpgpu_flat_global_mem, 0 = off)",
+      "0");
   option_parser_register(
       opp, "-gpgpu_ptx_inst_debug_to_file", OPT_BOOL, &g_ptx_inst_debug_to_file,
       "Dump executed instructions' debug information to file", "0");
@@ -176,7 +298,12 @@ void gpgpu_functional_sim_config::ptx_set_tex_cache_linesize(
 gpgpu_t::gpgpu_t(const gpgpu_functional_sim_config &config, gpgpu_context *ctx)
     : m_function_model_config(config) {
   gpgpu_ctx = ctx;
-  m_global_mem = new memory_space_impl<8192>("global", 64 * 1024);
+  unsigned long long flat_size =
+      (unsigned long long)m_function_model_config.get_flat_global_mem() << 30;
+  if (flat_size)
+    m_global_mem = new flat_memory_space<8192>("global", flat_size);
+  else
+    m_global_mem = new memory_space_impl<8192>("global", 64 * 1024);
 
   m_tex_mem = new memory_space_impl<8192>("tex", 64 * 1024);
   m_surf_mem = new memory_space_impl<8192>("surf", 64 * 1024);
@@ -190,6 +317,7 @@ gpgpu_t::gpgpu_t(const gpgpu_functional_sim_config &config, gpgpu_context *ctx)
   resume_CTA = m_function_model_config.get_resume_CTA();
   checkpoint_CTA_t = m_function_model_config.get_checkpoint_CTA_t();
   checkpoint_insn_Y = m_function_model_config.get_checkpoint_insn_Y();
+  checkpoint_binary = m_function_model_config.get_checkpoint_binary();
 
   // initialize texture mappings to empty
   m_NameToTextureInfo.clear();
@@ -750,6 +878,7 @@ kernel_info_t::kernel_info_t(dim3 gridDim, dim3 blockDim,
   m_kernel_entry = entry;
   m_grid_dim = gridDim;
   m_block_dim = blockDim;
+  m_dynamic_smem = 0;
   m_next_cta.x = 0;
   m_next_cta.y = 0;
   m_next_cta.z = 0;
@@ -781,6 +910,7 @@ kernel_info_t::kernel_info_t(
   m_kernel_entry = entry;
   m_grid_dim = gridDim;
   m_block_dim = blockDim;
+  m_dynamic_smem = 0;
   m_next_cta.x = 0;
   m_next_cta.y = 0;
   m_next_cta.z = 0;
@@ -1176,6 +1306,23 @@ void simt_stack::update(simt_mask_t &thread_done, addr_vector_t &next_pc,
 }
 
 void core_t::execute_warp_inst_t(warp_inst_t &inst, unsigned warpId) {
+  int simd = m_gpu->get_config().get_ptx_warp_simd();
+  warp_simd_exec exec;
+  if (simd != WARP_SIMD_OFF) {
+    if (warpId == (unsigned(-1))) warpId = inst.warp_id();
+    if (!exec.prepare(inst, m_thread + m_warp_size * warpId, m_warp_size))
+      simd = WARP_SIMD_OFF;
+  }
+  if (simd == WARP_SIMD_ON) {
+    exec.commit(inst);
+    for (unsigned t = 0; t < m_warp_size; t++) {
+      if (!inst.active(t)) continue;
+      if (exec.skipped(t)) inst.set_not_active(t);
+      checkExecutionStatusAndUpdate(inst, t, m_warp_size * warpId + t);
+    }
+    return;
+  }
+
   for (unsigned t = 0; t < m_warp_size; t++) {
     if (inst.active(t)) {
       if (warpId == (unsigned(-1))) warpId = inst.warp_id();
@@ -1186,6 +1333,7 @@ void core_t::execute_warp_inst_t(warp_inst_t &inst, unsigned warpId) {
       checkExecutionStatusAndUpdate(inst, t, tid);
     }
   }
+  if (simd == WARP_SIMD_CHECK) exec.check(inst);
 }
 
 bool core_t::ptx_thread_done(unsigned hw_thread_id) const {
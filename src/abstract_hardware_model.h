@@ -229,6 +229,9 @@ class kernel_info_t {
 
   dim3 get_grid_dim() const { return m_grid_dim; }
   dim3 get_cta_dim() const { return m_block_dim; }
+  // dynamic shared memory requested by the launch, in bytes
+  size_t get_dynamic_smem() const { return m_dynamic_smem; }
+  void set_dynamic_smem(size_t bytes) { m_dynamic_smem = bytes; }
 
   void increment_cta_id() {
     increment_x_then_y_then_z(m_next_cta, m_grid_dim);
@@ -299,6 +302,7 @@ class kernel_info_t {
 
   dim3 m_grid_dim;
   dim3 m_block_dim;
+  size_t m_dynamic_smem;
   dim3 m_next_cta;
   dim3 m_next_tid;
 
@@ -523,6 +527,15 @@ class gpgpu_functional_sim_config {
   int get_resume_CTA() const { return resume_CTA; }
   int get_checkpoint_CTA_t() const { return checkpoint_CTA_t; }
   int get_checkpoint_insn_Y() const { return checkpoint_insn_Y; }
+  bool get_checkpoint_binary() const { return checkpoint_binary; }
+  int get_ptx_warp_simd() const { return m_ptx_warp_simd; }
+  int get_ptx_mma_emu() const { return m_ptx_mma_emu; }
+  unsigned get_flat_global_mem() const { return m_flat_global_mem; }
+  unsigned get_functional_threads() const { return m_functional_threads; }
+  bool get_functional_deterministic() const {
+    return m_functional_deterministic;
+  }
+  unsigned get_kernel_memo() const { return m_kernel_memo; }
 
  private:
   // PTX options
@@ -530,6 +543,12 @@ class gpgpu_functional_sim_config {
   int m_ptx_use_cuobjdump;
   int m_experimental_lib_support;
   unsigned m_ptx_force_max_capability;
+  int m_ptx_warp_simd;
+  int m_ptx_mma_emu;
+  unsigned m_flat_global_mem;
+  unsigned m_functional_threads;
+  bool m_functional_deterministic;
+  unsigned m_kernel_memo;
   int checkpoint_option;
   int checkpoint_kernel;
   int checkpoint_CTA;
@@ -538,6 +557,7 @@ class gpgpu_functional_sim_config {
   unsigned resume_CTA;
   unsigned checkpoint_CTA_t;
   int checkpoint_insn_Y;
+  bool checkpoint_binary;
   int g_ptx_inst_debug_to_file;
   char *g_ptx_inst_debug_file;
   int g_ptx_inst_debug_thread_uid;
@@ -558,6 +578,7 @@ class gpgpu_t {
   unsigned resume_CTA;
   unsigned checkpoint_CTA_t;
   int checkpoint_insn_Y;
+  bool checkpoint_binary;
 
   // Move some cycle core stats here instead of being global
   unsigned long long gpu_sim_cycle;
@@ -1130,8 +1151,15 @@ class warp_inst_t : public inst_t {
     assert(m_per_scalar_thread_valid);
     return m_per_scalar_thread[n].memreqaddr[0];
   }
+  // all MAX_ACCESSES_PER_INSN_PER_THREAD addresses of lane n
+  const new_addr_type *get_addrs(unsigned n) const {
+    assert(m_per_scalar_thread_valid);
+    return m_per_scalar_thread[n].memreqaddr;
+  }
 
   bool isatomic() const { return m_isatomic; }
+  // trace replay: the instruction is an atomic without callbacks
+  void set_atomic() { m_isatomic = true; }
 
   unsigned warp_size() const { return m_config->warp_size; }
 
@@ -1200,12 +1228,23 @@ void move_warp(warp_inst_t *&dst, warp_inst_t *&src);
 size_t get_kernel_code_size(class function_info *entry);
 class checkpoint {
  public:
-  checkpoint();
+  // binary: store memory as mem_page_image files (-checkpoint_binary);
+  // either kind of file is loaded
+  checkpoint(bool binary = false);
   ~checkpoint() { printf("clasfsfss destructed\n"); }
 
   void load_global_mem(class memory_space *temp_mem, char *f1name);
   void store_global_mem(class memory_space *mem, char *fname, char *format);
+  // what store_global_mem() writes for a space that was never created
+  void store_empty_mem(unsigned page_size, char *fname);
+  // writes the text memory file fname as a mem_page_image of page_size
+  // byte pages to image_name; fname is left as it is
+  static void convert_global_mem(const char *fname, const char *image_name,
+                                 unsigned page_size);
   unsigned radnom;
+
+ private:
+  bool m_binary;
 };
 /*
  * This abstract class used as a base for functional and performance and
@@ -34,6 +34,7 @@
 class ptx_recognizer;
 typedef void *yyscan_t;
 #include <stdio.h>
+#include <algorithm>
 #include <map>
 #include <set>
 #include <sstream>
@@ -45,6 +46,7 @@ typedef void *yyscan_t;
 #include "../stream_manager.h"
 #include "cuda_device_runtime.h"
 #include "decuda_pred_table/decuda_pred_table.h"
+#include "kernel_memo.h"
 #include "memory.h"
 #include "opcodes.h"
 #include "ptx-stats.h"
@@ -290,6 +292,7 @@ void function_info::ptx_assemble() {
     gpgpu_ctx->s_g_pc_to_insn.push_back((ptx_instruction *)NULL);
   PC += PC % MAX_INST_SIZE;
   m_start_PC = PC;
+  m_n_reg_slots = m_symtab->num_reg_slots();
 
   addr_t n = 0;  // offset in m_instr_mem
   // Why s_g_pc_to_insn.size() is needed to reserve additional memory for insts?
@@ -508,9 +511,7 @@ void gpgpu_t::memcpy_to_gpu(size_t dst_start_addr, const void *src,
     fclose(kernel_FP);
   }
 
-  for (unsigned n = 0; n < count; n++) {
-    m_global_mem->write(dst_start_addr + n, 1, src_data + n, NULL, NULL);
-  }
+  m_global_mem->write(dst_start_addr, count, src_data, NULL, NULL);
 
   // Copy into the performance model.
   // extern gpgpu_sim* g_the_gpu;
@@ -528,8 +529,7 @@ void gpgpu_t::memcpy_from_gpu(void *dst, size_t src_start_addr, size_t count) {
     fflush(stdout);
   }
   unsigned char *dst_data = (unsigned char *)dst;
-  for (unsigned n = 0; n < count; n++)
-    m_global_mem->read(src_start_addr + n, 1, dst_data + n);
+  m_global_mem->read(src_start_addr, count, dst_data);
 
   // JIN
   FILE *kernel_FP;
@@ -567,11 +567,9 @@ void gpgpu_t::memcpy_gpu_to_gpu(size_t dst, size_t src, size_t count) {
     fclose(kernel_FP);
   }
 
-  for (unsigned n = 0; n < count; n++) {
-    unsigned char tmp;
-    m_global_mem->read(src + n, 1, &tmp);
-    m_global_mem->write(dst + n, 1, &tmp, NULL, NULL);
-  }
+  std::vector<unsigned char> tmp(count);
+  m_global_mem->read(src, count, tmp.data());
+  m_global_mem->write(dst, count, tmp.data(), NULL, NULL);
   if (g_debug_execution >= 3) {
     printf(" done.\n");
     fflush(stdout);
@@ -597,9 +595,8 @@ void gpgpu_t::gpu_memset(size_t dst_start_addr, int c, size_t count) {
     fclose(kernel_FP);
   }
 
-  unsigned char c_value = (unsigned char)c;
-  for (unsigned n = 0; n < count; n++)
-    m_global_mem->write(dst_start_addr + n, 1, &c_value, NULL, NULL);
+  std::vector<unsigned char> c_value(count, (unsigned char)c);
+  m_global_mem->write(dst_start_addr, count, c_value.data(), NULL, NULL);
   if (g_debug_execution >= 3) {
     printf(" done.\n");
     fflush(stdout);
@@ -1092,14 +1089,18 @@ void ptx_instruction::pre_decode() {
 
   bool has_dst = false;
 
+  m_exec_fn = NULL;
   switch (get_opcode()) {
 #define OP_DEF(OP, FUNC, STR, DST, CLASSIFICATION) \
   case OP:                                         \
     has_dst = (DST != 0);                          \
+    m_exec_fn = FUNC;                              \
+    m_op_classification = CLASSIFICATION;          \
     break;
 #define OP_W_DEF(OP, FUNC, STR, DST, CLASSIFICATION) \
   case OP:                                           \
     has_dst = (DST != 0);                            \
+    m_op_classification = CLASSIFICATION;            \
     break;
 #include "opcodes.def"
 #undef OP_DEF
@@ -1148,6 +1149,9 @@ void ptx_instruction::pre_decode() {
 
   set_opcode_and_latency();
   set_bar_type();
+  for (unsigned i = 0; i < m_operands.size(); i++) m_operands[i].pre_decode();
+  m_pred_is_reg = m_pred && m_pred->type() &&
+                  m_pred->type()->get_key().is_reg();
   // Get register operands
   int n = 0, m = 0;
   ptx_instruction::const_iterator opr = op_iter_begin();
@@ -1791,8 +1795,13 @@ void ptx_thread_info::ptx_exec_inst(warp_inst_t &inst, unsigned lane_id) {
     }
 
     if (pI->has_pred()) {
-      const operand_info &pred = pI->get_pred();
-      ptx_reg_t pred_value = get_operand_value(pred, pred, PRED_TYPE, this, 0);
+      ptx_reg_t pred_value;
+      if (pI->pred_is_reg()) {
+        pred_value = get_reg(pI->get_pred_symbol());
+      } else {
+        const operand_info &pred = pI->get_pred();
+        pred_value = get_operand_value(pred, pred, PRED_TYPE, this, 0);
+      }
       if (pI->get_pred_mod() == -1) {
         skip = (pred_value.pred & 0x0001) ^
                pI->get_pred_neg();  // ptxplus inverts the zero flag
@@ -1805,13 +1814,8 @@ void ptx_thread_info::ptx_exec_inst(warp_inst_t &inst, unsigned lane_id) {
     if (skip) {
       inst.set_not_active(lane_id);
     } else {
-      const ptx_instruction *pI_saved = pI;
-      ptx_instruction *pJ = NULL;
-      if (pI->get_opcode() == VOTE_OP || pI->get_opcode() == ACTIVEMASK_OP) {
-        pJ = new ptx_instruction(*pI);
-        *((warp_inst_t *)pJ) = inst;  // copy active mask information
-        pI = pJ;
-      }
+      // active mask information for vote and activemask
+      m_executing_inst = &inst;
 
       if (((inst_opcode == MMA_OP || inst_opcode == MMA_LD_OP ||
             inst_opcode == MMA_ST_OP))) {
@@ -1828,28 +1832,26 @@ void ptx_thread_info::ptx_exec_inst(warp_inst_t &inst, unsigned lane_id) {
       // redundant tensorcore operation
       if (!tensorcore_op(inst_opcode) ||
           ((tensorcore_op(inst_opcode)) && (lane_id == 0))) {
-        switch (inst_opcode) {
-#define OP_DEF(OP, FUNC, STR, DST, CLASSIFICATION) \
-  case OP:                                         \
-    FUNC(pI, this);                                \
-    op_classification = CLASSIFICATION;            \
-    break;
+        if (pI->exec_fn()) {
+          pI->exec_fn()(pI, this);
+        } else {
+          switch (inst_opcode) {
+#define OP_DEF(OP, FUNC, STR, DST, CLASSIFICATION)
 #define OP_W_DEF(OP, FUNC, STR, DST, CLASSIFICATION) \
   case OP:                                           \
     FUNC(pI, get_core(), inst);                      \
-    op_classification = CLASSIFICATION;              \
     break;
 #include "opcodes.def"
 #undef OP_DEF
 #undef OP_W_DEF
-          default:
-            printf("Execution error: Invalid opcode (0x%x)\n",
-                   pI->get_opcode());
-            break;
+            default:
+              printf("Execution error: Invalid opcode (0x%x)\n",
+                     pI->get_opcode());
+              break;
+          }
         }
+        op_classification = pI->op_classification();
       }
-      delete pJ;
-      pI = pI_saved;
 
       // Run exit instruction if exit option included
       if (pI->is_exit()) exit_impl(pI, this);
@@ -1939,7 +1941,7 @@ void ptx_thread_info::ptx_exec_inst(warp_inst_t &inst, unsigned lane_id) {
         dump_regs(stdout);
     }
     update_pc();
-    m_gpu->gpgpu_ctx->func_sim->g_ptx_sim_num_insn++;
+    (*m_num_insn)++;
 
     // not using it with functional simulation mode
     if (!(this->m_functionalSimulationMode))
@@ -1986,16 +1988,7 @@ void ptx_thread_info::ptx_exec_inst(warp_inst_t &inst, unsigned lane_id) {
                         [m_gpu->gpgpu_ctx->func_sim->g_ptx_kernel_count],
                     (int)pI->get_opcode());
     }
-    if ((m_gpu->gpgpu_ctx->func_sim->g_ptx_sim_num_insn % 100000) == 0) {
-      dim3 ctaid = get_ctaid();
-      dim3 tid = get_tid();
-      DPRINTF(LIVENESS,
-              "GPGPU-Sim PTX: %u instructions simulated : ctaid=(%u,%u,%u) "
-              "tid=(%u,%u,%u)\n",
-              m_gpu->gpgpu_ctx->func_sim->g_ptx_sim_num_insn, ctaid.x, ctaid.y,
-              ctaid.z, tid.x, tid.y, tid.z);
-      fflush(stdout);
-    }
+    liveness_message();
 
     // "Return values"
     if (!skip) {
@@ -2015,6 +2008,18 @@ void ptx_thread_info::ptx_exec_inst(warp_inst_t &inst, unsigned lane_id) {
   }
 }
 
+void ptx_thread_info::liveness_message() {
+  if ((*m_num_insn % 100000) == 0) {
+    dim3 ctaid = get_ctaid();
+    dim3 tid = get_tid();
+    DPRINTF(LIVENESS,
+            "GPGPU-Sim PTX: %u instructions simulated : ctaid=(%u,%u,%u) "
+            "tid=(%u,%u,%u)\n",
+            *m_num_insn, ctaid.x, ctaid.y, ctaid.z, tid.x, tid.y, tid.z);
+    fflush(stdout);
+  }
+}
+
 void cuda_sim::set_param_gpgpu_num_shaders(int num_shaders) {
   gpgpu_param_num_shaders = num_shaders;
 }
@@ -2039,9 +2044,9 @@ unsigned ptx_sim_init_thread(kernel_info_t &kernel,
   static std::map<unsigned, memory_space *> shared_memory_lookup;
   static std::map<unsigned, memory_space *> sstarr_memory_lookup;
   static std::map<unsigned, ptx_cta_info *> ptx_cta_lookup;
-  static std::map<unsigned, ptx_warp_info *> ptx_warp_lookup;
-  static std::map<unsigned, std::map<unsigned, memory_space *> >
-      local_memory_lookup;
+  static std::map<unsigned, std::map<unsigned, ptx_warp_info *> >
+      ptx_warp_lookup;
+  ptx_thread_pool &pool = gpu->gpgpu_ctx->func_sim->g_thread_pools[sid];
 
   if (*thread_info != NULL) {
     ptx_thread_info *thd = *thread_info;
@@ -2056,7 +2061,7 @@ unsigned ptx_sim_init_thread(kernel_info_t &kernel,
       fflush(stdout);
     }
     thd->m_cta_info->register_deleted_thread(thd);
-    delete thd;
+    pool.release(thd);
     *thread_info = NULL;
   }
 
@@ -2121,35 +2126,20 @@ unsigned ptx_sim_init_thread(kernel_info_t &kernel,
     cta_info->check_cta_thread_status_and_reset();
   }
 
-  std::map<unsigned, memory_space *> &local_mem_lookup =
-      local_memory_lookup[sid];
+  std::map<unsigned, ptx_warp_info *> &warp_lookup = ptx_warp_lookup[sid];
   while (kernel.more_threads_in_cta()) {
     dim3 ctaid3d = kernel.get_next_cta_id();
-    unsigned new_tid = kernel.get_next_thread_id();
     dim3 tid3d = kernel.get_next_thread_id_3d();
     kernel.increment_thread_id();
-    new_tid += tid;
-    ptx_thread_info *thd = new ptx_thread_info(kernel);
+    ptx_thread_info *thd = pool.alloc(kernel);
     ptx_warp_info *warp_info = NULL;
-    if (ptx_warp_lookup.find(hw_warp_id) == ptx_warp_lookup.end()) {
+    if (warp_lookup.find(hw_warp_id) == warp_lookup.end()) {
       warp_info = new ptx_warp_info();
-      ptx_warp_lookup[hw_warp_id] = warp_info;
+      warp_lookup[hw_warp_id] = warp_info;
     } else {
-      warp_info = ptx_warp_lookup[hw_warp_id];
+      warp_info = warp_lookup[hw_warp_id];
     }
     thd->m_warp_info = warp_info;
-
-    memory_space *local_mem = NULL;
-    std::map<unsigned, memory_space *>::iterator l =
-        local_mem_lookup.find(new_tid);
-    if (l != local_mem_lookup.end()) {
-      local_mem = l->second;
-    } else {
-      char buf[512];
-      snprintf(buf, 512, "local_%u_%u", sid, new_tid);
-      local_mem = new memory_space_impl<32>(buf, 32);
-      local_mem_lookup[new_tid] = local_mem;
-    }
     thd->set_info(kernel.entry());
     thd->set_nctaid(kernel.get_grid_dim());
     thd->set_ntid(kernel.get_cta_dim());
@@ -2166,7 +2156,6 @@ unsigned ptx_sim_init_thread(kernel_info_t &kernel,
     thd->func_info()->param_to_shared(thd->m_sstarr_mem, st);
     thd->m_cta_info = cta_info;
     cta_info->add_thread(thd);
-    thd->m_local_mem = local_mem;
     if (g_debug_execution == -1) {
       printf(
           "GPGPU-Sim PTX simulator:  allocating thread ctaid=(%u,%u,%u) "
@@ -2193,6 +2182,22 @@ unsigned ptx_sim_init_thread(kernel_info_t &kernel,
   return 1;
 }
 
+void cuda_sim::print_thread_pool_stats(FILE *fout) const {
+  size_t max_bytes = 0;
+  unsigned max_threads = 0;
+  std::map<unsigned, ptx_thread_pool>::const_iterator p;
+  for (p = g_thread_pools.begin(); p != g_thread_pools.end(); ++p) {
+    max_bytes = std::max(max_bytes, p->second.peak_bytes());
+    max_threads = std::max(max_threads, p->second.peak_threads());
+  }
+  fprintf(fout, "ptx_thread_ctx_peak_kb = %zu\n", max_bytes / 1024);
+  fprintf(fout, "ptx_thread_ctx_peak_threads = %u\n", max_threads);
+  fprintf(fout, "ptx_thread_ctx_peak_kb_per_core =");
+  for (p = g_thread_pools.begin(); p != g_thread_pools.end(); ++p)
+    fprintf(fout, " %zu", p->second.peak_bytes() / 1024);
+  fprintf(fout, "\n");
+}
+
 size_t get_kernel_code_size(class function_info *entry) {
   return entry->get_function_size();
 }
@@ -2459,7 +2464,8 @@ void cuda_sim::gpgpu_cuda_ptx_sim_main_func(kernel_info_t &kernel,
   const struct gpgpu_ptx_sim_info *kernel_info =
       ptx_sim_kernel_info(kernel_func_info);
   checkpoint *g_checkpoint;
-  g_checkpoint = new checkpoint();
+  g_checkpoint =
+      new checkpoint(gpgpu_ctx->the_gpgpusim->g_the_gpu->checkpoint_binary);
 
   if (kernel_func_info->is_pdom_set()) {
     printf("GPGPU-Sim PTX: PDOM analysis already done for %s \n",
@@ -2490,6 +2496,58 @@ void cuda_sim::gpgpu_cuda_ptx_sim_main_func(kernel_info_t &kernel,
   cp_cta_resume = gpgpu_ctx->the_gpgpusim->g_the_gpu->checkpoint_CTA_t;
   int cta_launched = 0;
 
+  // things that observe each CTA as it executes; kernels before the
+  // checkpoint or resume kernel run whole and are not observed
+  const gpgpu_functional_sim_config &fconfig =
+      gpgpu_ctx->the_gpgpusim->g_the_gpu->get_config();
+  int resume_kernel = gpgpu_ctx->the_gpgpusim->g_the_gpu->resume_kernel;
+  bool observed =
+      (cp_op != 0 && (int)kernel.get_uid() >= cp_kernel) ||
+      (gpgpu_ctx->the_gpgpusim->g_the_gpu->resume_option != 0 &&
+       (int)kernel.get_uid() >= resume_kernel) ||
+      gpgpu_ptx_instruction_classification ||
+      fconfig.get_ptx_inst_debug_to_file();
+#if (CUDART_VERSION >= 5000)
+  observed = observed || gpgpu_ctx->device_runtime->g_cdp_enabled;
+#endif
+
+  // a launch seen before is replayed, any other one recorded
+  memory_space *global_mem =
+      gpgpu_ctx->the_gpgpusim->g_the_gpu->get_global_memory();
+  bool memo_recording = false;
+  if (fconfig.get_kernel_memo() && !observed) {
+    if (!g_kernel_memo)
+      g_kernel_memo = new kernel_memo(
+          (unsigned long long)fconfig.get_kernel_memo() << 20);
+    if (g_kernel_memo->memoizable(kernel_func_info) &&
+        !g_kernel_memo->replay(kernel, global_mem))
+      memo_recording = g_kernel_memo->record(kernel, global_mem);
+  }
+
+  // CTAs run concurrently unless something in the way they execute relies
+  // on running one at a time
+  unsigned n_workers = std::min(fconfig.get_functional_threads(),
+                                MAX_STREAMING_MULTIPROCESSORS);
+  if (n_workers > 1 && !kernel.no_more_ctas_to_run()) {
+    bool serial = observed || !fconfig.get_flat_global_mem();
+    if (serial) {
+      if (!g_serial_cta_noted)
+        printf(
+            "GPGPU-Sim PTX: running the CTAs of %s and later kernels one at a "
+            "time where needed (checkpoints, hash map global memory, "
+            "instruction classification, instruction debug files and dynamic "
+            "parallelism need it)\n",
+            kernel.name().c_str());
+      g_serial_cta_noted = true;
+    } else {
+      functional_cta_pool pool(
+          kernel, gpgpu_ctx->the_gpgpusim->g_the_gpu,
+          gpgpu_ctx->the_gpgpusim->g_the_gpu->getShaderCoreConfig()->warp_size,
+          n_workers, fconfig.get_functional_deterministic());
+      pool.run();
+    }
+  }
+
   // we excute the kernel one CTA (Block) at the time, as synchronization
   // functions work block wise
   while (!kernel.no_more_ctas_to_run()) {
@@ -2513,6 +2571,7 @@ void cuda_sim::gpgpu_cuda_ptx_sim_main_func(kernel_info_t &kernel,
     }
     cta_launched++;
   }
+  if (memo_recording) g_kernel_memo->finish(global_mem);
 
   if (cp_op == 1) {
     char f1name[2048];
@@ -2540,6 +2599,8 @@ void cuda_sim::gpgpu_cuda_ptx_sim_main_func(kernel_info_t &kernel,
     StatDisp(g_inst_classification_stat[g_ptx_kernel_count]);
     StatDisp(g_inst_op_classification_stat[g_ptx_kernel_count]);
   }
+  print_thread_pool_stats(stdout);
+  if (g_kernel_memo) g_kernel_memo->print_stats(stdout);
 
   // time_t variables used to calculate the total simulation time
   // the start time of simulation is hold by the global variable
@@ -2579,11 +2640,12 @@ void functionalCoreSim::initializeCTA(unsigned ctaid_cp) {
 
   // get threads for a cta
   for (unsigned i = 0; i < m_kernel->threads_per_cta(); i++) {
-    ptx_sim_init_thread(*m_kernel, &m_thread[i], 0, i,
+    ptx_sim_init_thread(*m_kernel, &m_thread[i], m_sid, i,
                         m_kernel->threads_per_cta() - i,
                         m_kernel->threads_per_cta(), this, 0, i / m_warp_size,
                         (gpgpu_t *)m_gpu, true);
     assert(m_thread[i] != NULL && !m_thread[i]->is_done());
+    if (m_pool) m_thread[i]->set_insn_counter(&m_num_insn);
     char fname[2048];
     snprintf(fname, 2048, "checkpoint_files/thread_%d_0_reg.txt", i);
     if (m_gpu->gpgpu_ctx->func_sim->cp_cta_resume == 1)
@@ -2629,7 +2691,10 @@ void functionalCoreSim::execute(int inst_count, unsigned ctaid_cp) {
   m_gpu->gpgpu_ctx->func_sim->cp_count = m_gpu->checkpoint_insn_Y;
   m_gpu->gpgpu_ctx->func_sim->cp_cta_resume = m_gpu->checkpoint_CTA_t;
   initializeCTA(ctaid_cp);
+  run(inst_count, ctaid_cp);
+}
 
+void functionalCoreSim::run(int inst_count, unsigned ctaid_cp) {
   int count = 0;
   while (true) {
     bool someOneLive = false;
@@ -2652,17 +2717,13 @@ void functionalCoreSim::execute(int inst_count, unsigned ctaid_cp) {
     }
   }
 
-  checkpoint *g_checkpoint;
-  g_checkpoint = new checkpoint();
-
-  ptx_reg_t regval;
-  regval.u64 = 123;
-
-  unsigned ctaid = m_kernel->get_next_cta_id_single();
   if (m_gpu->checkpoint_option == 1 &&
       (m_kernel->get_uid() == m_gpu->checkpoint_kernel) &&
       (ctaid_cp >= m_gpu->checkpoint_CTA) &&
       (ctaid_cp < m_gpu->checkpoint_CTA_t)) {
+    checkpoint *g_checkpoint;
+    g_checkpoint = new checkpoint(m_gpu->checkpoint_binary);
+    unsigned ctaid = m_kernel->get_next_cta_id_single();
     char fname[2048];
     snprintf(fname, 2048, "checkpoint_files/shared_mem_%d.txt", ctaid - 1);
     g_checkpoint->store_global_mem(m_thread[0]->m_shared_mem, fname,
@@ -2675,8 +2736,13 @@ void functionalCoreSim::execute(int inst_count, unsigned ctaid_cp) {
       char f1name[2048];
       snprintf(f1name, 2048, "checkpoint_files/local_mem_thread_%d_%d_reg.txt",
                i, ctaid - 1);
-      g_checkpoint->store_global_mem(m_thread[i]->m_local_mem, f1name,
-                                     (char *)"%08x");
+      // local memory is only created by the thread's first access
+      if (m_thread[i]->allocated_local_mem())
+        g_checkpoint->store_global_mem(m_thread[i]->allocated_local_mem(),
+                                       f1name, (char *)"%08x");
+      else
+        g_checkpoint->store_empty_mem(ptx_thread_info::LOCAL_MEM_PAGE_SIZE,
+                                      f1name);
       m_thread[i]->set_done();
       m_thread[i]->exitCore();
       m_thread[i]->registerExit();
@@ -2698,8 +2764,14 @@ void functionalCoreSim::executeWarp(unsigned i, bool &allAtBarrier,
                                     bool &someOneLive) {
   if (!m_warpAtBarrier[i] && m_liveThreadCount[i] != 0) {
     warp_inst_t inst = getExecuteWarp(i);
+    if (m_pc_counts) (*m_pc_counts)[inst.pc] += inst.active_count();
     execute_warp_inst_t(inst, i);
-    if (inst.isatomic()) inst.do_atomic(true);
+    if (inst.isatomic()) {
+      if (m_pool)
+        m_pool->atomic(inst, m_cta_seq);
+      else
+        inst.do_atomic(true);
+    }
     if (inst.op == BARRIER_OP || inst.op == MEMORY_BARRIER_OP)
       m_warpAtBarrier[i] = true;
     updateSIMTStack(i, &inst);
@@ -2858,6 +2930,53 @@ address_type get_return_pc(void *thd) {
   return the_thread->get_return_PC();
 }
 
+unsigned ptx_vector_elements(const warp_inst_t *inst) {
+  switch (static_cast<const ptx_instruction *>(inst)->get_vector()) {
+    case V2_TYPE:
+      return 2;
+    case V3_TYPE:
+      return 3;
+    case V4_TYPE:
+      return 4;
+    default:
+      return 1;
+  }
+}
+
+bool ptx_touches_shared_state(const warp_inst_t *inst) {
+  const ptx_instruction *pI = static_cast<const ptx_instruction *>(inst);
+  switch (pI->get_opcode()) {
+    case ATOM_OP:
+    case RED_OP:
+    case CALL_OP:
+    case CALLP_OP:
+    case TRAP_OP:
+    case BRKPT_OP:
+    case PMEVENT_OP:
+    case SULD_OP:
+    case SUST_OP:
+    case SURED_OP:
+    case SUQ_OP:
+    case TEX_OP:
+      return true;
+    default:
+      break;
+  }
+  if (!pI->has_memory_read() && !pI->has_memory_write()) return false;
+  switch (pI->get_space().get_type()) {
+    case reg_space:
+    case local_space:
+    case param_space_local:
+    case shared_space:
+    case sstarr_space:
+    case param_space_kernel:
+    case const_space:  // read-only while kernels run
+      return false;
+    default:  // global, generic or not known
+      return true;
+  }
+}
+
 address_type cuda_sim::get_converge_point(address_type pc) {
   // the branch could encode the reconvergence point and/or a bit that indicates
   // the reconvergence point is the return PC on the call stack in the case the
@@ -2886,7 +3005,92 @@ void functionalCoreSim::warp_exit(unsigned warp_id) {
   for (int i = 0; i < m_warp_count * m_warp_size; i++) {
     if (m_thread[i] != NULL) {
       m_thread[i]->m_cta_info->register_deleted_thread(m_thread[i]);
-      delete m_thread[i];
+      m_gpu->gpgpu_ctx->func_sim->g_thread_pools[m_sid].release(m_thread[i]);
     }
   }
 }
+
+functional_cta_pool::functional_cta_pool(kernel_info_t &kernel,
+                                         gpgpu_sim *gpu, unsigned warp_size,
+                                         unsigned n_workers,
+                                         bool deterministic)
+    : m_kernel(kernel) {
+  m_gpu = gpu;
+  m_warp_size = warp_size;
+  m_n_workers = n_workers;
+  m_deterministic = deterministic;
+  m_next_sid = 0;
+  m_next_seq = 0;
+  pthread_mutex_init(&m_setup_lock, NULL);
+  pthread_mutex_init(&m_atomic_lock, NULL);
+  pthread_cond_init(&m_cta_done, NULL);
+}
+
+functional_cta_pool::~functional_cta_pool() {
+  pthread_cond_destroy(&m_cta_done);
+  pthread_mutex_destroy(&m_atomic_lock);
+  pthread_mutex_destroy(&m_setup_lock);
+}
+
+void functional_cta_pool::run() {
+  std::vector<pthread_t> threads(m_n_workers);
+  for (unsigned w = 0; w < m_n_workers; w++) {
+    if (pthread_create(&threads[w], NULL, worker_main, this)) {
+      printf("GPGPU-Sim PTX: ERROR ** cannot start functional worker %u\n",
+             w);
+      abort();
+    }
+  }
+  for (unsigned w = 0; w < m_n_workers; w++) pthread_join(threads[w], NULL);
+}
+
+void *functional_cta_pool::worker_main(void *arg) {
+  functional_cta_pool *pool = (functional_cta_pool *)arg;
+  pthread_mutex_lock(&pool->m_setup_lock);
+  unsigned sid = pool->m_next_sid++;
+  pthread_mutex_unlock(&pool->m_setup_lock);
+  pool->worker(sid);
+  return NULL;
+}
+
+void functional_cta_pool::worker(unsigned sid) {
+  while (true) {
+    pthread_mutex_lock(&m_setup_lock);
+    if (m_kernel.no_more_ctas_to_run()) {
+      pthread_mutex_unlock(&m_setup_lock);
+      break;
+    }
+    unsigned seq = m_next_seq++;
+    pthread_mutex_lock(&m_atomic_lock);
+    m_running.insert(seq);
+    pthread_mutex_unlock(&m_atomic_lock);
+    functionalCoreSim *cta =
+        new functionalCoreSim(&m_kernel, m_gpu, m_warp_size);
+    cta->set_worker(this, sid, seq);
+    cta->initializeCTA(0);
+    pthread_mutex_unlock(&m_setup_lock);
+
+    cta->run(0, 0);
+
+    pthread_mutex_lock(&m_setup_lock);
+    m_gpu->gpgpu_ctx->func_sim->g_ptx_sim_num_insn += cta->m_num_insn;
+    delete cta;
+    pthread_mutex_unlock(&m_setup_lock);
+
+    pthread_mutex_lock(&m_atomic_lock);
+    m_running.erase(seq);
+    pthread_cond_broadcast(&m_cta_done);
+    pthread_mutex_unlock(&m_atomic_lock);
+  }
+}
+
+void functional_cta_pool::atomic(warp_inst_t &inst, unsigned seq) {
+  pthread_mutex_lock(&m_atomic_lock);
+  // the oldest running CTA never waits, so this always makes progress
+  if (m_deterministic && inst.space.get_type() != shared_space) {
+    while (*m_running.begin() != seq)
+      pthread_cond_wait(&m_cta_done, &m_atomic_lock);
+  }
+  inst.do_atomic(true);
+  pthread_mutex_unlock(&m_atomic_lock);
+}
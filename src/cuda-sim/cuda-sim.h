@@ -29,14 +29,18 @@
 #ifndef CUDASIM_H_INCLUDED
 #define CUDASIM_H_INCLUDED
 
+#include <pthread.h>
 #include <stdlib.h>
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 #include "../abstract_hardware_model.h"
+#include "../gpgpu-sim/cta_sampler.h"
 #include "../gpgpu-sim/shader.h"
 #include "ptx_sim.h"
 
+class functional_cta_pool;
 class gpgpu_context;
 class memory_space;
 class function_info;
@@ -69,6 +73,11 @@ class functionalCoreSim : public core_t {
       : core_t(g, kernel, warp_size, kernel->threads_per_cta()) {
     m_warpAtBarrier = new bool[m_warp_count];
     m_liveThreadCount = new unsigned[m_warp_count];
+    m_pc_counts = NULL;
+    m_pool = NULL;
+    m_sid = 0;
+    m_cta_seq = 0;
+    m_num_insn = 0;
   }
   virtual ~functionalCoreSim() {
     warp_exit(0);
@@ -77,15 +86,27 @@ class functionalCoreSim : public core_t {
   }
   //! executes all warps till completion
   void execute(int inst_count, unsigned ctaid_cp);
+  //! adds the active threads of each executed instruction to counts[pc]
+  void count_pcs(pc_count_t *counts) { m_pc_counts = counts; }
+  //! runs as the seq-th CTA started by worker sid of a functional_cta_pool
+  void set_worker(functional_cta_pool *pool, unsigned sid, unsigned seq) {
+    m_pool = pool;
+    m_sid = sid;
+    m_cta_seq = seq;
+  }
   virtual void warp_exit(unsigned warp_id);
   virtual bool warp_waiting_at_barrier(unsigned warp_id) const {
     return (m_warpAtBarrier[warp_id] || !(m_liveThreadCount[warp_id] > 0));
   }
 
  private:
+  friend class functional_cta_pool;
+
   void executeWarp(unsigned, bool &, bool &);
   // initializes threads in the CTA block which we are executing
   void initializeCTA(unsigned ctaid_cp);
+  // executes the warps of an initialized CTA
+  void run(int inst_count, unsigned ctaid_cp);
   virtual void checkExecutionStatusAndUpdate(warp_inst_t &inst, unsigned t,
                                              unsigned tid) {
     if (m_thread[tid] == NULL || m_thread[tid]->is_done()) {
@@ -99,11 +120,64 @@ class functionalCoreSim : public core_t {
   // each warp live thread count and barrier indicator
   unsigned *m_liveThreadCount;
   bool *m_warpAtBarrier;
+  pc_count_t *m_pc_counts;
+  functional_cta_pool *m_pool;
+  unsigned m_sid;
+  unsigned m_cta_seq;
+  // instructions of the CTA when it runs on a worker
+  unsigned m_num_insn;
+};
+
+/*!
+ * Runs the CTAs of a kernel on several host threads in functional simulation
+ * (-gpgpu_functional_threads). CTAs only share global memory: setting a CTA
+ * up and tearing it down go through the kernel's CTA cursor and the
+ * bookkeeping of ptx_sim_init_thread, so they take a lock, as do atomics;
+ * everything else runs unsynchronized. Each worker gives its CTAs its own
+ * shader id, which keeps shared memory and the per-CTA state of
+ * ptx_sim_init_thread apart.
+ */
+class functional_cta_pool {
+ public:
+  functional_cta_pool(kernel_info_t &kernel, gpgpu_sim *gpu,
+                      unsigned warp_size, unsigned n_workers,
+                      bool deterministic);
+  ~functional_cta_pool();
+
+  //! executes every remaining CTA of the kernel
+  void run();
+  //! performs the atomics of a warp instruction of the seq-th CTA; in
+  //! deterministic mode global atomics wait until all earlier CTAs are done
+  void atomic(warp_inst_t &inst, unsigned seq);
+
+ private:
+  static void *worker_main(void *arg);
+  void worker(unsigned sid);
+
+  kernel_info_t &m_kernel;
+  gpgpu_sim *m_gpu;
+  unsigned m_warp_size;
+  unsigned m_n_workers;
+  bool m_deterministic;
+  // the next worker to start, during run()
+  unsigned m_next_sid;
+
+  pthread_mutex_t m_setup_lock;
+  unsigned m_next_seq;
+
+  pthread_mutex_t m_atomic_lock;
+  pthread_cond_t m_cta_done;
+  std::set<unsigned> m_running;
 };
 
 #define RECONVERGE_RETURN_PC ((address_type)-2)
 #define NO_BRANCH_DIVERGENCE ((address_type)-1)
 address_type get_return_pc(void *thd);
+// elements a vector load or store moves per thread, 1 for scalars
+unsigned ptx_vector_elements(const warp_inst_t *inst);
+// true if executing inst can touch state outside the core of its thread:
+// global memory, textures and surfaces, calls (printf, device launches)
+bool ptx_touches_shared_state(const warp_inst_t *inst);
 const char *get_ptxinfo_kname();
 void print_ptxinfo();
 void clear_ptxinfo();
@@ -132,6 +206,8 @@ class cuda_sim {
     g_ptx_thread_info_delete_count = 0;
     g_ptx_thread_info_uid_next = 1;
     g_debug_pc = 0xBEEF1518;
+    g_kernel_memo = NULL;
+    g_serial_cta_noted = false;
     gpgpu_ctx = ctx;
   }
   // global variables
@@ -174,7 +250,13 @@ class cuda_sim {
   ptx_reg_t *ptx_tex_regs;
   unsigned g_ptx_thread_info_delete_count;
   unsigned g_ptx_thread_info_uid_next;
+  // thread contexts of each core, by sid
+  std::map<unsigned, ptx_thread_pool> g_thread_pools;
   addr_t g_debug_pc;
+  // -gpgpu_kernel_memo, created by the first launch that uses it
+  class kernel_memo *g_kernel_memo;
+  // the message about CTAs running one at a time was printed
+  bool g_serial_cta_noted;
   // backward pointer
   class gpgpu_context *gpgpu_ctx;
   // global functions
@@ -199,6 +281,7 @@ class cuda_sim {
   void gpgpu_ptx_sim_memcpy_symbol(const char *hostVar, const void *src,
                                    size_t count, size_t offset, int to,
                                    gpgpu_t *gpu);
+  void print_thread_pool_stats(FILE *fout) const;
   void ptx_print_insn(address_type pc, FILE *fp);
   std::string ptx_get_insn_str(address_type pc);
   template <int activate_level>
@@ -88,7 +88,7 @@ void gpgpusim_cuda_vprintf(const ptx_instruction *pI, ptx_thread_info *thread,
     addr_t from_addr = actual_param_op.get_symbol()->get_address();
     unsigned long long buffer[1024];
     assert(size < 1024 * sizeof(unsigned long long));
-    thread->m_local_mem->read(from_addr, size, buffer);
+    thread->local_mem()->read(from_addr, size, buffer);
     addr_t addr =
         (addr_t)buffer[0];  // should be pointer to generic memory location
     memory_space *mem = NULL;
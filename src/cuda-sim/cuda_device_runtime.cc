@@ -53,24 +53,24 @@ void cuda_device_runtime::gpgpusim_cuda_getParameterBufferV2(
     if (arg == 0) {  // function_info* for the child kernel
       unsigned long long buf;
       assert(size == sizeof(function_info *));
-      thread->m_local_mem->read(from_addr, size, &buf);
+      thread->local_mem()->read(from_addr, size, &buf);
       child_kernel_entry = (function_info *)buf;
       assert(child_kernel_entry);
       DEV_RUNTIME_REPORT("child kernel name "
                          << child_kernel_entry->get_name());
     } else if (arg == 1) {  // dim3 grid_dim for the child kernel
       assert(size == sizeof(struct dim3));
-      thread->m_local_mem->read(from_addr, size, &grid_dim);
+      thread->local_mem()->read(from_addr, size, &grid_dim);
       DEV_RUNTIME_REPORT("grid (" << grid_dim.x << ", " << grid_dim.y << ", "
                                   << grid_dim.z << ")");
     } else if (arg == 2) {  // dim3 block_dim for the child kernel
       assert(size == sizeof(struct dim3));
-      thread->m_local_mem->read(from_addr, size, &block_dim);
+      thread->local_mem()->read(from_addr, size, &block_dim);
       DEV_RUNTIME_REPORT("block (" << block_dim.x << ", " << block_dim.y << ", "
                                    << block_dim.z << ")");
     } else if (arg == 3) {  // unsigned int shared_mem
       assert(size == sizeof(unsigned int));
-      thread->m_local_mem->read(from_addr, size, &shared_mem);
+      thread->local_mem()->read(from_addr, size, &shared_mem);
       DEV_RUNTIME_REPORT("shared memory " << shared_mem);
     }
   }
@@ -102,7 +102,7 @@ void cuda_device_runtime::gpgpusim_cuda_getParameterBufferV2(
   assert(actual_return_op.get_symbol()->get_size_in_bytes() == return_size &&
          return_size == sizeof(void *));
   addr_t ret_param_addr = actual_return_op.get_symbol()->get_address();
-  thread->m_local_mem->write(ret_param_addr, return_size, &param_buffer, NULL,
+  thread->local_mem()->write(ret_param_addr, return_size, &param_buffer, NULL,
                              NULL);
 }
 
@@ -138,7 +138,7 @@ void cuda_device_runtime::gpgpusim_cuda_launchDeviceV2(
     if (arg == 0) {  // paramter buffer for child kernel (in global memory)
       // get parameter_buffer from the cudaLaunchDeviceV2_param0
       assert(size == sizeof(void *));
-      thread->m_local_mem->read(from_addr, size, &parameter_buffer);
+      thread->local_mem()->read(from_addr, size, &parameter_buffer);
       assert((size_t)parameter_buffer >= GLOBAL_HEAP_START);
       DEV_RUNTIME_REPORT("Parameter buffer locating at global memory "
                          << parameter_buffer);
@@ -180,6 +180,7 @@ void cuda_device_runtime::gpgpusim_cuda_launchDeviceV2(
       device_grid = new kernel_info_t(
           config.grid_dim, config.block_dim, device_kernel_entry,
           gpu->getNameArrayMapping(), gpu->getNameInfoMapping());
+      device_grid->set_dynamic_smem(config.shared_mem);
       device_grid->launch_cycle = gpu->gpu_sim_cycle + gpu->gpu_tot_sim_cycle;
       kernel_info_t &parent_grid = thread->get_kernel();
       DEV_RUNTIME_REPORT(
@@ -205,7 +206,7 @@ void cuda_device_runtime::gpgpusim_cuda_launchDeviceV2(
     } else if (arg == 1) {  // cudaStream for the child kernel
 
       assert(size == sizeof(cudaStream_t));
-      thread->m_local_mem->read(from_addr, size, &child_stream);
+      thread->local_mem()->read(from_addr, size, &child_stream);
 
       kernel_info_t &parent_kernel = thread->get_kernel();
       if (child_stream == 0) {  // default stream on device for current CTA
@@ -241,7 +242,7 @@ void cuda_device_runtime::gpgpusim_cuda_launchDeviceV2(
          return_size == sizeof(cudaError_t));
   cudaError_t error = cudaSuccess;
   addr_t ret_param_addr = actual_return_op.get_symbol()->get_address();
-  thread->m_local_mem->write(ret_param_addr, return_size, &error, NULL, NULL);
+  thread->local_mem()->write(ret_param_addr, return_size, &error, NULL, NULL);
 }
 
 // Handling device runtime api:
@@ -272,7 +273,7 @@ void cuda_device_runtime::gpgpusim_cuda_streamCreateWithFlags(
 
     if (arg == 0) {  // cudaStream_t * pStream, address of cudaStream_t
       assert(size == sizeof(cudaStream_t *));
-      thread->m_local_mem->read(from_addr, size, &generic_pStream_addr);
+      thread->local_mem()->read(from_addr, size, &generic_pStream_addr);
 
       // pStream should be non-zero address in local memory
       pStream_addr = generic_to_local(
@@ -282,7 +283,7 @@ void cuda_device_runtime::gpgpusim_cuda_streamCreateWithFlags(
     } else if (arg ==
                1) {  // unsigned int flags, should be cudaStreamNonBlocking
       assert(size == sizeof(unsigned int));
-      thread->m_local_mem->read(from_addr, size, &flags);
+      thread->local_mem()->read(from_addr, size, &flags);
       assert(flags == cudaStreamNonBlocking);
     }
   }
@@ -291,7 +292,7 @@ void cuda_device_runtime::gpgpusim_cuda_streamCreateWithFlags(
   CUstream_st *stream =
       thread->get_kernel().create_stream_cta(thread->get_ctaid());
   DEV_RUNTIME_REPORT("Create stream " << stream->get_uid() << ": " << stream);
-  thread->m_local_mem->write(pStream_addr, sizeof(cudaStream_t), &stream, NULL,
+  thread->local_mem()->write(pStream_addr, sizeof(cudaStream_t), &stream, NULL,
                              NULL);
 
   // set retval0
@@ -305,7 +306,7 @@ void cuda_device_runtime::gpgpusim_cuda_streamCreateWithFlags(
          return_size == sizeof(cudaError_t));
   cudaError_t error = cudaSuccess;
   addr_t ret_param_addr = actual_return_op.get_symbol()->get_address();
-  thread->m_local_mem->write(ret_param_addr, return_size, &error, NULL, NULL);
+  thread->local_mem()->write(ret_param_addr, return_size, &error, NULL, NULL);
 }
 
 void cuda_device_runtime::launch_one_device_kernel() {
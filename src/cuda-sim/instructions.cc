@@ -49,6 +49,7 @@ class ptx_recognizer;
 #include "../gpgpu-sim/shader.h"
 #include "cuda-math.h"
 #include "cuda_device_printf.h"
+#include "mma_emu.h"
 #include "ptx.tab.h"
 #include "ptx_loader.h"
 
@@ -173,10 +174,10 @@ void sign_extend(ptx_reg_t &data, unsigned src_size, const operand_info &dst);
 
 void ptx_thread_info::set_reg(const symbol *reg, const ptx_reg_t &value) {
   assert(reg != NULL);
-  if (reg->name() == "_") return;
+  unsigned slot = reg->reg_num();
+  if (!slot) return;  // "_"
   assert(!m_regs.empty());
-  assert(reg->uid() > 0);
-  m_regs.back()[reg] = value;
+  m_regs.back().set(slot, reg, value);
   if (m_enable_debug_trace) m_debug_trace_regs_modified.back()[reg] = value;
   m_last_set_operand_value = value;
 }
@@ -188,15 +189,15 @@ void ptx_thread_info::print_reg_thread(char *fname) {
   int size = m_regs.size();
 
   if (size > 0) {
-    reg_map_t reg = m_regs.back();
-
-    reg_map_t::const_iterator it;
-    for (it = reg.begin(); it != reg.end(); ++it) {
-      const std::string &name = it->first->name();
-      const std::string &dec = it->first->decl_location();
-      unsigned size = it->first->get_size_in_bytes();
-      fprintf(fp, "%s %llu %s %d\n", name.c_str(), it->second, dec.c_str(),
-              size);
+    const reg_frame &reg = m_regs.back();
+
+    for (unsigned slot = 0; slot < reg.size(); slot++) {
+      if (!reg.defined(slot)) continue;
+      const std::string &name = reg.sym(slot)->name();
+      const std::string &dec = reg.sym(slot)->decl_location();
+      unsigned size = reg.sym(slot)->get_size_in_bytes();
+      fprintf(fp, "%s %llu %s %d\n", name.c_str(), reg.value(slot).u64,
+              dec.c_str(), size);
     }
     // m_regs.pop_back();
   }
@@ -206,7 +207,7 @@ void ptx_thread_info::print_reg_thread(char *fname) {
 void ptx_thread_info::resume_reg_thread(char *fname, symbol_table *symtab) {
   FILE *fp2 = fopen(fname, "r");
   assert(fp2 != NULL);
-  // m_regs.push_back( reg_map_t() );
+  // m_regs.push_back( reg_frame() );
   char line[200];
   while (fgets(line, sizeof line, fp2) != NULL) {
     symbol *reg;
@@ -219,7 +220,7 @@ void ptx_thread_info::resume_reg_thread(char *fname, symbol_table *symtab) {
     data = atoi(pch);
     pch = strtok(NULL, " ");
     pch = strtok(NULL, " ");
-    m_regs.back()[reg] = data;
+    m_regs.back().set(reg->reg_num(), reg, data);
   }
   fclose(fp2);
 }
@@ -228,8 +229,8 @@ ptx_reg_t ptx_thread_info::get_reg(const symbol *reg) {
   static bool unfound_register_warned = false;
   assert(reg != NULL);
   assert(!m_regs.empty());
-  reg_map_t::iterator regs_iter = m_regs.back().find(reg);
-  if (regs_iter == m_regs.back().end()) {
+  unsigned slot = reg->reg_num();
+  if (!m_regs.back().defined(slot)) {
     assert(reg->type()->get_key().is_reg());
     const std::string &name = reg->name();
     unsigned call_uid = m_callstack.back().m_call_uid;
@@ -247,11 +248,17 @@ ptx_reg_t ptx_thread_info::get_reg(const symbol *reg) {
           file_loc.c_str(), name.c_str(), call_uid);
       unfound_register_warned = true;
     }
-    regs_iter = m_regs.back().find(reg);
+    if (!slot) return uninit_reg;  // "_"
   }
-  if (m_enable_debug_trace)
-    m_debug_trace_regs_read.back()[reg] = regs_iter->second;
-  return regs_iter->second;
+  const ptx_reg_t &value = m_regs.back().value(slot);
+  if (m_enable_debug_trace) m_debug_trace_regs_read.back()[reg] = value;
+  return value;
+}
+
+ptx_reg_t ptx_thread_info::peek_reg(const symbol *reg) const {
+  unsigned slot = reg->reg_num();
+  if (!m_regs.back().defined(slot)) return ptx_reg_t();
+  return m_regs.back().value(slot);
 }
 
 ptx_reg_t ptx_thread_info::get_operand_value(const operand_info &op,
@@ -261,6 +268,11 @@ ptx_reg_t ptx_thread_info::get_operand_value(const operand_info &op,
                                              int derefFlag) {
   ptx_reg_t result, tmp;
 
+  if (opType != BB128_TYPE && opType != BB64_TYPE && opType != FF64_TYPE) {
+    if (op.fetch() == operand_info::FETCH_REG) return get_reg(op.get_symbol());
+    if (op.fetch() == operand_info::FETCH_LITERAL) return op.literal();
+  }
+
   if (op.get_double_operand_type() == 0) {
     if (((opType != BB128_TYPE) && (opType != BB64_TYPE) &&
          (opType != FF64_TYPE)) ||
@@ -426,7 +438,7 @@ ptx_reg_t ptx_thread_info::get_operand_value(const operand_info &op,
       sign_extend(finalResult, size, dstInfo);
   } else if ((op.get_addr_space() == local_space) && (derefFlag)) {
     // local memory - l0[4], l0[$r0]
-    mem = thread->m_local_mem;
+    mem = thread->local_mem();
     type_info_key::type_decode(opType, size, t);
     mem->read(result.u64, size / 8, &finalResult.u128);
     thread->m_last_effective_address = result.u64;
@@ -530,11 +542,9 @@ void ptx_thread_info::get_vector_operand_values(const operand_info &op,
   for (int idx = num_elements - 1; idx >= 0; --idx) {
     const symbol *sym = NULL;
     sym = op.vec_symbol(idx);
-    if (strcmp(sym->name().c_str(), "_") != 0) {
-      reg_map_t::iterator reg_iter = m_regs.back().find(sym);
-      if(reg_iter != m_regs.back().end())	// Added by jin
-        ptx_regs[idx] = reg_iter->second;
-    }
+    unsigned slot = sym->reg_num();
+    if (slot && m_regs.back().defined(slot))  // not "_"; Added by jin
+      ptx_regs[idx] = m_regs.back().value(slot);
   }
 }
 
@@ -568,7 +578,7 @@ void ptx_thread_info::set_operand_value(const operand_info &dst,
     ptx_reg_t predValue;
 
     const symbol *sym = dst.vec_symbol(0);
-    predValue.u64 = (m_regs.back()[sym].u64) & ~(0x0C);
+    predValue.u64 = peek_reg(sym).u64 & ~(0x0C);
     predValue.u64 |= ((overflow & 0x01) << 3);
     predValue.u64 |= ((carry & 0x01) << 2);
 
@@ -590,6 +600,14 @@ void ptx_thread_info::set_operand_value(const operand_info &dst,
   size_t size;
   int t;
 
+  if (dst.fetch() == operand_info::FETCH_REG && type != BB128_TYPE &&
+      type != BB64_TYPE && type != FF64_TYPE) {
+    ptx_reg_t setValue;
+    setValue.u64 = data.u64;
+    set_reg(dst.get_symbol(), setValue);
+    return;
+  }
+
   type_info_key::type_decode(type, size, t);
 
   /*complete this section for other cases*/
@@ -681,9 +699,9 @@ void ptx_thread_info::set_operand_value(const operand_info &dst,
 
       if (dst.get_operand_lohi() == 1) {
         setValue.u64 =
-            ((m_regs.back()[regName].u64) & (~(0xFFFF))) + (data.u64 & 0xFFFF);
+            (peek_reg(regName).u64 & (~(0xFFFF))) + (data.u64 & 0xFFFF);
       } else if (dst.get_operand_lohi() == 2) {
-        setValue.u64 = ((m_regs.back()[regName].u64) & (~(0xFFFF0000))) +
+        setValue.u64 = (peek_reg(regName).u64 & (~(0xFFFF0000))) +
                        ((data.u64 << 16) & 0xFFFF0000);
       }
 
@@ -731,12 +749,11 @@ void ptx_thread_info::set_operand_value(const operand_info &dst,
       set_reg(name2, setValue2);
     } else {
       if (dst.get_operand_lohi() == 1) {
-        setValue.u64 = ((m_regs.back()[dst.get_symbol()].u64) & (~(0xFFFF))) +
+        setValue.u64 = (peek_reg(dst.get_symbol()).u64 & (~(0xFFFF))) +
                        (data.u64 & 0xFFFF);
       } else if (dst.get_operand_lohi() == 2) {
-        setValue.u64 =
-            ((m_regs.back()[dst.get_symbol()].u64) & (~(0xFFFF0000))) +
-            ((data.u64 << 16) & 0xFFFF0000);
+        setValue.u64 = (peek_reg(dst.get_symbol()).u64 & (~(0xFFFF0000))) +
+                       ((data.u64 << 16) & 0xFFFF0000);
       }
       set_reg(dst.get_symbol(), setValue);
     }
@@ -767,7 +784,7 @@ void ptx_thread_info::set_operand_value(const operand_info &dst,
   // local memory - l0[4], l0[$r0]
   else if (dst.get_addr_space() == local_space) {
     dstData = thread->get_operand_value(dst, dst, type, thread, 0);
-    mem = thread->m_local_mem;
+    mem = thread->local_mem();
     type_info_key::type_decode(type, size, t);
 
     mem->write(dstData.u64, size / 8, &data.u128, thread, pI);
@@ -1885,78 +1902,82 @@ void mapping(int thread, int wmma_type, int wmma_layout, int type, int index,
   }
 }
 
+// an element of an mma matrix as a float, for the debug output
+static float mma_element_value(unsigned bits, unsigned type) {
+  if (type == F16_TYPE) return half_float::detail::half2float<float>(bits);
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
 void mma_impl(const ptx_instruction *pI, core_t *core, warp_inst_t inst) {
   int i, j, k, thrd;
   int row, col, offset;
-  ptx_reg_t matrix_a[16][16];
-  ptx_reg_t matrix_b[16][16];
-  ptx_reg_t matrix_c[16][16];
-  ptx_reg_t matrix_d[16][16];
-  ptx_reg_t src_data;
+  // f16 bit patterns; c and d hold f32 bits or f16 bits in the low half
+  unsigned short matrix_a[16][16] = {{0}};
+  unsigned short matrix_b[16][16] = {{0}};
+  unsigned matrix_c[16][16] = {{0}};
+  unsigned matrix_d[16][16];
   ptx_thread_info *thread;
 
   unsigned a_layout = pI->get_wmma_layout(0);
   unsigned b_layout = pI->get_wmma_layout(1);
   unsigned type = pI->get_type();
   unsigned type2 = pI->get_type2();
+  bool debug = core->get_gpu()->gpgpu_ctx->debug_tensorcore;
   int tid;
   const operand_info &dst = pI->operand_lookup(0);
 
+  if (type != F16_TYPE && type != F32_TYPE) {
+    printf("wmma:mma:wrong type\n");
+    abort();
+  }
   if (core->get_gpu()->is_functional_sim())
     tid = inst.warp_id_func() * core->get_warp_size();
   else
     tid = inst.warp_id() * core->get_warp_size();
-  float temp;
-  half temp2;
 
   for (thrd = 0; thrd < core->get_warp_size(); thrd++) {
     thread = core->get_thread_info()[tid + thrd];
-    if (core->get_gpu()->gpgpu_ctx->debug_tensorcore)
-      printf("THREAD=%d\n:", thrd);
+    if (debug) printf("THREAD=%d\n:", thrd);
     for (int operand_num = 1; operand_num <= 3; operand_num++) {
       const operand_info &src_a = pI->operand_lookup(operand_num);
       unsigned nelem = src_a.get_vect_nelem();
       ptx_reg_t v[8];
       thread->get_vector_operand_values(src_a, v, nelem);
-      if (core->get_gpu()->gpgpu_ctx->debug_tensorcore) {
+      if (debug) {
         printf("Thread%d_Iteration=%d\n:", thrd, operand_num);
         for (k = 0; k < nelem; k++) {
           printf("%llx ", v[k].u64);
         }
         printf("\n");
       }
-      ptx_reg_t nw_v[16];
-      int hex_val;
+      // f16 pairs, the upper half of each register first
+      unsigned short nw_v[16] = {0};
+      bool f32_operand = (operand_num == 3) && (type2 == F32_TYPE);
 
-      if (!((operand_num == 3) && (type2 == F32_TYPE))) {
+      if (!f32_operand) {
         for (k = 0; k < 2 * nelem; k++) {
           if (k % 2 == 1)
-            hex_val = (v[k / 2].s64 & 0xffff);
+            nw_v[k] = v[k / 2].u32 & 0xffff;
           else
-            hex_val = ((v[k / 2].s64 & 0xffff0000) >> 16);
-          nw_v[k].f16 = *((half *)&hex_val);
+            nw_v[k] = v[k / 2].u32 >> 16;
         }
       }
-      if (!((operand_num == 3) && (type2 == F32_TYPE))) {
-        for (k = 0; k < 2 * nelem; k++) {
-          temp = nw_v[k].f16;
-          if (core->get_gpu()->gpgpu_ctx->debug_tensorcore)
-            printf("%.2f ", temp);
-        }
-        if (core->get_gpu()->gpgpu_ctx->debug_tensorcore) printf("\n");
-      } else {
-        if (core->get_gpu()->gpgpu_ctx->debug_tensorcore) {
-          for (k = 0; k < 8; k++) {
-            printf("%.2f ", v[k].f32);
-          }
-          printf("\n");
+      if (debug) {
+        if (!f32_operand) {
+          for (k = 0; k < 2 * nelem; k++)
+            printf("%.2f ", half_float::detail::half2float<float>(nw_v[k]));
+        } else {
+          for (k = 0; k < 8; k++) printf("%.2f ", v[k].f32);
         }
+        printf("\n");
       }
       switch (operand_num) {
         case 1:  // operand 1
           for (k = 0; k < 8; k++) {
             mapping(thrd, LOAD_A, a_layout, F16_TYPE, k, 16, row, col, offset);
-            if (core->get_gpu()->gpgpu_ctx->debug_tensorcore)
+            if (debug)
               printf("A:thread=%d,row=%d,col=%d,offset=%d\n", thrd, row, col,
                      offset);
             matrix_a[row][col] = nw_v[offset];
@@ -1965,7 +1986,7 @@ void mma_impl(const ptx_instruction *pI, core_t *core, warp_inst_t inst) {
         case 2:  // operand 2
           for (k = 0; k < 8; k++) {
             mapping(thrd, LOAD_B, b_layout, F16_TYPE, k, 16, row, col, offset);
-            if (core->get_gpu()->gpgpu_ctx->debug_tensorcore)
+            if (debug)
               printf("B:thread=%d,row=%d,col=%d,offset=%d\n", thrd, row, col,
                      offset);
             matrix_b[row][col] = nw_v[offset];
@@ -1974,11 +1995,11 @@ void mma_impl(const ptx_instruction *pI, core_t *core, warp_inst_t inst) {
         case 3:  // operand 3
           for (k = 0; k < 8; k++) {
             mapping(thrd, LOAD_C, ROW, type2, k, 16, row, col, offset);
-            if (core->get_gpu()->gpgpu_ctx->debug_tensorcore)
+            if (debug)
               printf("C:thread=%d,row=%d,col=%d,offset=%d\n", thrd, row, col,
                      offset);
             if (type2 != F16_TYPE) {
-              matrix_c[row][col] = v[offset];
+              matrix_c[row][col] = v[offset].u32;
             } else {
               matrix_c[row][col] = nw_v[offset];
             }
@@ -1988,142 +2009,100 @@ void mma_impl(const ptx_instruction *pI, core_t *core, warp_inst_t inst) {
           printf("Invalid Operand Index\n");
       }
     }
-    if (core->get_gpu()->gpgpu_ctx->debug_tensorcore) printf("\n");
+    if (debug) printf("\n");
   }
-  if (core->get_gpu()->gpgpu_ctx->debug_tensorcore) {
+  if (debug) {
     printf("MATRIX_A\n");
     for (i = 0; i < 16; i++) {
-      for (j = 0; j < 16; j++) {
-        temp = matrix_a[i][j].f16;
-        printf("%.2f ", temp);
-      }
+      for (j = 0; j < 16; j++)
+        printf("%.2f ", half_float::detail::half2float<float>(matrix_a[i][j]));
       printf("\n");
     }
     printf("MATRIX_B\n");
     for (i = 0; i < 16; i++) {
-      for (j = 0; j < 16; j++) {
-        temp = matrix_b[i][j].f16;
-        printf("%.2f ", temp);
-      }
+      for (j = 0; j < 16; j++)
+        printf("%.2f ", half_float::detail::half2float<float>(matrix_b[i][j]));
       printf("\n");
     }
     printf("MATRIX_C\n");
     for (i = 0; i < 16; i++) {
-      for (j = 0; j < 16; j++) {
-        if (type2 == F16_TYPE) {
-          temp = matrix_c[i][j].f16;
-          printf("%.2f ", temp);
-        } else
-          printf("%.2f ", matrix_c[i][j].f32);
-      }
+      for (j = 0; j < 16; j++)
+        printf("%.2f ", mma_element_value(matrix_c[i][j], type2));
       printf("\n");
     }
   }
-  for (i = 0; i < 16; i++) {
-    for (j = 0; j < 16; j++) {
-      matrix_d[i][j].f16 = 0;
-    }
-  }
 
-  for (i = 0; i < 16; i++) {
-    for (j = 0; j < 16; j++) {
-      for (k = 0; k < 16; k++) {
-        matrix_d[i][j].f16 =
-            matrix_d[i][j].f16 + matrix_a[i][k].f16 * matrix_b[k][j].f16;
-      }
-      if ((type == F16_TYPE) && (type2 == F16_TYPE))
-        matrix_d[i][j].f16 += matrix_c[i][j].f16;
-      else if ((type == F32_TYPE) && (type2 == F16_TYPE)) {
-        temp2 = matrix_d[i][j].f16 + matrix_c[i][j].f16;
-        temp = temp2;
-        matrix_d[i][j].f32 = temp;
-      } else if ((type == F16_TYPE) && (type2 == F32_TYPE)) {
-        temp = matrix_d[i][j].f16;
-        temp += matrix_c[i][j].f32;
-        matrix_d[i][j].f16 = half(temp);
-      } else {
-        temp = matrix_d[i][j].f16;
-        temp += matrix_c[i][j].f32;
-        matrix_d[i][j].f32 = temp;
+  bool c_f32 = type2 != F16_TYPE;
+  bool d_f32 = type == F32_TYPE;
+  int mode = core->get_gpu()->get_config().get_ptx_mma_emu();
+  if (mode == MMA_EMU_SCALAR)
+    mma_m16n16k16_scalar(matrix_a, matrix_b, matrix_c, c_f32, matrix_d, d_f32);
+  else
+    mma_m16n16k16(matrix_a, matrix_b, matrix_c, c_f32, matrix_d, d_f32);
+  if (mode == MMA_EMU_CHECK) {
+    unsigned ref[16][16];
+    mma_m16n16k16_scalar(matrix_a, matrix_b, matrix_c, c_f32, ref, d_f32);
+    for (i = 0; i < 16; i++) {
+      for (j = 0; j < 16; j++) {
+        if (matrix_d[i][j] == ref[i][j]) continue;
+        printf(
+            "GPGPU-Sim PTX: ERROR ** mma kernel gives %08x for element "
+            "(%d,%d) of %s, the loop over half %08x\n",
+            matrix_d[i][j], i, j, pI->get_source(), ref[i][j]);
+        abort();
       }
     }
   }
-  if (core->get_gpu()->gpgpu_ctx->debug_tensorcore) {
+
+  if (debug) {
     printf("MATRIX_D\n");
     for (i = 0; i < 16; i++) {
-      for (j = 0; j < 16; j++) {
-        if (type == F16_TYPE) {
-          temp = matrix_d[i][j].f16;
-          printf("%.2f ", temp);
-        } else
-          printf("%.2f ", matrix_d[i][j].f32);
-      }
+      for (j = 0; j < 16; j++)
+        printf("%.2f ", mma_element_value(matrix_d[i][j], type));
       printf("\n");
     }
   }
   for (thrd = 0; thrd < core->get_warp_size(); thrd++) {
-    int row_t[8];
-    int col_t[8];
+    ptx_reg_t out[8];
     for (k = 0; k < 8; k++) {
-      mapping(thrd, LOAD_C, ROW, type, k, 16, row_t[k], col_t[k], offset);
-      if (core->get_gpu()->gpgpu_ctx->debug_tensorcore)
-        printf("mma:store:row:%d,col%d\n", row_t[k], col_t[k]);
+      mapping(thrd, LOAD_C, ROW, type, k, 16, row, col, offset);
+      if (debug) printf("mma:store:row:%d,col%d\n", row, col);
+      out[k].u32 = matrix_d[row][col];
     }
     thread = core->get_thread_info()[tid + thrd];
 
+    if (debug) {
+      printf("thread%d:", thrd);
+      for (k = 0; k < 8; k++)
+        printf("%.2f ", mma_element_value(out[k].u32, type));
+      printf("\n");
+    }
     if (type == F32_TYPE) {
-      thread->set_wmma_vector_operand_values(
-          dst, matrix_d[row_t[0]][col_t[0]], matrix_d[row_t[1]][col_t[1]],
-          matrix_d[row_t[2]][col_t[2]], matrix_d[row_t[3]][col_t[3]],
-          matrix_d[row_t[4]][col_t[4]], matrix_d[row_t[5]][col_t[5]],
-          matrix_d[row_t[6]][col_t[6]], matrix_d[row_t[7]][col_t[7]]);
-
-      if (core->get_gpu()->gpgpu_ctx->debug_tensorcore) {
-        printf("thread%d:", thrd);
-        for (k = 0; k < 8; k++) {
-          printf("%.2f ", matrix_d[row_t[k]][col_t[k]].f32);
-        }
-        printf("\n");
-      }
-    } else if (type == F16_TYPE) {
-      if (core->get_gpu()->gpgpu_ctx->debug_tensorcore) {
-        printf("thread%d:", thrd);
-        for (k = 0; k < 8; k++) {
-          temp = matrix_d[row_t[k]][col_t[k]].f16;
-          printf("%.2f ", temp);
-        }
-        printf("\n");
-
+      thread->set_wmma_vector_operand_values(dst, out[0], out[1], out[2],
+                                             out[3], out[4], out[5], out[6],
+                                             out[7]);
+    } else {
+      if (debug) {
         printf("thread%d:", thrd);
-        for (k = 0; k < 8; k++) {
-          printf("%x ", (unsigned int)matrix_d[row_t[k]][col_t[k]].f16);
-        }
+        for (k = 0; k < 8; k++) printf("%x ", out[k].u32);
         printf("\n");
       }
       ptx_reg_t nw_data1, nw_data2, nw_data3, nw_data4;
-      nw_data1.s64 = ((matrix_d[row_t[0]][col_t[0]].s64 & 0xffff)) |
-                     ((matrix_d[row_t[1]][col_t[1]].s64 & 0xffff) << 16);
-      nw_data2.s64 = ((matrix_d[row_t[2]][col_t[2]].s64 & 0xffff)) |
-                     ((matrix_d[row_t[3]][col_t[3]].s64 & 0xffff) << 16);
-      nw_data3.s64 = ((matrix_d[row_t[4]][col_t[4]].s64 & 0xffff)) |
-                     ((matrix_d[row_t[5]][col_t[5]].s64 & 0xffff) << 16);
-      nw_data4.s64 = ((matrix_d[row_t[6]][col_t[6]].s64 & 0xffff)) |
-                     ((matrix_d[row_t[7]][col_t[7]].s64 & 0xffff) << 16);
+      nw_data1.u64 = out[0].u32 | (out[1].u32 << 16);
+      nw_data2.u64 = out[2].u32 | (out[3].u32 << 16);
+      nw_data3.u64 = out[4].u32 | (out[5].u32 << 16);
+      nw_data4.u64 = out[6].u32 | (out[7].u32 << 16);
       thread->set_vector_operand_values(dst, nw_data1, nw_data2, nw_data3,
                                         nw_data4);
-      if (core->get_gpu()->gpgpu_ctx->debug_tensorcore)
+      if (debug)
         printf("thread%d=%llx,%llx,%llx,%llx", thrd, nw_data1.s64, nw_data2.s64,
                nw_data3.s64, nw_data4.s64);
-
-    } else {
-      printf("wmma:mma:wrong type\n");
-      abort();
     }
   }
 }
 
 void call_impl(const ptx_instruction *pI, ptx_thread_info *thread) {
-  static unsigned call_uid_next = 1;
+  static thread_local unsigned call_uid_next = 1;
 
   const operand_info &target = pI->func_addr();
   assert(target.is_function_address());
@@ -2217,7 +2196,7 @@ void call_impl(const ptx_instruction *pI, ptx_thread_info *thread) {
 
 // Ptxplus version of call instruction. Jumps to a label not a different Kernel.
 void callp_impl(const ptx_instruction *pI, ptx_thread_info *thread) {
-  static unsigned call_uid_next = 1;
+  static thread_local unsigned call_uid_next = 1;
 
   const operand_info &target = pI->dst();
   ptx_reg_t target_pc =
@@ -3303,7 +3282,7 @@ void decode_space(memory_space_t &space, ptx_thread_info *thread,
       break;
     case param_space_local:
     case local_space:
-      mem = thread->m_local_mem;
+      mem = thread->local_mem();
       addr += thread->get_local_mem_stack_pointer();
       break;
     case tex_space:
@@ -3334,7 +3313,7 @@ void decode_space(memory_space_t &space, ptx_thread_info *thread,
             addr = generic_to_global(addr);
             break;
           case local_space:
-            mem = thread->m_local_mem;
+            mem = thread->local_mem();
             addr = generic_to_local(smid, hwtid, addr);
             break;
           case shared_space:
@@ -6361,12 +6340,14 @@ void vsub_impl(const ptx_instruction *pI, ptx_thread_info *thread) {
 }
 
 void vote_impl(const ptx_instruction *pI, ptx_thread_info *thread) {
-  static bool first_in_warp = true;
-  static bool and_all;
-  static bool or_all;
-  static unsigned int ballot_result;
-  static std::list<ptx_thread_info *> threads_in_warp;
-  static unsigned last_tid;
+  const warp_inst_t &warp = thread->get_executing_inst();
+  // state of the warp being voted on, per functional worker
+  static thread_local bool first_in_warp = true;
+  static thread_local bool and_all;
+  static thread_local bool or_all;
+  static thread_local unsigned int ballot_result;
+  static thread_local std::list<ptx_thread_info *> threads_in_warp;
+  static thread_local unsigned last_tid;
 
   if (first_in_warp) {
     first_in_warp = false;
@@ -6375,10 +6356,10 @@ void vote_impl(const ptx_instruction *pI, ptx_thread_info *thread) {
     or_all = false;
     ballot_result = 0;
     int offset = 31;
-    while ((offset >= 0) && !pI->active(offset)) offset--;
+    while ((offset >= 0) && !warp.active(offset)) offset--;
     assert(offset >= 0);
     last_tid =
-        (thread->get_hw_tid() - (thread->get_hw_tid() % pI->warp_size())) +
+        (thread->get_hw_tid() - (thread->get_hw_tid() % warp.warp_size())) +
         offset;
   }
 
@@ -6398,7 +6379,7 @@ void vote_impl(const ptx_instruction *pI, ptx_thread_info *thread) {
 
   // vote.ballot
   if (invert ^ pred_value) {
-    int lane_id = thread->get_hw_tid() % pI->warp_size();
+    int lane_id = thread->get_hw_tid() % warp.warp_size();
     ballot_result |= (1 << lane_id);
   }
 
@@ -6442,7 +6423,8 @@ void vote_impl(const ptx_instruction *pI, ptx_thread_info *thread) {
 
 void activemask_impl( const ptx_instruction *pI, ptx_thread_info *thread )
 {
-  active_mask_t l_activemask_bitset = pI->get_warp_active_mask();
+  active_mask_t l_activemask_bitset =
+      thread->get_executing_inst().get_warp_active_mask();
   uint32_t l_activemask_uint = static_cast<uint32_t>(l_activemask_bitset.to_ulong());
 
   const operand_info &dst  = pI->dst();
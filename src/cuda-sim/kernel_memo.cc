@@ -0,0 +1,166 @@
+#include "kernel_memo.h"
+#include "ptx_cache.h"
+#include "ptx_ir.h"
+
+kernel_memo::kernel_memo(unsigned long long max_bytes) {
+  m_max_bytes = max_bytes;
+  m_bytes = 0;
+  m_recording = false;
+  m_trace.page_size = 0;
+  m_lookups = 0;
+  m_hits = 0;
+  m_stored = 0;
+  m_evicted = 0;
+}
+
+bool kernel_memo::scan(const function_info *func,
+                       std::set<const function_info *> &visited) const {
+  if (!visited.insert(func).second) return true;
+  const std::list<ptx_instruction *> &insns = func->get_instructions();
+  std::list<ptx_instruction *>::const_iterator i;
+  for (i = insns.begin(); i != insns.end(); ++i) {
+    const ptx_instruction *pI = *i;
+    if (pI->is_label()) continue;
+    switch (pI->get_opcode()) {
+      case TEX_OP:
+      case SULD_OP:
+      case SUST_OP:
+      case SURED_OP:
+      case SUQ_OP:
+      case CALLP_OP:
+      case TRAP_OP:
+        return false;
+      case CALL_OP: {
+        // printf, malloc and device launches are calls to functions
+        // without a body
+        const function_info *target = pI->func_addr().get_symbol()->get_pc();
+        if (!target || target->get_instructions().empty() ||
+            !scan(target, visited))
+          return false;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  return true;
+}
+
+bool kernel_memo::memoizable(const function_info *entry) {
+  std::map<const function_info *, bool>::const_iterator m =
+      m_memoizable.find(entry);
+  if (m != m_memoizable.end()) return m->second;
+  std::set<const function_info *> visited;
+  bool result = scan(entry, visited);
+  m_memoizable[entry] = result;
+  return result;
+}
+
+kernel_memo::key_t kernel_memo::launch_key(kernel_info_t &kernel) {
+  key_t key;
+  key.entry = kernel.entry();
+  key.grid = kernel.get_grid_dim();
+  key.block = kernel.get_cta_dim();
+  key.dynamic_smem = kernel.get_dynamic_smem();
+  key.params.resize(kernel.entry()->get_args_aligned_size());
+  if (!key.params.empty())
+    kernel.get_param_memory()->read(0, key.params.size(), &key.params[0]);
+  return key;
+}
+
+bool kernel_memo::replay(kernel_info_t &kernel, memory_space *global_mem) {
+  key_t key = launch_key(kernel);
+  m_lookups++;
+  // pages shared by several candidates are hashed once
+  std::map<mem_addr_t, unsigned long long> hashes;
+  std::string buf;
+  std::list<entry_t>::iterator e;
+  for (e = m_entries.begin(); e != m_entries.end(); ++e) {
+    if (!(e->key == key)) continue;
+    bool match = true;
+    for (size_t p = 0; match && p < e->before.size(); p++) {
+      mem_addr_t index = e->before[p].first;
+      std::map<mem_addr_t, unsigned long long>::iterator h =
+          hashes.find(index);
+      if (h == hashes.end()) {
+        buf.resize(m_trace.page_size);
+        global_mem->read(index * buf.size(), buf.size(), &buf[0]);
+        h = hashes.insert(std::make_pair(index, ptx_cache::hash(buf))).first;
+      }
+      match = h->second == e->before[p].second;
+    }
+    if (match) break;
+  }
+  if (e == m_entries.end()) return false;
+
+  for (size_t p = 0; p < e->after.size(); p++)
+    global_mem->write_only(0, e->after[p].first, e->after[p].second.size(),
+                           e->after[p].second.data());
+  while (!kernel.no_more_ctas_to_run()) kernel.increment_cta_id();
+  m_entries.splice(m_entries.begin(), m_entries, e);
+  m_hits++;
+  printf(
+      "GPGPU-Sim PTX: kernel %s replayed from an earlier launch (%zu pages "
+      "read, %zu written)\n",
+      kernel.name().c_str(), e->before.size(), e->after.size());
+  return true;
+}
+
+bool kernel_memo::record(kernel_info_t &kernel, memory_space *global_mem) {
+  assert(!m_recording);
+  m_trace.before.clear();
+  m_trace.written.clear();
+  if (!global_mem->trace_pages(&m_trace)) return false;
+  m_key = launch_key(kernel);
+  m_recording = true;
+  return true;
+}
+
+void kernel_memo::finish(memory_space *global_mem) {
+  if (!m_recording) return;
+  global_mem->trace_pages(NULL);
+  m_recording = false;
+
+  m_entries.push_front(entry_t());
+  entry_t &entry = m_entries.front();
+  entry.key = m_key;
+  entry.before.assign(m_trace.before.begin(), m_trace.before.end());
+  entry.bytes = sizeof(entry) + entry.key.params.size() +
+                entry.before.size() * sizeof(entry.before[0]);
+  entry.after.reserve(m_trace.written.size());
+  std::set<mem_addr_t>::const_iterator w;
+  for (w = m_trace.written.begin(); w != m_trace.written.end(); ++w) {
+    entry.bytes += sizeof(entry.after[0]) + m_trace.page_size;
+    if (entry.bytes > m_max_bytes) break;
+    entry.after.push_back(
+        std::make_pair(*w, std::string(m_trace.page_size, 0)));
+    std::string &data = entry.after.back().second;
+    global_mem->read(*w * data.size(), data.size(), &data[0]);
+  }
+  if (entry.bytes > m_max_bytes) {
+    // larger than the whole cache
+    m_entries.pop_front();
+    return;
+  }
+  m_bytes += entry.bytes;
+  m_stored++;
+  evict();
+}
+
+void kernel_memo::evict() {
+  while (m_bytes > m_max_bytes && !m_entries.empty()) {
+    m_bytes -= m_entries.back().bytes;
+    m_entries.pop_back();
+    m_evicted++;
+  }
+}
+
+void kernel_memo::print_stats(FILE *fout) const {
+  fprintf(fout, "kernel_memo_lookups = %llu\n", m_lookups);
+  fprintf(fout, "kernel_memo_hits = %llu\n", m_hits);
+  fprintf(fout, "kernel_memo_hit_rate = %.4f\n",
+          m_lookups ? (double)m_hits / m_lookups : 0.0);
+  fprintf(fout, "kernel_memo_entries = %zu (%llu stored, %llu evicted)\n",
+          m_entries.size(), m_stored, m_evicted);
+  fprintf(fout, "kernel_memo_kb = %llu\n", m_bytes / 1024);
+}
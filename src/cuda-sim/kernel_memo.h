@@ -0,0 +1,90 @@
+#ifndef KERNEL_MEMO_H
+#define KERNEL_MEMO_H
+
+#include <stdio.h>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../abstract_hardware_model.h"
+#include "memory.h"
+
+class function_info;
+
+// Results of functional kernel launches, replayed when the same kernel is
+// launched again instead of executing it (-gpgpu_kernel_memo). A launch is
+// recorded with a page trace on global memory: the hash of every page it
+// read or wrote, as the page was before the launch, and the final contents
+// of the pages it wrote. A later launch with the same entry, grid, block
+// and parameter bytes hits when every recorded page still hashes the same;
+// the written pages are then copied back. Written pages count as read, so
+// copying them whole is exact. Kernels that reach state outside global and
+// parameter memory (textures, surfaces, printf, device malloc and launches,
+// indirect calls, traps) are never recorded. Least recently used entries
+// are dropped beyond the size limit.
+class kernel_memo {
+ public:
+  kernel_memo(unsigned long long max_bytes);
+
+  // false if what the kernel computes may depend on more than global and
+  // parameter memory
+  bool memoizable(const function_info *entry);
+
+  // finishes the kernel from a recorded launch; false on a miss
+  bool replay(kernel_info_t &kernel, memory_space *global_mem);
+  // starts recording a launch about to execute; false if global_mem
+  // cannot trace pages
+  bool record(kernel_info_t &kernel, memory_space *global_mem);
+  // stores the launch record() started, once the kernel has executed
+  void finish(memory_space *global_mem);
+
+  void print_stats(FILE *fout) const;
+
+ private:
+  struct key_t {
+    bool operator==(const key_t &x) const {
+      return entry == x.entry && grid.x == x.grid.x && grid.y == x.grid.y &&
+             grid.z == x.grid.z && block.x == x.block.x &&
+             block.y == x.block.y && block.z == x.block.z &&
+             dynamic_smem == x.dynamic_smem && params == x.params;
+    }
+    const function_info *entry;
+    dim3 grid;
+    dim3 block;
+    size_t dynamic_smem;
+    std::string params;
+  };
+  struct entry_t {
+    key_t key;
+    // (page, hash) of every page touched, before the launch
+    std::vector<std::pair<mem_addr_t, unsigned long long> > before;
+    // (page, contents) of the pages written, after it
+    std::vector<std::pair<mem_addr_t, std::string> > after;
+    size_t bytes;
+  };
+
+  static key_t launch_key(kernel_info_t &kernel);
+  bool scan(const function_info *func,
+            std::set<const function_info *> &visited) const;
+  void evict();
+
+  unsigned long long m_max_bytes;
+  unsigned long long m_bytes;
+  // most recently used first
+  std::list<entry_t> m_entries;
+  std::map<const function_info *, bool> m_memoizable;
+
+  // the launch being recorded
+  bool m_recording;
+  key_t m_key;
+  mem_page_trace m_trace;
+
+  unsigned long long m_lookups;
+  unsigned long long m_hits;
+  unsigned long long m_stored;
+  unsigned long long m_evicted;
+};
+
+#endif
@@ -27,9 +27,15 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "memory.h"
+#include <fcntl.h>
 #include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
 #include "../../libcuda/gpgpu_context.h"
 #include "../debug.h"
+#include "ptx_cache.h"
 
 template <unsigned BSIZE>
 memory_space_impl<BSIZE>::memory_space_impl(std::string name,
@@ -176,15 +182,409 @@ void memory_space_impl<BSIZE>::print(const char *format, FILE *fout) const {
   }
 }
 
+template <unsigned BSIZE>
+void memory_space_impl<BSIZE>::store_pages(FILE *fout) const {
+  mem_page_image::pages_t pages;
+  pages.reserve(m_data.size());
+  for (typename map_t::const_iterator i = m_data.begin(); i != m_data.end();
+       ++i)
+    pages.push_back(std::make_pair(i->first, i->second.data()));
+  std::sort(pages.begin(), pages.end());
+  mem_page_image::write(fout, BSIZE, pages);
+}
+
+template <unsigned BSIZE>
+void memory_space_impl<BSIZE>::load_pages(const mem_page_image &image) {
+  if (image.page_size() != BSIZE) {
+    printf(
+        "GPGPU-Sim PTX: ERROR ** checkpoint pages are %u bytes, memory space "
+        "\'%s\' uses %u\n",
+        image.page_size(), m_name.c_str(), BSIZE);
+    abort();
+  }
+  static const unsigned char zero[BSIZE] = {0};
+  for (unsigned long long i = 0; i < image.n_pages(); i++) {
+    const unsigned char *data = image.data(i);
+    if (data) {
+      m_data[image.page(i)].write(0, BSIZE, data);
+    } else {
+      // pages never written read as zero already
+      typename map_t::iterator p = m_data.find(image.page(i));
+      if (p != m_data.end()) p->second.write(0, BSIZE, zero);
+    }
+  }
+}
+
 template <unsigned BSIZE>
 void memory_space_impl<BSIZE>::set_watch(addr_t addr, unsigned watchpoint) {
   m_watchpoints[watchpoint] = addr;
 }
 
+template <unsigned BSIZE>
+flat_memory_space<BSIZE>::flat_memory_space(std::string name,
+                                            unsigned long long region_size) {
+  m_name = name;
+  m_region = NULL;
+  m_region_size = region_size / BSIZE * BSIZE;
+  if (m_region_size) {
+    void *base = mmap(NULL, m_region_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+      printf(
+          "GPGPU-Sim PTX: WARNING ** cannot map %llu bytes for memory space "
+          "\'%s\', using a page table\n",
+          m_region_size, m_name.c_str());
+      m_region_size = 0;
+    } else {
+      m_region = (unsigned char *)base;
+    }
+  }
+  m_written.resize(m_region_size / BSIZE);
+  pthread_mutex_init(&m_table_lock, NULL);
+  m_trace = NULL;
+  pthread_mutex_init(&m_trace_lock, NULL);
+  m_write_log = NULL;
+}
+
+template <unsigned BSIZE>
+flat_memory_space<BSIZE>::~flat_memory_space() {
+  if (m_region) munmap(m_region, m_region_size);
+  for (typename table_t::iterator t = m_table.begin(); t != m_table.end();
+       ++t) {
+    for (unsigned i = 0; i < TABLE_SIZE; i++) free(t->second[i]);
+    free(t->second);
+  }
+  pthread_mutex_destroy(&m_table_lock);
+  pthread_mutex_destroy(&m_trace_lock);
+}
+
+template <unsigned BSIZE>
+unsigned char *flat_memory_space<BSIZE>::written_page(mem_addr_t index) {
+  if (index < m_written.size()) {
+    m_written[index] = true;
+    return m_region + index * BSIZE;
+  }
+  pthread_mutex_lock(&m_table_lock);
+  unsigned char **&table = m_table[index / TABLE_SIZE];
+  if (!table) table = (unsigned char **)calloc(TABLE_SIZE, sizeof(*table));
+  unsigned char *&p = table[index % TABLE_SIZE];
+  if (!p) p = (unsigned char *)calloc(1, BSIZE);
+  unsigned char *result = p;
+  pthread_mutex_unlock(&m_table_lock);
+  return result;
+}
+
+template <unsigned BSIZE>
+const unsigned char *flat_memory_space<BSIZE>::page(mem_addr_t index) const {
+  if (index < m_written.size()) return m_region + index * BSIZE;
+  pthread_mutex_lock(&m_table_lock);
+  typename table_t::const_iterator t = m_table.find(index / TABLE_SIZE);
+  const unsigned char *p =
+      t == m_table.end() ? NULL : t->second[index % TABLE_SIZE];
+  pthread_mutex_unlock(&m_table_lock);
+  return p;
+}
+
+template <unsigned BSIZE>
+void flat_memory_space<BSIZE>::copy(mem_addr_t addr, size_t length,
+                                    const unsigned char *src) {
+  if (!length) return;
+  if (m_trace) trace(addr, length, true);
+  if (m_write_log) fetch(addr, length, m_write_log->add(addr, length));
+  if (addr < m_region_size && length <= m_region_size - addr) {
+    memcpy(m_region + addr, src, length);
+    for (mem_addr_t i = addr / BSIZE; i <= (addr + length - 1) / BSIZE; i++)
+      m_written[i] = true;
+    return;
+  }
+  while (length) {
+    size_t offset = addr % BSIZE;
+    size_t n = std::min(length, BSIZE - offset);
+    memcpy(written_page(addr / BSIZE) + offset, src, n);
+    addr += n;
+    src += n;
+    length -= n;
+  }
+}
+
+template <unsigned BSIZE>
+void flat_memory_space<BSIZE>::write(mem_addr_t addr, size_t length,
+                                     const void *data, ptx_thread_info *thd,
+                                     const ptx_instruction *pI) {
+  copy(addr, length, (const unsigned char *)data);
+  if (!m_watchpoints.empty()) {
+    std::map<unsigned, mem_addr_t>::iterator i;
+    for (i = m_watchpoints.begin(); i != m_watchpoints.end(); i++) {
+      mem_addr_t wa = i->second;
+      if (((addr <= wa) && ((addr + length) > wa)) ||
+          ((addr > wa) && (addr < (wa + 4))))
+        thd->get_gpu()->gpgpu_ctx->the_gpgpusim->g_the_gpu->hit_watchpoint(
+            i->first, thd, pI);
+    }
+  }
+}
+
+template <unsigned BSIZE>
+void flat_memory_space<BSIZE>::write_only(mem_addr_t offset, mem_addr_t index,
+                                          size_t length, const void *data) {
+  assert(offset + length <= BSIZE);
+  copy(index * BSIZE + offset, length, (const unsigned char *)data);
+}
+
+template <unsigned BSIZE>
+void flat_memory_space<BSIZE>::read(mem_addr_t addr, size_t length,
+                                    void *data) const {
+  if (m_trace && length) trace(addr, length, false);
+  fetch(addr, length, (unsigned char *)data);
+}
+
+template <unsigned BSIZE>
+void flat_memory_space<BSIZE>::fetch(mem_addr_t addr, size_t length,
+                                     unsigned char *dst) const {
+  if (addr < m_region_size && length <= m_region_size - addr) {
+    memcpy(dst, m_region + addr, length);
+    return;
+  }
+  while (length) {
+    size_t offset = addr % BSIZE;
+    size_t n = std::min(length, BSIZE - offset);
+    const unsigned char *p = page(addr / BSIZE);
+    if (p)
+      memcpy(dst, p + offset, n);
+    else
+      memset(dst, 0, n);
+    addr += n;
+    dst += n;
+    length -= n;
+  }
+}
+
+template <unsigned BSIZE>
+void flat_memory_space<BSIZE>::written_pages(
+    mem_page_image::pages_t &pages) const {
+  for (mem_addr_t i = 0; i < m_written.size(); i++) {
+    if (m_written[i]) pages.push_back(std::make_pair(i, page(i)));
+  }
+  for (typename table_t::const_iterator t = m_table.begin();
+       t != m_table.end(); ++t) {
+    for (unsigned i = 0; i < TABLE_SIZE; i++) {
+      if (t->second[i])
+        pages.push_back(
+            std::make_pair(t->first * TABLE_SIZE + i, t->second[i]));
+    }
+  }
+}
+
+template <unsigned BSIZE>
+void flat_memory_space<BSIZE>::print(const char *format, FILE *fout) const {
+  mem_page_image::pages_t pages;
+  written_pages(pages);
+  // same layout as mem_storage::print()
+  for (size_t p = 0; p < pages.size(); p++) {
+    fprintf(fout, "%s %08x:", m_name.c_str(), (unsigned)pages[p].first);
+    const unsigned *words = (const unsigned *)pages[p].second;
+    for (unsigned d = 0; d < BSIZE / sizeof(unsigned); d++) {
+      fprintf(fout, "\n");
+      fprintf(fout, format, words[d]);
+      fprintf(fout, " ");
+    }
+    fprintf(fout, "\n");
+    fflush(fout);
+  }
+}
+
+template <unsigned BSIZE>
+void flat_memory_space<BSIZE>::store_pages(FILE *fout) const {
+  mem_page_image::pages_t pages;
+  written_pages(pages);
+  std::sort(pages.begin(), pages.end());
+  mem_page_image::write(fout, BSIZE, pages);
+}
+
+template <unsigned BSIZE>
+void flat_memory_space<BSIZE>::load_pages(const mem_page_image &image) {
+  if (image.page_size() != BSIZE) {
+    printf(
+        "GPGPU-Sim PTX: ERROR ** checkpoint pages are %u bytes, memory space "
+        "\'%s\' uses %u\n",
+        image.page_size(), m_name.c_str(), BSIZE);
+    abort();
+  }
+  for (unsigned long long i = 0; i < image.n_pages(); i++) {
+    mem_addr_t index = image.page(i);
+    const unsigned char *data = image.data(i);
+    if (data) {
+      copy(index * BSIZE, BSIZE, data);
+    } else if (index < m_written.size() ? m_written[index]
+                                        : page(index) != NULL) {
+      // pages never written read as zero already
+      memset(written_page(index), 0, BSIZE);
+    }
+  }
+}
+
+template <unsigned BSIZE>
+void flat_memory_space<BSIZE>::set_watch(addr_t addr, unsigned watchpoint) {
+  m_watchpoints[watchpoint] = addr;
+}
+
+template <unsigned BSIZE>
+void flat_memory_space<BSIZE>::trace(mem_addr_t addr, size_t length,
+                                     bool write) const {
+  static const unsigned char zero[BSIZE] = {0};
+  unsigned char flag = write ? TRACED_WRITTEN : TRACED_SEEN;
+  for (mem_addr_t i = addr / BSIZE; i <= (addr + length - 1) / BSIZE; i++) {
+    // the flag is set after the hash is taken, so a thread that sees it
+    // may change the page without the lock
+    if (i < m_traced.size() &&
+        (__atomic_load_n(&m_traced[i], __ATOMIC_ACQUIRE) & flag))
+      continue;
+    pthread_mutex_lock(&m_trace_lock);
+    // the first access to a page takes the lock before changing it, so
+    // the hash is of what the page held before the trace began
+    if (!m_trace->before.count(i)) {
+      const unsigned char *p = page(i);
+      m_trace->before[i] = ptx_cache::hash(p ? p : zero, BSIZE);
+    }
+    if (write) m_trace->written.insert(i);
+    if (i < m_traced.size())
+      __atomic_fetch_or(&m_traced[i],
+                        TRACED_SEEN | (write ? TRACED_WRITTEN : 0),
+                        __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&m_trace_lock);
+  }
+}
+
+template <unsigned BSIZE>
+bool flat_memory_space<BSIZE>::trace_pages(mem_page_trace *trace) {
+  if (m_trace) {
+    // clear only the flags this trace set
+    std::map<mem_addr_t, unsigned long long>::const_iterator p;
+    for (p = m_trace->before.begin(); p != m_trace->before.end(); ++p)
+      if (p->first < m_traced.size()) m_traced[p->first] = 0;
+  }
+  m_trace = trace;
+  if (trace) {
+    trace->page_size = BSIZE;
+    m_traced.resize(m_written.size());
+  }
+  return true;
+}
+
+template <unsigned BSIZE>
+bool flat_memory_space<BSIZE>::log_writes(mem_write_log *log) {
+  m_write_log = log;
+  return true;
+}
+
+unsigned char *mem_write_log::add(mem_addr_t addr, size_t length) {
+  entry_t e;
+  e.addr = addr;
+  e.length = length;
+  e.offset = m_bytes.size();
+  m_entries.push_back(e);
+  m_bytes.resize(e.offset + length);
+  return &m_bytes[e.offset];
+}
+
+void mem_write_log::undo(size_t first, mem_addr_t addr, size_t length,
+                         unsigned char *data) const {
+  // newest first, so that the bytes from before write `first` are left
+  for (size_t i = m_entries.size(); i > first; i--) {
+    const entry_t &e = m_entries[i - 1];
+    mem_addr_t lo = std::max(addr, e.addr);
+    mem_addr_t hi = std::min(addr + length, e.addr + e.length);
+    if (lo < hi)
+      memcpy(data + (lo - addr), &m_bytes[e.offset + (lo - e.addr)], hi - lo);
+  }
+}
+
+static const char MEM_PAGE_IMAGE_MAGIC[8] = "GPGPUPG";
+static const unsigned MEM_PAGE_IMAGE_VERSION = 1;
+static const unsigned MEM_PAGE_IMAGE_ALIGN = 4096;
+
+bool mem_page_image::is_image(const char *fname) {
+  char magic[sizeof(MEM_PAGE_IMAGE_MAGIC)];
+  FILE *fp = fopen(fname, "rb");
+  if (!fp) return false;
+  bool image = fread(magic, sizeof(magic), 1, fp) == 1 &&
+               !memcmp(magic, MEM_PAGE_IMAGE_MAGIC, sizeof(magic));
+  fclose(fp);
+  return image;
+}
+
+void mem_page_image::write(FILE *fout, unsigned page_size,
+                           const pages_t &pages) {
+  header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MEM_PAGE_IMAGE_MAGIC, sizeof(header.magic));
+  header.version = MEM_PAGE_IMAGE_VERSION;
+  header.page_size = page_size;
+  header.n_pages = pages.size();
+  unsigned long long index_end =
+      sizeof(header) + pages.size() * sizeof(entry_t);
+  header.data_offset = (index_end + MEM_PAGE_IMAGE_ALIGN - 1) /
+                       MEM_PAGE_IMAGE_ALIGN * MEM_PAGE_IMAGE_ALIGN;
+  fwrite(&header, sizeof(header), 1, fout);
+
+  std::vector<bool> zero(pages.size());
+  unsigned long long n_slots = 0;
+  for (size_t i = 0; i < pages.size(); i++) {
+    const unsigned char *d = pages[i].second;
+    zero[i] = !d[0] && !memcmp(d, d + 1, page_size - 1);
+    entry_t e = {pages[i].first, zero[i] ? ZERO_PAGE : n_slots++};
+    fwrite(&e, sizeof(e), 1, fout);
+  }
+  for (unsigned long long n = index_end; n < header.data_offset; n++)
+    fputc(0, fout);
+  for (size_t i = 0; i < pages.size(); i++) {
+    if (!zero[i]) fwrite(pages[i].second, page_size, 1, fout);
+  }
+}
+
+mem_page_image::mem_page_image(const char *fname) {
+  int fd = open(fname, O_RDONLY);
+  struct stat st;
+  void *base = MAP_FAILED;
+  if (fd >= 0 && !fstat(fd, &st) && st.st_size >= (off_t)sizeof(header_t))
+    base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (fd >= 0) close(fd);
+  if (base == MAP_FAILED) {
+    printf("GPGPU-Sim PTX: ERROR ** cannot map checkpoint %s\n", fname);
+    abort();
+  }
+  m_base = (const unsigned char *)base;
+  m_size = st.st_size;
+  m_header = (const header_t *)m_base;
+  m_index = (const entry_t *)(m_base + sizeof(header_t));
+
+  unsigned long long n_slots = 0;
+  bool valid =
+      !memcmp(m_header->magic, MEM_PAGE_IMAGE_MAGIC, sizeof(m_header->magic)) &&
+      m_header->version == MEM_PAGE_IMAGE_VERSION && m_header->page_size &&
+      m_header->data_offset >=
+          sizeof(header_t) + m_header->n_pages * sizeof(entry_t) &&
+      m_header->data_offset <= m_size;
+  for (unsigned long long i = 0; valid && i < m_header->n_pages; i++) {
+    if (m_index[i].slot != ZERO_PAGE) valid = m_index[i].slot == n_slots++;
+  }
+  if (!valid || m_header->data_offset + n_slots * m_header->page_size !=
+                    m_size) {
+    printf("GPGPU-Sim PTX: ERROR ** %s is not a valid checkpoint page image\n",
+           fname);
+    abort();
+  }
+  // pages are copied out in order, once
+  madvise(base, m_size, MADV_SEQUENTIAL);
+}
+
+mem_page_image::~mem_page_image() { munmap((void *)m_base, m_size); }
+
 template class memory_space_impl<32>;
 template class memory_space_impl<64>;
 template class memory_space_impl<8192>;
 template class memory_space_impl<16 * 1024>;
+template class flat_memory_space<8192>;
 
 void g_print_memory_space(memory_space *mem, const char *format = "%08x",
                           FILE *fout = stdout) {
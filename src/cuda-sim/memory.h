@@ -40,16 +40,68 @@
 #endif
 
 #include <assert.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <map>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 typedef address_type mem_addr_t;
 
 #define MEM_BLOCK_SIZE (4 * 1024)
 
+// Binary image of the pages of a memory space, used for checkpoints:
+// a header, an index of (page, slot) sorted by page, then the data of the
+// non-zero pages, one page per slot. Pages that are all zero are kept in
+// the index without data. The data starts on a host page boundary so the
+// image can be mmap()ed and copied page by page without parsing.
+class mem_page_image {
+ public:
+  typedef std::vector<std::pair<mem_addr_t, const unsigned char *> > pages_t;
+
+  static bool is_image(const char *fname);
+  // pages sorted by page index, each page_size bytes
+  static void write(FILE *fout, unsigned page_size, const pages_t &pages);
+
+  // maps an image; aborts if fname is not one
+  mem_page_image(const char *fname);
+  ~mem_page_image();
+
+  unsigned page_size() const { return m_header->page_size; }
+  unsigned long long n_pages() const { return m_header->n_pages; }
+  mem_addr_t page(unsigned long long i) const { return m_index[i].page; }
+  // NULL for a zero page
+  const unsigned char *data(unsigned long long i) const {
+    return m_index[i].slot == ZERO_PAGE
+               ? NULL
+               : m_base + m_header->data_offset +
+                     m_index[i].slot * m_header->page_size;
+  }
+
+ private:
+  static const unsigned long long ZERO_PAGE = ~0ULL;
+  struct header_t {
+    char magic[8];
+    unsigned version;
+    unsigned page_size;
+    unsigned long long n_pages;
+    unsigned long long data_offset;
+  };
+  struct entry_t {
+    unsigned long long page;
+    unsigned long long slot;
+  };
+
+  const unsigned char *m_base;
+  size_t m_size;
+  const header_t *m_header;
+  const entry_t *m_index;
+};
+
 template <unsigned BSIZE>
 class mem_storage {
  public:
@@ -70,6 +122,8 @@ class mem_storage {
     memcpy(data, m_data + offset, length);
   }
 
+  const unsigned char *data() const { return m_data; }
+
   void print(const char *format, FILE *fout) const {
     unsigned int *i_data = (unsigned int *)m_data;
     for (int d = 0; d < (BSIZE / sizeof(unsigned int)); d++) {
@@ -91,6 +145,43 @@ class mem_storage {
 class ptx_thread_info;
 class ptx_instruction;
 
+// Pages of a memory space touched while a trace is attached
+// (-gpgpu_kernel_memo): a hash of what each page held before it was first
+// read or written, and which of them were written.
+struct mem_page_trace {
+  unsigned page_size;
+  std::map<mem_addr_t, unsigned long long> before;
+  std::set<mem_addr_t> written;
+};
+
+// What the writes to a memory space overwrote while the log is attached, in
+// the order they were made, so that a later read can be turned back into
+// one made between two of them (-gpgpu_sim_threads reads the data of the
+// packets the clusters inject once they have all stepped).
+class mem_write_log {
+ public:
+  size_t size() const { return m_entries.size(); }
+  void clear() {
+    m_entries.clear();
+    m_bytes.clear();
+  }
+  // room for the length bytes at addr a write is about to replace
+  unsigned char *add(mem_addr_t addr, size_t length);
+  // turns data, read from addr now, into what a read before write `first`
+  // would have returned
+  void undo(size_t first, mem_addr_t addr, size_t length,
+            unsigned char *data) const;
+
+ private:
+  struct entry_t {
+    mem_addr_t addr;
+    size_t length;
+    size_t offset;  // of the old bytes in m_bytes
+  };
+  std::vector<entry_t> m_entries;
+  std::vector<unsigned char> m_bytes;
+};
+
 class memory_space {
  public:
   virtual ~memory_space() {}
@@ -100,7 +191,18 @@ class memory_space {
                           const void *data) = 0;
   virtual void read(mem_addr_t addr, size_t length, void *data) const = 0;
   virtual void print(const char *format, FILE *fout) const = 0;
+  // mem_page_image of the pages written so far, and its inverse
+  virtual void store_pages(FILE *fout) const = 0;
+  virtual void load_pages(const mem_page_image &image) = 0;
+  // bytes per page of print(), store_pages() and load_pages()
+  virtual unsigned page_size() const = 0;
   virtual void set_watch(addr_t addr, unsigned watchpoint) = 0;
+  // records accesses into trace until called again with NULL; false if the
+  // space cannot trace them
+  virtual bool trace_pages(mem_page_trace *trace) { return false; }
+  // logs what writes overwrite into log until called again with NULL; false
+  // if the space cannot log them
+  virtual bool log_writes(mem_write_log *log) { return false; }
 };
 
 template <unsigned BSIZE>
@@ -114,9 +216,19 @@ class memory_space_impl : public memory_space {
                           const void *data);
   virtual void read(mem_addr_t addr, size_t length, void *data) const;
   virtual void print(const char *format, FILE *fout) const;
+  virtual void store_pages(FILE *fout) const;
+  virtual void load_pages(const mem_page_image &image);
+  virtual unsigned page_size() const { return BSIZE; }
 
   virtual void set_watch(addr_t addr, unsigned watchpoint);
 
+  // estimate of the host memory taken, blocks and map nodes included
+  size_t host_bytes() const {
+    return sizeof(*this) + m_name.capacity() +
+           m_data.size() *
+               (sizeof(typename map_t::value_type) + 2 * sizeof(void *));
+  }
+
  private:
   void read_single_block(mem_addr_t blk_idx, mem_addr_t addr, size_t length,
                          void *data) const;
@@ -127,4 +239,71 @@ class memory_space_impl : public memory_space {
   std::map<unsigned, mem_addr_t> m_watchpoints;
 };
 
+// Global memory kept where the host can address it directly: device
+// addresses below region_size map one to one into a sparse anonymous
+// mapping (MAP_NORESERVE, so untouched pages cost nothing and read as zero),
+// making accesses and cudaMemcpy plain memcpy()s. Addresses above the
+// region, or all of them if the mapping fails, go through a two-level page
+// table of BSIZE pages. Pages written are tracked so print() and
+// store_pages() produce the same output as memory_space_impl. Concurrent
+// accesses from functional worker threads are safe, also while a page trace
+// is attached.
+template <unsigned BSIZE>
+class flat_memory_space : public memory_space {
+ public:
+  flat_memory_space(std::string name, unsigned long long region_size);
+  virtual ~flat_memory_space();
+
+  virtual void write(mem_addr_t addr, size_t length, const void *data,
+                     ptx_thread_info *thd, const ptx_instruction *pI);
+  virtual void write_only(mem_addr_t index, mem_addr_t offset, size_t length,
+                          const void *data);
+  virtual void read(mem_addr_t addr, size_t length, void *data) const;
+  virtual void print(const char *format, FILE *fout) const;
+  virtual void store_pages(FILE *fout) const;
+  virtual void load_pages(const mem_page_image &image);
+  virtual unsigned page_size() const { return BSIZE; }
+
+  virtual void set_watch(addr_t addr, unsigned watchpoint);
+  virtual bool trace_pages(mem_page_trace *trace);
+  virtual bool log_writes(mem_write_log *log);
+
+ private:
+  // pages per second-level table
+  static const unsigned TABLE_SIZE = 1024;
+  // m_traced bits of a region page
+  enum { TRACED_SEEN = 1, TRACED_WRITTEN = 2 };
+
+  // start of a page, NULL if it lies in the page table and was never written
+  const unsigned char *page(mem_addr_t index) const;
+  // start of a page about to be written, allocating it in the page table
+  unsigned char *written_page(mem_addr_t index);
+  // pages written so far, region first
+  void written_pages(mem_page_image::pages_t &pages) const;
+  void copy(mem_addr_t addr, size_t length, const unsigned char *src);
+  // read() without the trace
+  void fetch(mem_addr_t addr, size_t length, unsigned char *dst) const;
+  // adds the pages of an access to m_trace, hashing the ones it has not seen
+  void trace(mem_addr_t addr, size_t length, bool write) const;
+
+  std::string m_name;
+  unsigned char *m_region;
+  unsigned long long m_region_size;
+  // pages of the region written so far, a byte each so that concurrent
+  // writers never share a word they modify
+  std::vector<unsigned char> m_written;
+  typedef mem_map<mem_addr_t, unsigned char **> table_t;
+  table_t m_table;
+  mutable pthread_mutex_t m_table_lock;
+  std::map<unsigned, mem_addr_t> m_watchpoints;
+  // attached page trace; region pages it already holds are flagged in
+  // m_traced so that repeated accesses skip the lock. The flags are read
+  // without it, so they are only accessed atomically while tracing.
+  mem_page_trace *m_trace;
+  mutable std::vector<unsigned char> m_traced;
+  mutable pthread_mutex_t m_trace_lock;
+  // attached write log; only one thread writes while it is
+  mem_write_log *m_write_log;
+};
+
 #endif
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mma_emu.h"
+
+// Microbenchmark of the wmma.mma emulation (make mma_bench in this
+// directory): for each shape and accumulator type pair, times
+// mma_m16n16k16 against the loop over half on random fragments and checks
+// that the two agree bit for bit, also on fragments that overflow, go
+// subnormal or hold infinities and NaNs.
+//
+//   mma_bench [iterations]
+
+static const unsigned N_FRAGMENTS = 64;
+
+enum fragment_kind_t {
+  FRAGMENT_NORMAL = 0,  // values near 1, as in trained weights
+  FRAGMENT_WIDE,        // any finite value
+  FRAGMENT_SPECIAL,     // any bit pattern
+  N_FRAGMENT_KINDS
+};
+
+static const char *fragment_kind_name[N_FRAGMENT_KINDS] = {"normal", "wide",
+                                                           "special"};
+
+struct fragment_t {
+  unsigned short a[MMA_DIM][MMA_DIM];
+  unsigned short b[MMA_DIM][MMA_DIM];
+  unsigned c[MMA_DIM][MMA_DIM];
+};
+
+static unsigned long long g_seed = 88172645463325252ULL;
+
+static unsigned next_random() {
+  g_seed ^= g_seed << 13;
+  g_seed ^= g_seed >> 7;
+  g_seed ^= g_seed << 17;
+  return g_seed >> 32;
+}
+
+static unsigned short random_f16(fragment_kind_t kind) {
+  unsigned r = next_random();
+  switch (kind) {
+    case FRAGMENT_NORMAL:
+      // exponents 2^-4 .. 2^1
+      return (r & 0x83FF) | ((11 + (r >> 16) % 6) << 10);
+    case FRAGMENT_WIDE:
+      return (r & 0x83FF) | (((r >> 16) % 31) << 10);
+    default:
+      return r;
+  }
+}
+
+static unsigned random_f32(fragment_kind_t kind) {
+  unsigned r = next_random();
+  switch (kind) {
+    case FRAGMENT_NORMAL:
+      return (r & 0x807FFFFF) | ((123 + (r >> 24) % 6) << 23);
+    case FRAGMENT_WIDE:
+      return (r & 0x807FFFFF) | ((1 + (r >> 24) % 254) << 23);
+    default:
+      return r;
+  }
+}
+
+static void fill(fragment_t &f, fragment_kind_t kind, bool c_f32) {
+  for (unsigned i = 0; i < MMA_DIM; i++) {
+    for (unsigned j = 0; j < MMA_DIM; j++) {
+      f.a[i][j] = random_f16(kind);
+      f.b[i][j] = random_f16(kind);
+      f.c[i][j] = c_f32 ? random_f32(kind) : random_f16(kind);
+    }
+  }
+}
+
+static double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// ns per mma, with a checksum of the results so the calls stay
+static double run(bool emulated, const fragment_t *f, bool c_f32, bool d_f32,
+                  unsigned iterations, unsigned &checksum) {
+  unsigned d[MMA_DIM][MMA_DIM];
+  double start = now();
+  for (unsigned n = 0; n < iterations; n++) {
+    const fragment_t &x = f[n % N_FRAGMENTS];
+    if (emulated)
+      mma_m16n16k16(x.a, x.b, x.c, c_f32, d, d_f32);
+    else
+      mma_m16n16k16_scalar(x.a, x.b, x.c, c_f32, d, d_f32);
+    checksum += d[n % MMA_DIM][(n / MMA_DIM) % MMA_DIM];
+  }
+  return (now() - start) * 1e9 / iterations;
+}
+
+// false if the two implementations disagree on any fragment
+static bool check(const fragment_t *f, bool c_f32, bool d_f32,
+                  const char *name) {
+  for (unsigned n = 0; n < N_FRAGMENTS; n++) {
+    unsigned d[MMA_DIM][MMA_DIM];
+    unsigned ref[MMA_DIM][MMA_DIM];
+    mma_m16n16k16(f[n].a, f[n].b, f[n].c, c_f32, d, d_f32);
+    mma_m16n16k16_scalar(f[n].a, f[n].b, f[n].c, c_f32, ref, d_f32);
+    for (unsigned i = 0; i < MMA_DIM; i++) {
+      for (unsigned j = 0; j < MMA_DIM; j++) {
+        if (d[i][j] == ref[i][j]) continue;
+        printf("%s: fragment %u, d[%u][%u] is %08x, expected %08x\n", name,
+               n, i, j, d[i][j], ref[i][j]);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  unsigned iterations = argc > 1 ? atoi(argv[1]) : 20000;
+  if (!iterations) iterations = 1;
+  static fragment_t fragments[N_FRAGMENTS];
+  unsigned checksum = 0;
+  bool ok = true;
+  printf("mma_bench: %s kernel, %u mma per run\n",
+         mma_emu_vectorized() ? "F16C/AVX2" : "portable", iterations);
+  printf("%-28s %-8s %12s %12s %8s\n", "shape.d.c", "inputs", "scalar ns",
+         "emulated ns", "speedup");
+  for (unsigned t = 0; t < 4; t++) {
+    bool d_f32 = t & 2;
+    bool c_f32 = t & 1;
+    for (unsigned k = 0; k < N_FRAGMENT_KINDS; k++) {
+      fragment_kind_t kind = (fragment_kind_t)k;
+      for (unsigned n = 0; n < N_FRAGMENTS; n++)
+        fill(fragments[n], kind, c_f32);
+      char name[64];
+      snprintf(name, sizeof(name), "m16n16k16.%s.%s",
+               d_f32 ? "f32" : "f16", c_f32 ? "f32" : "f16");
+      ok = check(fragments, c_f32, d_f32, name) && ok;
+      double scalar =
+          run(false, fragments, c_f32, d_f32, iterations, checksum);
+      double emulated =
+          run(true, fragments, c_f32, d_f32, iterations, checksum);
+      printf("%-28s %-8s %12.1f %12.1f %7.1fx\n", name,
+             fragment_kind_name[k], scalar, emulated, scalar / emulated);
+    }
+  }
+  printf("mma_bench: results %s (checksum %08x)\n",
+         ok ? "match" : "DIFFER", checksum);
+  return ok ? 0 : 1;
+}
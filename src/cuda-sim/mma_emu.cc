@@ -0,0 +1,270 @@
+#include "mma_emu.h"
+#include <string.h>
+#include "half.h"
+
+#if defined(__F16C__) && defined(__AVX2__) && defined(__FMA__)
+#define MMA_EMU_AVX2 1
+#include <immintrin.h>
+#endif
+
+using half_float::half;
+
+// half.h's own conversions, truncating like every half assignment does
+static inline float h2f(unsigned short h) {
+  return half_float::detail::half2float<float>(h);
+}
+
+static inline unsigned short f2h(float f) {
+  return half_float::detail::float2half<(std::float_round_style)(
+      HALF_ROUND_STYLE)>(f);
+}
+
+static inline float f32_value(unsigned bits) {
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+static inline unsigned f32_bits(float f) {
+  unsigned bits;
+  memcpy(&bits, &f, sizeof(bits));
+  return bits;
+}
+
+static inline half to_half(unsigned short bits) {
+  half h;
+  memcpy(static_cast<void *>(&h), &bits, sizeof(h));
+  return h;
+}
+
+static inline unsigned short half_bits(half h) {
+  unsigned short bits;
+  memcpy(&bits, &h, sizeof(bits));
+  return bits;
+}
+
+void mma_m16n16k16_scalar(const unsigned short a[MMA_DIM][MMA_DIM],
+                          const unsigned short b[MMA_DIM][MMA_DIM],
+                          const unsigned c[MMA_DIM][MMA_DIM], bool c_f32,
+                          unsigned d[MMA_DIM][MMA_DIM], bool d_f32) {
+  for (unsigned i = 0; i < MMA_DIM; i++) {
+    for (unsigned j = 0; j < MMA_DIM; j++) {
+      half acc;
+      acc = 0;
+      for (unsigned k = 0; k < MMA_DIM; k++)
+        acc = acc + to_half(a[i][k]) * to_half(b[k][j]);
+      float temp;
+      half temp2;
+      if (!c_f32 && !d_f32) {
+        acc += to_half(c[i][j]);
+        d[i][j] = half_bits(acc);
+      } else if (!c_f32) {
+        temp2 = acc + to_half(c[i][j]);
+        temp = temp2;
+        d[i][j] = f32_bits(temp);
+      } else if (!d_f32) {
+        temp = acc;
+        temp += f32_value(c[i][j]);
+        d[i][j] = half_bits(half(temp));
+      } else {
+        temp = acc;
+        temp += f32_value(c[i][j]);
+        d[i][j] = f32_bits(temp);
+      }
+    }
+  }
+}
+
+#ifndef MMA_EMU_AVX2
+// false if any of the f16 values is an infinity or a NaN
+static bool mma_finite(const unsigned short m[MMA_DIM][MMA_DIM]) {
+  bool special = false;
+  for (unsigned i = 0; i < MMA_DIM; i++)
+    for (unsigned j = 0; j < MMA_DIM; j++)
+      special |= (m[i][j] & 0x7C00) == 0x7C00;
+  return !special;
+}
+
+static bool mma_finite(const unsigned c[MMA_DIM][MMA_DIM]) {
+  bool special = false;
+  for (unsigned i = 0; i < MMA_DIM; i++)
+    for (unsigned j = 0; j < MMA_DIM; j++)
+      special |= (c[i][j] & 0x7C00) == 0x7C00;
+  return !special;
+}
+
+// adds c to a finished accumulator
+static inline unsigned mma_finish(float acc, unsigned c, bool c_f32,
+                                  bool d_f32) {
+  if (!c_f32) {
+    unsigned short sum = f2h(acc + h2f(c));
+    return d_f32 ? f32_bits(h2f(sum)) : sum;
+  }
+  float sum = acc + f32_value(c);
+  return d_f32 ? f32_bits(sum) : f2h(sum);
+}
+
+// Same operations in the same order as the loop over half, but on f32
+// copies of a and b, a row of accumulators at a time.
+static void mma_blocked(const unsigned short a[MMA_DIM][MMA_DIM],
+                        const unsigned short b[MMA_DIM][MMA_DIM],
+                        const unsigned c[MMA_DIM][MMA_DIM], bool c_f32,
+                        unsigned d[MMA_DIM][MMA_DIM], bool d_f32) {
+  float fa[MMA_DIM][MMA_DIM];
+  float fb[MMA_DIM][MMA_DIM];
+  for (unsigned i = 0; i < MMA_DIM; i++) {
+    for (unsigned j = 0; j < MMA_DIM; j++) {
+      fa[i][j] = h2f(a[i][j]);
+      fb[i][j] = h2f(b[i][j]);
+    }
+  }
+  for (unsigned i = 0; i < MMA_DIM; i++) {
+    float acc[MMA_DIM];
+    for (unsigned j = 0; j < MMA_DIM; j++) acc[j] = 0;
+    for (unsigned k = 0; k < MMA_DIM; k++) {
+      float aik = fa[i][k];
+      for (unsigned j = 0; j < MMA_DIM; j++)
+        acc[j] = h2f(f2h(acc[j] + aik * fb[k][j]));
+    }
+    for (unsigned j = 0; j < MMA_DIM; j++)
+      d[i][j] = mma_finish(acc[j], c[i][j], c_f32, d_f32);
+  }
+}
+#else
+// rows of a whose accumulators are kept in registers together
+static const unsigned MMA_ROW_BLOCK = 4;
+
+// f16 conversion of half.h: F16C's round toward zero, except that half.h
+// turns values from 65536 up into infinities and keeps the top of NaN
+// payloads, so vectors with such lanes are converted by half.h
+static inline __m128i mma_cvt_f16(__m256 x) {
+  __m128i h = _mm256_cvtps_ph(x, _MM_FROUND_TO_ZERO);
+  __m256 big = _mm256_cmp_ps(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), x),
+                             _mm256_set1_ps(65536.0f), _CMP_NLT_UQ);
+  if (!_mm256_movemask_ps(big)) return h;
+  float f[8];
+  unsigned short s[8];
+  _mm256_storeu_ps(f, x);
+  for (unsigned l = 0; l < 8; l++) s[l] = f2h(f[l]);
+  return _mm_loadu_si128((const __m128i *)s);
+}
+
+// an accumulator rounded to f16; with finite a and b it is never a NaN,
+// so lanes from 65536 up just become infinities
+static inline __m256 mma_round_f16(__m256 x) {
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  __m256 r = _mm256_cvtph_ps(_mm256_cvtps_ph(x, _MM_FROUND_TO_ZERO));
+  __m256 big = _mm256_cmp_ps(_mm256_andnot_ps(sign, x),
+                             _mm256_set1_ps(65536.0f), _CMP_GE_OQ);
+  __m256 inf = _mm256_or_ps(_mm256_and_ps(sign, x),
+                            _mm256_set1_ps(__builtin_inff()));
+  return _mm256_blendv_ps(r, inf, big);
+}
+
+// false if any of the f16 values is an infinity or a NaN
+static bool mma_finite(const unsigned short m[MMA_DIM][MMA_DIM]) {
+  const __m256i exp = _mm256_set1_epi16(0x7C00);
+  __m256i special = _mm256_setzero_si256();
+  for (unsigned i = 0; i < MMA_DIM; i++) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)m[i]);
+    special = _mm256_or_si256(
+        special, _mm256_cmpeq_epi16(_mm256_and_si256(v, exp), exp));
+  }
+  return _mm256_testz_si256(special, special);
+}
+
+static bool mma_finite(const unsigned c[MMA_DIM][MMA_DIM]) {
+  const __m256i exp = _mm256_set1_epi32(0x7C00);
+  __m256i special = _mm256_setzero_si256();
+  for (unsigned i = 0; i < MMA_DIM; i++) {
+    for (unsigned j = 0; j < MMA_DIM; j += 8) {
+      __m256i v = _mm256_loadu_si256((const __m256i *)&c[i][j]);
+      special = _mm256_or_si256(
+          special, _mm256_cmpeq_epi32(_mm256_and_si256(v, exp), exp));
+    }
+  }
+  return _mm256_testz_si256(special, special);
+}
+
+// eight columns of d from their accumulators
+static inline void mma_finish(__m256 acc, const unsigned *c, bool c_f32,
+                              unsigned *d, bool d_f32) {
+  __m256 sum;
+  if (c_f32) {
+    sum = _mm256_add_ps(acc, _mm256_loadu_ps((const float *)c));
+    if (d_f32) {
+      _mm256_storeu_ps((float *)d, sum);
+      return;
+    }
+  } else {
+    unsigned short ch[8];
+    for (unsigned l = 0; l < 8; l++) ch[l] = c[l];
+    sum = _mm256_add_ps(
+        acc, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)ch)));
+  }
+  __m128i h = mma_cvt_f16(sum);
+  if (d_f32)
+    _mm256_storeu_ps((float *)d, _mm256_cvtph_ps(h));
+  else
+    _mm256_storeu_si256((__m256i *)d, _mm256_cvtepu16_epi32(h));
+}
+
+static void mma_avx2(const unsigned short a[MMA_DIM][MMA_DIM],
+                     const unsigned short b[MMA_DIM][MMA_DIM],
+                     const unsigned c[MMA_DIM][MMA_DIM], bool c_f32,
+                     unsigned d[MMA_DIM][MMA_DIM], bool d_f32) {
+  __m256 fb[MMA_DIM][2];
+  for (unsigned k = 0; k < MMA_DIM; k++) {
+    fb[k][0] = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)&b[k][0]));
+    fb[k][1] = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)&b[k][8]));
+  }
+  for (unsigned i0 = 0; i0 < MMA_DIM; i0 += MMA_ROW_BLOCK) {
+    float fa[MMA_ROW_BLOCK][MMA_DIM];
+    __m256 acc[MMA_ROW_BLOCK][2];
+    for (unsigned r = 0; r < MMA_ROW_BLOCK; r++) {
+      const unsigned short *row = a[i0 + r];
+      _mm256_storeu_ps(&fa[r][0], _mm256_cvtph_ps(_mm_loadu_si128(
+                                      (const __m128i *)&row[0])));
+      _mm256_storeu_ps(&fa[r][8], _mm256_cvtph_ps(_mm_loadu_si128(
+                                      (const __m128i *)&row[8])));
+      acc[r][0] = _mm256_setzero_ps();
+      acc[r][1] = _mm256_setzero_ps();
+    }
+    for (unsigned k = 0; k < MMA_DIM; k++) {
+      for (unsigned r = 0; r < MMA_ROW_BLOCK; r++) {
+        __m256 aik = _mm256_set1_ps(fa[r][k]);
+        acc[r][0] = mma_round_f16(_mm256_fmadd_ps(aik, fb[k][0], acc[r][0]));
+        acc[r][1] = mma_round_f16(_mm256_fmadd_ps(aik, fb[k][1], acc[r][1]));
+      }
+    }
+    for (unsigned r = 0; r < MMA_ROW_BLOCK; r++) {
+      unsigned i = i0 + r;
+      mma_finish(acc[r][0], &c[i][0], c_f32, &d[i][0], d_f32);
+      mma_finish(acc[r][1], &c[i][8], c_f32, &d[i][8], d_f32);
+    }
+  }
+}
+#endif
+
+void mma_m16n16k16(const unsigned short a[MMA_DIM][MMA_DIM],
+                   const unsigned short b[MMA_DIM][MMA_DIM],
+                   const unsigned c[MMA_DIM][MMA_DIM], bool c_f32,
+                   unsigned d[MMA_DIM][MMA_DIM], bool d_f32) {
+  if (!mma_finite(a) || !mma_finite(b) || (!c_f32 && !mma_finite(c))) {
+    mma_m16n16k16_scalar(a, b, c, c_f32, d, d_f32);
+    return;
+  }
+#ifdef MMA_EMU_AVX2
+  mma_avx2(a, b, c, c_f32, d, d_f32);
+#else
+  mma_blocked(a, b, c, c_f32, d, d_f32);
+#endif
+}
+
+bool mma_emu_vectorized() {
+#ifdef MMA_EMU_AVX2
+  return true;
+#else
+  return false;
+#endif
+}
@@ -0,0 +1,34 @@
+#ifndef MMA_EMU_H
+#define MMA_EMU_H
+
+// -gpgpu_ptx_mma_emu
+enum mma_emu_mode_t { MMA_EMU_SCALAR = 0, MMA_EMU_ON, MMA_EMU_CHECK };
+
+static const unsigned MMA_DIM = 16;
+
+// Arithmetic of wmma.mma for the m16n16k16 shape: d = a * b + c over the
+// whole fragments of a warp, laid out as row major matrices. a and b hold
+// f16 bit patterns; c and d hold an f16 bit pattern in the low half of each
+// word or f32 bits, as c_f32 and d_f32 say. Each element sums its products
+// in an f16 accumulator that half.h truncates after every step, then adds
+// c, all as mma_impl always did; products of two f16 values are exact in
+// f32, so fused multiply-adds give the same sums. Inputs are converted to
+// f32 once and rows of accumulators are updated together; with F16C=1 the
+// blocks of rows live in AVX2 registers and convert with F16C. Fragments
+// with f16 infinities or NaNs go through the loop over half, since which
+// NaN comes out of an operation on two of them depends on operand order.
+void mma_m16n16k16(const unsigned short a[MMA_DIM][MMA_DIM],
+                   const unsigned short b[MMA_DIM][MMA_DIM],
+                   const unsigned c[MMA_DIM][MMA_DIM], bool c_f32,
+                   unsigned d[MMA_DIM][MMA_DIM], bool d_f32);
+
+// the original element by element loop over half
+void mma_m16n16k16_scalar(const unsigned short a[MMA_DIM][MMA_DIM],
+                          const unsigned short b[MMA_DIM][MMA_DIM],
+                          const unsigned c[MMA_DIM][MMA_DIM], bool c_f32,
+                          unsigned d[MMA_DIM][MMA_DIM], bool d_f32);
+
+// true when built with the F16C/AVX2 kernel
+bool mma_emu_vectorized();
+
+#endif
@@ -27,8 +27,10 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "ptx-stats.h"
+#include <pthread.h>
 #include <stdio.h>
 #include <map>
+#include <vector>
 #include "../../libcuda/gpgpu_context.h"
 #include "../option_parser.h"
 #include "../tr1_hash_map.h"
@@ -105,6 +107,18 @@ class ptx_file_line_stats {
                                        // (attributed to this instruction)
   unsigned long long
       warp_divergence;  // number of warp divergence occured at this instruction
+
+  void add(const ptx_file_line_stats &other) {
+    exec_count += other.exec_count;
+    latency += other.latency;
+    dram_traffic += other.dram_traffic;
+    smem_n_way_bank_conflict_total += other.smem_n_way_bank_conflict_total;
+    smem_warp_count += other.smem_warp_count;
+    gmem_n_access_total += other.gmem_n_access_total;
+    gmem_warp_count += other.gmem_warp_count;
+    exposed_latency += other.exposed_latency;
+    warp_divergence += other.warp_divergence;
+  }
 };
 
 #if (tr1_hash_map_ismap == 1)
@@ -121,14 +135,39 @@ typedef tr1_hash_map<ptx_file_line, ptx_file_line_stats, hash_ptx_file_line>
     ptx_file_line_stats_map_t;
 #endif
 
-static ptx_file_line_stats_map_t ptx_file_line_stats_tracker;
+// one map per thread, as -gpgpu_sim_threads steps the SM clusters on
+// several; they are added up when the file is written
+static pthread_mutex_t ptx_file_line_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<ptx_file_line_stats_map_t *> ptx_file_line_stats_maps;
+static thread_local ptx_file_line_stats_map_t *ptx_file_line_stats_map = NULL;
+
+static ptx_file_line_stats_map_t &ptx_file_line_stats_tracker() {
+  if (!ptx_file_line_stats_map) {
+    ptx_file_line_stats_map = new ptx_file_line_stats_map_t;
+    pthread_mutex_lock(&ptx_file_line_stats_lock);
+    ptx_file_line_stats_maps.push_back(ptx_file_line_stats_map);
+    pthread_mutex_unlock(&ptx_file_line_stats_lock);
+  }
+  return *ptx_file_line_stats_map;
+}
 
 // output statistics to a file
 void ptx_stats::ptx_file_line_stats_write_file() {
   // check if stat collection is turned on
   if (enable_ptx_file_line_stats == 0) return;
 
-  ptx_file_line_stats_map_t::iterator it;
+  // by file and line
+  std::map<ptx_file_line, ptx_file_line_stats> stats;
+  pthread_mutex_lock(&ptx_file_line_stats_lock);
+  for (unsigned i = 0; i < ptx_file_line_stats_maps.size(); i++) {
+    for (ptx_file_line_stats_map_t::const_iterator it =
+             ptx_file_line_stats_maps[i]->begin();
+         it != ptx_file_line_stats_maps[i]->end(); it++)
+      stats[it->first].add(it->second);
+  }
+  pthread_mutex_unlock(&ptx_file_line_stats_lock);
+
+  std::map<ptx_file_line, ptx_file_line_stats>::iterator it;
   FILE *pfile;
 
   pfile = fopen(ptx_line_stats_filename, "w");
@@ -136,8 +175,7 @@ void ptx_stats::ptx_file_line_stats_write_file() {
       pfile,
       "kernel line : count latency dram_traffic smem_bk_conflicts smem_warp "
       "gmem_access_generated gmem_warp exposed_latency warp_divergence\n");
-  for (it = ptx_file_line_stats_tracker.begin();
-       it != ptx_file_line_stats_tracker.end(); it++) {
+  for (it = stats.begin(); it != stats.end(); it++) {
     fprintf(pfile, "%s %i : ", it->first.st.c_str(), it->first.line);
     fprintf(pfile, "%lu ", it->second.exec_count);
     fprintf(pfile, "%llu ", it->second.latency);
@@ -157,8 +195,8 @@ void ptx_stats::ptx_file_line_stats_write_file() {
 // attribute one more execution count to this ptx instruction
 // counting the number of threads (not warps) executing this instruction
 void ptx_file_line_stats_add_exec_count(const ptx_instruction *pInsn) {
-  ptx_file_line_stats_tracker[ptx_file_line(pInsn->source_file(),
-                                            pInsn->source_line())]
+  ptx_file_line_stats_tracker()[ptx_file_line(pInsn->source_file(),
+                                              pInsn->source_line())]
       .exec_count += 1;
 }
 
@@ -169,8 +207,8 @@ void ptx_stats::ptx_file_line_stats_add_latency(unsigned pc, unsigned latency) {
   const ptx_instruction *pInsn = gpgpu_ctx->pc_to_instruction(pc);
 
   if (pInsn != NULL)
-    ptx_file_line_stats_tracker[ptx_file_line(pInsn->source_file(),
-                                              pInsn->source_line())]
+    ptx_file_line_stats_tracker()[ptx_file_line(pInsn->source_file(),
+                                                pInsn->source_line())]
         .latency += latency;
 }
 
@@ -181,8 +219,8 @@ void ptx_stats::ptx_file_line_stats_add_dram_traffic(unsigned pc,
   const ptx_instruction *pInsn = gpgpu_ctx->pc_to_instruction(pc);
 
   if (pInsn != NULL)
-    ptx_file_line_stats_tracker[ptx_file_line(pInsn->source_file(),
-                                              pInsn->source_line())]
+    ptx_file_line_stats_tracker()[ptx_file_line(pInsn->source_file(),
+                                                pInsn->source_line())]
         .dram_traffic += dram_traffic;
 }
 
@@ -194,8 +232,9 @@ void ptx_stats::ptx_file_line_stats_add_smem_bank_conflict(
   const ptx_instruction *pInsn = gpgpu_ctx->pc_to_instruction(pc);
 
   if (pInsn != NULL) {
-    ptx_file_line_stats &line_stats = ptx_file_line_stats_tracker[ptx_file_line(
-        pInsn->source_file(), pInsn->source_line())];
+    ptx_file_line_stats &line_stats =
+        ptx_file_line_stats_tracker()[ptx_file_line(pInsn->source_file(),
+                                                    pInsn->source_line())];
     line_stats.smem_n_way_bank_conflict_total += n_way_bkconflict;
     line_stats.smem_warp_count += 1;
   }
@@ -209,8 +248,9 @@ void ptx_stats::ptx_file_line_stats_add_uncoalesced_gmem(unsigned pc,
   const ptx_instruction *pInsn = gpgpu_ctx->pc_to_instruction(pc);
 
   if (pInsn != NULL) {
-    ptx_file_line_stats &line_stats = ptx_file_line_stats_tracker[ptx_file_line(
-        pInsn->source_file(), pInsn->source_line())];
+    ptx_file_line_stats &line_stats =
+        ptx_file_line_stats_tracker()[ptx_file_line(pInsn->source_file(),
+                                                    pInsn->source_line())];
     line_stats.gmem_n_access_total += n_access;
     line_stats.gmem_warp_count += 1;
   }
@@ -247,8 +287,8 @@ class ptx_inflight_memory_insn_tracker {
     for (; i_exlatinsn != exlat_insnmap.end(); ++i_exlatinsn) {
       const ptx_instruction *pInsn = i_exlatinsn->first;
       ptx_file_line_stats &line_stats =
-          ptx_file_line_stats_tracker[ptx_file_line(pInsn->source_file(),
-                                                    pInsn->source_line())];
+          ptx_file_line_stats_tracker()[ptx_file_line(
+              pInsn->source_file(), pInsn->source_line())];
       line_stats.exposed_latency += count;
     }
   }
@@ -291,7 +331,8 @@ void ptx_stats::ptx_file_line_stats_add_warp_divergence(
     unsigned pc, unsigned n_way_divergence) {
   const ptx_instruction *pInsn = gpgpu_ctx->pc_to_instruction(pc);
 
-  ptx_file_line_stats &line_stats = ptx_file_line_stats_tracker[ptx_file_line(
-      pInsn->source_file(), pInsn->source_line())];
+  ptx_file_line_stats &line_stats =
+      ptx_file_line_stats_tracker()[ptx_file_line(pInsn->source_file(),
+                                                  pInsn->source_line())];
   line_stats.warp_divergence += n_way_divergence;
 }
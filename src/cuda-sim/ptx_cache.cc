@@ -0,0 +1,157 @@
+#include "ptx_cache.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char PTX_CACHE_MAGIC[8] = "GPGPUPC";
+static const unsigned PTX_CACHE_VERSION = 1;
+
+struct ptx_cache_header_t {
+  char magic[8];
+  unsigned version;
+  unsigned n_files;
+  unsigned long long key;
+};
+
+ptx_cache::ptx_cache(const char *dir) {
+  if (dir && dir[0]) {
+    m_dir = dir;
+    mkdir(dir, 0777);
+  }
+}
+
+unsigned long long ptx_cache::hash(const void *data, size_t size,
+                                   unsigned long long h) {
+  const unsigned char *p = (const unsigned char *)data;
+  for (size_t i = 0; i < size; i++) {
+    h ^= p[i];
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+bool ptx_cache::hash_file(const char *fname, unsigned long long &h) {
+  FILE *fp = fopen(fname, "rb");
+  if (!fp) return false;
+  char buf[1 << 16];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) h = hash(buf, n, h);
+  bool ok = !ferror(fp);
+  fclose(fp);
+  return ok;
+}
+
+bool ptx_cache::hash_tool(const char *tool, unsigned long long &h) {
+  const char *install_path = getenv("CUDA_INSTALL_PATH");
+  std::string path = std::string(install_path ? install_path : "") + "/bin/" +
+                     tool;
+  char resolved[PATH_MAX];
+  struct stat st;
+  if (!realpath(path.c_str(), resolved) || stat(resolved, &st)) return false;
+  h = hash(resolved, strlen(resolved), h);
+  unsigned long long id[3] = {(unsigned long long)st.st_size,
+                              (unsigned long long)st.st_mtime,
+                              (unsigned long long)st.st_ino};
+  h = hash(id, sizeof(id), h);
+  return true;
+}
+
+bool ptx_cache::read_file(const char *fname, std::string &data) {
+  FILE *fp = fopen(fname, "rb");
+  if (!fp) return false;
+  data.clear();
+  char buf[1 << 16];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) data.append(buf, n);
+  bool ok = !ferror(fp);
+  fclose(fp);
+  return ok;
+}
+
+bool ptx_cache::write_file(const char *fname, const std::string &data) {
+  FILE *fp = fopen(fname, "wb");
+  if (!fp) return false;
+  bool ok = fwrite(data.data(), 1, data.size(), fp) == data.size();
+  ok = !fclose(fp) && ok;
+  return ok;
+}
+
+std::string ptx_cache::entry_name(const char *kind,
+                                  unsigned long long key) const {
+  char name[64];
+  snprintf(name, sizeof(name), "/%s_%016llx.bin", kind, key);
+  return m_dir + name;
+}
+
+static bool read_string(FILE *fp, std::string &s) {
+  unsigned long long size;
+  if (fread(&size, sizeof(size), 1, fp) != 1) return false;
+  s.resize(size);
+  return !size || fread(&s[0], 1, size, fp) == size;
+}
+
+static void write_string(FILE *fp, const std::string &s) {
+  unsigned long long size = s.size();
+  fwrite(&size, sizeof(size), 1, fp);
+  fwrite(s.data(), 1, s.size(), fp);
+}
+
+bool ptx_cache::load(const char *kind, unsigned long long key,
+                     files_t &files) const {
+  if (!enabled()) return false;
+  FILE *fp = fopen(entry_name(kind, key).c_str(), "rb");
+  if (!fp) return false;
+  ptx_cache_header_t header;
+  bool ok = fread(&header, sizeof(header), 1, fp) == 1 &&
+            !memcmp(header.magic, PTX_CACHE_MAGIC, sizeof(header.magic)) &&
+            header.version == PTX_CACHE_VERSION && header.key == key;
+  files.clear();
+  for (unsigned i = 0; ok && i < header.n_files; i++) {
+    files.push_back(std::make_pair(std::string(), std::string()));
+    ok = read_string(fp, files.back().first) &&
+         read_string(fp, files.back().second);
+  }
+  fclose(fp);
+  if (!ok) {
+    printf("GPGPU-Sim PTX: WARNING ** ignoring damaged cache entry %s\n",
+           entry_name(kind, key).c_str());
+    files.clear();
+  }
+  return ok;
+}
+
+void ptx_cache::save(const char *kind, unsigned long long key,
+                     const files_t &files) const {
+  if (!enabled()) return;
+  std::string name = entry_name(kind, key);
+  char suffix[32];
+  snprintf(suffix, sizeof(suffix), ".%d.tmp", (int)getpid());
+  std::string tmp = name + suffix;
+  FILE *fp = fopen(tmp.c_str(), "wb");
+  if (!fp) {
+    printf("GPGPU-Sim PTX: WARNING ** cannot write cache entry %s\n",
+           name.c_str());
+    return;
+  }
+  ptx_cache_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, PTX_CACHE_MAGIC, sizeof(header.magic));
+  header.version = PTX_CACHE_VERSION;
+  header.n_files = files.size();
+  header.key = key;
+  fwrite(&header, sizeof(header), 1, fp);
+  for (size_t i = 0; i < files.size(); i++) {
+    write_string(fp, files[i].first);
+    write_string(fp, files[i].second);
+  }
+  bool ok = !ferror(fp);
+  ok = !fclose(fp) && ok;
+  if (!ok || rename(tmp.c_str(), name.c_str())) {
+    printf("GPGPU-Sim PTX: WARNING ** cannot write cache entry %s\n",
+           name.c_str());
+    unlink(tmp.c_str());
+  }
+}
@@ -0,0 +1,57 @@
+#ifndef PTX_CACHE_H
+#define PTX_CACHE_H
+
+#include <stddef.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+// On-disk cache of what loading a binary produces (-gpgpu_ptx_cache_dir): the
+// PTX files cuobjdump extracts, the grammar actions the PTX parser runs (see
+// ptx_action_op) and the register usage ptxas reports. Entries are keyed by a
+// hash of everything the result depends on (input contents, command line
+// flags, the tool binary, format version), so repeat runs of the same binary,
+// e.g. the points of a configuration sweep, skip the tools and the parser.
+// Each entry is one versioned binary file holding a set of named files;
+// entries are written under a temporary name and renamed, so several
+// simulators can share a directory.
+class ptx_cache {
+ public:
+  // (name, contents)
+  typedef std::vector<std::pair<std::string, std::string> > files_t;
+
+  // caching is off when dir is NULL or empty
+  ptx_cache(const char *dir);
+
+  bool enabled() const { return !m_dir.empty(); }
+
+  // FNV-1a, chained through h
+  static unsigned long long hash(const void *data, size_t size,
+                                 unsigned long long h = HASH_SEED);
+  static unsigned long long hash(const std::string &data,
+                                 unsigned long long h = HASH_SEED) {
+    return hash(data.data(), data.size(), h);
+  }
+  // hash of a file's contents, false if it cannot be read
+  static bool hash_file(const char *fname, unsigned long long &h);
+  // identity (path, size, modification time) of $CUDA_INSTALL_PATH/bin/tool,
+  // so a toolkit upgrade invalidates what the tool produced; false if it
+  // cannot be found
+  static bool hash_tool(const char *tool, unsigned long long &h);
+  static bool read_file(const char *fname, std::string &data);
+  static bool write_file(const char *fname, const std::string &data);
+
+  // false on a miss or a damaged entry
+  bool load(const char *kind, unsigned long long key, files_t &files) const;
+  void save(const char *kind, unsigned long long key,
+            const files_t &files) const;
+
+ private:
+  static const unsigned long long HASH_SEED = 14695981039346656037ULL;
+
+  std::string entry_name(const char *kind, unsigned long long key) const;
+
+  std::string m_dir;
+};
+
+#endif
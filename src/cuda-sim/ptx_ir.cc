@@ -319,6 +319,20 @@ void symbol_table::dump() {
   printf("\n");
 }
 
+void operand_info::pre_decode() {
+  m_fetch = FETCH_GENERIC;
+  if (m_double_operand_type != 0 || m_operand_lohi != 0 || m_operand_neg ||
+      m_addr_space != undefined_space)
+    return;
+  if (is_reg()) {
+    m_fetch = FETCH_REG;
+  } else if (is_literal() && !is_builtin() && !m_immediate_address &&
+             !is_memory_operand()) {
+    m_literal = get_literal_value();
+    m_fetch = FETCH_LITERAL;
+  }
+}
+
 unsigned operand_info::get_uid() {
   unsigned result = (gpgpu_ctx->operand_info_sm_next_uid)++;
   return result;
@@ -1093,7 +1107,7 @@ arg_buffer_t copy_arg_to_buffer(ptx_thread_info *thread,
     addr_t from_addr = thread->get_local_mem_stack_pointer() + frame_offset;
     char buffer[1024];
     assert(size < 1024);
-    thread->m_local_mem->read(from_addr, size, buffer);
+    thread->local_mem()->read(from_addr, size, buffer);
     return arg_buffer_t(formal_param, actual_param_op, buffer, size);
   } else {
     printf(
@@ -1130,7 +1144,7 @@ void copy_buffer_to_frame(ptx_thread_info *thread, const arg_buffer_t &a) {
     const symbol *dst = a.get_dst();
     addr_t frame_offset = dst->get_address();
     addr_t to_addr = thread->get_local_mem_stack_pointer() + frame_offset;
-    thread->m_local_mem->write(to_addr, size, buffer, NULL, NULL);
+    thread->local_mem()->write(to_addr, size, buffer, NULL, NULL);
   }
 }
 
@@ -1217,6 +1231,10 @@ ptx_instruction::ptx_instruction(
   m_lo = false;
   m_uni = false;
   m_exit = false;
+  m_warp_simd_kernel = -1;
+  m_exec_fn = NULL;
+  m_op_classification = 0;
+  m_pred_is_reg = false;
   m_abs = false;
   m_neg = false;
   m_to_option = false;
@@ -1494,6 +1512,7 @@ function_info::function_info(int entry_point, gpgpu_context *ctx) {
   m_kernel_info.regs = 0;
   m_kernel_info.smem = 0;
   m_local_mem_framesize = 0;
+  m_n_reg_slots = 0;
   m_args_aligned_size = -1;
   pdom_done = false;  // initialize it to false
 }
@@ -325,6 +325,8 @@ class symbol_table {
   type_info *get_array_type(type_info *base_type, unsigned array_dim);
   void set_label_address(const symbol *label, unsigned addr);
   unsigned next_reg_num() { return ++m_reg_allocator; }
+  // register numbers are dense per function: 0 ("_") to the last allocated
+  unsigned num_reg_slots() const { return m_reg_allocator + 1; }
   addr_t get_shared_next() { return m_shared_next; }
   addr_t get_sstarr_next() { return m_sstarr_next; }
   addr_t get_global_next() { return m_global_next; }
@@ -652,6 +654,7 @@ class operand_info {
     m_value.m_vector_symbolic = NULL;
     m_addr_offset = 0;
     m_neg_pred = 0;
+    m_fetch = FETCH_GENERIC;
     m_is_return_var = 0;
     m_is_non_arch_reg = 0;
   }
@@ -854,6 +857,13 @@ class operand_info {
   addr_t get_const_mem_offset() const { return m_const_mem_offset; }
   bool is_non_arch_reg() const { return m_is_non_arch_reg; }
 
+  // how get_operand_value() and set_operand_value() access the operand,
+  // resolved once by pre_decode(); FETCH_GENERIC takes the full decode
+  enum fetch_t { FETCH_GENERIC = 0, FETCH_REG, FETCH_LITERAL };
+  fetch_t fetch() const { return m_fetch; }
+  const ptx_reg_t &literal() const { return m_literal; }
+  void pre_decode();
+
  private:
   gpgpu_context *gpgpu_ctx;
   unsigned m_uid;
@@ -884,6 +894,8 @@ class operand_info {
   bool m_neg_pred;
   bool m_is_return_var;
   bool m_is_non_arch_reg;
+  fetch_t m_fetch;
+  ptx_reg_t m_literal;
 
   unsigned get_uid();
 };
@@ -962,6 +974,9 @@ class ptx_instruction : public warp_inst_t {
   unsigned get_num_operands() const { return m_operands.size(); }
   bool has_pred() const { return m_pred != NULL; }
   operand_info get_pred() const;
+  const symbol *get_pred_symbol() const { return m_pred; }
+  // the predicate is a plain register (not ptxplus), set by pre_decode()
+  bool pred_is_reg() const { return m_pred_is_reg; }
   bool get_pred_neg() const { return m_neg_pred; }
   int get_pred_mod() const { return m_pred_mod; }
   const char *get_source() const { return m_source.c_str(); }
@@ -1085,6 +1100,15 @@ class ptx_instruction : public warp_inst_t {
   unsigned cache_option() const { return m_cache_option; }
   unsigned rounding_mode() const { return m_rounding_mode; }
   unsigned saturation_mode() const { return m_saturation_mode; }
+  // handler of the opcode resolved by pre_decode(); NULL for the ones that
+  // work on the whole warp (OP_W_DEF)
+  typedef void (*exec_fn_t)(const ptx_instruction *pI,
+                            ptx_thread_info *thread);
+  exec_fn_t exec_fn() const { return m_exec_fn; }
+  int op_classification() const { return m_op_classification; }
+  // lane kernel of -gpgpu_ptx_warp_simd, -1 until a warp first executes it
+  int warp_simd_kernel() const { return m_warp_simd_kernel; }
+  void set_warp_simd_kernel(int kernel) const { m_warp_simd_kernel = kernel; }
   unsigned dimension() const { return m_geom_spec; }
   unsigned barrier_op() const { return m_barrier_op; }
   unsigned shfl_op() const { return m_shfl_op; }
@@ -1172,6 +1196,10 @@ class ptx_instruction : public warp_inst_t {
   int m_membar_level;
   int m_instr_mem_index;  // index into m_instr_mem array
   unsigned m_inst_size;   // bytes
+  exec_fn_t m_exec_fn;
+  int m_op_classification;
+  bool m_pred_is_reg;
+  mutable int m_warp_simd_kernel;
 
   virtual void pre_decode();
   friend class function_info;
@@ -1300,6 +1328,9 @@ class function_info {
   void get_reconvergence_pairs(gpgpu_recon_t *recon_points);
 
   unsigned get_function_size() { return m_instructions.size(); }
+  const std::list<ptx_instruction *> &get_instructions() const {
+    return m_instructions;
+  }
 
   void ptx_assemble();
 
@@ -1354,6 +1385,8 @@ class function_info {
   symbol_table *get_symtab() { return m_symtab; }
 
   unsigned local_mem_framesize() const { return m_local_mem_framesize; }
+  // size of a register frame of this function, indexed by symbol::reg_num()
+  unsigned num_reg_slots() const { return m_n_reg_slots; }
   void set_framesize(unsigned sz) { m_local_mem_framesize = sz; }
   bool is_entry_point() const { return m_entry_point; }
   bool is_pdom_set() const { return pdom_done; }  // return pdom flag
@@ -1389,6 +1422,7 @@ class function_info {
   unsigned maxnt_id;
   unsigned m_uid;
   unsigned m_local_mem_framesize;
+  unsigned m_n_reg_slots;
   bool m_entry_point;
   bool m_extern;
   bool m_assembled;
@@ -33,6 +33,7 @@
 #include <sstream>
 #include "../../libcuda/gpgpu_context.h"
 #include "cuda-sim.h"
+#include "ptx_cache.h"
 #include "ptx_ir.h"
 #include "ptx_parser.h"
 
@@ -56,6 +57,7 @@ extern int ptxinfo_lex_destroy(yyscan_t scanner);
 
 static bool g_save_embedded_ptx;
 static int g_occupancy_sm_number;
+static char *g_ptx_cache_dir;
 
 bool ptxinfo_data::keep_intermediate_files() {
   return g_keep_intermediate_files;
@@ -79,8 +81,16 @@ void gpgpu_context::ptx_reg_options(option_parser_t opp) {
                          "usage for computing GPU occupancy. "
                          "This parameter is required in the config.",
                          "0");
+  option_parser_register(opp, "-gpgpu_ptx_cache_dir", OPT_CSTR,
+                         &g_ptx_cache_dir,
+                         "Directory caching the PTX extracted by cuobjdump, "
+                         "the parsed PTX and the ptxas register usage across "
+                         "runs",
+                         NULL);
 }
 
+const char *gpgpu_context::ptx_cache_dir() const { return g_ptx_cache_dir; }
+
 void gpgpu_context::print_ptx_file(const char *p, unsigned source_num,
                                    const char *filename) {
   printf("\nGPGPU-Sim PTX: file _%u.ptx contents:\n\n", source_num);
@@ -356,11 +366,30 @@ void gpgpu_context::gpgpu_ptx_info_load_from_filename(const char *filename,
       buff, 1024,
       "$CUDA_INSTALL_PATH/bin/ptxas %s -v %s --output-file  /dev/null 2> %s",
       extra_flags, filename, ptxas_filename.c_str());
-  int result = system(buff);
-  if (result != 0) {
-    printf("GPGPU-Sim PTX: ERROR ** while loading PTX (b) %d\n", result);
-    printf("               Ensure ptxas is in your path.\n");
-    exit(1);
+
+  // the report depends on the PTX, the flags and the ptxas release
+  ptx_cache cache(g_ptx_cache_dir);
+  unsigned long long key = ptx_cache::hash(extra_flags);
+  ptx_cache::files_t report;
+  bool keyed = cache.enabled() && ptx_cache::hash_tool("ptxas", key) &&
+               ptx_cache::hash_file(filename, key);
+  bool cached =
+      keyed && cache.load("ptxas", key, report) && report.size() == 1 &&
+      ptx_cache::write_file(ptxas_filename.c_str(), report[0].second);
+  if (cached) {
+    printf("GPGPU-Sim PTX: ptxinfo of %s found in %s\n", filename,
+           g_ptx_cache_dir);
+  } else {
+    int result = system(buff);
+    if (result != 0) {
+      printf("GPGPU-Sim PTX: ERROR ** while loading PTX (b) %d\n", result);
+      printf("               Ensure ptxas is in your path.\n");
+      exit(1);
+    }
+    report.assign(1, std::make_pair(ptxas_filename, std::string()));
+    if (keyed &&
+        ptx_cache::read_file(ptxas_filename.c_str(), report[0].second))
+      cache.save("ptxas", key, report);
   }
 
   FILE *ptxinfo_in;
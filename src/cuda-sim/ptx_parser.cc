@@ -28,6 +28,7 @@
 
 #include "ptx_parser.h"
 #include "../../libcuda/gpgpu_context.h"
+#include "ptx_cache.h"
 #include "ptx_ir.h"
 
 typedef void *yyscan_t;
@@ -48,19 +49,207 @@ void ptx_recognizer::set_ptx_warp_size(const struct core_config *warp_size) {
   g_shader_core_config = warp_size;
 }
 
-#define PTX_PARSE_DPRINTF(...)                                            \
-  if (g_debug_ir_generation) {                                            \
-    printf(" %s:%u => ", gpgpu_ctx->g_filename, ptx_get_lineno(scanner)); \
-    printf("   (%s:%u) ", __FILE__, __LINE__);                            \
-    printf(__VA_ARGS__);                                                  \
-    printf("\n");                                                         \
-    fflush(stdout);                                                       \
+#define PTX_PARSE_DPRINTF(...)                             \
+  if (g_debug_ir_generation) {                             \
+    printf(" %s:%u => ", gpgpu_ctx->g_filename, lineno()); \
+    printf("   (%s:%u) ", __FILE__, __LINE__);             \
+    printf(__VA_ARGS__);                                   \
+    printf("\n");                                          \
+    fflush(stdout);                                        \
   }
 
 static std::map<unsigned, std::string> g_ptx_token_decode;
 
 const char *decode_token(int type) { return g_ptx_token_decode[type].c_str(); }
 
+unsigned ptx_recognizer::lineno() {
+  return scanner ? ptx_get_lineno(scanner) : g_replay_lineno;
+}
+
+ptx_action &ptx_recognizer::record(int op, int a, int b, int c, double real) {
+  if (!g_action_log) return m_no_action;
+  g_action_log->push_back(ptx_action(op, lineno(), a, b, c, real));
+  return g_action_log->back();
+}
+
+void ptx_recognizer::replay(const ptx_action_log &actions) {
+  scanner = NULL;
+  g_symtabs.clear();
+  for (ptx_action_log::const_iterator a = actions.begin(); a != actions.end();
+       a++) {
+    g_replay_lineno = a->m_line;
+    // the IR keeps some of the names it is given, as it does the lexer's
+    char *s[8] = {NULL};
+    for (unsigned i = 0; i < a->m_str.size() && i < 8; i++)
+      s[i] = strdup(a->m_str[i].c_str());
+    const int *n = a->m_int;
+    switch (a->m_op) {
+      case PTX_START_FUNCTION: start_function(n[0]); break;
+      case PTX_ADD_FUNCTION_NAME: add_function_name(s[0]); break;
+      case PTX_ADD_DIRECTIVE: add_directive(); break;
+      case PTX_END_FUNCTION: end_function(); break;
+      case PTX_ADD_IDENTIFIER: add_identifier(s[0], n[0], n[1]); break;
+      case PTX_ADD_FUNCTION_ARG: add_function_arg(); break;
+      case PTX_ADD_SCALAR_TYPE_SPEC: add_scalar_type_spec(n[0]); break;
+      case PTX_ADD_SCALAR_OPERAND: add_scalar_operand(s[0]); break;
+      case PTX_ADD_NEG_PRED_OPERAND: add_neg_pred_operand(s[0]); break;
+      case PTX_ADD_VARIABLES: add_variables(); break;
+      case PTX_SET_VARIABLE_TYPE: set_variable_type(); break;
+      case PTX_ADD_OPCODE: add_opcode(n[0]); break;
+      case PTX_ADD_PRED: add_pred(s[0], n[0], n[1]); break;
+      case PTX_ADD_1VECTOR_OPERAND: add_1vector_operand(s[0]); break;
+      case PTX_ADD_2VECTOR_OPERAND: add_2vector_operand(s[0], s[1]); break;
+      case PTX_ADD_3VECTOR_OPERAND:
+        add_3vector_operand(s[0], s[1], s[2]);
+        break;
+      case PTX_ADD_4VECTOR_OPERAND:
+        add_4vector_operand(s[0], s[1], s[2], s[3]);
+        break;
+      case PTX_ADD_8VECTOR_OPERAND:
+        add_8vector_operand(s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7]);
+        break;
+      case PTX_ADD_OPTION: add_option(n[0]); break;
+      case PTX_ADD_WMMA_OPTION: add_wmma_option(n[0]); break;
+      case PTX_ADD_BUILTIN_OPERAND: add_builtin_operand(n[0], n[1]); break;
+      case PTX_ADD_MEMORY_OPERAND: add_memory_operand(); break;
+      case PTX_ADD_LITERAL_INT: add_literal_int(n[0]); break;
+      case PTX_ADD_LITERAL_FLOAT: add_literal_float(a->m_real); break;
+      case PTX_ADD_LITERAL_DOUBLE: add_literal_double(a->m_real); break;
+      case PTX_ADD_ADDRESS_OPERAND: add_address_operand(s[0], n[0]); break;
+      case PTX_ADD_ADDRESS_OPERAND2: add_address_operand2(n[0]); break;
+      case PTX_ADD_LABEL: add_label(s[0]); break;
+      case PTX_ADD_VECTOR_SPEC: add_vector_spec(n[0]); break;
+      case PTX_ADD_SPACE_SPEC:
+        add_space_spec((enum _memory_space_t)n[0], n[1]);
+        break;
+      case PTX_ADD_PTR_SPEC: add_ptr_spec((enum _memory_space_t)n[0]); break;
+      case PTX_ADD_EXTERN_SPEC: add_extern_spec(); break;
+      case PTX_ADD_INSTRUCTION:
+        strncpy(linebuf, s[0], PTX_LINEBUF_SIZE - 1);
+        linebuf[PTX_LINEBUF_SIZE - 1] = '\0';
+        add_instruction();
+        break;
+      case PTX_SET_RETURN: set_return(); break;
+      case PTX_ADD_ALIGNMENT_SPEC: add_alignment_spec(n[0]); break;
+      case PTX_ADD_ARRAY_INITIALIZER: add_array_initializer(); break;
+      case PTX_ADD_FILE: add_file(n[0], s[0]); break;
+      case PTX_ADD_VERSION_INFO: add_version_info(a->m_real, n[0]); break;
+      case PTX_RESET_SYMTAB: reset_symtab(); break;
+      case PTX_SET_SYMTAB: set_symtab(g_symtabs[n[0]]); break;
+      case PTX_ADD_PRAGMA: add_pragma(s[0]); break;
+      case PTX_ADD_CONSTPTR: add_constptr(s[0], s[1], n[0]); break;
+      case PTX_TARGET_HEADER: target_header(s[0]); break;
+      case PTX_TARGET_HEADER2: target_header2(s[0], s[1]); break;
+      case PTX_TARGET_HEADER3: target_header3(s[0], s[1], s[2]); break;
+      case PTX_ADD_DOUBLE_OPERAND: add_double_operand(s[0], s[1]); break;
+      case PTX_CHANGE_MEMORY_ADDR_SPACE:
+        change_memory_addr_space(s[0]);
+        break;
+      case PTX_CHANGE_OPERAND_LOHI: change_operand_lohi(n[0]); break;
+      case PTX_CHANGE_DOUBLE_OPERAND_TYPE:
+        change_double_operand_type(n[0]);
+        break;
+      case PTX_CHANGE_OPERAND_NEG: change_operand_neg(); break;
+      case PTX_SET_IMMEDIATE_OPERAND_TYPE: set_immediate_operand_type(); break;
+      case PTX_MAXNT_ID: maxnt_id(n[0], n[1], n[2]); break;
+      case PTX_START_INST_GROUP: start_inst_group(); break;
+      case PTX_END_INST_GROUP: end_inst_group(); break;
+      case PTX_SET_FUNC_DECL: set_func_decl(n[0]); break;
+      default: assert(0);
+    }
+  }
+}
+
+// number of strings each action records; decode_actions() rejects entries
+// that do not match
+static unsigned action_strings(int op) {
+  switch (op) {
+    case PTX_ADD_FUNCTION_NAME:
+    case PTX_ADD_IDENTIFIER:
+    case PTX_ADD_SCALAR_OPERAND:
+    case PTX_ADD_NEG_PRED_OPERAND:
+    case PTX_ADD_PRED:
+    case PTX_ADD_1VECTOR_OPERAND:
+    case PTX_ADD_ADDRESS_OPERAND:
+    case PTX_ADD_LABEL:
+    case PTX_ADD_INSTRUCTION:
+    case PTX_ADD_FILE:
+    case PTX_ADD_PRAGMA:
+    case PTX_TARGET_HEADER:
+    case PTX_CHANGE_MEMORY_ADDR_SPACE:
+      return 1;
+    case PTX_ADD_2VECTOR_OPERAND:
+    case PTX_ADD_CONSTPTR:
+    case PTX_TARGET_HEADER2:
+    case PTX_ADD_DOUBLE_OPERAND:
+      return 2;
+    case PTX_ADD_3VECTOR_OPERAND:
+    case PTX_TARGET_HEADER3:
+      return 3;
+    case PTX_ADD_4VECTOR_OPERAND:
+      return 4;
+    case PTX_ADD_8VECTOR_OPERAND:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+template <class T>
+static void put(std::string &data, const T &v) {
+  data.append((const char *)&v, sizeof(v));
+}
+
+template <class T>
+static bool get(const std::string &data, size_t &pos, T &v) {
+  if (data.size() - pos < sizeof(v)) return false;
+  memcpy(&v, data.data() + pos, sizeof(v));
+  pos += sizeof(v);
+  return true;
+}
+
+static void encode_actions(const ptx_action_log &actions, std::string &data) {
+  data.clear();
+  put(data, (unsigned)PTX_ACTION_LOG_VERSION);
+  put(data, (unsigned long long)actions.size());
+  for (ptx_action_log::const_iterator a = actions.begin(); a != actions.end();
+       a++) {
+    put(data, a->m_op);
+    put(data, a->m_line);
+    put(data, a->m_int);
+    put(data, a->m_real);
+    for (unsigned i = 0; i < a->m_str.size(); i++) {
+      put(data, (unsigned)a->m_str[i].size());
+      data.append(a->m_str[i]);
+    }
+  }
+}
+
+static bool decode_actions(const std::string &data, ptx_action_log &actions) {
+  size_t pos = 0;
+  unsigned version;
+  unsigned long long n;
+  if (!get(data, pos, version) || version != PTX_ACTION_LOG_VERSION ||
+      !get(data, pos, n))
+    return false;
+  actions.clear();
+  for (unsigned long long k = 0; k < n; k++) {
+    ptx_action a(0, 0, 0, 0, 0, 0);
+    if (!get(data, pos, a.m_op) || a.m_op < 0 || a.m_op >= PTX_NUM_ACTIONS ||
+        !get(data, pos, a.m_line) || !get(data, pos, a.m_int) ||
+        !get(data, pos, a.m_real))
+      return false;
+    for (unsigned i = 0; i < action_strings(a.m_op); i++) {
+      unsigned size;
+      if (!get(data, pos, size) || data.size() - pos < size) return false;
+      a.m_str.push_back(data.substr(pos, size));
+      pos += size;
+    }
+    actions.push_back(a);
+  }
+  return pos == data.size();
+}
+
 void ptx_recognizer::read_parser_environment_variables() {
   gpgpu_ctx->g_filename = getenv("PTX_SIM_KERNELFILE");
   char *dbg_level = getenv("PTX_SIM_DEBUG");
@@ -133,18 +322,50 @@ symbol_table *gpgpu_context::init_parser(const char *ptx_filename) {
   ptx_lex_init(&(ptx_parser->scanner));
   ptx_parser->init_directive_state();
   ptx_parser->init_instruction_state();
+  ptx_parser->g_symtabs.clear();
+
+  // the grammar actions only depend on the PTX text, so a recording keyed
+  // by its hash replays into the same IR under any file name
+  ptx_cache cache(ptx_cache_dir());
+  unsigned long long key = ptx_cache::hash("ptxir");
+  unsigned version = PTX_ACTION_LOG_VERSION;
+  key = ptx_cache::hash(&version, sizeof(version), key);
+  bool cacheable = cache.enabled() && ptx_cache::hash_file(ptx_filename, key);
+  ptx_action_log actions;
+  if (cacheable) {
+    ptx_cache::files_t entry;
+    if (cache.load("ptxir", key, entry) && entry.size() == 1 &&
+        decode_actions(entry[0].second, actions)) {
+      printf("GPGPU-Sim PTX: replaying parse of %s from cache %s\n",
+             ptx_filename, ptx_cache_dir());
+      ptx_lex_destroy(ptx_parser->scanner);
+      ptx_parser->replay(actions);
+      return ptx_parser->g_global_symbol_table;
+    }
+    actions.clear();
+    ptx_parser->g_action_log = &actions;
+  }
 
   FILE *ptx_in;
   ptx_in = fopen(ptx_filename, "r");
   ptx_set_in(ptx_in, ptx_parser->scanner);
-  ptx_parse(ptx_parser->scanner, ptx_parser);
+  int errors = ptx_parse(ptx_parser->scanner, ptx_parser);
   ptx_in = ptx_get_in(ptx_parser->scanner);
   ptx_lex_destroy(ptx_parser->scanner);
   fclose(ptx_in);
+  ptx_parser->g_action_log = NULL;
+
+  if (cacheable && !errors && !ptx_parser->g_error_detected) {
+    ptx_cache::files_t entry(1);
+    entry[0].first = ptx_filename;
+    encode_actions(actions, entry[0].second);
+    cache.save("ptxir", key, entry);
+  }
   return ptx_parser->g_global_symbol_table;
 }
 
 void ptx_recognizer::start_function(int entry_point) {
+  record(PTX_START_FUNCTION, entry_point);
   PTX_PARSE_DPRINTF("start_function");
   init_directive_state();
   init_instruction_state();
@@ -154,6 +375,7 @@ void ptx_recognizer::start_function(int entry_point) {
 }
 
 void ptx_recognizer::add_function_name(const char *name) {
+  record(PTX_ADD_FUNCTION_NAME).str(name);
   PTX_PARSE_DPRINTF(
       "add_function_name %s %s", name,
       ((g_entry_point == 1) ? "(entrypoint)"
@@ -161,9 +383,13 @@ void ptx_recognizer::add_function_name(const char *name) {
   bool prior_decl = g_global_symbol_table->add_function_decl(
       name, g_entry_point, &g_func_info, &g_current_symbol_table);
   if (g_add_identifier_cached__identifier) {
+    // replaying add_function_name repeats this call, so it is not recorded
+    ptx_action_log *log = g_action_log;
+    g_action_log = NULL;
     add_identifier(g_add_identifier_cached__identifier,
                    g_add_identifier_cached__array_dim,
                    g_add_identifier_cached__array_ident);
+    g_action_log = log;
     free(g_add_identifier_cached__identifier);
     g_add_identifier_cached__identifier = NULL;
     g_func_info->add_return_var(g_last_symbol);
@@ -173,21 +399,24 @@ void ptx_recognizer::add_function_name(const char *name) {
     g_func_info->remove_args();
   }
   g_global_symbol_table->add_function(g_func_info, gpgpu_ctx->g_filename,
-                                      ptx_get_lineno(scanner));
+                                      lineno());
 }
 
 // Jin: handle instruction group for cdp
 void ptx_recognizer::start_inst_group() {
+  record(PTX_START_INST_GROUP);
   PTX_PARSE_DPRINTF("start_instruction_group");
   g_current_symbol_table = g_current_symbol_table->start_inst_group();
 }
 
 void ptx_recognizer::end_inst_group() {
+  record(PTX_END_INST_GROUP);
   PTX_PARSE_DPRINTF("end_instruction_group");
   g_current_symbol_table = g_current_symbol_table->end_inst_group();
 }
 
 void ptx_recognizer::add_directive() {
+  record(PTX_ADD_DIRECTIVE);
   PTX_PARSE_DPRINTF("add_directive");
   init_directive_state();
 }
@@ -195,6 +424,7 @@ void ptx_recognizer::add_directive() {
 #define mymax(a, b) ((a) > (b) ? (a) : (b))
 
 void ptx_recognizer::end_function() {
+  record(PTX_END_FUNCTION);
   PTX_PARSE_DPRINTF("end_function");
 
   init_directive_state();
@@ -224,9 +454,9 @@ void ptx_recognizer::parse_error_impl(const char *file, unsigned line,
   va_end(ap);
 
   g_error_detected = 1;
-  printf("%s:%u: Parse error: %s (%s:%u)\n\n", gpgpu_ctx->g_filename,
-         ptx_get_lineno(scanner), buf, file, line);
-  ptx_error(scanner, this, NULL);
+  printf("%s:%u: Parse error: %s (%s:%u)\n\n", gpgpu_ctx->g_filename, lineno(),
+         buf, file, line);
+  if (scanner) ptx_error(scanner, this, NULL);
   abort();
   exit(1);
 }
@@ -243,6 +473,7 @@ void ptx_recognizer::parse_assert_impl(int test_value, const char *file,
 }
 
 void ptx_recognizer::set_return() {
+  record(PTX_SET_RETURN);
   parse_assert((g_opcode == CALL_OP || g_opcode == CALLP_OP),
                "only call can have return value");
   g_operands.front().set_return();
@@ -261,20 +492,22 @@ const ptx_instruction *ptx_recognizer::ptx_instruction_lookup(
 }
 
 void ptx_recognizer::add_instruction() {
+  record(PTX_ADD_INSTRUCTION).str(linebuf);
   PTX_PARSE_DPRINTF("add_instruction: %s",
                     ((g_opcode > 0) ? g_opcode_string[g_opcode] : "<label>"));
   assert(g_shader_core_config != 0);
   ptx_instruction *i = new ptx_instruction(
       g_opcode, g_pred, g_neg_pred, g_pred_mod, g_label, g_operands,
       g_return_var, g_options, g_wmma_options, g_scalar_type, g_space_spec,
-      gpgpu_ctx->g_filename, ptx_get_lineno(scanner), linebuf,
-      g_shader_core_config, gpgpu_ctx);
+      gpgpu_ctx->g_filename, lineno(), linebuf, g_shader_core_config,
+      gpgpu_ctx);
   g_instructions.push_back(i);
-  g_inst_lookup[gpgpu_ctx->g_filename][ptx_get_lineno(scanner)] = i;
+  g_inst_lookup[gpgpu_ctx->g_filename][lineno()] = i;
   init_instruction_state();
 }
 
 void ptx_recognizer::add_variables() {
+  record(PTX_ADD_VARIABLES);
   PTX_PARSE_DPRINTF("add_variables");
   if (!g_operands.empty()) {
     assert(g_last_symbol != NULL);
@@ -284,6 +517,7 @@ void ptx_recognizer::add_variables() {
 }
 
 void ptx_recognizer::set_variable_type() {
+  record(PTX_SET_VARIABLE_TYPE);
   PTX_PARSE_DPRINTF("set_variable_type space_spec=%s scalar_type_spec=%s",
                     g_ptx_token_decode[g_space_spec.get_type()].c_str(),
                     g_ptx_token_decode[g_scalar_type_spec].c_str());
@@ -322,6 +556,7 @@ int pad_address(new_addr_type address, unsigned size, unsigned maxalign) {
 
 void ptx_recognizer::add_identifier(const char *identifier, int array_dim,
                                     unsigned array_ident) {
+  record(PTX_ADD_IDENTIFIER, array_dim, array_ident).str(identifier);
   if (array_ident == ARRAY_IDENTIFIER) {
     g_size *= array_dim;
   }
@@ -369,8 +604,7 @@ void ptx_recognizer::add_identifier(const char *identifier, int array_dim,
       break;
   }
   g_last_symbol = g_current_symbol_table->add_variable(
-      identifier, type, num_bits / 8, gpgpu_ctx->g_filename,
-      ptx_get_lineno(scanner));
+      identifier, type, num_bits / 8, gpgpu_ctx->g_filename, lineno());
   switch (ti.get_memory_space().get_type()) {
     case reg_space: {
       regnum = g_current_symbol_table->next_reg_num();
@@ -514,6 +748,7 @@ void ptx_recognizer::add_identifier(const char *identifier, int array_dim,
 
 void ptx_recognizer::add_constptr(const char *identifier1,
                                   const char *identifier2, int offset) {
+  record(PTX_ADD_CONSTPTR, offset).str(identifier1).str(identifier2);
   symbol *s1 = g_current_symbol_table->lookup(identifier1);
   const symbol *s2 = g_current_symbol_table->lookup(identifier2);
   parse_assert(s1 != NULL, "'from' constant identifier does not exist.");
@@ -528,6 +763,7 @@ void ptx_recognizer::add_constptr(const char *identifier1,
 }
 
 void ptx_recognizer::add_function_arg() {
+  record(PTX_ADD_FUNCTION_ARG);
   assert(g_size > 0);
   if (g_func_info) {
     PTX_PARSE_DPRINTF("add_function_arg \"%s\"", g_last_symbol->name().c_str());
@@ -540,11 +776,13 @@ void ptx_recognizer::add_function_arg() {
 }
 
 void ptx_recognizer::add_extern_spec() {
+  record(PTX_ADD_EXTERN_SPEC);
   PTX_PARSE_DPRINTF("add_extern_spec");
   g_extern_spec = 1;
 }
 
 void ptx_recognizer::add_alignment_spec(int spec) {
+  record(PTX_ADD_ALIGNMENT_SPEC, spec);
   PTX_PARSE_DPRINTF("add_alignment_spec");
   parse_assert(
       g_alignment_spec == -1,
@@ -553,6 +791,7 @@ void ptx_recognizer::add_alignment_spec(int spec) {
 }
 
 void ptx_recognizer::add_ptr_spec(enum _memory_space_t spec) {
+  record(PTX_ADD_PTR_SPEC, spec);
   PTX_PARSE_DPRINTF("add_ptr_spec \"%s\"", g_ptx_token_decode[spec].c_str());
   parse_assert(g_ptr_spec == undefined_space,
                "multiple ptr space specifiers not allowed.");
@@ -563,6 +802,7 @@ void ptx_recognizer::add_ptr_spec(enum _memory_space_t spec) {
 }
 
 void ptx_recognizer::add_space_spec(enum _memory_space_t spec, int value) {
+  record(PTX_ADD_SPACE_SPEC, spec, value);
   PTX_PARSE_DPRINTF("add_space_spec \"%s\"", g_ptx_token_decode[spec].c_str());
   parse_assert(g_space_spec == undefined_space,
                "multiple space specifiers not allowed.");
@@ -581,12 +821,14 @@ void ptx_recognizer::add_space_spec(enum _memory_space_t spec, int value) {
 }
 
 void ptx_recognizer::add_vector_spec(int spec) {
+  record(PTX_ADD_VECTOR_SPEC, spec);
   PTX_PARSE_DPRINTF("add_vector_spec");
   parse_assert(g_vector_spec == -1, "multiple vector specifiers not allowed.");
   g_vector_spec = spec;
 }
 
 void ptx_recognizer::add_scalar_type_spec(int type_spec) {
+  record(PTX_ADD_SCALAR_TYPE_SPEC, type_spec);
   // save size of parameter
   switch (type_spec) {
     case B8_TYPE:
@@ -634,20 +876,25 @@ void ptx_recognizer::add_scalar_type_spec(int type_spec) {
 }
 
 void ptx_recognizer::add_label(const char *identifier) {
+  record(PTX_ADD_LABEL).str(identifier);
   PTX_PARSE_DPRINTF("add_label");
   symbol *s = g_current_symbol_table->lookup(identifier);
   if (s != NULL) {
     g_label = s;
   } else {
     g_label = g_current_symbol_table->add_variable(
-        identifier, NULL, 0, gpgpu_ctx->g_filename, ptx_get_lineno(scanner));
+        identifier, NULL, 0, gpgpu_ctx->g_filename, lineno());
   }
 }
 
-void ptx_recognizer::add_opcode(int opcode) { g_opcode = opcode; }
+void ptx_recognizer::add_opcode(int opcode) {
+  record(PTX_ADD_OPCODE, opcode);
+  g_opcode = opcode;
+}
 
 void ptx_recognizer::add_pred(const char *identifier, int neg,
                               int predModifier) {
+  record(PTX_ADD_PRED, neg, predModifier).str(identifier);
   PTX_PARSE_DPRINTF("add_pred");
   const symbol *s = g_current_symbol_table->lookup(identifier);
   if (s == NULL) {
@@ -661,14 +908,17 @@ void ptx_recognizer::add_pred(const char *identifier, int neg,
 }
 
 void ptx_recognizer::add_option(int option) {
+  record(PTX_ADD_OPTION, option);
   PTX_PARSE_DPRINTF("add_option");
   g_options.push_back(option);
 }
 void ptx_recognizer::add_wmma_option(int option) {
+  record(PTX_ADD_WMMA_OPTION, option);
   PTX_PARSE_DPRINTF("add_option");
   g_wmma_options.push_back(option);
 }
 void ptx_recognizer::add_double_operand(const char *d1, const char *d2) {
+  record(PTX_ADD_DOUBLE_OPERAND).str(d1).str(d2);
   // operands that access two variables.
   // eg. s[$ofs1+$r0], g[$ofs1+=$r0]
   // TODO: Not sure if I'm going to use this for storing to two destinations or
@@ -682,6 +932,7 @@ void ptx_recognizer::add_double_operand(const char *d1, const char *d2) {
 }
 
 void ptx_recognizer::add_1vector_operand(const char *d1) {
+  record(PTX_ADD_1VECTOR_OPERAND).str(d1);
   // handles the single element vector operand ({%v1}) found in tex.1d
   // instructions
   PTX_PARSE_DPRINTF("add_1vector_operand");
@@ -691,6 +942,7 @@ void ptx_recognizer::add_1vector_operand(const char *d1) {
 }
 
 void ptx_recognizer::add_2vector_operand(const char *d1, const char *d2) {
+  record(PTX_ADD_2VECTOR_OPERAND).str(d1).str(d2);
   PTX_PARSE_DPRINTF("add_2vector_operand");
   const symbol *s1 = g_current_symbol_table->lookup(d1);
   const symbol *s2 = g_current_symbol_table->lookup(d2);
@@ -701,6 +953,7 @@ void ptx_recognizer::add_2vector_operand(const char *d1, const char *d2) {
 
 void ptx_recognizer::add_3vector_operand(const char *d1, const char *d2,
                                          const char *d3) {
+  record(PTX_ADD_3VECTOR_OPERAND).str(d1).str(d2).str(d3);
   PTX_PARSE_DPRINTF("add_3vector_operand");
   const symbol *s1 = g_current_symbol_table->lookup(d1);
   const symbol *s2 = g_current_symbol_table->lookup(d2);
@@ -712,6 +965,7 @@ void ptx_recognizer::add_3vector_operand(const char *d1, const char *d2,
 
 void ptx_recognizer::add_4vector_operand(const char *d1, const char *d2,
                                          const char *d3, const char *d4) {
+  record(PTX_ADD_4VECTOR_OPERAND).str(d1).str(d2).str(d3).str(d4);
   PTX_PARSE_DPRINTF("add_4vector_operand");
   const symbol *s1 = g_current_symbol_table->lookup(d1);
   const symbol *s2 = g_current_symbol_table->lookup(d2);
@@ -729,6 +983,15 @@ void ptx_recognizer::add_8vector_operand(const char *d1, const char *d2,
                                          const char *d3, const char *d4,
                                          const char *d5, const char *d6,
                                          const char *d7, const char *d8) {
+  record(PTX_ADD_8VECTOR_OPERAND)
+      .str(d1)
+      .str(d2)
+      .str(d3)
+      .str(d4)
+      .str(d5)
+      .str(d6)
+      .str(d7)
+      .str(d8);
   PTX_PARSE_DPRINTF("add_8vector_operand");
   const symbol *s1 = g_current_symbol_table->lookup(d1);
   const symbol *s2 = g_current_symbol_table->lookup(d2);
@@ -753,11 +1016,13 @@ void ptx_recognizer::add_8vector_operand(const char *d1, const char *d2,
 }
 
 void ptx_recognizer::add_builtin_operand(int builtin, int dim_modifier) {
+  record(PTX_ADD_BUILTIN_OPERAND, builtin, dim_modifier);
   PTX_PARSE_DPRINTF("add_builtin_operand");
   g_operands.push_back(operand_info(builtin, dim_modifier, gpgpu_ctx));
 }
 
 void ptx_recognizer::add_memory_operand() {
+  record(PTX_ADD_MEMORY_OPERAND);
   PTX_PARSE_DPRINTF("add_memory_operand");
   assert(!g_operands.empty());
   g_operands.back().make_memory_operand();
@@ -765,6 +1030,7 @@ void ptx_recognizer::add_memory_operand() {
 
 /*TODO: add other memory locations*/
 void ptx_recognizer::change_memory_addr_space(const char *identifier) {
+  record(PTX_CHANGE_MEMORY_ADDR_SPACE).str(identifier);
   /*0 = N/A, not reading from memory
    *1 = global memory
    *2 = shared memory
@@ -812,6 +1078,7 @@ void ptx_recognizer::change_memory_addr_space(const char *identifier) {
 }
 
 void ptx_recognizer::change_operand_lohi(int lohi) {
+  record(PTX_CHANGE_OPERAND_LOHI, lohi);
   /*0 = N/A, read entire operand
    *1 = lo, reading from lowest bits
    *2 = hi, reading from highest bits
@@ -824,12 +1091,14 @@ void ptx_recognizer::change_operand_lohi(int lohi) {
 }
 
 void ptx_recognizer::set_immediate_operand_type() {
+  record(PTX_SET_IMMEDIATE_OPERAND_TYPE);
   PTX_PARSE_DPRINTF("set_immediate_operand_type");
   assert(!g_operands.empty());
   g_operands.back().set_immediate_addr();
 }
 
 void ptx_recognizer::change_double_operand_type(int operand_type) {
+  record(PTX_CHANGE_DOUBLE_OPERAND_TYPE, operand_type);
   /*
    *-3 = reg / reg (set instruction, but both get same value)
    *-2 = reg | reg (cvt instruction)
@@ -860,6 +1129,7 @@ void ptx_recognizer::change_double_operand_type(int operand_type) {
 }
 
 void ptx_recognizer::change_operand_neg() {
+  record(PTX_CHANGE_OPERAND_NEG);
   PTX_PARSE_DPRINTF("change_operand_neg");
   assert(!g_operands.empty());
 
@@ -867,28 +1137,32 @@ void ptx_recognizer::change_operand_neg() {
 }
 
 void ptx_recognizer::add_literal_int(int value) {
+  record(PTX_ADD_LITERAL_INT, value);
   PTX_PARSE_DPRINTF("add_literal_int");
   g_operands.push_back(operand_info(value, gpgpu_ctx));
 }
 
 void ptx_recognizer::add_literal_float(float value) {
+  record(PTX_ADD_LITERAL_FLOAT, 0, 0, 0, value);
   PTX_PARSE_DPRINTF("add_literal_float");
   g_operands.push_back(operand_info(value, gpgpu_ctx));
 }
 
 void ptx_recognizer::add_literal_double(double value) {
+  record(PTX_ADD_LITERAL_DOUBLE, 0, 0, 0, value);
   PTX_PARSE_DPRINTF("add_literal_double");
   g_operands.push_back(operand_info(value, gpgpu_ctx));
 }
 
 void ptx_recognizer::add_scalar_operand(const char *identifier) {
+  record(PTX_ADD_SCALAR_OPERAND).str(identifier);
   PTX_PARSE_DPRINTF("add_scalar_operand");
   const symbol *s = g_current_symbol_table->lookup(identifier);
   if (s == NULL) {
     if (g_opcode == BRA_OP || g_opcode == CALLP_OP) {
       // forward branch target...
       s = g_current_symbol_table->add_variable(
-          identifier, NULL, 0, gpgpu_ctx->g_filename, ptx_get_lineno(scanner));
+          identifier, NULL, 0, gpgpu_ctx->g_filename, lineno());
     } else {
       std::string msg =
           std::string("operand \"") + identifier + "\" has no declaration.";
@@ -899,11 +1173,12 @@ void ptx_recognizer::add_scalar_operand(const char *identifier) {
 }
 
 void ptx_recognizer::add_neg_pred_operand(const char *identifier) {
+  record(PTX_ADD_NEG_PRED_OPERAND).str(identifier);
   PTX_PARSE_DPRINTF("add_neg_pred_operand");
   const symbol *s = g_current_symbol_table->lookup(identifier);
   if (s == NULL) {
     s = g_current_symbol_table->add_variable(
-        identifier, NULL, 1, gpgpu_ctx->g_filename, ptx_get_lineno(scanner));
+        identifier, NULL, 1, gpgpu_ctx->g_filename, lineno());
   }
   operand_info op(s, gpgpu_ctx);
   op.set_neg_pred();
@@ -911,6 +1186,7 @@ void ptx_recognizer::add_neg_pred_operand(const char *identifier) {
 }
 
 void ptx_recognizer::add_address_operand(const char *identifier, int offset) {
+  record(PTX_ADD_ADDRESS_OPERAND, offset).str(identifier);
   PTX_PARSE_DPRINTF("add_address_operand");
   const symbol *s = g_current_symbol_table->lookup(identifier);
   if (s == NULL) {
@@ -922,19 +1198,23 @@ void ptx_recognizer::add_address_operand(const char *identifier, int offset) {
 }
 
 void ptx_recognizer::add_address_operand2(int offset) {
+  record(PTX_ADD_ADDRESS_OPERAND2, offset);
   PTX_PARSE_DPRINTF("add_address_operand");
   g_operands.push_back(operand_info((unsigned)offset, gpgpu_ctx));
 }
 
 void ptx_recognizer::add_array_initializer() {
+  record(PTX_ADD_ARRAY_INITIALIZER);
   g_last_symbol->add_initializer(g_operands);
 }
 
 void ptx_recognizer::add_version_info(float ver, unsigned ext) {
+  record(PTX_ADD_VERSION_INFO, ext, 0, 0, ver);
   g_global_symbol_table->set_ptx_version(ver, ext);
 }
 
 void ptx_recognizer::add_file(unsigned num, const char *filename) {
+  record(PTX_ADD_FILE, num).str(filename);
   if (gpgpu_ctx->g_filename == NULL) {
     char *b = strdup(filename);
     char *l = b;
@@ -960,37 +1240,55 @@ void ptx_recognizer::add_file(unsigned num, const char *filename) {
 }
 
 void *ptx_recognizer::reset_symtab() {
+  record(PTX_RESET_SYMTAB);
   void *result = g_current_symbol_table;
   g_current_symbol_table = g_global_symbol_table;
+  g_symtabs.push_back(result);
   return result;
 }
 
 void ptx_recognizer::set_symtab(void *symtab) {
+  if (g_action_log) {
+    int index = g_symtabs.size() - 1;
+    while (index >= 0 && g_symtabs[index] != symtab) index--;
+    assert(index >= 0);
+    record(PTX_SET_SYMTAB, index);
+  }
   g_current_symbol_table = (symbol_table *)symtab;
 }
 
 void ptx_recognizer::add_pragma(const char *str) {
+  record(PTX_ADD_PRAGMA).str(str);
   printf("GPGPU-Sim PTX: Warning -- ignoring pragma '%s'\n", str);
 }
 
 void ptx_recognizer::version_header(double a) {}  // intentional dummy function
 
 void ptx_recognizer::target_header(char *a) {
+  record(PTX_TARGET_HEADER).str(a);
   g_global_symbol_table->set_sm_target(a, NULL, NULL);
 }
 
 void ptx_recognizer::target_header2(char *a, char *b) {
+  record(PTX_TARGET_HEADER2).str(a).str(b);
   g_global_symbol_table->set_sm_target(a, b, NULL);
 }
 
 void ptx_recognizer::target_header3(char *a, char *b, char *c) {
+  record(PTX_TARGET_HEADER3).str(a).str(b).str(c);
   g_global_symbol_table->set_sm_target(a, b, c);
 }
 
 void ptx_recognizer::maxnt_id(int x, int y, int z) {
+  record(PTX_MAXNT_ID, x, y, z);
   g_func_info->set_maxnt_id(x * y * z);
 }
 
+void ptx_recognizer::set_func_decl(int decl) {
+  record(PTX_SET_FUNC_DECL, decl);
+  g_func_decl = decl;
+}
+
 void ptx_recognizer::func_header(const char *a) {}  // intentional dummy
                                                     // function
 void ptx_recognizer::func_header_info(const char *a) {
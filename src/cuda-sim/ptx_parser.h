@@ -34,9 +34,99 @@
 
 class gpgpu_context;
 typedef void *yyscan_t;
+
+// The grammar actions in ptx.y, in the order ptx_recognizer receives them.
+// Recording them while a file is parsed and replaying them later rebuilds the
+// same symbol tables and function_info (ptx_assemble included) without the
+// lexer and parser; -gpgpu_ptx_cache_dir keeps the recordings across runs.
+enum ptx_action_op {
+  PTX_START_FUNCTION,
+  PTX_ADD_FUNCTION_NAME,
+  PTX_ADD_DIRECTIVE,
+  PTX_END_FUNCTION,
+  PTX_ADD_IDENTIFIER,
+  PTX_ADD_FUNCTION_ARG,
+  PTX_ADD_SCALAR_TYPE_SPEC,
+  PTX_ADD_SCALAR_OPERAND,
+  PTX_ADD_NEG_PRED_OPERAND,
+  PTX_ADD_VARIABLES,
+  PTX_SET_VARIABLE_TYPE,
+  PTX_ADD_OPCODE,
+  PTX_ADD_PRED,
+  PTX_ADD_1VECTOR_OPERAND,
+  PTX_ADD_2VECTOR_OPERAND,
+  PTX_ADD_3VECTOR_OPERAND,
+  PTX_ADD_4VECTOR_OPERAND,
+  PTX_ADD_8VECTOR_OPERAND,
+  PTX_ADD_OPTION,
+  PTX_ADD_WMMA_OPTION,
+  PTX_ADD_BUILTIN_OPERAND,
+  PTX_ADD_MEMORY_OPERAND,
+  PTX_ADD_LITERAL_INT,
+  PTX_ADD_LITERAL_FLOAT,
+  PTX_ADD_LITERAL_DOUBLE,
+  PTX_ADD_ADDRESS_OPERAND,
+  PTX_ADD_ADDRESS_OPERAND2,
+  PTX_ADD_LABEL,
+  PTX_ADD_VECTOR_SPEC,
+  PTX_ADD_SPACE_SPEC,
+  PTX_ADD_PTR_SPEC,
+  PTX_ADD_EXTERN_SPEC,
+  PTX_ADD_INSTRUCTION,
+  PTX_SET_RETURN,
+  PTX_ADD_ALIGNMENT_SPEC,
+  PTX_ADD_ARRAY_INITIALIZER,
+  PTX_ADD_FILE,
+  PTX_ADD_VERSION_INFO,
+  PTX_RESET_SYMTAB,
+  PTX_SET_SYMTAB,
+  PTX_ADD_PRAGMA,
+  PTX_ADD_CONSTPTR,
+  PTX_TARGET_HEADER,
+  PTX_TARGET_HEADER2,
+  PTX_TARGET_HEADER3,
+  PTX_ADD_DOUBLE_OPERAND,
+  PTX_CHANGE_MEMORY_ADDR_SPACE,
+  PTX_CHANGE_OPERAND_LOHI,
+  PTX_CHANGE_DOUBLE_OPERAND_TYPE,
+  PTX_CHANGE_OPERAND_NEG,
+  PTX_SET_IMMEDIATE_OPERAND_TYPE,
+  PTX_MAXNT_ID,
+  PTX_START_INST_GROUP,
+  PTX_END_INST_GROUP,
+  PTX_SET_FUNC_DECL,
+  PTX_NUM_ACTIONS
+};
+
+// bump whenever ptx_action_op or the arguments an action records change, so
+// stale recordings in the cache are ignored
+#define PTX_ACTION_LOG_VERSION 1
+
+struct ptx_action {
+  ptx_action(int op, unsigned line, int a, int b, int c, double real)
+      : m_op(op), m_line(line), m_real(real) {
+    m_int[0] = a;
+    m_int[1] = b;
+    m_int[2] = c;
+  }
+  // strings are only kept for actions that are being recorded
+  ptx_action &str(const char *s) {
+    if (m_op >= 0) m_str.push_back(s ? s : "");
+    return *this;
+  }
+
+  int m_op;  // ptx_action_op, -1 when not recording
+  unsigned m_line;
+  int m_int[3];
+  double m_real;
+  std::vector<std::string> m_str;
+};
+typedef std::vector<ptx_action> ptx_action_log;
+
 class ptx_recognizer {
  public:
-  ptx_recognizer(gpgpu_context *ctx) : g_return_var(ctx) {
+  ptx_recognizer(gpgpu_context *ctx)
+      : g_return_var(ctx), m_no_action(-1, 0, 0, 0, 0, 0) {
     scanner = NULL;
     g_size = -1;
     g_add_identifier_cached__identifier = NULL;
@@ -59,6 +149,8 @@ class ptx_recognizer {
     g_entry_func_param_index = 0;
     g_func_info = NULL;
     g_debug_ir_generation = false;
+    g_action_log = NULL;
+    g_replay_lineno = 0;
     gpgpu_ctx = ctx;
   }
   // global list
@@ -108,6 +200,12 @@ class ptx_recognizer {
       g_inst_lookup;
   // the program intermediate representation...
   std::map<std::string, symbol_table *> g_sym_name_to_symbol_table;
+  // grammar actions are appended here while it is not NULL
+  ptx_action_log *g_action_log;
+  // line number of the action being replayed
+  unsigned g_replay_lineno;
+  // reset_symtab() results of the current file, named by set_symtab actions
+  std::vector<void *> g_symtabs;
   // backward pointer
   class gpgpu_context *gpgpu_ctx;
 
@@ -174,6 +272,7 @@ class ptx_recognizer {
   void set_immediate_operand_type();
   void version_header(double a);
   void maxnt_id(int x, int y, int z);
+  void set_func_decl(int decl);
   void parse_error_impl(const char *file, unsigned line, const char *msg, ...);
   void parse_assert_impl(int test_value, const char *file, unsigned line,
                          const char *msg, ...);
@@ -185,6 +284,14 @@ class ptx_recognizer {
   void set_ptx_warp_size(const struct core_config *warp_size);
   const class ptx_instruction *ptx_instruction_lookup(const char *filename,
                                                       unsigned linenumber);
+  // line of the current action, from the scanner or the action being replayed
+  unsigned lineno();
+  ptx_action &record(int op, int a = 0, int b = 0, int c = 0, double real = 0);
+  // runs a recorded parse through the grammar actions again
+  void replay(const ptx_action_log &actions);
+
+ private:
+  ptx_action m_no_action;
 };
 
 const char *decode_token(int type);
@@ -27,6 +27,8 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "ptx_sim.h"
+#include <algorithm>
+#include <new>
 #include <string>
 #include "ptx_ir.h"
 class ptx_recognizer;
@@ -145,6 +147,7 @@ void ptx_warp_info::reset_done_threads() { m_done_threads = 0; }
 
 ptx_thread_info::~ptx_thread_info() {
   m_gpu->gpgpu_ctx->func_sim->g_ptx_thread_info_delete_count++;
+  delete m_local_mem;
 }
 
 ptx_thread_info::ptx_thread_info(kernel_info_t &kernel) : m_kernel(kernel) {
@@ -173,7 +176,9 @@ ptx_thread_info::ptx_thread_info(kernel_info_t &kernel) : m_kernel(kernel) {
   m_hw_sid = -1;
   m_last_dram_callback.function = NULL;
   m_last_dram_callback.instruction = NULL;
-  m_regs.push_back(reg_map_t());
+  m_executing_inst = NULL;
+  m_num_insn = &kernel.entry()->gpgpu_ctx->func_sim->g_ptx_sim_num_insn;
+  m_regs.push_back(reg_frame());
   m_debug_trace_regs_modified.push_back(reg_map_t());
   m_debug_trace_regs_read.push_back(reg_map_t());
   m_callstack.push_back(stack_entry());
@@ -186,6 +191,70 @@ ptx_thread_info::ptx_thread_info(kernel_info_t &kernel) : m_kernel(kernel) {
   m_last_set_operand_value = ptx_reg_t();
 }
 
+memory_space *ptx_thread_info::local_mem() {
+  if (!m_local_mem) {
+    char buf[512];
+    snprintf(buf, 512, "local_%u_%u", m_hw_sid, m_uid);
+    m_local_mem = new memory_space_impl<LOCAL_MEM_PAGE_SIZE>(buf, 32);
+  }
+  return m_local_mem;
+}
+
+size_t ptx_thread_info::host_bytes() const {
+  size_t bytes = sizeof(*this) + m_callstack.size() * sizeof(stack_entry);
+  std::list<reg_frame>::const_iterator r;
+  for (r = m_regs.begin(); r != m_regs.end(); ++r) bytes += r->host_bytes();
+  if (m_local_mem) bytes += m_local_mem->host_bytes();
+  return bytes;
+}
+
+ptx_thread_pool::~ptx_thread_pool() {
+  for (size_t i = 0; i < m_free.size(); i++) ::operator delete(m_free[i]);
+}
+
+ptx_thread_info *ptx_thread_pool::alloc(kernel_info_t &kernel) {
+  void *storage;
+  if (m_free.empty()) {
+    storage = ::operator new(sizeof(ptx_thread_info));
+  } else {
+    storage = m_free.back();
+    m_free.pop_back();
+  }
+  ptx_thread_info *thread = new (storage) ptx_thread_info(kernel);
+  m_live.insert(thread);
+  m_grown = true;
+  return thread;
+}
+
+void ptx_thread_pool::release(ptx_thread_info *thread) {
+  // sampled here rather than at alloc(), when the contexts are still empty,
+  // so registers and local memory the threads used are counted
+  if (m_grown) {
+    m_peak_bytes = std::max(m_peak_bytes, live_bytes());
+    m_peak_threads = std::max(m_peak_threads, (unsigned)m_live.size());
+    m_grown = false;
+  }
+  m_live.erase(thread);
+  thread->~ptx_thread_info();
+  m_free.push_back(thread);
+}
+
+size_t ptx_thread_pool::live_bytes() const {
+  size_t bytes = m_free.size() * sizeof(ptx_thread_info);
+  std::set<ptx_thread_info *>::const_iterator t;
+  for (t = m_live.begin(); t != m_live.end(); ++t) bytes += (*t)->host_bytes();
+  return bytes;
+}
+
+// threads still live at the end have not been sampled yet
+size_t ptx_thread_pool::peak_bytes() const {
+  return m_grown ? std::max(m_peak_bytes, live_bytes()) : m_peak_bytes;
+}
+
+unsigned ptx_thread_pool::peak_threads() const {
+  return std::max(m_peak_threads, (unsigned)m_live.size());
+}
+
 const ptx_version &ptx_thread_info::get_ptx_version() const {
   return m_func_info->get_ptx_version();
 }
@@ -308,6 +377,7 @@ void ptx_thread_info::set_info(function_info *func) {
   m_symbol_table = func->get_symtab();
   m_func_info = func;
   m_PC = func->get_start_PC();
+  m_regs.back().resize(func->num_reg_slots());
 }
 
 void ptx_thread_info::cpy_tid_to_reg(dim3 tid) {
@@ -413,7 +483,7 @@ void ptx_thread_info::callstack_push(unsigned pc, unsigned rpc,
   assert(m_func_info != NULL);
   m_callstack.push_back(stack_entry(m_symbol_table, m_func_info, pc, rpc,
                                     return_var_src, return_var_dst, call_uid));
-  m_regs.push_back(reg_map_t());
+  m_regs.push_back(reg_frame());
   m_debug_trace_regs_modified.push_back(reg_map_t());
   m_debug_trace_regs_read.push_back(reg_map_t());
   m_local_mem_stack_pointer += m_func_info->local_mem_framesize();
@@ -430,7 +500,7 @@ void ptx_thread_info::callstack_push_plus(unsigned pc, unsigned rpc,
   assert(m_func_info != NULL);
   m_callstack.push_back(stack_entry(m_symbol_table, m_func_info, pc, rpc,
                                     return_var_src, return_var_dst, call_uid));
-  // m_regs.push_back( reg_map_t() );
+  // m_regs.push_back( reg_frame() );
   // m_debug_trace_regs_modified.push_back( reg_map_t() );
   // m_debug_trace_regs_read.push_back( reg_map_t() );
   m_local_mem_stack_pointer += m_func_info->local_mem_framesize();
@@ -507,22 +577,22 @@ bool ptx_thread_info::callstack_pop_plus() {
 
 void ptx_thread_info::dump_callstack() const {
   std::list<stack_entry>::const_iterator c = m_callstack.begin();
-  std::list<reg_map_t>::const_iterator r = m_regs.begin();
+  std::list<reg_frame>::const_iterator r = m_regs.begin();
 
   printf("\n\n");
   printf("Call stack for thread uid = %u (sc=%u, hwtid=%u)\n", m_uid, m_hw_sid,
          m_hw_tid);
   while (c != m_callstack.end() && r != m_regs.end()) {
     const stack_entry &c_e = *c;
-    const reg_map_t &regs = *r;
+    const reg_frame &regs = *r;
     if (!c_e.m_valid) {
-      printf("  <entry>                              #regs = %zu\n",
-             regs.size());
+      printf("  <entry>                              #regs = %u\n",
+             regs.num_defined());
     } else {
-      printf("  %20s  PC=%3u RV= (callee=\'%s\',caller=\'%s\') #regs = %zu\n",
+      printf("  %20s  PC=%3u RV= (callee=\'%s\',caller=\'%s\') #regs = %u\n",
              c_e.m_func_info->get_name().c_str(), c_e.m_PC,
              c_e.m_return_var_src->name().c_str(),
-             c_e.m_return_var_dst->name().c_str(), regs.size());
+             c_e.m_return_var_dst->name().c_str(), regs.num_defined());
     }
     c++;
     r++;
@@ -548,17 +618,21 @@ const ptx_instruction *ptx_thread_info::get_inst(addr_t pc) const {
   return m_func_info->get_instruction(pc);
 }
 
+unsigned ptx_thread_info::reg_frame::num_defined() const {
+  unsigned n = 0;
+  for (unsigned slot = 0; slot < m_syms.size(); slot++) n += m_syms[slot] != 0;
+  return n;
+}
+
 void ptx_thread_info::dump_regs(FILE *fp) {
   if (m_regs.empty()) return;
-  if (m_regs.back().empty()) return;
+  const reg_frame &regs = m_regs.back();
+  if (!regs.num_defined()) return;
   fprintf(fp, "Register File Contents:\n");
   fflush(fp);
-  reg_map_t::const_iterator r;
-  for (r = m_regs.back().begin(); r != m_regs.back().end(); ++r) {
-    const symbol *sym = r->first;
-    ptx_reg_t value = r->second;
-    std::string name = sym->name();
-    print_reg(fp, name, value, m_symbol_table);
+  for (unsigned slot = 0; slot < regs.size(); slot++) {
+    if (!regs.defined(slot)) continue;
+    print_reg(fp, regs.sym(slot)->name(), regs.value(slot), m_symbol_table);
   }
 }
 
@@ -609,6 +683,7 @@ void ptx_thread_info::set_npc(const function_info *f) {
   m_NPC = f->get_start_PC();
   m_func_info = const_cast<function_info *>(f);
   m_symbol_table = m_func_info->get_symtab();
+  m_regs.back().resize(f->num_reg_slots());
 }
 
 void feature_not_implemented(const char *f) {
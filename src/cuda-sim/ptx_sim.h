@@ -40,6 +40,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "memory.h"
 
@@ -289,6 +290,8 @@ class ptx_version {
 };
 
 class ptx_thread_info {
+  friend class warp_simd_exec;
+
  public:
   ~ptx_thread_info();
   ptx_thread_info(kernel_info_t &kernel);
@@ -415,6 +418,8 @@ class ptx_thread_info {
   unsigned get_return_PC() { return m_callstack.back().m_PC; }
   void update_pc() { m_PC = m_NPC; }
   void dump_regs(FILE *fp);
+  // LIVENESS trace every 100000 simulated instructions
+  void liveness_message();
   void dump_modifiedregs(FILE *fp);
   void clear_modifiedregs() {
     m_debug_trace_regs_modified.back().clear();
@@ -458,6 +463,18 @@ class ptx_thread_info {
 
   // Jin: get corresponding kernel grid for CDP purpose
   kernel_info_t &get_kernel() { return m_kernel; }
+  // warp instruction in ptx_exec_inst(), with the warp's current active mask
+  const warp_inst_t &get_executing_inst() const { return *m_executing_inst; }
+  // functional workers count the instructions of their CTA privately and
+  // add them to g_ptx_sim_num_insn when it is done
+  void set_insn_counter(unsigned *counter) { m_num_insn = counter; }
+  // local memory, created on the first access; most kernels never touch it
+  memory_space *local_mem();
+  // NULL until local_mem() is first called
+  memory_space *allocated_local_mem() const { return m_local_mem; }
+  static const unsigned LOCAL_MEM_PAGE_SIZE = 32;
+  // estimate of the host memory the context takes
+  size_t host_bytes() const;
 
  public:
   addr_t m_last_effective_address;
@@ -466,12 +483,13 @@ class ptx_thread_info {
   dram_callback_t m_last_dram_callback;
   memory_space *m_shared_mem;
   memory_space *m_sstarr_mem;
-  memory_space *m_local_mem;
   ptx_warp_info *m_warp_info;
   ptx_cta_info *m_cta_info;
   ptx_reg_t m_last_set_operand_value;
 
  private:
+  const warp_inst_t *m_executing_inst;
+  unsigned *m_num_insn;
   bool m_functionalSimulationMode;
   unsigned m_uid;
   kernel_info_t &m_kernel;
@@ -504,10 +522,47 @@ class ptx_thread_info {
   function_info *m_func_info;
 
   std::list<stack_entry> m_callstack;
+  memory_space_impl<LOCAL_MEM_PAGE_SIZE> *m_local_mem;
   unsigned m_local_mem_stack_pointer;
 
+  // registers of one call frame, indexed by the register number the parser
+  // gives each register symbol (dense per function, 0 is "_" and never set);
+  // m_syms is the name view for the dump and checkpoint paths, the symbol
+  // last set in each slot or NULL while the register is undefined
+  class reg_frame {
+   public:
+    unsigned size() const { return m_syms.size(); }
+    void resize(unsigned n) {
+      if (n <= m_syms.size()) return;
+      m_values.resize(n);
+      m_syms.resize(n, NULL);
+    }
+    bool defined(unsigned slot) const {
+      return slot < m_syms.size() && m_syms[slot];
+    }
+    const symbol *sym(unsigned slot) const { return m_syms[slot]; }
+    const ptx_reg_t &value(unsigned slot) const { return m_values[slot]; }
+    void set(unsigned slot, const symbol *reg, const ptx_reg_t &value) {
+      if (slot >= m_syms.size()) resize(slot + 1);
+      m_values[slot] = value;
+      m_syms[slot] = reg;
+    }
+    unsigned num_defined() const;
+    size_t host_bytes() const {
+      return m_values.capacity() * sizeof(ptx_reg_t) +
+             m_syms.capacity() * sizeof(const symbol *);
+    }
+
+   private:
+    std::vector<ptx_reg_t> m_values;
+    std::vector<const symbol *> m_syms;
+  };
+  // value of a register without the undefined register warning or the debug
+  // trace; zero if undefined
+  ptx_reg_t peek_reg(const symbol *reg) const;
+
+  std::list<reg_frame> m_regs;
   typedef tr1_hash_map<const symbol *, ptx_reg_t> reg_map_t;
-  std::list<reg_map_t> m_regs;
   std::list<reg_map_t> m_debug_trace_regs_modified;
   std::list<reg_map_t> m_debug_trace_regs_read;
   bool m_enable_debug_trace;
@@ -528,4 +583,32 @@ memory_space_t whichspace(addr_t addr);
 
 extern unsigned g_ptx_thread_info_uid_next;
 
+// Thread contexts of one core (an SM, or a functional worker). Released
+// contexts keep their storage for the core's next CTA instead of going back
+// to the heap, and the live ones are measured when the first context after
+// a launch is released, once they have run, to report the peak host memory
+// the core's threads took.
+class ptx_thread_pool {
+ public:
+  ptx_thread_pool() : m_peak_bytes(0), m_peak_threads(0), m_grown(false) {}
+  ~ptx_thread_pool();
+
+  ptx_thread_info *alloc(kernel_info_t &kernel);
+  void release(ptx_thread_info *thread);
+
+  size_t peak_bytes() const;
+  unsigned peak_threads() const;
+
+ private:
+  size_t live_bytes() const;
+
+  std::vector<void *> m_free;
+  std::set<ptx_thread_info *> m_live;
+  size_t m_peak_bytes;
+  unsigned m_peak_threads;
+  // contexts were allocated since the last sample: the live set is at a
+  // local peak once the first of them is released
+  bool m_grown;
+};
+
 #endif
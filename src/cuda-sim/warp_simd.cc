@@ -0,0 +1,529 @@
+#include "warp_simd.h"
+#include <assert.h>
+#include <stdio.h>
+#include <cmath>
+#include "../../libcuda/gpgpu_context.h"
+#include "cuda-sim.h"
+#include "opcodes.h"
+#include "ptx-stats.h"
+#include "ptx.tab.h"
+#include "ptx_ir.h"
+#include "ptx_sim.h"
+
+bool CmpOp(int type, ptx_reg_t a, ptx_reg_t b, unsigned cmpop);
+
+// One lane of each operation, written like the matching case of its
+// implementation in instructions.cc so both paths agree bit for bit.
+#define LANE_OP(NAME, BODY)                                   \
+  struct NAME {                                               \
+    static void apply(const ptx_reg_t &a, const ptx_reg_t &b, \
+                      const ptx_reg_t &c, ptx_reg_t &d) {     \
+      BODY;                                                   \
+    }                                                         \
+  };
+
+LANE_OP(add_i32, d.u64 = (a.u64 & 0xFFFFFFFF) + (b.u64 & 0xFFFFFFFF))
+LANE_OP(add_i64, d.u64 = a.u64 + b.u64)
+LANE_OP(add_f32, d.f32 = a.f32 + b.f32)
+LANE_OP(add_f64, d.f64 = a.f64 + b.f64)
+LANE_OP(sub_i32, d.u64 = (a.u64 & 0xFFFFFFFF) - (b.u64 & 0xFFFFFFFF) +
+                         0x100000000ull)
+LANE_OP(sub_i64, d.u64 = a.u64 - b.u64)
+LANE_OP(sub_f32, d.f32 = a.f32 - b.f32)
+LANE_OP(sub_f64, d.f64 = a.f64 - b.f64)
+LANE_OP(mul_lo_s32, d.s32 = ((long long)a.s32) * ((long long)b.s32))
+LANE_OP(mul_hi_s32, d.s32 = (((long long)a.s32) * ((long long)b.s32)) >> 32)
+LANE_OP(mul_wide_s32, d.s64 = ((long long)a.s32) * ((long long)b.s32))
+LANE_OP(mul_lo_u32, d.u32 = ((unsigned long long)a.u32) *
+                            ((unsigned long long)b.u32))
+LANE_OP(mul_hi_u32, d.u32 = (((unsigned long long)a.u32) *
+                             ((unsigned long long)b.u32)) >> 32)
+LANE_OP(mul_wide_u32, d.u64 = ((unsigned long long)a.u32) *
+                              ((unsigned long long)b.u32))
+LANE_OP(mul_lo_i64, d.u64 = a.u64 * b.u64)
+LANE_OP(mul_f32, d.f32 = a.f32 * b.f32)
+LANE_OP(mul_f64, d.f64 = a.f64 * b.f64)
+// the 32 bit signed product is formed in int, as mad_def() does
+LANE_OP(mad_lo_s32, ptx_reg_t t; t.s64 = a.s32 * b.s32; d.s32 = t.s32 + c.s32)
+LANE_OP(mad_hi_s32, ptx_reg_t t; t.s64 = a.s32 * b.s32;
+        d.s32 = (t.s64 >> 32) + c.s32)
+LANE_OP(mad_wide_s32, ptx_reg_t t; t.s64 = a.s32 * b.s32;
+        d.s64 = t.s64 + c.s64)
+LANE_OP(mad_lo_u32, ptx_reg_t t; t.u64 = a.u32 * b.u32; d.u32 = t.u32 + c.u32)
+LANE_OP(mad_hi_u32, ptx_reg_t t; t.u64 = a.u32 * b.u32;
+        d.u32 = (t.u64 + c.u32) >> 32)
+LANE_OP(mad_wide_u32, ptx_reg_t t; t.u64 = a.u32 * b.u32;
+        d.u64 = t.u64 + c.u64)
+LANE_OP(mad_lo_i64, d.u64 = a.u64 * b.u64 + c.u64)
+LANE_OP(mad_f32, d.f32 = a.f32 * b.f32 + c.f32)
+LANE_OP(mad_f64, d.f64 = a.f64 * b.f64 + c.f64)
+LANE_OP(min_s32, d.s32 = (a.s32 < b.s32) ? a.s32 : b.s32)
+LANE_OP(min_u32, d.u32 = (a.u32 < b.u32) ? a.u32 : b.u32)
+LANE_OP(min_s64, d.s64 = (a.s64 < b.s64) ? a.s64 : b.s64)
+LANE_OP(min_u64, d.u64 = (a.u64 < b.u64) ? a.u64 : b.u64)
+LANE_OP(min_f32, d.f32 = std::isnan(a.f32)   ? b.f32
+                         : std::isnan(b.f32) ? a.f32
+                         : (a.f32 < b.f32)   ? a.f32
+                                             : b.f32)
+LANE_OP(min_f64, d.f64 = std::isnan(a.f64)   ? b.f64
+                         : std::isnan(b.f64) ? a.f64
+                         : (a.f64 < b.f64)   ? a.f64
+                                             : b.f64)
+LANE_OP(max_s32, d.s32 = (a.s32 > b.s32) ? a.s32 : b.s32)
+LANE_OP(max_u32, d.u32 = (a.u32 > b.u32) ? a.u32 : b.u32)
+LANE_OP(max_s64, d.s64 = (a.s64 > b.s64) ? a.s64 : b.s64)
+LANE_OP(max_u64, d.u64 = (a.u64 > b.u64) ? a.u64 : b.u64)
+LANE_OP(max_f32, d.f32 = std::isnan(a.f32)   ? b.f32
+                         : std::isnan(b.f32) ? a.f32
+                         : (a.f32 > b.f32)   ? a.f32
+                                             : b.f32)
+LANE_OP(max_f64, d.f64 = std::isnan(a.f64)   ? b.f64
+                         : std::isnan(b.f64) ? a.f64
+                         : (a.f64 > b.f64)   ? a.f64
+                                             : b.f64)
+LANE_OP(and_b64, d.u64 = a.u64 & b.u64)
+LANE_OP(or_b64, d.u64 = a.u64 | b.u64)
+LANE_OP(xor_b64, d.u64 = a.u64 ^ b.u64)
+LANE_OP(not_b32, d.u32 = ~a.u32)
+LANE_OP(not_b64, d.u64 = ~a.u64)
+LANE_OP(shl_b32, if (b.u32 >= 32) d.u32 = 0;
+        else d.u32 = (unsigned)((a.u32 << b.u32) & 0xFFFFFFFF))
+// shl_impl() and shr_impl() shift by b.u64, which on x86 is b.u32 once the
+// count is known to be below 64
+LANE_OP(shl_b64, if (b.u32 >= 64) d.u64 = 0; else d.u64 = (a.u64 << b.u32))
+LANE_OP(shr_u32, if (b.u32 < 32) d.u32 = (a.u32 >> b.u32); else d.u32 = 0)
+LANE_OP(shr_u64, if (b.u32 < 64) d.u64 = (a.u64 >> b.u32); else d.u64 = 0)
+LANE_OP(shr_s32, if (b.u32 < 32) d.s64 = (a.s32 >> b.s32);
+        else d.s64 = a.s32 < 0 ? -1 : 0)
+LANE_OP(shr_s64, if (b.u64 < 64) d.s64 = (a.s64 >> b.u64);
+        else if (a.s64 >= 0) d.s64 = 0; else if (b.s32 >= 0) d.s64 = -1;
+        else d.u64 = 0xFFFFFFFF00000000ull)
+LANE_OP(mov_b64, d.u64 = a.u64)
+LANE_OP(selp_b64, d.u64 = (!(c.pred & 0x0001)) ? a.u64 : b.u64)
+
+#define LANE_OPS(X)                                                         \
+  X(add_i32) X(add_i64) X(add_f32) X(add_f64) X(sub_i32) X(sub_i64)         \
+  X(sub_f32) X(sub_f64) X(mul_lo_s32) X(mul_hi_s32) X(mul_wide_s32)         \
+  X(mul_lo_u32) X(mul_hi_u32) X(mul_wide_u32) X(mul_lo_i64) X(mul_f32)      \
+  X(mul_f64) X(mad_lo_s32) X(mad_hi_s32) X(mad_wide_s32) X(mad_lo_u32)      \
+  X(mad_hi_u32) X(mad_wide_u32) X(mad_lo_i64) X(mad_f32) X(mad_f64)         \
+  X(min_s32) X(min_u32) X(min_s64) X(min_u64) X(min_f32) X(min_f64)         \
+  X(max_s32) X(max_u32) X(max_s64) X(max_u64) X(max_f32) X(max_f64)         \
+  X(and_b64) X(or_b64) X(xor_b64) X(not_b32) X(not_b64) X(shl_b32)         \
+  X(shl_b64) X(shr_u32) X(shr_u64) X(shr_s32) X(shr_s64) X(mov_b64)         \
+  X(selp_b64)
+
+typedef void (*lane_kernel_t)(const ptx_instruction *pI, unsigned n_lanes,
+                              const unsigned long long *a,
+                              const unsigned long long *b,
+                              const unsigned long long *c,
+                              unsigned long long *d);
+
+// one loop over all lanes; lanes that do not execute compute on zeros
+template <class OP>
+static void lanes(const ptx_instruction *pI, unsigned n_lanes,
+                  const unsigned long long *a, const unsigned long long *b,
+                  const unsigned long long *c, unsigned long long *d) {
+  for (unsigned l = 0; l < n_lanes; l++) {
+    ptx_reg_t x, y, z, r;
+    x.u64 = a[l];
+    y.u64 = b[l];
+    z.u64 = c[l];
+    OP::apply(x, y, z, r);
+    d[l] = r.u64;
+  }
+}
+
+// setp_impl() stores the zero flag: 1 if the comparison is false
+#define SETP_LANES(EXPR) \
+  for (unsigned l = 0; l < n_lanes; l++) d[l] = !(EXPR);
+
+template <class T>
+static void setp_lanes(const ptx_instruction *pI, unsigned n_lanes,
+                       const unsigned long long *a,
+                       const unsigned long long *b,
+                       const unsigned long long *c, unsigned long long *d) {
+  switch (pI->get_cmpop()) {
+    case EQ_OPTION:
+      SETP_LANES((T)a[l] == (T)b[l]);
+      break;
+    case NE_OPTION:
+      SETP_LANES((T)a[l] != (T)b[l]);
+      break;
+    case LT_OPTION:
+    case LO_OPTION:
+      SETP_LANES((T)a[l] < (T)b[l]);
+      break;
+    case LE_OPTION:
+    case LS_OPTION:
+      SETP_LANES((T)a[l] <= (T)b[l]);
+      break;
+    case GT_OPTION:
+    case HI_OPTION:
+      SETP_LANES((T)a[l] > (T)b[l]);
+      break;
+    case GE_OPTION:
+    case HS_OPTION:
+      SETP_LANES((T)a[l] >= (T)b[l]);
+      break;
+    default:
+      assert(0);
+  }
+}
+
+// floating point and narrow types compare lane by lane through CmpOp()
+static void setp_other(const ptx_instruction *pI, unsigned n_lanes,
+                       const unsigned long long *a,
+                       const unsigned long long *b,
+                       const unsigned long long *c, unsigned long long *d) {
+  int type = pI->get_type();
+  unsigned cmpop = pI->get_cmpop();
+  for (unsigned l = 0; l < n_lanes; l++) {
+    ptx_reg_t x, y;
+    x.u64 = a[l];
+    y.u64 = b[l];
+    d[l] = !CmpOp(type, x, y, cmpop);
+  }
+}
+
+enum lane_kernel_id {
+  NO_LANE_KERNEL = 0,
+#define X(NAME) NAME##_kernel,
+  LANE_OPS(X)
+#undef X
+  setp_s32_kernel,
+  setp_u32_kernel,
+  setp_s64_kernel,
+  setp_u64_kernel,
+  setp_other_kernel,
+  N_LANE_KERNELS
+};
+
+static const lane_kernel_t g_lane_kernels[N_LANE_KERNELS] = {
+    NULL,
+#define X(NAME) lanes<NAME>,
+    LANE_OPS(X)
+#undef X
+    setp_lanes<int>,
+    setp_lanes<unsigned>,
+    setp_lanes<long long>,
+    setp_lanes<unsigned long long>,
+    setp_other};
+
+static bool plain_operand(const operand_info &op) {
+  return op.get_double_operand_type() == 0 && op.get_operand_lohi() == 0 &&
+         !op.get_operand_neg() && op.get_addr_space() == undefined_space &&
+         !op.is_vector();
+}
+
+static bool simd_source(const operand_info &op) {
+  if (!plain_operand(op) || op.is_immediate_address() ||
+      op.is_memory_operand())
+    return false;
+  return op.is_reg() || op.is_builtin() || op.is_literal();
+}
+
+static bool is_signed(int type) {
+  return type == S32_TYPE || type == S64_TYPE;
+}
+
+// integer type of a 32 or 64 bit signed, unsigned or bit size operation
+static bool int_type(int type, bool &wide) {
+  switch (type) {
+    case S32_TYPE:
+    case U32_TYPE:
+    case B32_TYPE:
+      wide = false;
+      return true;
+    case S64_TYPE:
+    case U64_TYPE:
+    case B64_TYPE:
+      wide = true;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// picks the lane kernel of an instruction, NO_LANE_KERNEL if it has to run
+// thread by thread
+static int decode(const ptx_instruction *pI) {
+  if (pI->is_exit()) return NO_LANE_KERNEL;
+  if (pI->has_pred() &&
+      (pI->get_pred_mod() != -1 ||
+       !pI->get_pred_symbol()->type()->get_key().is_reg()))
+    return NO_LANE_KERNEL;
+  if (pI->get_num_operands() < 2) return NO_LANE_KERNEL;
+  const operand_info &dst = pI->dst();
+  if (!plain_operand(dst) || !dst.is_reg()) return NO_LANE_KERNEL;
+
+  int type = pI->get_type();
+  bool wide = false;
+  bool integer = int_type(type, wide);
+  bool sign = is_signed(type);
+  bool rn = pI->rounding_mode() == RN_OPTION;
+  bool sat = pI->saturation_mode() != 0;
+  unsigned n_src = 2;
+  int k = NO_LANE_KERNEL;
+  switch (pI->get_opcode()) {
+    case ADD_OP:
+      if (integer && type != B32_TYPE && type != B64_TYPE)
+        k = wide ? add_i64_kernel : add_i32_kernel;
+      else if (type == F32_TYPE && rn)
+        k = add_f32_kernel;
+      else if (type == F64_TYPE && rn)
+        k = add_f64_kernel;
+      break;
+    case SUB_OP:
+      if (integer)
+        k = wide ? sub_i64_kernel : sub_i32_kernel;
+      else if (type == F32_TYPE)
+        k = sub_f32_kernel;
+      else if (type == F64_TYPE)
+        k = sub_f64_kernel;
+      break;
+    case MUL_OP:
+      if (integer && type != B32_TYPE && type != B64_TYPE) {
+        if (wide)
+          k = pI->is_lo() ? mul_lo_i64_kernel : NO_LANE_KERNEL;
+        else if (pI->is_wide())
+          k = sign ? mul_wide_s32_kernel : mul_wide_u32_kernel;
+        else if (pI->is_hi())
+          k = sign ? mul_hi_s32_kernel : mul_hi_u32_kernel;
+        else if (pI->is_lo())
+          k = sign ? mul_lo_s32_kernel : mul_lo_u32_kernel;
+      } else if (type == F32_TYPE && rn && !sat) {
+        k = mul_f32_kernel;
+      } else if (type == F64_TYPE && rn && !sat) {
+        k = mul_f64_kernel;
+      }
+      break;
+    case MAD_OP:
+    case FMA_OP:
+      n_src = 3;
+      if (integer && type != B32_TYPE && type != B64_TYPE) {
+        if (wide)
+          k = pI->is_lo() ? mad_lo_i64_kernel : NO_LANE_KERNEL;
+        else if (pI->is_wide())
+          k = sign ? mad_wide_s32_kernel : mad_wide_u32_kernel;
+        else if (pI->is_hi())
+          k = sign ? mad_hi_s32_kernel : mad_hi_u32_kernel;
+        else if (pI->is_lo())
+          k = sign ? mad_lo_s32_kernel : mad_lo_u32_kernel;
+      } else if (type == F32_TYPE && rn && !sat) {
+        k = mad_f32_kernel;
+      } else if (type == F64_TYPE && rn && !sat) {
+        k = mad_f64_kernel;
+      }
+      break;
+    case MIN_OP:
+    case MAX_OP: {
+      bool max = pI->get_opcode() == MAX_OP;
+      if (type == S32_TYPE)
+        k = max ? max_s32_kernel : min_s32_kernel;
+      else if (type == U32_TYPE)
+        k = max ? max_u32_kernel : min_u32_kernel;
+      else if (type == S64_TYPE)
+        k = max ? max_s64_kernel : min_s64_kernel;
+      else if (type == U64_TYPE)
+        k = max ? max_u64_kernel : min_u64_kernel;
+      else if (type == F32_TYPE)
+        k = max ? max_f32_kernel : min_f32_kernel;
+      else if (type == F64_TYPE)
+        k = max ? max_f64_kernel : min_f64_kernel;
+      break;
+    }
+    case AND_OP:
+    case OR_OP:
+    case XOR_OP:
+      if (type == PRED_TYPE || type == BB64_TYPE || type == BB128_TYPE ||
+          type == FF64_TYPE)
+        break;
+      k = pI->get_opcode() == AND_OP  ? and_b64_kernel
+          : pI->get_opcode() == OR_OP ? or_b64_kernel
+                                      : xor_b64_kernel;
+      break;
+    case NOT_OP:
+      n_src = 1;
+      if (type == B32_TYPE)
+        k = not_b32_kernel;
+      else if (type == B64_TYPE)
+        k = not_b64_kernel;
+      break;
+    case SHL_OP:
+      if (integer && !sign) k = wide ? shl_b64_kernel : shl_b32_kernel;
+      break;
+    case SHR_OP:
+      if (type == S32_TYPE)
+        k = shr_s32_kernel;
+      else if (type == S64_TYPE)
+        k = shr_s64_kernel;
+      else if (integer)
+        k = wide ? shr_u64_kernel : shr_u32_kernel;
+      break;
+    case MOV_OP:
+      n_src = 1;
+      if (type != PRED_TYPE && type != BB64_TYPE && type != BB128_TYPE &&
+          type != FF64_TYPE)
+        k = mov_b64_kernel;
+      break;
+    case SELP_OP:
+      n_src = 3;
+      if (type != BB64_TYPE && type != BB128_TYPE && type != FF64_TYPE)
+        k = selp_b64_kernel;
+      break;
+    case SETP_OP: {
+      unsigned cmpop = pI->get_cmpop();
+      bool ordered = cmpop == EQ_OPTION || cmpop == NE_OPTION ||
+                     cmpop == LT_OPTION || cmpop == LE_OPTION ||
+                     cmpop == GT_OPTION || cmpop == GE_OPTION;
+      bool unsigned_only = cmpop == LO_OPTION || cmpop == LS_OPTION ||
+                           cmpop == HI_OPTION || cmpop == HS_OPTION;
+      if (type == S32_TYPE)
+        k = setp_s32_kernel;
+      else if (type == U32_TYPE)
+        k = setp_u32_kernel;
+      else if (type == S64_TYPE)
+        k = setp_s64_kernel;
+      else if (type == U64_TYPE)
+        k = setp_u64_kernel;
+      else if (type != BB64_TYPE && type != BB128_TYPE && type != FF64_TYPE)
+        k = setp_other_kernel;
+      // anything else asserts in CmpOp()
+      if (k != setp_other_kernel && !ordered && (sign || !unsigned_only))
+        k = NO_LANE_KERNEL;
+      break;
+    }
+    default:
+      break;
+  }
+  if (k == NO_LANE_KERNEL || pI->get_num_operands() != 1 + n_src)
+    return NO_LANE_KERNEL;
+  for (unsigned s = 1; s <= n_src; s++) {
+    if (!simd_source(pI->operand_lookup(s))) return NO_LANE_KERNEL;
+  }
+  return k;
+}
+
+bool warp_simd_exec::read(ptx_thread_info *thread, const operand_info &op,
+                          unsigned long long &value) {
+  if (op.is_reg()) {
+    const ptx_thread_info::reg_frame &frame = thread->m_regs.back();
+    unsigned slot = op.get_symbol()->reg_num();
+    if (!frame.defined(slot)) return false;
+    value = frame.value(slot).u64;
+  } else if (op.is_builtin()) {
+    value = thread->get_builtin(op.get_int(), op.get_addr_offset());
+  } else {
+    value = op.get_literal_value().u64;
+  }
+  return true;
+}
+
+bool warp_simd_exec::prepare(const warp_inst_t &inst,
+                             ptx_thread_info **threads, unsigned n_lanes) {
+  // the debug output is written by the per-thread path
+  if (g_debug_execution >= 5) return false;
+  unsigned first = 0;
+  while (first < n_lanes && !inst.active(first)) first++;
+  if (first == n_lanes) return false;
+  ptx_thread_info *thd = threads[first];
+  if (thd->get_config().get_ptx_inst_debug_to_file() ||
+      thd->m_gpu->gpgpu_ctx->func_sim->gpgpu_ptx_instruction_classification)
+    return false;
+
+  const ptx_instruction *pI = thd->m_func_info->get_instruction(inst.pc);
+  int k = pI->warp_simd_kernel();
+  if (k < 0) {
+    k = decode(pI);
+    pI->set_warp_simd_kernel(k);
+  }
+  if (k == NO_LANE_KERNEL) return false;
+
+  const symbol *pred = pI->has_pred() ? pI->get_pred_symbol() : NULL;
+  unsigned n_src = pI->get_num_operands() - 1;
+  lanes_t src[3];
+  m_active.reset();
+  m_skip.reset();
+  for (unsigned l = 0; l < n_lanes; l++) {
+    src[0][l] = src[1][l] = src[2][l] = 0;
+    if (!inst.active(l)) continue;
+    thd = threads[l];
+    if (thd->m_enable_debug_trace) return false;
+    m_active.set(l);
+    if (pred) {
+      const ptx_thread_info::reg_frame &frame = thd->m_regs.back();
+      unsigned slot = pred->reg_num();
+      if (!frame.defined(slot)) return false;
+      if ((frame.value(slot).pred & 0x0001) ^ pI->get_pred_neg()) {
+        m_skip.set(l);
+        continue;
+      }
+    }
+    for (unsigned s = 0; s < n_src; s++) {
+      if (!read(thd, pI->operand_lookup(s + 1), src[s][l])) return false;
+    }
+  }
+
+  g_lane_kernels[k](pI, n_lanes, src[0], src[1], src[2], m_result);
+  m_inst = pI;
+  m_threads = threads;
+  m_n_lanes = n_lanes;
+  return true;
+}
+
+void warp_simd_exec::commit(warp_inst_t &inst) {
+  const symbol *reg = m_inst->dst().get_symbol();
+  unsigned slot = reg->reg_num();
+  for (unsigned l = 0; l < m_n_lanes; l++) {
+    if (!m_active.test(l)) continue;
+    ptx_thread_info *thd = m_threads[l];
+    addr_t pc = thd->next_instr();
+    assert(pc == inst.pc);
+    thd->set_npc(pc + m_inst->inst_size());
+    thd->clearRPC();
+    thd->m_last_set_operand_value.u64 = 0;
+    if (thd->is_done()) {
+      printf(
+          "attempted to execute instruction on a thread that is already "
+          "done.\n");
+      assert(0);
+    }
+    if (!m_skip.test(l) && slot) {
+      ptx_reg_t value;
+      value.u64 = m_result[l];
+      thd->m_regs.back().set(slot, reg, value);
+      thd->m_last_set_operand_value = value;
+    }
+    thd->update_pc();
+    (*thd->m_num_insn)++;
+    if (!thd->m_functionalSimulationMode)
+      ptx_file_line_stats_add_exec_count(m_inst);
+    thd->liveness_message();
+    if (!m_skip.test(l)) {
+      inst.space = undefined_space;
+      inst.set_addr(l, 0xFEEBDAED);
+      inst.data_size = 0;
+      assert(inst.memory_op == no_memory_op);
+    }
+  }
+}
+
+void warp_simd_exec::check(const warp_inst_t &inst) const {
+  const symbol *reg = m_inst->dst().get_symbol();
+  unsigned slot = reg->reg_num();
+  for (unsigned l = 0; l < m_n_lanes; l++) {
+    if (!m_active.test(l)) continue;
+    bool skip = !inst.active(l);
+    unsigned long long value = m_result[l];
+    if (!skip && slot) value = m_threads[l]->m_regs.back().value(slot).u64;
+    if (skip == m_skip.test(l) && value == m_result[l]) continue;
+    printf(
+        "GPGPU-Sim PTX: ERROR ** warp SIMD execution of lane %u differs "
+        "(%s:%u - %s): skip %d/%d, result 0x%llx/0x%llx\n",
+        l, m_inst->source_file(), m_inst->source_line(),
+        m_inst->get_source(), (int)m_skip.test(l), (int)skip, m_result[l],
+        value);
+    abort();
+  }
+}
@@ -0,0 +1,50 @@
+#ifndef WARP_SIMD_H
+#define WARP_SIMD_H
+
+#include "../abstract_hardware_model.h"
+
+class operand_info;
+class ptx_instruction;
+class ptx_thread_info;
+
+// -gpgpu_ptx_warp_simd
+enum warp_simd_mode_t { WARP_SIMD_OFF = 0, WARP_SIMD_ON, WARP_SIMD_CHECK };
+
+// Executes a common ALU instruction (integer and floating point arithmetic,
+// logic, shifts, setp, selp, mov) for all lanes of a warp at once: operands
+// of the lanes are gathered into 32-wide arrays, one loop per operation
+// computes every lane and the results are scattered back to the threads'
+// register frames. Each operation repeats the bit-level behaviour of its
+// per-thread implementation in instructions.cc. Memory, control, exotic ops
+// and operands with modifiers run thread by thread through ptx_exec_inst.
+class warp_simd_exec {
+ public:
+  // decodes the instruction and reads the operands of the warp's active
+  // lanes, changing no state; false if it has to run thread by thread
+  bool prepare(const warp_inst_t &inst, ptx_thread_info **threads,
+               unsigned n_lanes);
+  // writes the results and does the per-thread bookkeeping of
+  // ptx_exec_inst; predicated off lanes are left for the caller to
+  // deactivate in lane order
+  void commit(warp_inst_t &inst);
+  bool skipped(unsigned lane) const { return m_skip.test(lane); }
+  // -gpgpu_ptx_warp_simd 2: after the per-thread path ran, aborts if any lane
+  // got a different result than prepare() computed
+  void check(const warp_inst_t &inst) const;
+
+ private:
+  typedef unsigned long long lanes_t[MAX_WARP_SIZE];
+
+  // value of a source operand, false if it is an undefined register
+  static bool read(ptx_thread_info *thread, const operand_info &op,
+                   unsigned long long &value);
+
+  const ptx_instruction *m_inst;
+  ptx_thread_info **m_threads;
+  unsigned m_n_lanes;
+  active_mask_t m_active;
+  active_mask_t m_skip;
+  lanes_t m_result;
+};
+
+#endif
@@ -29,6 +29,9 @@
 #include "addrdec.h"
 #include <math.h>
 #include <string.h>
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
 #include "../option_parser.h"
 #include "gpu-sim.h"
 #include "hashing.h"
@@ -42,6 +45,32 @@ static new_addr_type addrdec_packbits(new_addr_type mask, new_addr_type val,
 static void addrdec_getmasklimit(new_addr_type mask, unsigned char *high,
                                  unsigned char *low);
 
+// gather the bits of val selected by mask into the low bits of the result,
+// the same as addrdec_packbits() over the whole mask
+static inline new_addr_type addrdec_pext(new_addr_type val,
+                                         new_addr_type mask) {
+#ifdef __BMI2__
+  return _pext_u64(val, mask);
+#else
+  new_addr_type result = 0;
+  for (new_addr_type bit = 1; mask; mask &= mask - 1, bit <<= 1) {
+    if (val & mask & (~mask + 1)) result |= bit;
+  }
+  return result;
+#endif
+}
+
+// Decode of the last page seen by this host thread. Memory partitions stepped
+// on worker threads (-gpgpu_sim_threads) allocate mem_fetches concurrently,
+// so a single cache in the mapping would be a data race.
+struct addrdec_page_t {
+  unsigned long long epoch;  // page_epoch of the mapping that filled it
+  new_addr_type tag;
+  addrdec_t tlx;
+};
+static thread_local addrdec_page_t addrdec_last_page;
+static unsigned long long addrdec_n_page_epoch = 0;  // bumped by init()
+
 linear_to_raw_address_translation::linear_to_raw_address_translation() {
   addrdec_option = NULL;
   ADDR_CHIP_S = 10;
@@ -52,6 +81,10 @@ linear_to_raw_address_translation::linear_to_raw_address_translation() {
   addrdec_mask[2] = 0x000000000FFF0000;
   addrdec_mask[3] = 0x000000000000E0FF;
   addrdec_mask[4] = 0x000000000000000F;
+  page_mask = 0;
+  page_col_bits = 0;
+  page_burst_bits = 0;
+  page_epoch = 0;
 }
 
 void linear_to_raw_address_translation::addrdec_setoption(option_parser_t opp) {
@@ -73,39 +106,65 @@ void linear_to_raw_address_translation::addrdec_setoption(option_parser_t opp) {
       &memory_partition_indexing,
       "0 = no indexing, 1 = bitwise xoring, 2 = IPoly, 3 = custom indexing",
       "0");
+  option_parser_register(
+      opp, "-gpgpu_mem_addr_page_cache", OPT_BOOL, &page_cache_enabled,
+      "reuse the decode of the last page, only redecoding column bits", "0");
 }
 
 new_addr_type linear_to_raw_address_translation::partition_address(
     new_addr_type addr) const {
   if (!gap) {
-    return addrdec_packbits(~(addrdec_mask[CHIP] | sub_partition_id_mask), addr,
-                            64, 0);
+    return addrdec_pext(addr, ~(addrdec_mask[CHIP] | sub_partition_id_mask));
   } else {
     // see addrdec_tlx for explanation
     unsigned long long int partition_addr;
     partition_addr = ((addr >> ADDR_CHIP_S) / m_n_channel) << ADDR_CHIP_S;
     partition_addr |= addr & ((1 << ADDR_CHIP_S) - 1);
     // remove the part of address that constributes to the sub partition ID
-    partition_addr =
-        addrdec_packbits(~sub_partition_id_mask, partition_addr, 64, 0);
+    partition_addr = addrdec_pext(partition_addr, ~sub_partition_id_mask);
     return partition_addr;
   }
 }
 
 void linear_to_raw_address_translation::addrdec_tlx(new_addr_type addr,
                                                     addrdec_t *tlx) const {
+  if (!page_cache_enabled || !page_mask) {
+    addrdec_decode(addr, tlx, false);
+    return;
+  }
+  addrdec_page_t &page = addrdec_last_page;
+  if (page.epoch == page_epoch && (addr & ~page_mask) == page.tag) {
+    *tlx = page.tlx;
+    tlx->col = (page.tlx.col >> page_col_bits << page_col_bits) |
+               addrdec_pext(addr, addrdec_mask[COL] & page_mask);
+    tlx->burst = (page.tlx.burst >> page_burst_bits << page_burst_bits) |
+                 addrdec_pext(addr, addrdec_mask[BURST] & page_mask);
+    return;
+  }
+  addrdec_decode(addr, tlx, false);
+  page.epoch = page_epoch;
+  page.tag = addr & ~page_mask;
+  page.tlx = *tlx;
+}
+
+new_addr_type linear_to_raw_address_translation::addrdec_field(
+    unsigned field, new_addr_type val, bool reference) const {
+  if (reference)
+    return addrdec_packbits(addrdec_mask[field], val, addrdec_mkhigh[field],
+                            addrdec_mklow[field]);
+  return addrdec_pext(val, addrdec_mask[field]);
+}
+
+void linear_to_raw_address_translation::addrdec_decode(new_addr_type addr,
+                                                       addrdec_t *tlx,
+                                                       bool reference) const {
   unsigned long long int addr_for_chip, rest_of_addr, rest_of_addr_high_bits;
   if (!gap) {
-    tlx->chip = addrdec_packbits(addrdec_mask[CHIP], addr, addrdec_mkhigh[CHIP],
-                                 addrdec_mklow[CHIP]);
-    tlx->bk = addrdec_packbits(addrdec_mask[BK], addr, addrdec_mkhigh[BK],
-                               addrdec_mklow[BK]);
-    tlx->row = addrdec_packbits(addrdec_mask[ROW], addr, addrdec_mkhigh[ROW],
-                                addrdec_mklow[ROW]);
-    tlx->col = addrdec_packbits(addrdec_mask[COL], addr, addrdec_mkhigh[COL],
-                                addrdec_mklow[COL]);
-    tlx->burst = addrdec_packbits(addrdec_mask[BURST], addr,
-                                  addrdec_mkhigh[BURST], addrdec_mklow[BURST]);
+    tlx->chip = addrdec_field(CHIP, addr, reference);
+    tlx->bk = addrdec_field(BK, addr, reference);
+    tlx->row = addrdec_field(ROW, addr, reference);
+    tlx->col = addrdec_field(COL, addr, reference);
+    tlx->burst = addrdec_field(BURST, addr, reference);
     rest_of_addr_high_bits =
         (addr >> (ADDR_CHIP_S + (log2channel + log2sub_partition)));
 
@@ -120,14 +179,10 @@ void linear_to_raw_address_translation::addrdec_tlx(new_addr_type addr,
     rest_of_addr |= addr & ((1 << ADDR_CHIP_S) - 1);
 
     tlx->chip = addr_for_chip;
-    tlx->bk = addrdec_packbits(addrdec_mask[BK], rest_of_addr,
-                               addrdec_mkhigh[BK], addrdec_mklow[BK]);
-    tlx->row = addrdec_packbits(addrdec_mask[ROW], rest_of_addr,
-                                addrdec_mkhigh[ROW], addrdec_mklow[ROW]);
-    tlx->col = addrdec_packbits(addrdec_mask[COL], rest_of_addr,
-                                addrdec_mkhigh[COL], addrdec_mklow[COL]);
-    tlx->burst = addrdec_packbits(addrdec_mask[BURST], rest_of_addr,
-                                  addrdec_mkhigh[BURST], addrdec_mklow[BURST]);
+    tlx->bk = addrdec_field(BK, rest_of_addr, reference);
+    tlx->row = addrdec_field(ROW, rest_of_addr, reference);
+    tlx->col = addrdec_field(COL, rest_of_addr, reference);
+    tlx->burst = addrdec_field(BURST, rest_of_addr, reference);
   }
 
   switch (memory_partition_indexing) {
@@ -459,6 +514,27 @@ void linear_to_raw_address_translation::init(
   }
   printf("sub_partition_id_mask = %016llx\n", sub_partition_id_mask);
 
+  // The page is everything below the lowest CHIP, BK or ROW bit, and below
+  // the address bits the partition hashing looks at, so only COL and BURST
+  // bits change inside it. Without a dram id start bit the hashing input is
+  // not bounded, so the cache is only used with consecutive indexing.
+  unsigned page_bits = 64;
+  new_addr_type page_fixed =
+      addrdec_mask[CHIP] | addrdec_mask[BK] | addrdec_mask[ROW];
+  if (page_fixed) page_bits = __builtin_ctzll(page_fixed);
+  if (ADDR_CHIP_S != -1) {
+    int chip_bits = ADDR_CHIP_S - (int)log2sub_partition;
+    if (chip_bits < 0) chip_bits = 0;
+    if ((unsigned)chip_bits < page_bits) page_bits = chip_bits;
+  } else if (memory_partition_indexing != CONSECUTIVE) {
+    page_bits = 0;
+  }
+  if (page_bits > 31) page_bits = 31;  // col/burst are 32-bit fields
+  page_mask = (1ULL << page_bits) - 1;
+  page_col_bits = __builtin_popcountll(addrdec_mask[COL] & page_mask);
+  page_burst_bits = __builtin_popcountll(addrdec_mask[BURST] & page_mask);
+  page_epoch = ++addrdec_n_page_epoch;
+
   if (run_test) {
     sweep_test();
   }
@@ -472,19 +548,14 @@ bool operator==(const addrdec_t &x, const addrdec_t &y) {
   return (memcmp(&x, &y, sizeof(addrdec_t)) == 0);
 }
 
+// lexicographic, so sweep_test also works when tr1_hash_map is a std::map
 bool operator<(const addrdec_t &x, const addrdec_t &y) {
-  if (x.chip >= y.chip)
-    return false;
-  else if (x.bk >= y.bk)
-    return false;
-  else if (x.row >= y.row)
-    return false;
-  else if (x.col >= y.col)
-    return false;
-  else if (x.burst >= y.burst)
-    return false;
-  else
-    return true;
+  if (x.chip != y.chip) return x.chip < y.chip;
+  if (x.bk != y.bk) return x.bk < y.bk;
+  if (x.row != y.row) return x.row < y.row;
+  if (x.col != y.col) return x.col < y.col;
+  if (x.burst != y.burst) return x.burst < y.burst;
+  return x.sub_partition < y.sub_partition;
 }
 
 class hash_addrdec_t {
@@ -510,6 +581,20 @@ void linear_to_raw_address_translation::sweep_test() const {
     addrdec_t tlx;
     addrdec_tlx(raw_addr, &tlx);
 
+    // the PEXT decoder (and page cache) must match the bit-by-bit decoder
+    addrdec_t ref_tlx;
+    addrdec_decode(raw_addr, &ref_tlx, true);
+    if (!(tlx == ref_tlx)) {
+      printf("[AddrDec] ** Error: fast address decoding differs from the "
+             "reference decoding for %llx\n",
+             raw_addr);
+      tlx.print(stdout);
+      printf("\n");
+      ref_tlx.print(stdout);
+      printf("\n");
+      abort();
+    }
+
     history_map_t::iterator h = history_map.find(tlx);
 
     if (h != history_map.end()) {
@@ -66,10 +66,18 @@ class linear_to_raw_address_translation {
   // accessors
   void addrdec_tlx(new_addr_type addr, addrdec_t *tlx) const;
   new_addr_type partition_address(new_addr_type addr) const;
+  // RANDOM indexing assigns channels with rand() as addresses are first
+  // seen, so decodes must happen on one thread in simulation order
+  bool serial_decode() const { return memory_partition_indexing == RANDOM; }
 
  private:
   void addrdec_parseoption(const char *option);
   void sweep_test() const;  // sanity check to ensure no overlapping
+  // full decode; reference selects the original bit-by-bit packing, which
+  // sweep_test compares the PEXT based path against
+  void addrdec_decode(new_addr_type addr, addrdec_t *tlx, bool reference) const;
+  new_addr_type addrdec_field(unsigned field, new_addr_type val,
+                              bool reference) const;
 
   enum { CHIP = 0, BK = 1, ROW = 2, COL = 3, BURST = 4, N_ADDRDEC };
 
@@ -77,6 +85,7 @@ class linear_to_raw_address_translation {
   int gpgpu_mem_address_mask;
   partition_index_function memory_partition_indexing;
   bool run_test;
+  bool page_cache_enabled;
 
   int ADDR_CHIP_S;
   unsigned char addrdec_mklow[N_ADDRDEC];
@@ -91,6 +100,15 @@ class linear_to_raw_address_translation {
   unsigned log2channel;
   unsigned log2sub_partition;
   unsigned nextPowerOf2_m_n_channel;
+
+  // Within a page only the COL and BURST bits below page_mask change, the
+  // rest of the decode (including hashing) holds. The decode of the last page
+  // seen is kept per host thread (see addrdec.cc); page_epoch tells this
+  // mapping's entries apart from those of another mapping.
+  new_addr_type page_mask;
+  unsigned page_col_bits;
+  unsigned page_burst_bits;
+  unsigned long long page_epoch;
 };
 
 #endif
@@ -15,11 +15,18 @@
 #include "MPCmodules/ScanModule.h"
 #include "MPCmodules/XORModule.h"
 #include "MPCmodules/CompStruct.h"
+#include "uarch_checkpoint.h"
 
 #define MIN_GRAN 32
 
 compressor *g_comp;
 
+void compressor::checkpoint_state(uarch_checkpoint &cp)
+{
+  cp.io(m_uncomp_size);
+  cp.io(m_comp_size);
+}
+
 // MPC ---------------------------------------------------------------------
 unsigned MPCompressor::compress(uint8_t* data, int req_size)
 {
@@ -422,6 +429,13 @@ unsigned MPCompressor::checkOtherPatterns(const int numStartingModule, std::vect
 }
 
 // CPACK ---------------------------------------------------------------------
+void CachePacker::checkpoint_state(uarch_checkpoint &cp)
+{
+  compressor::checkpoint_state(cp);
+  for (int i = 0; i < CPACK_NUM_ENTRY; i++)
+    cp.io(m_Dictionary[i], CPACK_WORDSIZE);
+}
+
 unsigned CachePacker::compress(uint8_t *data, int req_size)
 {
   std::vector<uint8_t> dataLine(data, data + req_size);
@@ -1281,6 +1295,14 @@ bool cmp(const std::pair<int64_t, uint64_t> &lhs, const std::pair<int64_t, uint6
 
 }
 
+void SC2Compressor::checkpoint_state(uarch_checkpoint &cp)
+{
+  compressor::checkpoint_state(cp);
+  cp.io(m_samplingCnt);
+  cp.io(*mp_symFreqMap);
+  cp.io(m_huffmanCodes);
+}
+
 void SC2Compressor::SetSamplingCnt(unsigned cnt)
 {
   m_maxSamplingCnt = cnt;
@@ -68,6 +68,8 @@ typedef unsigned long long virtual_stream_id;
 //------------------------------------------------------------------------------
 //using namespace std;
 
+class uarch_checkpoint;
+
 //------------------------------------------------------------------------------
 class compressor {
 public:
@@ -80,6 +82,8 @@ public:
   }
 
   virtual unsigned compress(uint8_t* data, int req_size) = 0;
+  // size totals and whatever the compressor learned from earlier lines
+  virtual void checkpoint_state(uarch_checkpoint &cp);
 
 public:
   uint64_t m_uncomp_size = 0;
@@ -150,6 +154,7 @@ public:
   }
 
   virtual unsigned compress(uint8_t *data, int req_size); 
+  virtual void checkpoint_state(uarch_checkpoint &cp);
 
 private:
   std::deque<uint8_t*> m_Dictionary;
@@ -315,6 +320,7 @@ public:
   }
 
   virtual unsigned compress(uint8_t *data, int req_size);
+  virtual void checkpoint_state(uarch_checkpoint &cp);
   void SetSamplingCnt(unsigned cnt);
 
 private:
@@ -0,0 +1,246 @@
+#include "cta_sampler.h"
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+
+cta_sampler::cta_sampler(unsigned interval_ctas, double threshold) {
+  m_interval_opt = interval_ctas;
+  m_threshold = threshold;
+  m_kernel = NULL;
+  m_interval_ctas = 0;
+  m_n_ctas = 0;
+  m_mode = DETAILED;
+}
+
+void cta_sampler::launch(kernel_info_t *kernel,
+                         const cta_sample_counters &now) {
+  // one kernel at a time; kernels launched meanwhile run fully detailed
+  if (m_kernel) return;
+  m_kernel = kernel;
+  m_interval_ctas = 0;
+  m_n_ctas = kernel->num_blocks();
+  m_mode = DETAILED;
+  m_start = now;
+  m_live.clear();
+  m_functional = interval();
+  m_samples.clear();
+  m_detailed_ctas = 0;
+  m_detailed_insts = 0;
+  m_functional_ctas = 0;
+  m_functional_insts = 0;
+  m_functional_cycles = 0;
+  m_n_switches = 0;
+}
+
+void cta_sampler::kernel_done(kernel_info_t *kernel,
+                              const cta_sample_counters &now) {
+  if (kernel != m_kernel) return;
+  // intervals cut short by -gpgpu_max_cta and the like
+  for (std::map<unsigned, interval>::iterator i = m_live.begin();
+       i != m_live.end(); ++i) {
+    if (!i->second.end) i->second.end = now.cycle;
+    finish(i->second, false);
+  }
+  m_live.clear();
+  print(now);
+  m_kernel = NULL;
+  m_mode = DETAILED;
+}
+
+unsigned cta_sampler::n_ctas(unsigned index) const {
+  unsigned first = index * m_interval_ctas;
+  return first + m_interval_ctas <= m_n_ctas ? m_interval_ctas
+                                             : m_n_ctas - first;
+}
+
+void cta_sampler::cta_issued(const kernel_info_t *kernel, unsigned ctaid,
+                             unsigned wave_ctas, unsigned long long cycle) {
+  if (kernel != m_kernel) return;
+  if (!m_interval_ctas) {
+    m_interval_ctas = m_interval_opt ? m_interval_opt : wave_ctas;
+    if (!m_interval_ctas) m_interval_ctas = 1;
+    // a repeat needs two detailed intervals, so there must be a third to skip
+    if ((m_n_ctas + m_interval_ctas - 1) / m_interval_ctas < 3) {
+      m_kernel = NULL;
+      return;
+    }
+  }
+  unsigned index = ctaid / m_interval_ctas;
+  interval &iv = m_live[index];
+  if (!iv.n_issued) {
+    iv.start = cycle;
+    // CTAs issue in id order, so the previous interval is fully issued
+    std::map<unsigned, interval>::iterator prev = m_live.find(index - 1);
+    if (index && prev != m_live.end() && !prev->second.end)
+      prev->second.end = cycle;
+  }
+  iv.n_issued++;
+  m_detailed_ctas++;
+}
+
+void cta_sampler::cta_done(const kernel_info_t *kernel, unsigned ctaid,
+                           unsigned long long cycle) {
+  if (kernel != m_kernel) return;
+  unsigned index = ctaid / m_interval_ctas;
+  std::map<unsigned, interval>::iterator i = m_live.find(index);
+  assert(i != m_live.end());
+  interval &iv = i->second;
+  iv.n_done++;
+  if (iv.n_done == n_ctas(index)) {
+    if (!iv.end) iv.end = cycle;
+    finish(iv, true);
+    m_live.erase(i);
+  }
+}
+
+bool cta_sampler::fast_forwarding(unsigned n_running,
+                                  unsigned long long cycle) {
+  if (m_mode == DRAINING && !n_running) {
+    // the partly issued interval is not a sample; its cycles are already
+    // part of the measured ones
+    for (std::map<unsigned, interval>::iterator i = m_live.begin();
+         i != m_live.end(); ++i) {
+      if (!i->second.end) i->second.end = cycle;
+      finish(i->second, false);
+    }
+    m_live.clear();
+    m_mode = FUNCTIONAL;
+  }
+  return m_mode == FUNCTIONAL;
+}
+
+void cta_sampler::functional_interval_done(unsigned n_ctas) {
+  m_functional_ctas += n_ctas;
+  if (m_functional.insts) {
+    bbv_t bbv;
+    normalize(m_functional.pcs, m_functional.insts, bbv);
+    double dist;
+    sample *s = nearest(bbv, dist);
+    assert(s);
+    m_functional_insts += m_functional.insts;
+    m_functional_cycles += m_functional.insts * s->mean_cpi();
+    s->functional_insts += m_functional.insts;
+    // a new phase; simulate its next interval in detail
+    if (dist > m_threshold) {
+      m_mode = DETAILED;
+      m_n_switches++;
+    }
+  }
+  m_functional = interval();
+}
+
+void cta_sampler::finish(interval &iv, bool whole) {
+  m_detailed_insts += iv.insts;
+  if (!whole || !iv.insts) return;
+
+  double cpi = (double)(iv.end - iv.start) / iv.insts;
+  bbv_t bbv;
+  normalize(iv.pcs, iv.insts, bbv);
+  double dist;
+  sample *s = nearest(bbv, dist);
+  if (s && dist <= m_threshold) {
+    s->cpi_sum += cpi;
+    s->cpi_sq_sum += cpi * cpi;
+    s->n++;
+    if (m_mode == DETAILED) {
+      m_mode = DRAINING;
+      m_n_switches++;
+    }
+  } else {
+    m_samples.push_back(sample());
+    sample &n = m_samples.back();
+    n.bbv.swap(bbv);
+    n.cpi_sum = cpi;
+    n.cpi_sq_sum = cpi * cpi;
+    n.n = 1;
+    n.functional_insts = 0;
+  }
+}
+
+void cta_sampler::normalize(const pc_count_t &pcs, unsigned long long insts,
+                            bbv_t &bbv) {
+  for (pc_count_t::const_iterator i = pcs.begin(); i != pcs.end(); ++i)
+    bbv[i->first] = (double)i->second / insts;
+}
+
+// Manhattan distance of two normalized vectors, 0 (same) to 2 (disjoint)
+double cta_sampler::distance(const bbv_t &a, const bbv_t &b) {
+  double dist = 0;
+  for (bbv_t::const_iterator i = a.begin(); i != a.end(); ++i) {
+    bbv_t::const_iterator j = b.find(i->first);
+    dist += fabs(i->second - (j == b.end() ? 0 : j->second));
+  }
+  for (bbv_t::const_iterator j = b.begin(); j != b.end(); ++j) {
+    if (a.find(j->first) == a.end()) dist += j->second;
+  }
+  return dist;
+}
+
+cta_sampler::sample *cta_sampler::nearest(const bbv_t &bbv, double &dist) {
+  sample *best = NULL;
+  dist = 2;
+  for (unsigned i = 0; i < m_samples.size(); i++) {
+    double d = distance(bbv, m_samples[i].bbv);
+    if (!best || d < dist) {
+      best = &m_samples[i];
+      dist = d;
+    }
+  }
+  return best;
+}
+
+double cta_sampler::sample::cpi_std_error() const {
+  if (n < 2) return -1;
+  double var = (cpi_sq_sum - cpi_sum * cpi_sum / n) / (n - 1);
+  return var > 0 ? sqrt(var / n) : 0;
+}
+
+void cta_sampler::print(const cta_sample_counters &now) const {
+  unsigned long long measured = now.cycle - m_start.cycle;
+  double cycles = measured + m_functional_cycles;
+
+  // 95% interval from the CPI spread of each sample's detailed intervals;
+  // samples seen once borrow the widest relative error of the others
+  double widest = 0;
+  for (unsigned i = 0; i < m_samples.size(); i++) {
+    double se = m_samples[i].cpi_std_error();
+    if (se > 0) widest = fmax(widest, se / m_samples[i].mean_cpi());
+  }
+  double var = 0;
+  for (unsigned i = 0; i < m_samples.size(); i++) {
+    const sample &s = m_samples[i];
+    double se = s.cpi_std_error();
+    if (se < 0) se = widest * s.mean_cpi();
+    var += (s.functional_insts * se) * (s.functional_insts * se);
+  }
+
+  unsigned long long insts = m_detailed_insts + m_functional_insts;
+  // memory traffic grows with the work done
+  double scale = m_detailed_insts ? (double)insts / m_detailed_insts : 1;
+
+  printf("cta_sample_kernel = %s (uid %u)\n", m_kernel->name().c_str(),
+         m_kernel->get_uid());
+  printf("cta_sample_interval = %u CTAs\n", m_interval_ctas);
+  printf("cta_sample_phases = %zu\n", m_samples.size());
+  printf("cta_sample_mode_switches = %u\n", m_n_switches);
+  printf("cta_sample_detailed_cta = %llu\n", m_detailed_ctas);
+  printf("cta_sample_functional_cta = %llu\n", m_functional_ctas);
+  printf("cta_sample_detailed_insn = %llu\n", m_detailed_insts);
+  printf("cta_sample_functional_insn = %llu\n", m_functional_insts);
+  printf("cta_sample_measured_cycle = %llu\n", measured);
+  printf("cta_sample_est_cycle = %.0f (95%% CI +/- %.0f)\n", cycles,
+         1.96 * sqrt(var));
+  printf("cta_sample_est_ipc = %.4f\n", cycles ? insts / cycles : 0);
+  const char *dir[2] = {"dn", "up"};
+  for (unsigned d = 0; d < 2; d++) {
+    unsigned long long data =
+        now.link_data_size[d] - m_start.link_data_size[d];
+    unsigned long long packet =
+        now.link_packet_size[d] - m_start.link_packet_size[d];
+    printf("cta_sample_est_link_%s_data_size = %.0f\n", dir[d], data * scale);
+    printf("cta_sample_est_link_%s_data_packet_size = %.0f\n", dir[d],
+           packet * scale);
+    printf("cta_sample_link_%s_compression_ratio = %lf\n", dir[d],
+           packet ? (double)data / packet : 0);
+  }
+}
@@ -0,0 +1,117 @@
+#ifndef CTA_SAMPLER_H
+#define CTA_SAMPLER_H
+
+#include <map>
+#include <vector>
+#include "../abstract_hardware_model.h"
+#include "../tr1_hash_map.h"
+
+// thread instructions executed per PC by a set of CTAs; normalized, this is
+// the basic block vector of the set with each block weighted by its size
+typedef tr1_hash_map<address_type, unsigned long long> pc_count_t;
+
+// running totals the sampler snapshots at launch and extrapolates at the end
+struct cta_sample_counters {
+  unsigned long long cycle;
+  unsigned long long link_data_size[2];    // down, up link payload (bits)
+  unsigned long long link_packet_size[2];  // down, up link wire size (bits)
+};
+
+// -gpgpu_cta_sampling: simulates a kernel's CTAs in intervals of consecutive
+// CTA ids. Intervals run in detail until one repeats the basic block vector
+// of an earlier sample; CTA issue is then held, the GPU drains, and the
+// following intervals run on the functional model. A functional interval that
+// matches no sample hands the kernel back to the timing model, so every phase
+// keeps a detailed sample. Cycles of functional intervals are estimated from
+// the cycles per thread instruction of their nearest sample.
+class cta_sampler {
+ public:
+  cta_sampler(unsigned interval_ctas, double threshold);
+
+  // kernel being sampled, NULL when none is
+  kernel_info_t *kernel() const { return m_kernel; }
+  void launch(kernel_info_t *kernel, const cta_sample_counters &now);
+  void kernel_done(kernel_info_t *kernel, const cta_sample_counters &now);
+
+  // detailed CTAs, from the timing model; wave_ctas (the CTAs the GPU holds
+  // at once) sizes the intervals when the first one issues
+  void cta_issued(const kernel_info_t *kernel, unsigned ctaid,
+                  unsigned wave_ctas, unsigned long long cycle);
+  void count(const kernel_info_t *kernel, unsigned ctaid, address_type pc,
+             unsigned n_threads) {
+    if (kernel != m_kernel) return;
+    interval &iv = m_live[ctaid / m_interval_ctas];
+    iv.pcs[pc] += n_threads;
+    iv.insts += n_threads;
+  }
+  void cta_done(const kernel_info_t *kernel, unsigned ctaid,
+                unsigned long long cycle);
+
+  // CTA issue stops at the first repeating interval
+  bool hold_issue() const { return m_mode != DETAILED; }
+  // true once the held kernel has drained; the caller then runs the CTAs up
+  // to interval_end() on the functional model, counting into
+  // functional_pcs(), and reports them with functional_interval_done()
+  bool fast_forwarding(unsigned n_running, unsigned long long cycle);
+  unsigned interval_end(unsigned ctaid) const {
+    return (ctaid / m_interval_ctas + 1) * m_interval_ctas;
+  }
+  pc_count_t *functional_pcs() { return &m_functional.pcs; }
+  void functional_interval_done(unsigned n_ctas);
+
+ private:
+  enum mode_t { DETAILED, DRAINING, FUNCTIONAL };
+  typedef tr1_hash_map<address_type, double> bbv_t;
+
+  struct interval {
+    interval() : insts(0), n_issued(0), n_done(0), start(0), end(0) {}
+    pc_count_t pcs;
+    unsigned long long insts;
+    unsigned n_issued;
+    unsigned n_done;
+    // issue of the first CTA, and of the next interval's first CTA (or the
+    // last CTA's exit when the next interval is not issued in detail)
+    unsigned long long start;
+    unsigned long long end;
+  };
+  struct sample {
+    bbv_t bbv;
+    // cycles per thread instruction of the detailed intervals matching it
+    double cpi_sum;
+    double cpi_sq_sum;
+    unsigned n;
+    unsigned long long functional_insts;
+    double mean_cpi() const { return cpi_sum / n; }
+    double cpi_std_error() const;
+  };
+
+  unsigned n_ctas(unsigned index) const;
+  void finish(interval &iv, bool whole);
+  static void normalize(const pc_count_t &pcs, unsigned long long insts,
+                        bbv_t &bbv);
+  static double distance(const bbv_t &a, const bbv_t &b);
+  sample *nearest(const bbv_t &bbv, double &dist);
+  void print(const cta_sample_counters &now) const;
+
+  unsigned m_interval_opt;
+  double m_threshold;
+
+  kernel_info_t *m_kernel;
+  unsigned m_interval_ctas;  // 0 until the first CTA issues
+  unsigned m_n_ctas;
+  mode_t m_mode;
+  cta_sample_counters m_start;
+
+  std::map<unsigned, interval> m_live;  // detailed, by interval index
+  interval m_functional;
+  std::vector<sample> m_samples;
+
+  unsigned long long m_detailed_ctas;
+  unsigned long long m_detailed_insts;
+  unsigned long long m_functional_ctas;
+  unsigned long long m_functional_insts;
+  double m_functional_cycles;  // estimated
+  unsigned m_n_switches;       // detailed to functional and back
+};
+
+#endif
@@ -161,6 +161,13 @@ class fifo_pipeline {
   unsigned get_n_element() const { return m_n_element; }
   unsigned get_length() const { return m_length; }
   unsigned get_max_len() const { return m_max_len; }
+  // entries ahead of the first non-NULL one, or the length if all are NULL
+  unsigned leading_empty() const {
+    unsigned n = 0;
+    for (fifo_data<T>* ddp = m_head; ddp && !ddp->m_data; ddp = ddp->m_next)
+      n++;
+    return n;
+  }
 
   void print() const {
     fifo_data<T>* ddp = m_head;
@@ -28,6 +28,7 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "dram.h"
+#include "../cuda-sim/ptx-stats.h"
 #include "dram_sched.h"
 #include "gpu-misc.h"
 #include "gpu-sim.h"
@@ -35,6 +36,7 @@
 #include "l2cache.h"
 #include "mem_fetch.h"
 #include "mem_latency_stat.h"
+#include "uarch_checkpoint.h"
 
 #ifdef DRAM_VERIFY
 int PRINT_CYCLE = 0;
@@ -69,6 +71,12 @@ dram_t::dram_t(unsigned int partition_id, const memory_config *config,
   issued_total_row = 0;
   issued_total_col = 0;
 
+  dram_cycle = 0;
+  activity_until = 0;
+  n_bk_mrq = 0;
+  n_rwq_cmd = 0;
+  n_idle_bulk = 0;
+
   CCDc = 0;
   RRDc = 0;
   RTWc = 0;
@@ -152,6 +160,15 @@ dram_t::dram_t(unsigned int partition_id, const memory_config *config,
   ave_mrqs_partial = 0;
   bwutil_partial = 0;
 
+  m_shared.dirty = false;
+  m_shared.n_access = 0;
+  m_shared.n_reads = 0;
+  m_shared.n_writes = 0;
+  m_shared.mrq_latency = 0;
+  m_shared.mrq_num = 0;
+  m_shared.max_mrq_latency = 0;
+  memset(m_shared.mrq_lat_table, 0, sizeof(m_shared.mrq_lat_table));
+
   if (queue_limit())
     mrqq_Dist = StatCreate("mrqq_length", 1, queue_limit());
   else                                             // queue length is unlimited;
@@ -264,6 +281,38 @@ void dram_t::push(class mem_fetch *data) {
                                                          : mrqq->get_length();
   }
   m_stats->memlatstat_dram_access(data);
+  if (data->get_pc() != (unsigned)-1) {
+    m_shared.dram_traffic.push_back(
+        std::make_pair(data->get_pc(), data->get_data_size()));
+    m_shared.dirty = true;
+  }
+}
+
+void dram_t::flush_shared_stats() {
+  if (!m_shared.dirty) return;
+  m_stats->total_n_access += m_shared.n_access;
+  m_stats->total_n_reads += m_shared.n_reads;
+  m_stats->total_n_writes += m_shared.n_writes;
+  m_stats->tot_mrq_latency += m_shared.mrq_latency;
+  m_stats->tot_mrq_num += m_shared.mrq_num;
+  if (m_shared.max_mrq_latency > m_stats->max_mrq_latency)
+    m_stats->max_mrq_latency = m_shared.max_mrq_latency;
+  for (unsigned i = 0; i < 32; i++) {
+    m_stats->mrq_lat_table[i] += m_shared.mrq_lat_table[i];
+    m_shared.mrq_lat_table[i] = 0;
+  }
+  for (unsigned i = 0; i < m_shared.dram_traffic.size(); i++) {
+    m_gpu->gpgpu_ctx->stats->ptx_file_line_stats_add_dram_traffic(
+        m_shared.dram_traffic[i].first, m_shared.dram_traffic[i].second);
+  }
+  m_shared.dram_traffic.clear();
+  m_shared.n_access = 0;
+  m_shared.n_reads = 0;
+  m_shared.n_writes = 0;
+  m_shared.mrq_latency = 0;
+  m_shared.mrq_num = 0;
+  m_shared.max_mrq_latency = 0;
+  m_shared.dirty = false;
 }
 
 void dram_t::scheduler_fifo() {
@@ -282,11 +331,11 @@ void dram_t::scheduler_fifo() {
 		req->data->print_data();  // JIN
 #endif
 		bk[bkn]->mrq = req;
+		n_bk_mrq++;
 	}
   }
 }
 
-#define DEC2ZERO(x) x = (x) ? (x - 1) : 0;
 #define SWAP(a, b) \
   a ^= b;          \
   b ^= a;          \
@@ -304,6 +353,7 @@ void dram_t::cycle() {
              cmd->col + cmd->dqbytes);
 #endif
       cmd->dqbytes += m_config->dram_atom_size;
+      n_rwq_cmd--;
 
       if (cmd->dqbytes >= cmd->nbytes) {
         mem_fetch *data = cmd->data;
@@ -354,7 +404,6 @@ void dram_t::cycle() {
     ave_mrqs_partial += mrqq->get_length();
   }
 
-  unsigned k = m_config->nbk;
   bool issued = false;
 
   // collect row buffer locality, BLP and other statistics
@@ -399,12 +448,16 @@ void dram_t::cycle() {
   for (unsigned j = 0; j < m_config->nbk; j++) {
     unsigned grp = get_bankgrp_number(j);
     if (bk[j]->mrq &&
-        ((!CCDc && !bk[j]->RCDc && !(bkgrp[grp]->CCDLc) &&
+        ((!timer_left(CCDc) && !timer_left(bk[j]->RCDc) &&
+          !timer_left(bkgrp[grp]->CCDLc) &&
           (bk[j]->curr_row == bk[j]->mrq->row) && (bk[j]->mrq->rw == READ) &&
-          (WTRc == 0) && (bk[j]->state == BANK_ACTIVE) && !rwq->full()) ||
-         (!CCDc && !bk[j]->RCDWRc && !(bkgrp[grp]->CCDLc) &&
+          !timer_left(WTRc) && (bk[j]->state == BANK_ACTIVE) &&
+          !rwq->full()) ||
+         (!timer_left(CCDc) && !timer_left(bk[j]->RCDWRc) &&
+          !timer_left(bkgrp[grp]->CCDLc) &&
           (bk[j]->curr_row == bk[j]->mrq->row) && (bk[j]->mrq->rw == WRITE) &&
-          (RTWc == 0) && (bk[j]->state == BANK_ACTIVE) && !rwq->full()))) {
+          !timer_left(RTWc) && (bk[j]->state == BANK_ACTIVE) &&
+          !rwq->full()))) {
       memory_Pending_ready++;
     }
   }
@@ -430,12 +483,7 @@ void dram_t::cycle() {
     }
     for (unsigned i = 0; i < m_config->nbk; i++) {
       unsigned j = (i + prio) % m_config->nbk;
-      if (!bk[j]->mrq) {
-        if (!CCDc && !RRDc && !RTWc && !WTRc && !bk[j]->RCDc && !bk[j]->RASc &&
-            !bk[j]->RCc && !bk[j]->RPc && !bk[j]->RCDWRc)
-          k--;
-        bk[j]->n_idle++;
-      }
+      if (!bk[j]->mrq) bk[j]->n_idle++;
     }
   } else {
     // single bus interface
@@ -447,12 +495,7 @@ void dram_t::cycle() {
       if (!issued_col_cmd && !issued_row_cmd)
         issued_row_cmd = issue_row_command(j);
 
-      if (!bk[j]->mrq) {
-        if (!CCDc && !RRDc && !RTWc && !WTRc && !bk[j]->RCDc && !bk[j]->RASc &&
-            !bk[j]->RCc && !bk[j]->RPc && !bk[j]->RCDWRc)
-          k--;
-        bk[j]->n_idle++;
-      }
+      if (!bk[j]->mrq) bk[j]->n_idle++;
     }
   }
 
@@ -464,7 +507,9 @@ void dram_t::cycle() {
     printf("\tNOP                        ");
 #endif
   }
-  if (k) {
+  // the channel is active while a bank holds a request or any timing
+  // constraint other than the precharge/CCDL ones is still pending
+  if (n_bk_mrq || timer_left(activity_until)) {
     n_activity++;
     n_activity_partial++;
   }
@@ -496,7 +541,7 @@ void dram_t::cycle() {
       memory_pending_rw_found = true;
   }
 
-  if (issued_col_cmd || CCDc)
+  if (issued_col_cmd || timer_left(CCDc))
     util_bw++;
   else if (memory_pending_rw_found) {
     wasted_bw_col++;
@@ -506,25 +551,29 @@ void dram_t::cycle() {
       if (bk[j]->mrq &&
           (((bk[j]->curr_row == bk[j]->mrq->row) && (bk[j]->mrq->rw == READ) &&
             (bk[j]->state == BANK_ACTIVE)))) {
-        if (bk[j]->RCDc) RCDc_limit++;
-        if (bkgrp[grp]->CCDLc) CCDLc_limit++;
-        if (WTRc) WTRc_limit++;
-        if (CCDc) CCDc_limit++;
+        if (timer_left(bk[j]->RCDc)) RCDc_limit++;
+        if (timer_left(bkgrp[grp]->CCDLc)) CCDLc_limit++;
+        if (timer_left(WTRc)) WTRc_limit++;
+        if (timer_left(CCDc)) CCDc_limit++;
         if (rwq->full()) rwq_limit++;
-        if (bkgrp[grp]->CCDLc && !WTRc) CCDLc_limit_alone++;
-        if (!bkgrp[grp]->CCDLc && WTRc) WTRc_limit_alone++;
+        if (timer_left(bkgrp[grp]->CCDLc) && !timer_left(WTRc))
+          CCDLc_limit_alone++;
+        if (!timer_left(bkgrp[grp]->CCDLc) && timer_left(WTRc))
+          WTRc_limit_alone++;
       }
       // write
       else if (bk[j]->mrq &&
                ((bk[j]->curr_row == bk[j]->mrq->row) &&
                 (bk[j]->mrq->rw == WRITE) && (bk[j]->state == BANK_ACTIVE))) {
-        if (bk[j]->RCDWRc) RCDWRc_limit++;
-        if (bkgrp[grp]->CCDLc) CCDLc_limit++;
-        if (RTWc) RTWc_limit++;
-        if (CCDc) CCDc_limit++;
+        if (timer_left(bk[j]->RCDWRc)) RCDWRc_limit++;
+        if (timer_left(bkgrp[grp]->CCDLc)) CCDLc_limit++;
+        if (timer_left(RTWc)) RTWc_limit++;
+        if (timer_left(CCDc)) CCDc_limit++;
         if (rwq->full()) rwq_limit++;
-        if (bkgrp[grp]->CCDLc && !RTWc) CCDLc_limit_alone++;
-        if (!bkgrp[grp]->CCDLc && RTWc) RTWc_limit_alone++;
+        if (timer_left(bkgrp[grp]->CCDLc) && !timer_left(RTWc))
+          CCDLc_limit_alone++;
+        if (!timer_left(bkgrp[grp]->CCDLc) && timer_left(RTWc))
+          RTWc_limit_alone++;
       }
     }
   } else if (memory_pending_found)
@@ -536,30 +585,83 @@ void dram_t::cycle() {
 
   /////////////////////////////////////////////////////////
 
-  // decrements counters once for each time dram_issueCMD is called
-  DEC2ZERO(RRDc);
-  DEC2ZERO(CCDc);
-  DEC2ZERO(RTWc);
-  DEC2ZERO(WTRc);
-  for (unsigned j = 0; j < m_config->nbk; j++) {
-    DEC2ZERO(bk[j]->RCDc);
-    DEC2ZERO(bk[j]->RASc);
-    DEC2ZERO(bk[j]->RCc);
-    DEC2ZERO(bk[j]->RPc);
-    DEC2ZERO(bk[j]->RCDWRc);
-    DEC2ZERO(bk[j]->WTPc);
-    DEC2ZERO(bk[j]->RTPc);
-  }
-  for (unsigned j = 0; j < m_config->nbkgrp; j++) {
-    DEC2ZERO(bkgrp[j]->CCDLc);
-    DEC2ZERO(bkgrp[j]->RTPLc);
-  }
+  dram_cycle++;
 
 #ifdef DRAM_VISUALIZE
   visualize();
 #endif
 }
 
+bool dram_t::idle() const {
+  if (n_bk_mrq || n_rwq_cmd || !mrqq->empty() || !returnq->empty())
+    return false;
+  if (m_frfcfs_scheduler)
+    return !m_frfcfs_scheduler->num_pending() &&
+           !m_frfcfs_scheduler->num_write_pending();
+  return true;
+}
+
+// The only state a cycle() of an idle channel touches is the NOP/activity
+// accounting and the scheduler read/write mode, so do just that. Timing
+// constraints keep expiring on their own since they are stored as deadlines.
+void dram_t::idle_cycle() {
+  assert(idle());
+  if (m_frfcfs_scheduler) m_frfcfs_scheduler->update_mode();
+
+  n_nop++;
+  n_nop_partial++;
+  if (timer_left(activity_until)) {
+    n_activity++;
+    n_activity_partial++;
+  }
+  n_cmd++;
+  n_cmd_partial++;
+  if (timer_left(CCDc))
+    util_bw++;
+  else
+    idle_bw++;
+  n_idle_bulk++;  // every bank is idle
+
+  dram_cycle++;
+}
+
+unsigned long long dram_t::quiet_cycles() const {
+  if (n_bk_mrq || !mrqq->empty() || !returnq->empty()) return 0;
+  if (m_frfcfs_scheduler && (m_frfcfs_scheduler->num_pending() ||
+                             m_frfcfs_scheduler->num_write_pending()))
+    return 0;
+  if (!n_rwq_cmd) return (unsigned long long)-1;
+  // the data bursts ahead of the first command in rwq
+  return rwq->leading_empty();
+}
+
+// n cycles of a channel without bank requests: idle_cycle() plus the rwq
+// pops, with the timers read once since they only expire.
+void dram_t::skip(unsigned long long n) {
+  assert(n <= quiet_cycles());
+  if (!n) return;
+  if (m_frfcfs_scheduler) m_frfcfs_scheduler->update_mode();
+  // a pipeline of NULLs is back to its minimum length after that many pops
+  for (unsigned long long i = 0; i < n && i < rwq->get_length(); i++)
+    rwq->pop();
+
+  n_nop += n;
+  n_nop_partial += n;
+  unsigned long long active = std::min<unsigned long long>(
+      n, timer_left(activity_until));
+  n_activity += active;
+  n_activity_partial += active;
+  n_cmd += n;
+  n_cmd_partial += n;
+  unsigned long long util = std::min<unsigned long long>(n, timer_left(CCDc));
+  util_bw += util;
+  idle_bw += n - util;
+  n_idle_bulk += n;
+  StatAddSamples(mrqq_Dist, 0, n);
+
+  dram_cycle += n;
+}
+
 bool dram_t::issue_col_command(int j) {
   bool issued = false;
   unsigned grp = get_bankgrp_number(j);
@@ -567,20 +669,22 @@ bool dram_t::issue_col_command(int j) {
     bk[j]->mrq->data->set_status(
         IN_PARTITION_DRAM, m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle);
     // correct row activated for a READ
-    if (!issued && !CCDc && !bk[j]->RCDc && !(bkgrp[grp]->CCDLc) &&
+    if (!issued && !timer_left(CCDc) && !timer_left(bk[j]->RCDc) &&
+        !timer_left(bkgrp[grp]->CCDLc) &&
         (bk[j]->curr_row == bk[j]->mrq->row) && (bk[j]->mrq->rw == READ) &&
-        (WTRc == 0) && (bk[j]->state == BANK_ACTIVE) && !rwq->full()) {
+        !timer_left(WTRc) && (bk[j]->state == BANK_ACTIVE) && !rwq->full()) {
       if (rw == WRITE) {
         rw = READ;
         rwq->set_min_length(m_config->CL);
       }
       rwq->push(bk[j]->mrq);
+      n_rwq_cmd++;
       bk[j]->mrq->txbytes += m_config->dram_atom_size;
-      CCDc = m_config->tCCD;
-      bkgrp[grp]->CCDLc = m_config->tCCDL;
-      RTWc = m_config->tRTW;
-      bk[j]->RTPc = m_config->BL / m_config->data_command_freq_ratio;
-      bkgrp[grp]->RTPLc = m_config->tRTPL;
+      set_act_timer(CCDc, m_config->tCCD);
+      set_timer(bkgrp[grp]->CCDLc, m_config->tCCDL);
+      set_act_timer(RTWc, m_config->tRTW);
+      set_timer(bk[j]->RTPc, m_config->BL / m_config->data_command_freq_ratio);
+      set_timer(bkgrp[grp]->RTPLc, m_config->tRTPL);
       issued = true;
       if (bk[j]->mrq->data->get_access_type() == L2_WR_ALLOC_R)
         n_rd_L2_A++;
@@ -602,23 +706,27 @@ bool dram_t::issue_col_command(int j) {
       // transfer done
       if (!(bk[j]->mrq->txbytes < bk[j]->mrq->nbytes)) {
         bk[j]->mrq = NULL;
+        n_bk_mrq--;
       }
     } else
         // correct row activated for a WRITE
-        if (!issued && !CCDc && !bk[j]->RCDWRc && !(bkgrp[grp]->CCDLc) &&
+        if (!issued && !timer_left(CCDc) && !timer_left(bk[j]->RCDWRc) &&
+            !timer_left(bkgrp[grp]->CCDLc) &&
             (bk[j]->curr_row == bk[j]->mrq->row) && (bk[j]->mrq->rw == WRITE) &&
-            (RTWc == 0) && (bk[j]->state == BANK_ACTIVE) && !rwq->full()) {
+            !timer_left(RTWc) && (bk[j]->state == BANK_ACTIVE) &&
+            !rwq->full()) {
       if (rw == READ) {
         rw = WRITE;
         rwq->set_min_length(m_config->WL);
       }
       rwq->push(bk[j]->mrq);
+      n_rwq_cmd++;
 
       bk[j]->mrq->txbytes += m_config->dram_atom_size;
-      CCDc = m_config->tCCD;
-      bkgrp[grp]->CCDLc = m_config->tCCDL;
-      WTRc = m_config->tWTR;
-      bk[j]->WTPc = m_config->tWTP;
+      set_act_timer(CCDc, m_config->tCCD);
+      set_timer(bkgrp[grp]->CCDLc, m_config->tCCDL);
+      set_act_timer(WTRc, m_config->tWTR);
+      set_timer(bk[j]->WTPc, m_config->tWTP);
       issued = true;
 
       if (bk[j]->mrq->data->get_access_type() == L2_WRBK_ACC)
@@ -639,6 +747,7 @@ bool dram_t::issue_col_command(int j) {
       // transfer done
       if (!(bk[j]->mrq->txbytes < bk[j]->mrq->nbytes)) {
         bk[j]->mrq = NULL;
+        n_bk_mrq--;
       }
     }
   }
@@ -654,8 +763,8 @@ bool dram_t::issue_row_command(int j) {
         IN_PARTITION_DRAM, m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle);
     //     bank is idle
     // else
-    if (!issued && !RRDc && (bk[j]->state == BANK_IDLE) && !bk[j]->RPc &&
-        !bk[j]->RCc) {  //
+    if (!issued && !timer_left(RRDc) && (bk[j]->state == BANK_IDLE) &&
+        !timer_left(bk[j]->RPc) && !timer_left(bk[j]->RCc)) {  //
 #ifdef DRAM_VERIFY
       PRINT_CYCLE = 1;
       printf("\tACT BK:%d NewRow:%03x From:%03x \n", j, bk[j]->mrq->row,
@@ -664,11 +773,11 @@ bool dram_t::issue_row_command(int j) {
       // activate the row with current memory request
       bk[j]->curr_row = bk[j]->mrq->row;
       bk[j]->state = BANK_ACTIVE;
-      RRDc = m_config->tRRD;
-      bk[j]->RCDc = m_config->tRCD;
-      bk[j]->RCDWRc = m_config->tRCDWR;
-      bk[j]->RASc = m_config->tRAS;
-      bk[j]->RCc = m_config->tRC;
+      set_act_timer(RRDc, m_config->tRRD);
+      set_act_timer(bk[j]->RCDc, m_config->tRCD);
+      set_act_timer(bk[j]->RCDWRc, m_config->tRCDWR);
+      set_act_timer(bk[j]->RASc, m_config->tRAS);
+      set_act_timer(bk[j]->RCc, m_config->tRC);
       prio = (j + 1) % m_config->nbk;
       issued = true;
       n_act_partial++;
@@ -679,11 +788,11 @@ bool dram_t::issue_row_command(int j) {
         // different row activated
         if ((!issued) && (bk[j]->curr_row != bk[j]->mrq->row) &&
             (bk[j]->state == BANK_ACTIVE) &&
-            (!bk[j]->RASc && !bk[j]->WTPc && !bk[j]->RTPc &&
-             !bkgrp[grp]->RTPLc)) {
+            (!timer_left(bk[j]->RASc) && !timer_left(bk[j]->WTPc) &&
+             !timer_left(bk[j]->RTPc) && !timer_left(bkgrp[grp]->RTPLc))) {
       // make the bank idle again
       bk[j]->state = BANK_IDLE;
-      bk[j]->RPc = m_config->tRP;
+      set_act_timer(bk[j]->RPc, m_config->tRP);
       prio = (j + 1) % m_config->nbk;
       issued = true;
       n_pre++;
@@ -706,6 +815,71 @@ class mem_fetch *dram_t::return_queue_top() {
   return returnq->top();
 }
 
+void dram_t::checkpoint_state(uarch_checkpoint &cp) {
+  cp.section("dram", (unsigned long long)m_config->nbk << 32 |
+                         m_config->nbkgrp << 1 | (m_frfcfs_scheduler != NULL));
+  cp.require(idle() && !m_shared.dirty, "dram channel");
+  for (unsigned i = 0; i < m_config->nbkgrp; i++) cp.io(*bkgrp[i]);
+  for (unsigned i = 0; i < m_config->nbk; i++) {
+    bank_t &b = *bk[i];
+    cp.io(b.RCDc);
+    cp.io(b.RCDWRc);
+    cp.io(b.RASc);
+    cp.io(b.RPc);
+    cp.io(b.RCc);
+    cp.io(b.WTPc);
+    cp.io(b.RTPc);
+    cp.io(b.rw);
+    cp.io(b.state);
+    cp.io(b.curr_row);
+    cp.io(b.n_access);
+    cp.io(b.n_writes);
+    cp.io(b.n_idle);
+  }
+  cp.io(prio);
+  cp.io(dram_cycle);
+  cp.io(activity_until);
+  cp.io(n_idle_bulk);
+  cp.io(RRDc);
+  cp.io(CCDc);
+  cp.io(RTWc);
+  cp.io(WTRc);
+  cp.io(rw);
+  cp.io(pending_writes);
+
+  cp.io(dram_util_bins, 10);
+  cp.io(dram_eff_bins, 10);
+  cp.io(last_n_cmd);
+  cp.io(last_n_activity);
+  cp.io(last_bwutil);
+  unsigned long long *counters[] = {
+      &n_cmd, &n_activity, &n_nop, &n_act, &n_pre, &n_ref, &n_rd, &n_rd_L2_A,
+      &n_wr, &n_wr_WB, &n_req, &max_mrqs_temp, &wasted_bw_row, &wasted_bw_col,
+      &util_bw, &idle_bw, &RCDc_limit, &CCDLc_limit, &CCDLc_limit_alone,
+      &CCDc_limit, &WTRc_limit, &WTRc_limit_alone, &RCDWRc_limit, &RTWc_limit,
+      &RTWc_limit_alone, &rwq_limit, &access_num, &read_num, &write_num,
+      &hits_num, &hits_read_num, &hits_write_num, &banks_1time,
+      &banks_acess_total, &banks_acess_total_after, &banks_time_rw,
+      &banks_access_rw_total, &banks_time_ready, &banks_access_ready_total,
+      &issued_two, &issued_total, &issued_total_row, &issued_total_col,
+      &bkgrp_parallsim_rw};
+  for (unsigned i = 0; i < sizeof(counters) / sizeof(counters[0]); i++)
+    cp.io(*counters[i]);
+  cp.io(write_to_read_ratio_blp_rw_average);
+  cp.io(bwutil);
+  cp.io(max_mrqs);
+  cp.io(ave_mrqs);
+  cp.io(n_cmd_partial);
+  cp.io(n_activity_partial);
+  cp.io(n_nop_partial);
+  cp.io(n_act_partial);
+  cp.io(n_pre_partial);
+  cp.io(n_req_partial);
+  cp.io(ave_mrqs_partial);
+  cp.io(bwutil_partial);
+  if (m_frfcfs_scheduler) m_frfcfs_scheduler->checkpoint_state(cp);
+}
+
 void dram_t::print(FILE *simFile) const {
   unsigned i;
   fprintf(simFile, "DRAM[%d]: %d bks, busW=%d BL=%d CL=%d, ", id, m_config->nbk,
@@ -722,7 +896,8 @@ void dram_t::print(FILE *simFile) const {
   fprintf(simFile, "n_activity=%llu dram_eff=%.4g\n", n_activity,
           (float)bwutil / n_activity);
   for (i = 0; i < m_config->nbk; i++) {
-    fprintf(simFile, "bk%d: %da %di ", i, bk[i]->n_access, bk[i]->n_idle);
+    fprintf(simFile, "bk%d: %da %di ", i, bk[i]->n_access,
+            bk[i]->n_idle + n_idle_bulk);
   }
   fprintf(simFile, "\n");
   fprintf(simFile,
@@ -798,11 +973,12 @@ void dram_t::print(FILE *simFile) const {
 }
 
 void dram_t::visualize() const {
-  printf("RRDc=%d CCDc=%d mrqq.Length=%d rwq.Length=%d\n", RRDc, CCDc,
-         mrqq->get_length(), rwq->get_length());
+  printf("RRDc=%d CCDc=%d mrqq.Length=%d rwq.Length=%d\n", timer_left(RRDc),
+         timer_left(CCDc), mrqq->get_length(), rwq->get_length());
   for (unsigned i = 0; i < m_config->nbk; i++) {
     printf("BK%d: state=%c curr_row=%03x, %2d %2d %2d %2d %p ", i, bk[i]->state,
-           bk[i]->curr_row, bk[i]->RCDc, bk[i]->RASc, bk[i]->RPc, bk[i]->RCc,
+           bk[i]->curr_row, timer_left(bk[i]->RCDc), timer_left(bk[i]->RASc),
+           timer_left(bk[i]->RPc), timer_left(bk[i]->RCc),
            bk[i]->mrq);
     if (bk[i]->mrq)
       printf("txf: %d %d", bk[i]->mrq->nbytes, bk[i]->mrq->txbytes);
@@ -67,19 +67,21 @@ class dram_req_t {
   class gpgpu_sim *m_gpu;
 };
 
+// The timing constraint fields below (*c) hold the DRAM cycle at which the
+// constraint expires, not a per-cycle countdown; see dram_t::timer_left().
 struct bankgrp_t {
-  unsigned int CCDLc;
-  unsigned int RTPLc;
+  unsigned long long CCDLc;
+  unsigned long long RTPLc;
 };
 
 struct bank_t {
-  unsigned int RCDc;
-  unsigned int RCDWRc;
-  unsigned int RASc;
-  unsigned int RPc;
-  unsigned int RCc;
-  unsigned int WTPc;  // write to precharge
-  unsigned int RTPc;  // read to precharge
+  unsigned long long RCDc;
+  unsigned long long RCDWRc;
+  unsigned long long RASc;
+  unsigned long long RPc;
+  unsigned long long RCc;
+  unsigned long long WTPc;  // write to precharge
+  unsigned long long RTPc;  // read to precharge
 
   unsigned char rw;     // is the bank reading or writing?
   unsigned char state;  // is the bank active or idle?
@@ -105,6 +107,7 @@ enum bank_grp_bits_position { HIGHER_BITS = 0, LOWER_BITS };
 
 class mem_fetch;
 class memory_config;
+class uarch_checkpoint;
 
 class dram_t {
  public:
@@ -126,7 +129,19 @@ class dram_t {
 
   void push(class mem_fetch *data);
   void cycle();
+  // true if no request is queued, scheduled or in flight in this channel
+  bool idle() const;
+  // equivalent to cycle() when idle(), without walking the banks
+  void idle_cycle();
+  // cycles that can pass before a request moves, 0 if a bank, queue or
+  // scheduler holds one; column commands in flight only count down
+  unsigned long long quiet_cycles() const;
+  // n cycles within quiet_cycles(), including their SAMPLELOG dram_log()
+  void skip(unsigned long long n);
   void dram_log(int task);
+  // add the shared counters buffered since the last call to m_stats
+  void flush_shared_stats();
+  void checkpoint_state(uarch_checkpoint &cp);
 
   class memory_partition_unit *m_memory_partition_unit;
   class gpgpu_sim *m_gpu;
@@ -153,10 +168,31 @@ class dram_t {
   bool issue_col_command(int j);
   bool issue_row_command(int j);
 
-  unsigned int RRDc;
-  unsigned int CCDc;
-  unsigned int RTWc;  // read to write penalty applies across banks
-  unsigned int WTRc;  // write to read penalty applies across banks
+  // remaining cycles of a timing constraint (0 once it has expired)
+  unsigned timer_left(unsigned long long timer) const {
+    return timer > dram_cycle ? (unsigned)(timer - dram_cycle) : 0;
+  }
+  // start a timing constraint that lasts for the given number of cycles;
+  // constraints that keep the channel "active" (see n_activity) also extend
+  // activity_until
+  void set_timer(unsigned long long &timer, unsigned cycles) {
+    timer = dram_cycle + cycles;
+  }
+  void set_act_timer(unsigned long long &timer, unsigned cycles) {
+    timer = dram_cycle + cycles;
+    if (timer > activity_until) activity_until = timer;
+  }
+
+  unsigned long long dram_cycle;      // DRAM cycles simulated so far
+  unsigned long long activity_until;  // last cycle with an active constraint
+  unsigned int n_bk_mrq;              // banks currently holding a request
+  unsigned int n_rwq_cmd;             // column commands in flight in rwq
+  unsigned int n_idle_bulk;  // idle_cycle() calls, counted as n_idle per bank
+
+  unsigned long long RRDc;
+  unsigned long long CCDc;
+  unsigned long long RTWc;  // read to write penalty applies across banks
+  unsigned long long WTRc;  // write to read penalty applies across banks
 
   unsigned char
       rw;  // was last request a read or write? (important for RTW, WTR)
@@ -241,6 +277,23 @@ class dram_t {
   class memory_stats_t *m_stats;
   class Stats *mrqq_Dist;  // memory request queue inside DRAM
 
+  // memory_stats_t counters that every channel adds to, plus the dram
+  // traffic per pc for the ptx line stats. Channels can be stepped on
+  // different host threads (-gpgpu_sim_threads), so they are buffered here
+  // and added by flush_shared_stats() in channel order.
+  struct shared_stats_t {
+    bool dirty;
+    unsigned n_access;
+    unsigned n_reads;
+    unsigned n_writes;
+    unsigned long long mrq_latency;
+    unsigned long long mrq_num;
+    unsigned max_mrq_latency;
+    unsigned mrq_lat_table[32];
+    std::vector<std::pair<unsigned, unsigned> > dram_traffic;  // pc, bytes
+  };
+  shared_stats_t m_shared;
+
   friend class frfcfs_scheduler;
 };
 
@@ -31,6 +31,7 @@
 #include "gpu-misc.h"
 #include "gpu-sim.h"
 #include "mem_latency_stat.h"
+#include "uarch_checkpoint.h"
 
 frfcfs_scheduler::frfcfs_scheduler(const memory_config *config, dram_t *dm,
                                    memory_stats_t *stats) {
@@ -106,15 +107,7 @@ void frfcfs_scheduler::data_collection(unsigned int bank) {
   m_stats->num_activates[m_dram->id][bank]++;
 }
 
-dram_req_t *frfcfs_scheduler::schedule(unsigned bank, unsigned curr_row) {
-  // row
-  bool rowhit = true;
-  std::list<dram_req_t *> *m_current_queue = m_queue;
-  std::map<unsigned, std::list<std::list<dram_req_t *>::iterator> >
-      *m_current_bins = m_bins;
-  std::list<std::list<dram_req_t *>::iterator> **m_current_last_row =
-      m_last_row;
-
+void frfcfs_scheduler::update_mode() {
   if (m_config->seperate_write_queue_enabled) {
     if (m_mode == READ_MODE &&
         ((m_num_write_pending >= m_config->write_high_watermark)
@@ -128,6 +121,18 @@ dram_req_t *frfcfs_scheduler::schedule(unsigned bank, unsigned curr_row) {
       m_mode = READ_MODE;
     }
   }
+}
+
+dram_req_t *frfcfs_scheduler::schedule(unsigned bank, unsigned curr_row) {
+  // row
+  bool rowhit = true;
+  std::list<dram_req_t *> *m_current_queue = m_queue;
+  std::map<unsigned, std::list<std::list<dram_req_t *>::iterator> >
+      *m_current_bins = m_bins;
+  std::list<std::list<dram_req_t *>::iterator> **m_current_last_row =
+      m_last_row;
+
+  update_mode();
 
   if (m_mode == WRITE_MODE) {
     m_current_queue = m_write_queue;
@@ -204,6 +209,17 @@ void frfcfs_scheduler::print(FILE *fp) {
   }
 }
 
+void frfcfs_scheduler::checkpoint_state(uarch_checkpoint &cp) {
+  cp.require(!m_num_pending && !m_num_write_pending, "frfcfs queues");
+  cp.io(curr_row_service_time, m_config->nbk);
+  cp.io(row_service_timestamp, m_config->nbk);
+  cp.io(m_mode);
+  for (unsigned b = 0; b < m_config->nbk; b++) {
+    m_last_row[b] = NULL;
+    if (m_config->seperate_write_queue_enabled) m_last_write_row[b] = NULL;
+  }
+}
+
 void dram_t::scheduler_frfcfs() {
   unsigned mrq_latency;
   frfcfs_scheduler *sched = m_frfcfs_scheduler;
@@ -213,12 +229,13 @@ void dram_t::scheduler_frfcfs() {
     // Power stats
     // if(req->data->get_type() != READ_REPLY && req->data->get_type() !=
     // WRITE_ACK)
-    m_stats->total_n_access++;
+    m_shared.n_access++;
+    m_shared.dirty = true;
 
     if (req->data->get_type() == WRITE_REQUEST) {
-      m_stats->total_n_writes++;
+      m_shared.n_writes++;
     } else if (req->data->get_type() == READ_REQUEST) {
-      m_stats->total_n_reads++;
+      m_shared.n_reads++;
     }
 
     req->data->set_status(IN_PARTITION_MC_INPUT_QUEUE,
@@ -242,16 +259,17 @@ void dram_t::scheduler_frfcfs() {
                               m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle);
         prio = (prio + 1) % m_config->nbk;
         bk[b]->mrq = req;
+        n_bk_mrq++;
         if (m_config->gpgpu_memlatency_stat) {
           mrq_latency = m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle -
                         bk[b]->mrq->timestamp;
-          m_stats->tot_mrq_latency += mrq_latency;
-          m_stats->tot_mrq_num++;
+          m_shared.mrq_latency += mrq_latency;
+          m_shared.mrq_num++;
           bk[b]->mrq->timestamp =
               m_gpu->gpu_tot_sim_cycle + m_gpu->gpu_sim_cycle;
-          m_stats->mrq_lat_table[LOGB2(mrq_latency)]++;
-          if (mrq_latency > m_stats->max_mrq_latency) {
-            m_stats->max_mrq_latency = mrq_latency;
+          m_shared.mrq_lat_table[LOGB2(mrq_latency)]++;
+          if (mrq_latency > m_shared.max_mrq_latency) {
+            m_shared.max_mrq_latency = mrq_latency;
           }
         }
 
@@ -44,8 +44,11 @@ class frfcfs_scheduler {
                    memory_stats_t *stats);
   void add_req(dram_req_t *req);
   void data_collection(unsigned bank);
+  // switch between read and write draining based on the write watermarks
+  void update_mode();
   dram_req_t *schedule(unsigned bank, unsigned curr_row);
   void print(FILE *fp);
+  void checkpoint_state(uarch_checkpoint &cp);
   unsigned num_pending() const { return m_num_pending; }
   unsigned num_write_pending() const { return m_num_write_pending; }
 
@@ -31,6 +31,7 @@
 #include "gpu-sim.h"
 #include "hashing.h"
 #include "stat-tool.h"
+#include "uarch_checkpoint.h"
 
 // used to allocate memory that is large enough to adapt the changes in cache
 // size across kernels
@@ -180,6 +181,60 @@ void tag_array::update_cache_parameters(cache_config &config) {
   m_config = config;
 }
 
+void cache_block_t::checkpoint_block(uarch_checkpoint &cp) {
+  cp.io(m_tag);
+  cp.io(m_block_addr);
+  cp.io(m_data, 128);
+  cp.io(m_tpc, 4);
+  cp.io(m_sid, 4);
+  cp.io(m_wid, 4);
+  cp.io(m_inst_count, 4);
+}
+
+void line_cache_block::checkpoint_state(uarch_checkpoint &cp) {
+  checkpoint_block(cp);
+  cp.io(m_alloc_time);
+  cp.io(m_last_access_time);
+  cp.io(m_fill_time);
+  cp.io(m_status);
+  cp.io(m_ignore_on_fill_status);
+  cp.io(m_set_modified_on_fill);
+  cp.io(m_readable);
+}
+
+void sector_cache_block::checkpoint_state(uarch_checkpoint &cp) {
+  checkpoint_block(cp);
+  cp.io(m_sector_alloc_time, SECTOR_CHUNCK_SIZE);
+  cp.io(m_last_sector_access_time, SECTOR_CHUNCK_SIZE);
+  cp.io(m_sector_fill_time, SECTOR_CHUNCK_SIZE);
+  cp.io(m_line_alloc_time);
+  cp.io(m_line_last_access_time);
+  cp.io(m_line_fill_time);
+  cp.io(m_status, SECTOR_CHUNCK_SIZE);
+  cp.io(m_ignore_on_fill_status, SECTOR_CHUNCK_SIZE);
+  cp.io(m_set_modified_on_fill, SECTOR_CHUNCK_SIZE);
+  cp.io(m_readable, SECTOR_CHUNCK_SIZE);
+}
+
+void tag_array::checkpoint_state(uarch_checkpoint &cp) {
+  unsigned n_lines = m_config.get_max_num_lines();
+  unsigned long long geometry = n_lines;
+  geometry = (geometry << 16) | m_config.m_line_sz;
+  geometry = (geometry << 1) | (m_config.m_cache_type == SECTOR);
+  cp.section("tag_array", geometry);
+  cp.require(pending_lines.empty(), "pending lines");
+  for (unsigned i = 0; i < n_lines; i++) m_lines[i]->checkpoint_state(cp);
+  cp.io(m_access);
+  cp.io(m_miss);
+  cp.io(m_pending_hit);
+  cp.io(m_res_fail);
+  cp.io(m_sector_miss);
+  cp.io(m_prev_snapshot_access);
+  cp.io(m_prev_snapshot_miss);
+  cp.io(m_prev_snapshot_pending_hit);
+  cp.io(is_used);
+}
+
 tag_array::tag_array(cache_config &config, int core_id, int type_id)
     : m_config(config) {
   // assert( m_config.m_write_policy == READ_ONLY ); Old assert
@@ -946,6 +1001,15 @@ void cache_stats::sample_cache_port_utility(bool data_port_busy,
   }
 }
 
+void cache_stats::checkpoint_state(uarch_checkpoint &cp) {
+  cp.io(m_stats);
+  cp.io(m_stats_pw);
+  cp.io(m_fail_stats);
+  cp.io(m_cache_port_available_cycles);
+  cp.io(m_cache_data_port_busy_cycles);
+  cp.io(m_cache_fill_port_busy_cycles);
+}
+
 baseline_cache::bandwidth_management::bandwidth_management(cache_config &config)
     : m_config(config) {
   m_data_port_occupied_cycles = 0;
@@ -1100,6 +1164,12 @@ void baseline_cache::print(FILE *fp, unsigned &accesses,
   m_tag_array->print(fp, accesses, misses);
 }
 
+void baseline_cache::checkpoint_state(uarch_checkpoint &cp) {
+  cp.require(idle() && m_extra_mf_fields.empty(), m_name.c_str());
+  m_tag_array->checkpoint_state(cp);
+  m_stats.checkpoint_state(cp);
+}
+
 void baseline_cache::display_state(FILE *fp) const {
   fprintf(fp, "Cache %s:\n", m_name.c_str());
   m_mshrs.display(fp);
@@ -1872,6 +1942,16 @@ void tex_cache::fill(mem_fetch *mf, unsigned time) {
   assert(r.m_block_addr == m_config.block_addr(mf->get_addr()));
 }
 
+void tex_cache::checkpoint_state(uarch_checkpoint &cp) {
+  cp.require(m_fragment_fifo.empty() && m_request_fifo.empty() &&
+                 m_rob.empty() && m_result_fifo.empty() &&
+                 m_extra_mf_fields.empty(),
+             m_name.c_str());
+  m_tags.checkpoint_state(cp);
+  cp.io(m_cache, m_config.get_num_lines());
+  m_stats.checkpoint_state(cp);
+}
+
 void tex_cache::display_state(FILE *fp) const {
   fprintf(fp, "%s (texture cache) state:\n", m_name.c_str());
   fprintf(fp, "fragment fifo entries  = %u / %u\n", m_fragment_fifo.size(),
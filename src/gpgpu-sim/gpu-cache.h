@@ -110,6 +110,8 @@ struct cache_event {
 
 const char *cache_request_status_str(enum cache_request_status status);
 
+class uarch_checkpoint;
+
 struct cache_block_t {
   cache_block_t() {
     m_tag = 0;
@@ -152,6 +154,7 @@ struct cache_block_t {
                               mem_access_sector_mask_t sector_mask) = 0;
   virtual bool is_readable(mem_access_sector_mask_t sector_mask) = 0;
   virtual void print_status() = 0;
+  virtual void checkpoint_state(uarch_checkpoint &cp) = 0;
   virtual ~cache_block_t() {}
 
   new_addr_type m_tag;
@@ -163,6 +166,9 @@ struct cache_block_t {
   unsigned m_sid[4];
   unsigned m_wid[4];
   unsigned m_inst_count[4];
+
+ protected:
+  void checkpoint_block(uarch_checkpoint &cp);
 };
 
 struct line_cache_block : public cache_block_t {
@@ -252,6 +258,7 @@ struct line_cache_block : public cache_block_t {
   virtual void print_status() {
     printf("m_block_addr is %llu, status = %u\n", m_block_addr, m_status);
   }
+  virtual void checkpoint_state(uarch_checkpoint &cp);
 
  private:
   unsigned long long m_alloc_time;
@@ -462,6 +469,7 @@ struct sector_cache_block : public cache_block_t {
     printf("m_block_addr is %llu, status = %u %u %u %u\n", m_block_addr,
            m_status[0], m_status[1], m_status[2], m_status[3]);
   }
+  virtual void checkpoint_state(uarch_checkpoint &cp);
 
  private:
   unsigned m_sector_alloc_time[SECTOR_CHUNCK_SIZE];
@@ -922,6 +930,7 @@ class tag_array {
   void update_cache_parameters(cache_config &config);
   void add_pending_line(mem_fetch *mf);
   void remove_pending_line(mem_fetch *mf);
+  void checkpoint_state(uarch_checkpoint &cp);
 
  protected:
   // This constructor is intended for use only from derived classes that wish to
@@ -1170,6 +1179,11 @@ class cache_stats {
   void get_sub_stats_pw(struct cache_sub_stats_pw &css) const;
 
   void sample_cache_port_utility(bool data_port_busy, bool fill_port_busy);
+  // n samples with both ports free
+  void sample_idle_cycles(unsigned long long n) {
+    m_cache_port_available_cycles += n;
+  }
+  void checkpoint_state(uarch_checkpoint &cp);
 
  private:
   bool check_valid(int type, int status) const;
@@ -1246,6 +1260,16 @@ class baseline_cache : public cache_t {
   /// Are any (accepted) accesses that had to wait for memory now ready? (does
   /// not include accesses that "HIT")
   bool access_ready() const { return m_mshrs.access_ready(); }
+  /// Nothing to send, hand back or drain from the ports, so cycle() would
+  /// only sample the port utility
+  bool idle() const {
+    return m_miss_queue.empty() && !access_ready() && data_port_free() &&
+           fill_port_free();
+  }
+  /// n calls to cycle() of an idle() cache
+  void idle_cycles(unsigned long long n) { m_stats.sample_idle_cycles(n); }
+  /// tags and stats of an idle() cache
+  void checkpoint_state(uarch_checkpoint &cp);
   /// Pop next ready access (does not include accesses that "HIT")
   mem_fetch *next_access() { return m_mshrs.next_access(); }
   // flash invalidate all entries in cache
@@ -1685,6 +1709,10 @@ class tex_cache : public cache_t {
                                    unsigned time,
                                    std::list<cache_event> &events);
   void cycle();
+  /// Nothing to send to memory or to read out, so cycle() does nothing
+  bool idle() const {
+    return m_request_fifo.empty() && m_fragment_fifo.empty();
+  }
   /// Place returning cache block into reorder buffer
   void fill(mem_fetch *mf, unsigned time);
   /// Are any (accepted) accesses that had to wait for memory now ready? (does
@@ -1694,6 +1722,7 @@ class tex_cache : public cache_t {
   /// "MISS")
   mem_fetch *next_access() { return m_result_fifo.pop(); }
   void display_state(FILE *fp) const;
+  void checkpoint_state(uarch_checkpoint &cp);
 
   // accessors for cache bandwidth availability - stubs for now
   bool data_port_free() const { return true; }
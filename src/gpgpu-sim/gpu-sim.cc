@@ -29,11 +29,14 @@
 
 #include "gpu-sim.h"
 
+#include <limits.h>
 #include <math.h>
+#include <sched.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include "comp.h"
+#include "cta_sampler.h"
 #include "memory_link.h"
 #include "zlib.h"
 
@@ -41,6 +44,7 @@
 #include "mem_fetch.h"
 #include "shader.h"
 #include "shader_trace.h"
+#include "sim_profile.h"
 
 #include <time.h>
 #include <cstdio>
@@ -53,16 +57,21 @@
 #include "l2cache.h"
 #include "shader.h"
 #include "stat-tool.h"
+#include "uarch_checkpoint.h"
+#include "warp_trace.h"
+#include "worker_pool.h"
 
 #include "../../libcuda/gpgpu_context.h"
 #include "../abstract_hardware_model.h"
 #include "../cuda-sim/cuda-sim.h"
 #include "../cuda-sim/cuda_device_runtime.h"
+#include "../cuda-sim/memory.h"
 #include "../cuda-sim/ptx-stats.h"
 #include "../cuda-sim/ptx_ir.h"
 #include "../debug.h"
 #include "../gpgpusim_entrypoint.h"
 #include "../statwrapper.h"
+#include "../stream_manager.h"
 #include "../trace.h"
 #include "mem_latency_stat.h"
 #include "power_stat.h"
@@ -542,6 +551,12 @@ void shader_core_config::reg_options(class OptionParser *opp) {
       "scheduler_prioritization_type"
       "Default: gto",
       "gto");
+  option_parser_register(
+      opp, "-gpgpu_scheduler_order_check", OPT_BOOL,
+      &gpgpu_scheduler_order_check,
+      "Compare the incrementally maintained warp issue order against a full "
+      "re-sort every cycle and abort on a mismatch (Default = 0)",
+      "0");
 
   option_parser_register(
       opp, "-gpgpu_concurrent_kernel_sm", OPT_BOOL, &gpgpu_concurrent_kernel_sm,
@@ -626,6 +641,78 @@ void gpgpu_sim_config::reg_options(option_parser_t opp) {
   option_parser_register(
       opp, "-gpgpu_max_concurrent_kernel", OPT_INT32, &max_concurrent_kernel,
       "maximum kernels that can run concurrently on GPU", "8");
+  option_parser_register(
+      opp, "-gpgpu_sim_threads", OPT_UINT32, &gpgpu_sim_threads,
+      "Number of host threads stepping the SM clusters, L2 sub partitions "
+      "and memory links each clock edge; results do not depend on it "
+      "(1 = serial)",
+      "1");
+  option_parser_register(
+      opp, "-gpgpu_idle_fast_forward", OPT_BOOL, &gpgpu_idle_fast_forward,
+      "Jump over clock edges on which no unit can act (cores stalled on "
+      "memory or idle, only link, DRAM, ROP and launch latencies counting "
+      "down); results do not depend on it (1=on, 0=off)",
+      "0");
+  option_parser_register(
+      opp, "-gpgpu_cta_sampling", OPT_BOOL, &gpgpu_cta_sampling,
+      "Simulate representative intervals of a kernel's CTAs in detail and "
+      "fast-forward repeating ones on the functional model, extrapolating "
+      "cycles and link traffic (1=on, 0=off)",
+      "0");
+  option_parser_register(
+      opp, "-gpgpu_cta_sample_interval", OPT_UINT32,
+      &gpgpu_cta_sample_interval,
+      "CTAs per sampling interval (0 = as many as the GPU holds at once)",
+      "0");
+  option_parser_register(
+      opp, "-gpgpu_cta_sample_threshold", OPT_DOUBLE,
+      &gpgpu_cta_sample_threshold,
+      "Largest Manhattan distance (0 to 2) between normalized basic block "
+      "vectors of intervals in the same phase",
+      "0.1");
+  option_parser_register(
+      opp, "-gpgpu_uarch_checkpoint_kernel", OPT_UINT32,
+      &gpgpu_uarch_checkpoint_kernel,
+      "Save the cache, DRAM, link and compressor state with the statistics "
+      "to -gpgpu_uarch_checkpoint_file once the GPU drains after this kernel "
+      "uid (0 = no checkpoint); snapshots are only taken at drain points, "
+      "never in the middle of a kernel",
+      "0");
+  option_parser_register(opp, "-gpgpu_uarch_checkpoint_file", OPT_CSTR,
+                         &gpgpu_uarch_checkpoint_file,
+                         "Timing model checkpoint file",
+                         "uarch_checkpoint.bin");
+  option_parser_register(
+      opp, "-gpgpu_uarch_restore", OPT_BOOL, &gpgpu_uarch_restore,
+      "Load -gpgpu_uarch_checkpoint_file before the first kernel; pair with "
+      "-resume_option for the functional state. The shapes of the caches, "
+      "DRAM and links must match the saved run; under another "
+      "-compress_link the compressor starts cold (1=on, 0=off)",
+      "0");
+  option_parser_register(
+      opp, "-gpgpu_sweep_kernel", OPT_UINT32, &gpgpu_sweep_kernel,
+      "At the launch of this kernel uid, fork one process per line of "
+      "-gpgpu_sweep_file, each simulating the rest of the program with that "
+      "line's timing model options (0 = no sweep)",
+      "0");
+  option_parser_register(
+      opp, "-gpgpu_sweep_file", OPT_CSTR, &gpgpu_sweep_file,
+      "Sweep points, one per line: a name (its output goes to <name>.log) "
+      "followed by option overrides",
+      "sweep.txt");
+  option_parser_register(opp, "-gpgpu_sweep_jobs", OPT_UINT32,
+                         &gpgpu_sweep_jobs,
+                         "Sweep points simulated at once (0 = all)", "0");
+  option_parser_register(
+      opp, "-gpgpu_trace_capture", OPT_CSTR, &gpgpu_trace_capture,
+      "Record each warp's instructions, active masks, addresses and store "
+      "data to this file for -gpgpu_trace_replay",
+      NULL);
+  option_parser_register(
+      opp, "-gpgpu_trace_replay", OPT_CSTR, &gpgpu_trace_replay,
+      "Drive the timing model from a -gpgpu_trace_capture file instead of "
+      "executing the kernels",
+      NULL);
   option_parser_register(
       opp, "-gpgpu_cflog_interval", OPT_INT32, &gpgpu_cflog_interval,
       "Interval between each snapshot in control flow logger", "0");
@@ -729,6 +816,10 @@ void gpgpu_sim::launch(kernel_info_t *kinfo) {
     }
   }
   assert(n < m_running_kernels.size());
+  m_idle_check_wait = 0;
+  m_idle_check_backoff = 1;
+  if (m_cta_sampler && !checkpoint_option && !resume_option)
+    m_cta_sampler->launch(kinfo, get_cta_sample_counters());
 }
 
 bool gpgpu_sim::can_start_kernel() {
@@ -772,6 +863,24 @@ void gpgpu_sim::decrement_kernel_latency() {
   }
 }
 
+bool gpgpu_sim::select_kernel_stable(kernel_info_t **kernel) const {
+  kernel_info_t *last = m_running_kernels[m_last_issued_kernel];
+  if (last && !last->no_more_ctas_to_run() && !last->m_kernel_TB_latency) {
+    *kernel = last;
+    // selected before, so start_cycle is set already
+    return std::find(m_executed_kernel_uids.begin(),
+                     m_executed_kernel_uids.end(),
+                     last->get_uid()) != m_executed_kernel_uids.end();
+  }
+  for (unsigned n = 0; n < m_running_kernels.size(); n++) {
+    if (kernel_more_cta_left(m_running_kernels[n]) &&
+        !m_running_kernels[n]->m_kernel_TB_latency)
+      return false;
+  }
+  *kernel = NULL;
+  return true;
+}
+
 kernel_info_t *gpgpu_sim::select_kernel() {
   if (m_running_kernels[m_last_issued_kernel] &&
       !m_running_kernels[m_last_issued_kernel]->no_more_ctas_to_run() &&
@@ -818,7 +927,11 @@ unsigned gpgpu_sim::finished_kernel() {
 }
 
 void gpgpu_sim::set_kernel_done(kernel_info_t *kernel) {
+  if (m_cta_sampler)
+    m_cta_sampler->kernel_done(kernel, get_cta_sample_counters());
   unsigned uid = kernel->get_uid();
+  if (m_warp_trace) m_warp_trace->kernel_done(uid, get_global_memory());
+  if (uid > m_last_done_kernel_uid) m_last_done_kernel_uid = uid;
   m_finished_kernel.push_back(uid);
   std::vector<kernel_info_t *>::iterator k;
   for (k = m_running_kernels.begin(); k != m_running_kernels.end(); k++) {
@@ -843,10 +956,17 @@ void gpgpu_sim::stop_all_running_kernels() {
 
 void exec_gpgpu_sim::createSIMTCluster() {
   m_cluster = new simt_core_cluster *[m_shader_config->n_simt_clusters];
-  for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++)
+  m_cluster_stats.clear();
+  for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++) {
+    shader_core_stats *stats = m_shader_stats;
+    if (m_concurrent_cores) {
+      stats = new shader_core_stats(m_shader_stats);
+      m_cluster_stats.push_back(stats);
+    }
     m_cluster[i] =
         new exec_simt_core_cluster(this, i, m_shader_config, m_memory_config,
-                                   m_shader_stats, m_memory_stats);
+                                   stats, m_memory_stats);
+  }
 }
 
 gpgpu_sim::gpgpu_sim(const gpgpu_sim_config &config, gpgpu_context *ctx)
@@ -855,11 +975,20 @@ gpgpu_sim::gpgpu_sim(const gpgpu_sim_config &config, gpgpu_context *ctx)
   m_shader_config = &m_config.m_shader_config;
   m_memory_config = &m_config.m_memory_config;
   ctx->ptx_parser->set_ptx_warp_size(m_shader_config);
+  build_timing_model();
+
+  // Jin: functional simulation for CDP
+  m_functional_sim = false;
+  m_functional_sim_kernel = NULL;
+}
+
+void gpgpu_sim::build_timing_model() {
   ptx_file_line_stats_create_exposed_latency_tracker(m_config.num_shader());
 
 #ifdef GPGPUSIM_POWER_MODEL
-  m_gpgpusim_wrapper = new gpgpu_sim_wrapper(config.g_power_simulation_enabled,
-                                             config.g_power_config_name);
+  m_gpgpusim_wrapper =
+      new gpgpu_sim_wrapper(m_config.g_power_simulation_enabled,
+                            m_config.g_power_config_name);
 #endif
 
   m_shader_stats = new shader_core_stats(m_shader_config);
@@ -876,6 +1005,8 @@ gpgpu_sim::gpgpu_sim(const gpgpu_sim_config &config, gpgpu_context *ctx)
   gpu_tot_issued_cta = 0;
   gpu_completed_cta = 0;
   m_total_cta_launched = 0;
+  gpu_occupancy = occupancy_stats();
+  gpu_tot_occupancy = occupancy_stats();
   gpu_deadlock = false;
 
   gpu_stall_dramfull = 0;
@@ -903,14 +1034,14 @@ gpgpu_sim::gpgpu_sim(const gpgpu_sim_config &config, gpgpu_context *ctx)
       m_memory_link[i] = new memory_link(link_name,
           link_latency,
           m_n_mem_per_link,
-          m_memory_config, ctx);
+          m_memory_config, gpgpu_ctx);
       printf("Memory link\n");
     }
     else if (m_memory_config->compress_link >= 1 && m_memory_config->compress_link <= 6) {
       m_memory_link[i] = new compressed_memory_link(link_name,
           link_latency, comp_latency, decomp_latency,
           m_n_mem_per_link,
-          m_memory_config, ctx);
+          m_memory_config, gpgpu_ctx);
       printf("Compressed memory link\n");
     }
     else {
@@ -939,11 +1070,75 @@ gpgpu_sim::gpgpu_sim(const gpgpu_sim_config &config, gpgpu_context *ctx)
   icnt_create(m_shader_config->n_simt_clusters,
               m_memory_config->m_n_mem_sub_partition);
 
+  m_n_not_completed = 0;
+  m_n_busy_sub_partitions = 0;
+  m_idle_check_wait = 0;
+  m_idle_check_backoff = 1;
+  m_last_done_kernel_uid = 0;
+  m_uarch_checkpoint_saved = false;
+  m_uarch_checkpoint_restored = false;
+#if SIM_PROFILE_ON
+  m_profile = new sim_profile();
+#else
+  m_profile = NULL;
+#endif
+
+  m_warp_trace = NULL;
+  if (m_config.gpgpu_trace_capture && m_config.gpgpu_trace_replay) {
+    printf("GPGPU-Sim uArch: ERROR ** -gpgpu_trace_capture and "
+           "-gpgpu_trace_replay are exclusive\n");
+    abort();
+  }
+  if (m_config.gpgpu_trace_capture)
+    m_warp_trace = new warp_trace(m_config.gpgpu_trace_capture, false);
+  if (m_config.gpgpu_trace_replay)
+    m_warp_trace = new warp_trace(m_config.gpgpu_trace_replay, true);
+
+  m_cta_sampler = NULL;
+  if (m_config.gpgpu_cta_sampling) {
+    if (m_shader_config->gpgpu_concurrent_kernel_sm) {
+      printf("GPGPU-Sim uArch: -gpgpu_cta_sampling ignored with "
+             "-gpgpu_concurrent_kernel_sm\n");
+    } else if (m_warp_trace) {
+      // fast-forwarded CTAs run on the functional model only
+      printf("GPGPU-Sim uArch: -gpgpu_cta_sampling ignored with a trace\n");
+    } else {
+      m_cta_sampler = new cta_sampler(m_config.gpgpu_cta_sample_interval,
+                                      m_config.gpgpu_cta_sample_threshold);
+    }
+  }
+
+  m_workers = NULL;
+  if (m_config.gpgpu_sim_threads > 1) {
+    m_workers = new worker_pool(m_config.gpgpu_sim_threads);
+    m_l2_stat_shards.resize(m_workers->size());
+    printf("GPGPU-Sim uArch: stepping with %u host threads\n",
+           m_workers->size());
+  }
+  // The clusters step at once unless their effects must come out in the
+  // serial order as they happen: traces and CTA sampling record them, the
+  // debug output prints them, RANDOM address decoding draws from one
+  // generator, and the data of the packets the clusters send is read back
+  // through a log of the global memory writes.
+  m_concurrent_cores =
+      m_workers && !m_warp_trace && !m_cta_sampler &&
+      !g_interactive_debugger_enabled && !Trace::enabled &&
+      g_debug_execution == 0 &&
+      !gpgpu_ctx->func_sim->gpgpu_ptx_instruction_classification &&
+      !m_config.get_ptx_inst_debug_to_file() &&
+      !m_memory_config->m_address_mapping.serial_decode() &&
+      get_global_memory()->log_writes(NULL);
+  if (m_workers && !m_concurrent_cores)
+    printf("GPGPU-Sim uArch: the SM clusters step serially\n");
+  m_cluster_done.assign(m_shader_config->n_simt_clusters, 0);
+  m_cluster_stepped.assign(m_shader_config->n_simt_clusters, 0);
+  m_core_write_log = m_concurrent_cores ? new mem_write_log : NULL;
+
   time_vector_create(NUM_MEM_REQ_STAT);
   fprintf(stdout,
           "GPGPU-Sim uArch: performance model initialization complete.\n");
 
-  m_running_kernels.resize(config.max_concurrent_kernel, NULL);
+  m_running_kernels.resize(m_config.max_concurrent_kernel, NULL);
   m_last_issued_kernel = 0;
   m_last_cluster_issue = m_shader_config->n_simt_clusters -
                          1;  // this causes first launch to use simt cluster 0
@@ -984,10 +1179,16 @@ gpgpu_sim::gpgpu_sim(const gpgpu_sim_config &config, gpgpu_context *ctx)
     printf("ERROR: Compressor option is not specified\n");
     exit(1);
   }
+}
 
-  // Jin: functional simulation for CDP
-  m_functional_sim = false;
-  m_functional_sim_kernel = NULL;
+void gpgpu_sim::rebuild_timing_model() {
+  // the old host threads did not survive the fork; the pool is abandoned
+  m_workers = NULL;
+  build_timing_model();
+  createSIMTCluster();
+  // its stats start at the sweep kernel
+  gpu_sim_cycle = 0;
+  gpu_tot_sim_cycle = 0;
 }
 
 int gpgpu_sim::shared_mem_size() const {
@@ -1074,12 +1275,8 @@ bool gpgpu_sim::active() {
       (gpu_completed_cta >= m_config.gpu_max_completed_cta_opt))
     return false;
   if (m_config.gpu_deadlock_detect && gpu_deadlock) return false;
-  for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++)
-    if (m_cluster[i]->get_not_completed() > 0) return true;
-  ;
-  for (unsigned i = 0; i < m_memory_config->m_n_mem; i++)
-    if (m_memory_partition_unit[i]->busy() > 0) return true;
-  ;
+  if (m_n_not_completed) return true;
+  if (__atomic_load_n(&m_n_busy_sub_partitions, __ATOMIC_RELAXED)) return true;
   if (icnt_busy()) return true;
   if (get_more_cta_left()) return true;
   return false;
@@ -1096,11 +1293,15 @@ void gpgpu_sim::init() {
   partiton_replys_in_parallel = 0;
   partiton_reqs_in_parallel_util = 0;
   gpu_sim_cycle_parition_util = 0;
+  m_idle_check_wait = 0;
+  m_idle_check_backoff = 1;
 
   reinit_clock_domains();
   gpgpu_ctx->func_sim->set_param_gpgpu_num_shaders(m_config.num_shader());
   for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++)
     m_cluster[i]->reinit();
+  if (m_config.gpgpu_uarch_restore && !m_uarch_checkpoint_restored)
+    restore_uarch_checkpoint();
   m_shader_stats->new_grid();
   // initialize the control-flow, memory access, memory latency logger
   if (m_config.g_visualizer_enabled) {
@@ -1152,6 +1353,80 @@ void gpgpu_sim::update_stats() {
   m_total_cta_launched = 0;
   gpu_completed_cta = 0;
   gpu_occupancy = occupancy_stats();
+
+  if (m_config.gpgpu_uarch_checkpoint_kernel && !m_uarch_checkpoint_saved &&
+      m_last_done_kernel_uid >= m_config.gpgpu_uarch_checkpoint_kernel) {
+    // kernels still running (-gpgpu_concurrent_kernel_sm, CDP) hold state
+    // the checkpoint does not capture; try again at the next drain
+    if (active()) {
+      printf("GPGPU-Sim uArch: GPU not drained after kernel %u, timing model "
+             "checkpoint deferred\n",
+             m_last_done_kernel_uid);
+    } else {
+      save_uarch_checkpoint();
+    }
+  }
+}
+
+void gpgpu_sim::checkpoint_state(uarch_checkpoint &cp) {
+  cp.section("gpgpu_sim", (unsigned long long)m_shader_config->num_shader()
+                                  << 32 |
+                              m_memory_config->m_n_mem << 16 |
+                              m_memory_config->m_n_mem_link);
+  cp.io(gpu_tot_sim_cycle);
+  cp.io(gpu_tot_sim_insn);
+  cp.io(gpu_tot_issued_cta);
+  cp.io(partiton_reqs_in_parallel_total);
+  cp.io(partiton_replys_in_parallel_total);
+  cp.io(partiton_reqs_in_parallel_util_total);
+  cp.io(gpu_tot_sim_cycle_parition_util);
+  cp.io(gpu_tot_occupancy);
+  cp.io(gpu_stall_dramfull);
+  cp.io(gpu_stall_icnt2sh);
+  m_shader_stats->checkpoint_state(cp);
+  m_memory_stats->checkpoint_state(cp);
+  // the compressors learn from the lines they have seen; a snapshot restored
+  // under another -compress_link leaves the new compressor as built
+  if (cp.variant("compressor", m_memory_config->compress_link)) {
+    if (g_comp) g_comp->checkpoint_state(cp);
+  } else {
+    printf("GPGPU-Sim uArch: checkpoint was taken with another "
+           "-compress_link, compressor state not restored\n");
+  }
+  cp.end_variant();
+  for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++)
+    m_cluster[i]->checkpoint_state(cp);
+  for (unsigned i = 0; i < m_memory_config->m_n_mem; i++)
+    m_memory_partition_unit[i]->checkpoint_state(cp);
+  for (unsigned i = 0; i < m_memory_config->m_n_mem_link; i++)
+    m_memory_link[i]->checkpoint_state(cp);
+}
+
+void gpgpu_sim::save_uarch_checkpoint() {
+  {
+    uarch_checkpoint cp(m_config.gpgpu_uarch_checkpoint_file,
+                        uarch_checkpoint::SAVE);
+    cp.io(m_last_done_kernel_uid);
+    checkpoint_state(cp);
+  }
+  m_uarch_checkpoint_saved = true;
+  printf("GPGPU-Sim uArch: timing model checkpoint after kernel %u saved to "
+         "%s\n",
+         m_last_done_kernel_uid, m_config.gpgpu_uarch_checkpoint_file);
+}
+
+void gpgpu_sim::restore_uarch_checkpoint() {
+  unsigned kernel_uid;
+  {
+    uarch_checkpoint cp(m_config.gpgpu_uarch_checkpoint_file,
+                        uarch_checkpoint::RESTORE);
+    cp.io(kernel_uid);
+    checkpoint_state(cp);
+  }
+  m_uarch_checkpoint_restored = true;
+  printf("GPGPU-Sim uArch: timing model restored from %s, taken after kernel "
+         "%u\n",
+         m_config.gpgpu_uarch_checkpoint_file, kernel_uid);
 }
 
 void gpgpu_sim::print_stats() {
@@ -1384,6 +1659,7 @@ void gpgpu_sim::gpu_print_stat() {
   // performance counter for stalls due to congestion.
   printf("gpu_stall_dramfull = %d\n", gpu_stall_dramfull);
   printf("gpu_stall_icnt2sh    = %d\n", gpu_stall_icnt2sh);
+  gpgpu_ctx->func_sim->print_thread_pool_stats(statfout);
 
   // printf("partiton_reqs_in_parallel = %lld\n", partiton_reqs_in_parallel);
   // printf("partiton_reqs_in_parallel_total    = %lld\n",
@@ -1762,7 +2038,7 @@ void shader_core_ctx::issue_block2core(kernel_info_t &kernel) {
   function_info *kernel_func_info = kernel.entry();
   symbol_table *symtab = kernel_func_info->get_symtab();
   unsigned ctaid = kernel.get_next_cta_id_single();
-  checkpoint *g_checkpoint = new checkpoint();
+  checkpoint *g_checkpoint = new checkpoint(m_gpu->checkpoint_binary);
   for (unsigned i = start_thread; i < end_thread; i++) {
     m_threadState[i].m_cta_id = free_cta_hw_id;
     unsigned warp_id = i / m_config->warp_size;
@@ -1770,6 +2046,8 @@ void shader_core_ctx::issue_block2core(kernel_info_t &kernel) {
         kernel, &m_thread[i], m_sid, i, cta_size - (i - start_thread),
         m_config->n_thread_per_shader, this, free_cta_hw_id, warp_id,
         m_cluster->get_gpu());
+    if (m_gpu->concurrent_cores() && m_thread[i])
+      m_thread[i]->set_insn_counter(m_cluster->ptx_insn_counter());
     m_threadState[i].m_active = true;
     // load thread local memory and register file
     if (m_gpu->resume_option == 1 && kernel.get_uid() == m_gpu->resume_kernel &&
@@ -1781,7 +2059,7 @@ void shader_core_ctx::issue_block2core(kernel_info_t &kernel) {
       char f1name[2048];
       snprintf(f1name, 2048, "checkpoint_files/local_mem_thread_%d_%d_reg.txt",
                i % cta_size, ctaid);
-      g_checkpoint->load_global_mem(m_thread[i]->m_local_mem, f1name);
+      g_checkpoint->load_global_mem(m_thread[i]->local_mem(), f1name);
     }
     //
     warps.set(warp_id);
@@ -1807,6 +2085,13 @@ void shader_core_ctx::issue_block2core(kernel_info_t &kernel) {
   init_warps(free_cta_hw_id, start_thread, end_thread, ctaid, cta_size, kernel);
   m_n_active_cta++;
 
+  m_cta_kernel[free_cta_hw_id] = &kernel;
+  m_cta_ctaid[free_cta_hw_id] = ctaid;
+  if (m_gpu->get_cta_sampler())
+    m_gpu->get_cta_sampler()->cta_issued(
+        &kernel, ctaid, max_cta_per_core * m_config->num_shader(),
+        m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle);
+
   shader_CTA_count_log(m_sid, 1);
   SHADER_DPRINTF(LIVENESS,
                  "GPGPU-Sim uArch: cta:%2u, start_tid:%4u, end_tid:%4u, "
@@ -1851,6 +2136,7 @@ int gpgpu_sim::next_clock_domain(void) {
 }
 
 void gpgpu_sim::issue_block2core() {
+  if (m_cta_sampler && m_cta_sampler->hold_issue()) return;
   unsigned last_issued = m_last_cluster_issue;
   for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++) {
     unsigned idx = (i + last_issued + 1) % m_shader_config->n_simt_clusters;
@@ -1862,20 +2148,417 @@ void gpgpu_sim::issue_block2core() {
   }
 }
 
+cta_sample_counters gpgpu_sim::get_cta_sample_counters() const {
+  cta_sample_counters now;
+  now.cycle = gpu_sim_cycle + gpu_tot_sim_cycle;
+  for (unsigned d = 0; d < 2; d++) {
+    now.link_data_size[d] = 0;
+    now.link_packet_size[d] = 0;
+  }
+  for (unsigned i = 0; i < m_memory_config->m_n_mem_link; i++)
+    m_memory_link[i]->add_data_size(now.link_data_size, now.link_packet_size);
+  return now;
+}
+
+// Runs the next interval of a drained sampled kernel on the functional model.
+// One interval per core cycle keeps the stream manager and any other running
+// kernel serviced in between.
+void gpgpu_sim::cta_sample_cycle() {
+  kernel_info_t *kernel = m_cta_sampler->kernel();
+  if (!kernel || !m_cta_sampler->fast_forwarding(
+                     kernel->running(), gpu_sim_cycle + gpu_tot_sim_cycle))
+    return;
+
+  unsigned end = m_cta_sampler->interval_end(kernel->get_next_cta_id_single());
+  unsigned n_ctas = 0;
+  while (!kernel->no_more_ctas_to_run() &&
+         kernel->get_next_cta_id_single() < end) {
+    functionalCoreSim cta(kernel, this, m_shader_config->warp_size);
+    cta.count_pcs(m_cta_sampler->functional_pcs());
+    cta.execute(0, kernel->get_next_cta_id_single());
+    n_ctas++;
+  }
+  m_cta_sampler->functional_interval_done(n_ctas);
+  if (kernel->no_more_ctas_to_run()) set_kernel_done(kernel);
+}
+
 unsigned long long g_single_step =
     0;  // set this in gdb to single step the pipeline
 
+// Steps the memory links on every clock edge and the dram channels behind
+// them on dram edges. A channel only shares its link with the other channels
+// on that link, so with worker threads each link and its channels are one
+// work item. Compressed links all share g_comp and stay serial around it.
+void gpgpu_sim::memory_cycle(bool dram_edge) {
+  const double n_flit = m_memory_config->n_flit_per_mem_cycle;
+  const unsigned n_link = m_memory_config->m_n_mem_link;
+  bool serial_links = !m_workers || m_memory_config->compress_link != 0;
+
+  if (serial_links) {
+    SIM_PROFILE_PHASE(*m_profile, PROF_UPLINK);
+    for (unsigned i = 0; i < n_link; i++) m_memory_link[i]->uplink_step(n_flit);
+  }
+  if (!m_workers) {
+    if (dram_edge) {
+      SIM_PROFILE_PHASE(*m_profile, PROF_DRAM_CYCLE);
+      for (unsigned i = 0; i < m_memory_config->m_n_mem; i++) dram_cycle(i);
+    }
+  } else if (dram_edge || !serial_links) {
+    SIM_PROFILE_PHASE(*m_profile, PROF_DRAM_CYCLE);
+    m_memory_dram_edge = dram_edge;
+    m_memory_serial_links = serial_links;
+    m_workers->run(n_link, memory_cycle_task, this);
+  }
+  if (serial_links) {
+    SIM_PROFILE_PHASE(*m_profile, PROF_DNLINK);
+    for (unsigned i = 0; i < n_link; i++) m_memory_link[i]->dnlink_step(n_flit);
+  }
+
+  if (dram_edge) {
+    for (unsigned i = 0; i < m_memory_config->m_n_mem; i++)
+      m_memory_partition_unit[i]->flush_dram_stats();
+  }
+}
+
+void gpgpu_sim::memory_cycle_task(void *arg, unsigned link, unsigned worker) {
+  gpgpu_sim *gpu = (gpgpu_sim *)arg;
+  const memory_config *config = gpu->m_memory_config;
+  const double n_flit = config->n_flit_per_mem_cycle;
+  if (!gpu->m_memory_serial_links)
+    gpu->m_memory_link[link]->uplink_step(n_flit);
+  if (gpu->m_memory_dram_edge) {
+    unsigned first = link * config->m_n_mem_per_link;
+    unsigned last = std::min(first + config->m_n_mem_per_link, config->m_n_mem);
+    for (unsigned i = first; i < last; i++) gpu->dram_cycle(i);
+  }
+  if (!gpu->m_memory_serial_links)
+    gpu->m_memory_link[link]->dnlink_step(n_flit);
+}
+
+void gpgpu_sim::dram_cycle(unsigned i) {
+  if (m_memory_config->simple_dram_model)
+    m_memory_partition_unit[i]->simple_dram_model_cycle();
+  else
+    m_memory_partition_unit[i]
+        ->dram_cycle();  // Issue the dram command (scheduler + delay model)
+  // Update performance counters for DRAM
+  m_memory_partition_unit[i]->set_dram_power_stats(
+      m_power_stats->pwr_mem_stat->n_cmd[CURRENT_STAT_IDX][i],
+      m_power_stats->pwr_mem_stat->n_activity[CURRENT_STAT_IDX][i],
+      m_power_stats->pwr_mem_stat->n_nop[CURRENT_STAT_IDX][i],
+      m_power_stats->pwr_mem_stat->n_act[CURRENT_STAT_IDX][i],
+      m_power_stats->pwr_mem_stat->n_pre[CURRENT_STAT_IDX][i],
+      m_power_stats->pwr_mem_stat->n_rd[CURRENT_STAT_IDX][i],
+      m_power_stats->pwr_mem_stat->n_wr[CURRENT_STAT_IDX][i],
+      m_power_stats->pwr_mem_stat->n_req[CURRENT_STAT_IDX][i]);
+}
+
+// Steps the L2 of every memory sub partition once the interconnect requests
+// have been moved in. Sub partitions are independent here, so with worker
+// threads each worker sums the L2 stats of its sub partitions into its shard
+// and the shards are added in worker order. Write-backs decode their address
+// as they are created, so RANDOM partition indexing keeps this serial.
+void gpgpu_sim::l2_cycle() {
+  cache_stats &l2_stats =
+      m_power_stats->pwr_mem_stat->l2_cache_stats[CURRENT_STAT_IDX];
+  l2_stats.clear();
+  if (!m_workers || m_memory_config->m_address_mapping.serial_decode()) {
+    for (unsigned i = 0; i < m_memory_config->m_n_mem_sub_partition; i++) {
+      m_memory_sub_partition[i]->cache_cycle(gpu_sim_cycle + gpu_tot_sim_cycle);
+      m_memory_sub_partition[i]->accumulate_L2cache_stats(l2_stats);
+    }
+    return;
+  }
+
+  for (unsigned w = 0; w < m_l2_stat_shards.size(); w++)
+    m_l2_stat_shards[w].clear();
+  m_workers->run(m_memory_config->m_n_mem_sub_partition, l2_cycle_task, this);
+  for (unsigned w = 0; w < m_l2_stat_shards.size(); w++)
+    l2_stats += m_l2_stat_shards[w];
+}
+
+void gpgpu_sim::l2_cycle_task(void *arg, unsigned sub_partition,
+                              unsigned worker) {
+  gpgpu_sim *gpu = (gpgpu_sim *)arg;
+  memory_sub_partition *sp = gpu->m_memory_sub_partition[sub_partition];
+  sp->cache_cycle(gpu->gpu_sim_cycle + gpu->gpu_tot_sim_cycle);
+  sp->accumulate_L2cache_stats(gpu->m_l2_stat_shards[worker]);
+}
+
+// Steps the SM clusters on the worker threads. A cluster runs on its own
+// until it is about to do something the other clusters or the rest of the
+// GPU can see, and from there on waits for the lower-numbered clusters (see
+// simt_core_cluster::order()), so such effects happen in cluster order as
+// when stepping serially. Stats the clusters share are kept per cluster and
+// merged in order. Their requests to the interconnect are staged against
+// the room their inputs had and made here in cluster order; the packet data
+// is read from global memory then and the writes made after each request
+// are undone from the log of the edge.
+void gpgpu_sim::core_cycle_concurrent(bool more_cta_left) {
+  const unsigned n = m_shader_config->n_simt_clusters;
+  m_core_more_cta_left = more_cta_left;
+  m_core_write_log->clear();
+  for (unsigned i = 0; i < n; i++) {
+    m_cluster_done[i] = 0;
+    m_cluster_stepped[i] = 0;
+    m_cluster[i]->begin_concurrent_cycle(*m_core_write_log);
+  }
+  get_global_memory()->log_writes(m_core_write_log);
+  m_workers->run(n, core_cycle_task, this);
+  get_global_memory()->log_writes(NULL);
+  size_t log_pos = 0;
+  for (unsigned i = 0; i < n; i++) m_cluster[i]->drain_icnt(log_pos);
+}
+
+void gpgpu_sim::core_cycle_task(void *arg, unsigned cluster,
+                                unsigned worker) {
+  gpgpu_sim *gpu = (gpgpu_sim *)arg;
+  simt_core_cluster *c = gpu->m_cluster[cluster];
+  if (gpu->m_core_more_cta_left || c->get_not_completed()) {
+    c->core_cycle();
+    gpu->m_cluster_stepped[cluster] = 1;
+  }
+  c->end_concurrent_cycle();
+  __atomic_store_n(&gpu->m_cluster_done[cluster], 1, __ATOMIC_RELEASE);
+}
+
+void gpgpu_sim::wait_lower_clusters(unsigned cluster) {
+  for (unsigned i = 0; i < cluster; i++) {
+    while (!__atomic_load_n(&m_cluster_done[i], __ATOMIC_ACQUIRE))
+      sched_yield();
+  }
+}
+
+void gpgpu_sim::merge_core_stats() {
+  for (unsigned i = 0; i < m_cluster_stats.size(); i++)
+    m_cluster_stats[i]->merge();
+}
+
+// Jumps over the clock edges on which no unit can act: every core is idle or
+// only has warps waiting on loads, barriers or instruction misses, no CTA
+// can be issued, the interconnect is empty, and the memory side only counts
+// down link flits, column commands in the dram channels, and the DRAM
+// latency and ROP queues. The edges next_clock_domain() would take are
+// counted up to the first one on which a unit has work due or a cycle
+// hook runs; all four clock domains then move there at once, and each unit
+// adds the stats of its skipped edges in bulk. Proving quiescence walks
+// every warp, so a failed try is repeated with an exponential backoff.
+void gpgpu_sim::fast_forward() {
+  if (m_idle_check_wait) {
+    m_idle_check_wait--;
+    return;
+  }
+  skip_edges_t s;
+  s.edges = 0;
+  if (quiet()) {
+    count_skip_edges(s, ULLONG_MAX);
+    // the links bound the edges of all domains
+    unsigned long long max_edges = s.edges;
+    const double n_flit = m_memory_config->n_flit_per_mem_cycle;
+    for (unsigned i = 0; i < m_memory_config->m_n_mem_link && max_edges; i++)
+      max_edges = m_memory_link[i]->quiet_edges(n_flit, max_edges);
+    if (max_edges < s.edges) count_skip_edges(s, max_edges);
+  }
+  if (!s.edges) {
+    m_idle_check_wait = m_idle_check_backoff;
+    m_idle_check_backoff = std::min(2 * m_idle_check_backoff, 1024u);
+    return;
+  }
+  m_idle_check_backoff = 1;
+  skip_edges(s);
+}
+
+// The state fast_forward() needs, and the bounds it counts edges against
+bool gpgpu_sim::quiet() {
+  if (m_config.g_power_simulation_enabled || m_config.gpgpu_flush_l2_cache ||
+      g_single_step || g_interactive_debugger_enabled)
+    return false;
+#if (CUDART_VERSION >= 5000)
+  if (!gpgpu_ctx->device_runtime->g_cuda_device_launch_op.empty())
+    return false;
+#endif
+  stream_manager *streams = gpgpu_ctx->the_gpgpusim->g_stream_manager;
+  if (!m_finished_kernel.empty() || (streams && !streams->quiet()))
+    return false;
+  if (m_cta_sampler && m_cta_sampler->kernel()) return false;
+  if (!::icnt_idle()) return false;
+  for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++)
+    if (!m_cluster[i]->quiet()) return false;
+  if (m_cta_sampler && m_cta_sampler->hold_issue()) return true;
+  for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++)
+    if (m_cluster[i]->can_issue_block()) return false;
+  return true;
+}
+
+// Counts the edges next_clock_domain() would take from now, up to
+// max_edges, stopping before the first edge on which the L2, a dram channel
+// or the core clock has something to do. Fills in s from the current state.
+void gpgpu_sim::count_skip_edges(skip_edges_t &s,
+                                 unsigned long long max_edges) const {
+  const unsigned long long now = gpu_sim_cycle + gpu_tot_sim_cycle;
+
+  // the hooks run on the core edge that brings gpu_sim_cycle to `hook`
+  unsigned long long freq = m_config.gpu_stat_sample_freq;
+  unsigned long long hook = (gpu_sim_cycle / freq + 1) * freq;
+  hook = std::min(hook, (gpu_sim_cycle / 100000 + 1) * 100000);
+  hook = std::min(hook, next_stat_tool_cycle(gpu_sim_cycle));
+  if (m_config.gpu_max_cycle_opt)
+    hook = std::min(hook, m_config.gpu_max_cycle_opt - gpu_tot_sim_cycle);
+  s.max_core = hook - 1 - gpu_sim_cycle;
+  // CTAs held back by the launch latency become issuable once it reaches 0
+  for (unsigned n = 0; n < m_running_kernels.size(); n++) {
+    kernel_info_t *kernel = m_running_kernels[n];
+    if (kernel_more_cta_left(kernel) && kernel->m_kernel_TB_latency)
+      s.max_core = std::min<unsigned long long>(s.max_core,
+                                                kernel->m_kernel_TB_latency);
+  }
+
+  s.l2_ready = ULLONG_MAX;
+  for (unsigned i = 0; i < m_memory_config->m_n_mem_sub_partition; i++)
+    s.l2_ready =
+        std::min(s.l2_ready, m_memory_sub_partition[i]->idle_until(now));
+  // a sub partition holding a request moves it on the next L2 or
+  // interconnect edge
+  if (s.l2_ready <= now) max_edges = 0;
+  s.max_dram = ULLONG_MAX;
+  s.dram_ready = ULLONG_MAX;
+  for (unsigned i = 0; i < m_memory_config->m_n_mem; i++) {
+    s.max_dram =
+        std::min(s.max_dram, m_memory_partition_unit[i]->quiet_dram_cycles());
+    s.dram_ready =
+        std::min(s.dram_ready, m_memory_partition_unit[i]->dram_ready_cycle());
+  }
+
+  s.core_time = core_time;
+  s.icnt_time = icnt_time;
+  s.dram_time = dram_time;
+  s.l2_time = l2_time;
+  s.edges = s.core = s.icnt = s.dram = s.l2 = 0;
+  for (; s.edges < max_edges; s.edges++) {
+    // next_clock_domain()
+    double smallest = min3(s.core_time, s.icnt_time, s.dram_time);
+    bool l2_edge = s.l2_time <= smallest;
+    if (l2_edge) smallest = s.l2_time;
+    bool icnt_edge = s.icnt_time <= smallest;
+    bool dram_edge = s.dram_time <= smallest;
+    bool core_edge = s.core_time <= smallest;
+    // the cycle the L2 and dram see on this edge
+    unsigned long long cycle = now + s.core;
+    if (l2_edge && cycle >= s.l2_ready) break;
+    if (dram_edge && (s.dram == s.max_dram || cycle >= s.dram_ready)) break;
+    if (core_edge && s.core == s.max_core) break;
+    if (l2_edge) {
+      s.l2_time += m_config.l2_period;
+      s.l2++;
+    }
+    if (icnt_edge) {
+      s.icnt_time += m_config.icnt_period;
+      s.icnt++;
+    }
+    if (dram_edge) {
+      s.dram_time += m_config.dram_period;
+      s.dram++;
+    }
+    if (core_edge) {
+      s.core_time += m_config.core_period;
+      s.core++;
+    }
+  }
+}
+
+// The edges s counts, as cycle() would step them on a quiet() GPU
+void gpgpu_sim::skip_edges(const skip_edges_t &s) {
+  core_time = s.core_time;
+  icnt_time = s.icnt_time;
+  dram_time = s.dram_time;
+  l2_time = s.l2_time;
+
+  // memory_cycle()
+  const double n_flit = m_memory_config->n_flit_per_mem_cycle;
+  for (unsigned i = 0; i < m_memory_config->m_n_mem_link; i++)
+    m_memory_link[i]->skip(n_flit, s.edges);
+  if (s.dram) {
+    for (unsigned i = 0; i < m_memory_config->m_n_mem; i++) {
+      m_memory_partition_unit[i]->skip_dram(s.dram);
+      m_memory_partition_unit[i]->set_dram_power_stats(
+          m_power_stats->pwr_mem_stat->n_cmd[CURRENT_STAT_IDX][i],
+          m_power_stats->pwr_mem_stat->n_activity[CURRENT_STAT_IDX][i],
+          m_power_stats->pwr_mem_stat->n_nop[CURRENT_STAT_IDX][i],
+          m_power_stats->pwr_mem_stat->n_act[CURRENT_STAT_IDX][i],
+          m_power_stats->pwr_mem_stat->n_pre[CURRENT_STAT_IDX][i],
+          m_power_stats->pwr_mem_stat->n_rd[CURRENT_STAT_IDX][i],
+          m_power_stats->pwr_mem_stat->n_wr[CURRENT_STAT_IDX][i],
+          m_power_stats->pwr_mem_stat->n_req[CURRENT_STAT_IDX][i]);
+      m_memory_partition_unit[i]->flush_dram_stats();
+    }
+  }
+
+  if (s.l2) {
+    cache_stats &l2_stats =
+        m_power_stats->pwr_mem_stat->l2_cache_stats[CURRENT_STAT_IDX];
+    l2_stats.clear();
+    for (unsigned i = 0; i < m_memory_config->m_n_mem_sub_partition; i++) {
+      if (m_memory_sub_partition[i]->full(SECTOR_CHUNCK_SIZE))
+        gpu_stall_dramfull += s.l2;
+      m_memory_sub_partition[i]->idle_cycles(s.l2);
+      m_memory_sub_partition[i]->accumulate_L2cache_stats(l2_stats);
+    }
+  }
+
+  if (s.icnt) ::icnt_skip(s.icnt);
+
+  if (s.core) {
+    cache_stats &core_stats =
+        m_power_stats->pwr_mem_stat->core_cache_stats[CURRENT_STAT_IDX];
+    core_stats.clear();
+    bool more_cta_left = get_more_cta_left();
+    unsigned long long active = 0, total = 0;
+    for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++) {
+      if (more_cta_left || m_cluster[i]->get_not_completed()) {
+        m_cluster[i]->skip(s.core);
+        *active_sms += (float)s.core * m_cluster[i]->get_n_active_sms();
+      }
+      m_cluster[i]->get_icnt_stats(
+          m_power_stats->pwr_mem_stat->n_simt_to_mem[CURRENT_STAT_IDX][i],
+          m_power_stats->pwr_mem_stat->n_mem_to_simt[CURRENT_STAT_IDX][i]);
+      m_cluster[i]->get_cache_stats(core_stats);
+      m_cluster[i]->get_current_occupancy(active, total);
+    }
+    merge_core_stats();
+    gpu_occupancy.aggregate_warp_slot_filled += s.core * active;
+    gpu_occupancy.aggregate_theoretical_warp_slots += s.core * total;
+    float temp = 0;
+    for (unsigned i = 0; i < m_shader_config->num_shader(); i++) {
+      temp += m_shader_stats->m_pipeline_duty_cycle[i];
+    }
+    temp = temp / m_shader_config->num_shader();
+    *average_pipeline_duty_cycle += s.core * temp;
+
+    gpu_sim_cycle += s.core;
+    for (unsigned n = 0; n < m_running_kernels.size(); n++) {
+      kernel_info_t *kernel = m_running_kernels[n];
+      if (kernel)
+        kernel->m_kernel_TB_latency -= std::min<unsigned long long>(
+            kernel->m_kernel_TB_latency, s.core);
+    }
+  }
+}
+
 void gpgpu_sim::cycle() {
+  SIM_PROFILE_PHASE(*m_profile, PROF_CYCLE);
+  if (m_config.gpgpu_idle_fast_forward) fast_forward();
   int clock_mask = next_clock_domain();
 
   if (clock_mask & CORE) {
     // shader core loading (pop from ICNT into core) follows CORE clock
+    SIM_PROFILE_PHASE(*m_profile, PROF_ICNT_CYCLE);
     for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++)
       m_cluster[i]->icnt_cycle();
   }
   unsigned partiton_replys_in_parallel_per_cycle = 0;
   if (clock_mask & ICNT) {
     // pop from memory controller to interconnect
+    SIM_PROFILE_PHASE(*m_profile, PROF_PARTITION_POP);
     for (unsigned i = 0; i < m_memory_config->m_n_mem_sub_partition; i++) {
       mem_fetch *mf = m_memory_sub_partition[i]->top();
       if (mf) {
@@ -1899,46 +2582,13 @@ void gpgpu_sim::cycle() {
   }
   partiton_replys_in_parallel += partiton_replys_in_parallel_per_cycle;
 
-  // up link
-  if (clock_mask && DRAM) {
-    for (unsigned i = 0; i < m_memory_config->m_n_mem_link; i++) {
-      m_memory_link[i]->uplink_step(m_memory_config->n_flit_per_mem_cycle);
-    }
-  }
-  
-  // dram
-  if (clock_mask & DRAM) {
-    for (unsigned i = 0; i < m_memory_config->m_n_mem; i++) {
-      if (m_memory_config->simple_dram_model)
-        m_memory_partition_unit[i]->simple_dram_model_cycle();
-      else
-        m_memory_partition_unit[i]
-            ->dram_cycle();  // Issue the dram command (scheduler + delay model)
-      // Update performance counters for DRAM
-      m_memory_partition_unit[i]->set_dram_power_stats(
-          m_power_stats->pwr_mem_stat->n_cmd[CURRENT_STAT_IDX][i],
-          m_power_stats->pwr_mem_stat->n_activity[CURRENT_STAT_IDX][i],
-          m_power_stats->pwr_mem_stat->n_nop[CURRENT_STAT_IDX][i],
-          m_power_stats->pwr_mem_stat->n_act[CURRENT_STAT_IDX][i],
-          m_power_stats->pwr_mem_stat->n_pre[CURRENT_STAT_IDX][i],
-          m_power_stats->pwr_mem_stat->n_rd[CURRENT_STAT_IDX][i],
-          m_power_stats->pwr_mem_stat->n_wr[CURRENT_STAT_IDX][i],
-          m_power_stats->pwr_mem_stat->n_req[CURRENT_STAT_IDX][i]);
-    }
-  }
-
-  // down link
-  if (clock_mask && DRAM) {
-    for (unsigned i = 0; i < m_memory_config->m_n_mem_link; i++) {
-      m_memory_link[i]->dnlink_step(m_memory_config->n_flit_per_mem_cycle);
-      
-    }
-  }
+  // memory links and dram
+  memory_cycle(clock_mask & DRAM);
 
   // L2 operations follow L2 clock domain
   unsigned partiton_reqs_in_parallel_per_cycle = 0;
   if (clock_mask & L2) {
-    m_power_stats->pwr_mem_stat->l2_cache_stats[CURRENT_STAT_IDX].clear();
+    SIM_PROFILE_PHASE(*m_profile, PROF_CACHE_CYCLE);
     for (unsigned i = 0; i < m_memory_config->m_n_mem_sub_partition; i++) {
       // move memory request from interconnect into memory partition (if not
       // backed up) Note:This needs to be called in DRAM clock domain if there
@@ -1951,10 +2601,8 @@ void gpgpu_sim::cycle() {
         m_memory_sub_partition[i]->push(mf, gpu_sim_cycle + gpu_tot_sim_cycle);
         if (mf) partiton_reqs_in_parallel_per_cycle++;
       }
-      m_memory_sub_partition[i]->cache_cycle(gpu_sim_cycle + gpu_tot_sim_cycle);
-      m_memory_sub_partition[i]->accumulate_L2cache_stats(
-          m_power_stats->pwr_mem_stat->l2_cache_stats[CURRENT_STAT_IDX]);
     }
+    l2_cycle();
   }
   partiton_reqs_in_parallel += partiton_reqs_in_parallel_per_cycle;
   if (partiton_reqs_in_parallel_per_cycle > 0) {
@@ -1963,26 +2611,37 @@ void gpgpu_sim::cycle() {
   }
 
   if (clock_mask & ICNT) {
+    SIM_PROFILE_PHASE(*m_profile, PROF_ICNT_TRANSFER);
     icnt_transfer();
   }
 
   if (clock_mask & CORE) {
     // L1 cache + shader core pipeline stages
     m_power_stats->pwr_mem_stat->core_cache_stats[CURRENT_STAT_IDX].clear();
-    for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++) {
-      if (m_cluster[i]->get_not_completed() || get_more_cta_left()) {
-        m_cluster[i]->core_cycle();
-        *active_sms += m_cluster[i]->get_n_active_sms();
+    bool more_cta_left = get_more_cta_left();
+    {
+      SIM_PROFILE_PHASE(*m_profile, PROF_CORE_CYCLE);
+      if (m_concurrent_cores) core_cycle_concurrent(more_cta_left);
+      for (unsigned i = 0; i < m_shader_config->n_simt_clusters; i++) {
+        if (m_concurrent_cores) {
+          if (m_cluster_stepped[i])
+            *active_sms += m_cluster[i]->get_n_active_sms();
+        } else if (more_cta_left || m_cluster[i]->get_not_completed()) {
+          m_cluster[i]->core_cycle();
+          *active_sms += m_cluster[i]->get_n_active_sms();
+        }
+        m_cluster[i]->commit_sim_insn();
+        // Update core icnt/cache stats for GPUWattch
+        m_cluster[i]->get_icnt_stats(
+            m_power_stats->pwr_mem_stat->n_simt_to_mem[CURRENT_STAT_IDX][i],
+            m_power_stats->pwr_mem_stat->n_mem_to_simt[CURRENT_STAT_IDX][i]);
+        m_cluster[i]->get_cache_stats(
+            m_power_stats->pwr_mem_stat->core_cache_stats[CURRENT_STAT_IDX]);
+        m_cluster[i]->get_current_occupancy(
+            gpu_occupancy.aggregate_warp_slot_filled,
+            gpu_occupancy.aggregate_theoretical_warp_slots);
       }
-      // Update core icnt/cache stats for GPUWattch
-      m_cluster[i]->get_icnt_stats(
-          m_power_stats->pwr_mem_stat->n_simt_to_mem[CURRENT_STAT_IDX][i],
-          m_power_stats->pwr_mem_stat->n_mem_to_simt[CURRENT_STAT_IDX][i]);
-      m_cluster[i]->get_cache_stats(
-          m_power_stats->pwr_mem_stat->core_cache_stats[CURRENT_STAT_IDX]);
-      m_cluster[i]->get_current_occupancy(
-          gpu_occupancy.aggregate_warp_slot_filled,
-          gpu_occupancy.aggregate_theoretical_warp_slots);
+      merge_core_stats();
     }
     float temp = 0;
     for (unsigned i = 0; i < m_shader_config->num_shader(); i++) {
@@ -2004,6 +2663,7 @@ void gpgpu_sim::cycle() {
       // McPAT main cycle (interface with McPAT)
 #ifdef GPGPUSIM_POWER_MODEL
     if (m_config.g_power_simulation_enabled) {
+      SIM_PROFILE_PHASE(*m_profile, PROF_MCPAT_CYCLE);
       mcpat_cycle(m_config, getShaderCoreConfig(), m_gpgpusim_wrapper,
                   m_power_stats, m_config.gpu_stat_sample_freq,
                   gpu_tot_sim_cycle, gpu_sim_cycle, gpu_tot_sim_insn,
@@ -2011,6 +2671,7 @@ void gpgpu_sim::cycle() {
     }
 #endif
 
+    if (m_cta_sampler) cta_sample_cycle();
     issue_block2core();
     decrement_kernel_latency();
 
@@ -2050,6 +2711,7 @@ void gpgpu_sim::cycle() {
     }
 
     if (!(gpu_sim_cycle % m_config.gpu_stat_sample_freq)) {
+      SIM_PROFILE_PHASE(*m_profile, PROF_STAT_SAMPLE);
       time_t days, hrs, minutes, sec;
       time_t curr_time;
       time(&curr_time);
@@ -2076,6 +2738,9 @@ void gpgpu_sim::cycle() {
                  (unsigned)((gpu_tot_sim_insn + gpu_sim_insn) / elapsed_time),
                  (unsigned)days, (unsigned)hrs, (unsigned)minutes,
                  (unsigned)sec, ctime(&curr_time));
+#if SIM_PROFILE_ON
+        m_profile->print_interval(stdout);
+#endif
         fflush(stdout);
         last_liveness_message_time = elapsed_time;
       }
@@ -2119,6 +2784,12 @@ void gpgpu_sim::cycle() {
   }
 }
 
+void gpgpu_sim::print_self_profile(FILE *fout) {
+#if SIM_PROFILE_ON
+  m_profile->print(fout);
+#endif
+}
+
 void shader_core_ctx::dump_warp_state(FILE *fout) const {
   fprintf(fout, "\n");
   fprintf(fout, "per warp functional simulation status:\n");
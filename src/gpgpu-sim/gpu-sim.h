@@ -390,6 +390,10 @@ class gpgpu_sim_config : public power_config,
 
   bool flush_l1() const { return gpgpu_flush_l1_cache; }
 
+  unsigned sweep_kernel() const { return gpgpu_sweep_kernel; }
+  const char *sweep_file() const { return gpgpu_sweep_file; }
+  unsigned sweep_jobs() const { return gpgpu_sweep_jobs; }
+
  private:
   void init_clock_domains(void);
 
@@ -421,6 +425,19 @@ class gpgpu_sim_config : public power_config,
   int gpgpu_cflog_interval;
   char *gpgpu_clock_domains;
   unsigned max_concurrent_kernel;
+  unsigned gpgpu_sim_threads;
+  bool gpgpu_idle_fast_forward;
+  bool gpgpu_cta_sampling;
+  unsigned gpgpu_cta_sample_interval;
+  double gpgpu_cta_sample_threshold;
+  unsigned gpgpu_uarch_checkpoint_kernel;
+  char *gpgpu_uarch_checkpoint_file;
+  bool gpgpu_uarch_restore;
+  unsigned gpgpu_sweep_kernel;
+  char *gpgpu_sweep_file;
+  unsigned gpgpu_sweep_jobs;
+  char *gpgpu_trace_capture;
+  char *gpgpu_trace_replay;
 
   // visualizer
   bool g_visualizer_enabled;
@@ -516,6 +533,9 @@ class gpgpu_sim : public gpgpu_t {
   void stop_all_running_kernels();
 
   void init();
+  // a sweep child's timing model, built anew from its options (after
+  // gpgpu_sim_config::init()); the functional state is kept
+  void rebuild_timing_model();
   void cycle();
   bool active();
   bool cycle_insn_cta_max_hit() {
@@ -530,8 +550,28 @@ class gpgpu_sim : public gpgpu_t {
   }
   void print_stats();
   void update_stats();
+  // time spent in each phase of cycle(); prints nothing unless built with
+  // PROFILE=1
+  void print_self_profile(FILE *fout);
   void deadlock_check();
   void inc_completed_cta() { gpu_completed_cta++; }
+  // activity counts behind active(), kept by the cores and sub partitions
+  // as threads and requests come and go
+  void add_not_completed(int n_threads) { m_n_not_completed += n_threads; }
+  void sub_partition_busy(bool busy) {
+    __atomic_add_fetch(&m_n_busy_sub_partitions, busy ? 1 : -1,
+                       __ATOMIC_RELAXED);
+  }
+  // true if -gpgpu_sim_threads steps the SM clusters at once
+  bool concurrent_cores() const { return m_concurrent_cores; }
+  // returns once the clusters below cluster are done with the core edge
+  void wait_lower_clusters(unsigned cluster);
+  // adds the core stats the clusters keep apart into the main ones
+  void merge_core_stats();
+  // NULL unless -gpgpu_cta_sampling
+  class cta_sampler *get_cta_sampler() const { return m_cta_sampler; }
+  // NULL unless -gpgpu_trace_capture or -gpgpu_trace_replay
+  class warp_trace *get_warp_trace() const { return m_warp_trace; }
   void get_pdom_stack_top_info(unsigned sid, unsigned tid, unsigned *pc,
                                unsigned *rpc);
 
@@ -553,6 +593,8 @@ class gpgpu_sim : public gpgpu_t {
   bool kernel_more_cta_left(kernel_info_t *kernel) const;
   bool hit_max_cta_count() const;
   kernel_info_t *select_kernel();
+  // true if select_kernel() would change nothing; *kernel is what it returns
+  bool select_kernel_stable(kernel_info_t **kernel) const;
   void decrement_kernel_latency();
 
   const gpgpu_sim_config &get_config() const { return m_config; }
@@ -607,6 +649,34 @@ class gpgpu_sim : public gpgpu_t {
   void gpgpu_debug();
 
  protected:
+  void memory_cycle(bool dram_edge);
+  static void memory_cycle_task(void *arg, unsigned link, unsigned worker);
+  void dram_cycle(unsigned partition);
+  void l2_cycle();
+  static void l2_cycle_task(void *arg, unsigned sub_partition, unsigned worker);
+  void core_cycle_concurrent(bool more_cta_left);
+  static void core_cycle_task(void *arg, unsigned cluster, unsigned worker);
+  // clock edges fast_forward() skips, counted per domain, and the bounds
+  // they are counted against
+  struct skip_edges_t {
+    unsigned long long max_core;    // core edges before a hook or CTA issue
+    unsigned long long max_dram;    // dram edges before a channel moves
+    unsigned long long l2_ready;    // cycle of the first ROP release
+    unsigned long long dram_ready;  // cycle of the first DRAM latency release
+    unsigned long long edges, core, icnt, dram, l2;
+    double core_time, icnt_time, dram_time, l2_time;
+  };
+  void fast_forward();
+  bool quiet();
+  void count_skip_edges(skip_edges_t &s, unsigned long long max_edges) const;
+  void skip_edges(const skip_edges_t &s);
+  struct cta_sample_counters get_cta_sample_counters() const;
+  void cta_sample_cycle();
+  // caches, DRAM and links of the drained GPU, and the running totals
+  void checkpoint_state(class uarch_checkpoint &cp);
+  void save_uarch_checkpoint();
+  void restore_uarch_checkpoint();
+
   ///// data /////
   class simt_core_cluster **m_cluster;
   class memory_partition_unit **m_memory_partition_unit;
@@ -619,6 +689,41 @@ class gpgpu_sim : public gpgpu_t {
   // m_total_cta_launched == per-kernel count. gpu_tot_issued_cta == global
 
   class memory_link **m_memory_link;
+
+  // host threads for -gpgpu_sim_threads > 1, NULL when stepping serially
+  class worker_pool *m_workers;
+  // per-worker partial sums of the L2 stats gathered each L2 cycle
+  std::vector<cache_stats> m_l2_stat_shards;
+  // edge being stepped by memory_cycle_task
+  bool m_memory_dram_edge;
+  bool m_memory_serial_links;
+  // the SM clusters step on m_workers too, unless something they do would
+  // have to be serial; each keeps the core stats totals apart in
+  // m_cluster_stats
+  bool m_concurrent_cores;
+  std::vector<class shader_core_stats *> m_cluster_stats;
+  // core edge being stepped by core_cycle_task: clusters done with it and
+  // clusters stepped at all, and the global memory writes they made
+  bool m_core_more_cta_left;
+  std::vector<unsigned char> m_cluster_done;
+  std::vector<unsigned char> m_cluster_stepped;
+  class mem_write_log *m_core_write_log;
+  // threads not completed on all cores, sub partitions with requests in
+  // flight; the latter changes from the L2 worker threads
+  unsigned long long m_n_not_completed;
+  int m_n_busy_sub_partitions;
+  // -gpgpu_idle_fast_forward
+  unsigned m_idle_check_wait;     // edges before quiet() is tried again
+  unsigned m_idle_check_backoff;  // wait set by the next failed try
+  class cta_sampler *m_cta_sampler;
+  class warp_trace *m_warp_trace;
+  // -gpgpu_uarch_checkpoint_kernel / -gpgpu_uarch_restore
+  unsigned m_last_done_kernel_uid;
+  bool m_uarch_checkpoint_saved;
+  bool m_uarch_checkpoint_restored;
+  // phase timers of cycle(), NULL unless built with PROFILE=1 (a pointer so
+  // the layout does not depend on the build flag)
+  class sim_profile *m_profile;
   
   // count.
   unsigned long long m_total_cta_launched;
@@ -666,6 +771,8 @@ class gpgpu_sim : public gpgpu_t {
   void clear_executed_kernel_info();  //< clear the kernel information after
                                       // stat printout
   virtual void createSIMTCluster() = 0;
+  // everything but the functional state and the clusters
+  void build_timing_model();
 
  public:
   unsigned long long gpu_sim_insn;
@@ -35,10 +35,14 @@
 icnt_create_p icnt_create;
 icnt_init_p icnt_init;
 icnt_has_buffer_p icnt_has_buffer;
+icnt_input_space_p icnt_input_space;
+icnt_packet_space_p icnt_packet_space;
 icnt_push_p icnt_push;
 icnt_pop_p icnt_pop;
 icnt_transfer_p icnt_transfer;
 icnt_busy_p icnt_busy;
+icnt_idle_p icnt_idle;
+icnt_skip_p icnt_skip;
 icnt_display_stats_p icnt_display_stats;
 icnt_display_overall_stats_p icnt_display_overall_stats;
 icnt_display_state_p icnt_display_state;
@@ -47,6 +51,10 @@ icnt_get_flit_size_p icnt_get_flit_size;
 unsigned g_network_mode;
 char* g_network_config_filename;
 
+// packets pushed and not yet popped. Both networks hold a packet from push
+// until pop, so this answers icnt_busy() without walking every buffer.
+static unsigned long long g_icnt_n_packets = 0;
+
 struct inct_config g_inct_config;
 LocalInterconnect* g_localicnt_interface;
 
@@ -65,18 +73,37 @@ static bool intersim2_has_buffer(unsigned input, unsigned int size) {
   return g_icnt_interface->HasBuffer(input, size);
 }
 
+static unsigned intersim2_input_space(unsigned input) {
+  return g_icnt_interface->InputSpace(input);
+}
+
+static unsigned intersim2_packet_space(unsigned int size) {
+  return g_icnt_interface->PacketSpace(size);
+}
+
 static void intersim2_push(unsigned input, unsigned output, void* data,
                            unsigned int size) {
   g_icnt_interface->Push(input, output, data, size);
+  g_icnt_n_packets++;
 }
 
 static void* intersim2_pop(unsigned output) {
-  return g_icnt_interface->Pop(output);
+  void* data = g_icnt_interface->Pop(output);
+  if (data) g_icnt_n_packets--;
+  return data;
 }
 
 static void intersim2_transfer() { g_icnt_interface->Advance(); }
 
-static bool intersim2_busy() { return g_icnt_interface->Busy(); }
+static bool intersim2_busy() { return g_icnt_n_packets != 0; }
+
+static bool intersim2_idle() {
+  return g_icnt_n_packets == 0 && g_icnt_interface->Idle();
+}
+
+static void intersim2_skip(unsigned long long n) {
+  g_icnt_interface->Skip(n);
+}
 
 static void intersim2_display_stats() { g_icnt_interface->DisplayStats(); }
 
@@ -105,18 +132,37 @@ static bool LocalInterconnect_has_buffer(unsigned input, unsigned int size) {
   return g_localicnt_interface->HasBuffer(input, size);
 }
 
+static unsigned LocalInterconnect_input_space(unsigned input) {
+  return g_localicnt_interface->InputSpace(input);
+}
+
+static unsigned LocalInterconnect_packet_space(unsigned int size) {
+  return g_localicnt_interface->PacketSpace(size);
+}
+
 static void LocalInterconnect_push(unsigned input, unsigned output, void* data,
                                    unsigned int size) {
   g_localicnt_interface->Push(input, output, data, size);
+  g_icnt_n_packets++;
 }
 
 static void* LocalInterconnect_pop(unsigned output) {
-  return g_localicnt_interface->Pop(output);
+  void* data = g_localicnt_interface->Pop(output);
+  if (data) g_icnt_n_packets--;
+  return data;
 }
 
 static void LocalInterconnect_transfer() { g_localicnt_interface->Advance(); }
 
-static bool LocalInterconnect_busy() { return g_localicnt_interface->Busy(); }
+static bool LocalInterconnect_busy() { return g_icnt_n_packets != 0; }
+
+static bool LocalInterconnect_idle() {
+  return g_icnt_n_packets == 0 && g_localicnt_interface->Idle();
+}
+
+static void LocalInterconnect_skip(unsigned long long n) {
+  g_localicnt_interface->Skip(n);
+}
 
 static void LocalInterconnect_display_stats() {
   g_localicnt_interface->DisplayStats();
@@ -168,10 +214,14 @@ void icnt_wrapper_init() {
       icnt_create = intersim2_create;
       icnt_init = intersim2_init;
       icnt_has_buffer = intersim2_has_buffer;
+      icnt_input_space = intersim2_input_space;
+      icnt_packet_space = intersim2_packet_space;
       icnt_push = intersim2_push;
       icnt_pop = intersim2_pop;
       icnt_transfer = intersim2_transfer;
       icnt_busy = intersim2_busy;
+      icnt_idle = intersim2_idle;
+      icnt_skip = intersim2_skip;
       icnt_display_stats = intersim2_display_stats;
       icnt_display_overall_stats = intersim2_display_overall_stats;
       icnt_display_state = intersim2_display_state;
@@ -182,10 +232,14 @@ void icnt_wrapper_init() {
       icnt_create = LocalInterconnect_create;
       icnt_init = LocalInterconnect_init;
       icnt_has_buffer = LocalInterconnect_has_buffer;
+      icnt_input_space = LocalInterconnect_input_space;
+      icnt_packet_space = LocalInterconnect_packet_space;
       icnt_push = LocalInterconnect_push;
       icnt_pop = LocalInterconnect_pop;
       icnt_transfer = LocalInterconnect_transfer;
       icnt_busy = LocalInterconnect_busy;
+      icnt_idle = LocalInterconnect_idle;
+      icnt_skip = LocalInterconnect_skip;
       icnt_display_stats = LocalInterconnect_display_stats;
       icnt_display_overall_stats = LocalInterconnect_display_overall_stats;
       icnt_display_state = LocalInterconnect_display_state;
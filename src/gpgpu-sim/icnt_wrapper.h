@@ -36,11 +36,20 @@
 typedef void (*icnt_create_p)(unsigned n_shader, unsigned n_mem);
 typedef void (*icnt_init_p)();
 typedef bool (*icnt_has_buffer_p)(unsigned input, unsigned int size);
+// room left at an input, and how much of it a packet of size bytes takes;
+// icnt_has_buffer(input, size) is icnt_packet_space(size) <=
+// icnt_input_space(input) until the next icnt_push or icnt_transfer
+typedef unsigned (*icnt_input_space_p)(unsigned input);
+typedef unsigned (*icnt_packet_space_p)(unsigned int size);
 typedef void (*icnt_push_p)(unsigned input, unsigned output, void* data,
                             unsigned int size);
 typedef void* (*icnt_pop_p)(unsigned output);
 typedef void (*icnt_transfer_p)();
 typedef bool (*icnt_busy_p)();
+// true if icnt_transfer() would only advance the network clock
+typedef bool (*icnt_idle_p)();
+// n calls to icnt_transfer() on an idle network
+typedef void (*icnt_skip_p)(unsigned long long n);
 typedef void (*icnt_drain_p)();
 typedef void (*icnt_display_stats_p)();
 typedef void (*icnt_display_overall_stats_p)();
@@ -50,10 +59,14 @@ typedef unsigned (*icnt_get_flit_size_p)();
 extern icnt_create_p icnt_create;
 extern icnt_init_p icnt_init;
 extern icnt_has_buffer_p icnt_has_buffer;
+extern icnt_input_space_p icnt_input_space;
+extern icnt_packet_space_p icnt_packet_space;
 extern icnt_push_p icnt_push;
 extern icnt_pop_p icnt_pop;
 extern icnt_transfer_p icnt_transfer;
 extern icnt_busy_p icnt_busy;
+extern icnt_idle_p icnt_idle;
+extern icnt_skip_p icnt_skip;
 extern icnt_drain_p icnt_drain;
 extern icnt_display_stats_p icnt_display_stats;
 extern icnt_display_overall_stats_p icnt_display_overall_stats;
@@ -26,10 +26,12 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
 #include <list>
 #include <set>
 
@@ -45,6 +47,7 @@
 #include "mem_fetch.h"
 #include "mem_latency_stat.h"
 #include "shader.h"
+#include "uarch_checkpoint.h"
 
 mem_fetch *partition_mf_allocator::alloc(new_addr_type addr,
                                          mem_access_type type, unsigned size,
@@ -289,7 +292,42 @@ void memory_partition_unit::simple_dram_model_cycle() {
   //}
 }
 
+bool memory_partition_unit::dram_idle() const {
+  if (!m_dram->idle() || !m_dram_latency_queue.empty()) return false;
+  for (unsigned p = 0; p < m_config->m_n_sub_partition_per_memory_channel;
+       p++) {
+    if (!m_sub_partition[p]->L2_dram_queue_empty()) return false;
+  }
+  return true;
+}
+
+unsigned long long memory_partition_unit::quiet_dram_cycles() const {
+  for (unsigned p = 0; p < m_config->m_n_sub_partition_per_memory_channel;
+       p++) {
+    if (!m_sub_partition[p]->L2_dram_queue_empty()) return 0;
+  }
+  if (m_config->simple_dram_model) return ULLONG_MAX;
+  return m_dram->quiet_cycles();
+}
+
+unsigned long long memory_partition_unit::dram_ready_cycle() const {
+  if (m_dram_latency_queue.empty()) return ULLONG_MAX;
+  return m_dram_latency_queue.front().ready_cycle;
+}
+
+void memory_partition_unit::skip_dram(unsigned long long n) {
+  // the simple model keeps no per-cycle state besides the latency queue
+  if (!m_config->simple_dram_model) m_dram->skip(n);
+}
+
 void memory_partition_unit::dram_cycle() {
+  // nothing to move or schedule in this channel, only account for the cycle
+  if (dram_idle()) {
+    m_dram->idle_cycle();
+    m_dram->dram_log(SAMPLELOG);
+    return;
+  }
+
   // pop completed memory request from dram and push it to dram-to-L2 queue
   // of the original sub partition
   mem_fetch *mf_return = m_dram->return_queue_top();
@@ -367,6 +405,8 @@ void memory_partition_unit::dram_cycle() {
   }
 }
 
+void memory_partition_unit::flush_dram_stats() { m_dram->flush_shared_stats(); }
+
 void memory_partition_unit::set_done(mem_fetch *mf) {
   unsigned global_spid = mf->get_sub_partition_id();
   int spid = global_sub_partition_id_to_local_id(global_spid);
@@ -388,6 +428,16 @@ void memory_partition_unit::set_dram_power_stats(
                                n_wr, n_req);
 }
 
+void memory_partition_unit::checkpoint_state(uarch_checkpoint &cp) {
+  cp.section("memory_partition", m_id);
+  cp.require(m_dram_latency_queue.empty(), "dram latency queue");
+  m_dram->checkpoint_state(cp);
+  for (unsigned p = 0; p < m_config->m_n_sub_partition_per_memory_channel;
+       p++) {
+    m_sub_partition[p]->checkpoint_state(cp);
+  }
+}
+
 void memory_partition_unit::print(FILE *fp) const {
   fprintf(fp, "Memory Partition %u: \n", m_id);
   for (unsigned p = 0; p < m_config->m_n_sub_partition_per_memory_channel;
@@ -477,7 +527,7 @@ void memory_sub_partition::cache_cycle(unsigned cycle) {
               m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle);
           m_L2_icnt_queue->push(original_wr_mf);
         }
-        m_request_tracker.erase(mf);
+        untrack_request(mf);
         delete mf;
       }
     }
@@ -534,7 +584,7 @@ void memory_sub_partition::cache_cycle(unsigned cycle) {
             // L2 cache replies
             assert(!read_sent);
             if (mf->get_access_type() == L1_WRBK_ACC) {
-              m_request_tracker.erase(mf);
+              untrack_request(mf);
               delete mf;
             } else {
               mf->set_reply();
@@ -586,6 +636,20 @@ void memory_sub_partition::cache_cycle(unsigned cycle) {
   }
 }
 
+unsigned long long memory_sub_partition::idle_until(
+    unsigned long long cycle) const {
+  if (!m_icnt_L2_queue->empty() || !m_L2_icnt_queue->empty() ||
+      !dram_L2_queue_empty() || !L2_dram_queue_empty())
+    return cycle;
+  if (!m_config->m_L2_config.disabled() && !m_L2cache->idle()) return cycle;
+  if (m_rop.empty()) return ULLONG_MAX;
+  return std::max(cycle, m_rop.front().ready_cycle);
+}
+
+void memory_sub_partition::idle_cycles(unsigned long long n) {
+  if (!m_config->m_L2_config.disabled()) m_L2cache->idle_cycles(n);
+}
+
 bool memory_sub_partition::full() const { return m_icnt_L2_queue->full(); }
 
 bool memory_sub_partition::full(unsigned size) const {
@@ -696,6 +760,14 @@ void memory_sub_partition::print_cache_stat(unsigned &accesses,
   if (!m_config->m_L2_config.disabled()) m_L2cache->print(fp, accesses, misses);
 }
 
+void memory_sub_partition::checkpoint_state(uarch_checkpoint &cp) {
+  cp.section("memory_sub_partition", m_config->m_L2_config.disabled());
+  cp.require(m_request_tracker.empty() && idle_until(0) == ULLONG_MAX,
+             "L2 queues");
+  cp.io(m_memcpy_cycle_offset);
+  if (!m_config->m_L2_config.disabled()) m_L2cache->checkpoint_state(cp);
+}
+
 void memory_sub_partition::print(FILE *fp) const {
   if (!m_request_tracker.empty()) {
     fprintf(fp, "Memory Sub Parition %u: pending memory requests:\n", m_id);
@@ -865,7 +937,7 @@ void memory_sub_partition::push(mem_fetch *m_req, unsigned long long cycle) {
 
     for (unsigned i = 0; i < reqs.size(); ++i) {
       mem_fetch *req = reqs[i];
-      m_request_tracker.insert(req);
+      track_request(req);
       if (req->istexture()) {
         m_icnt_L2_queue->push(req);
         req->set_status(IN_PARTITION_ICNT_TO_L2_QUEUE,
@@ -884,7 +956,7 @@ void memory_sub_partition::push(mem_fetch *m_req, unsigned long long cycle) {
 
 mem_fetch *memory_sub_partition::pop() {
   mem_fetch *mf = m_L2_icnt_queue->pop();
-  m_request_tracker.erase(mf);
+  untrack_request(mf);
   if (mf && mf->isatomic()) mf->do_atomic();
   if (mf && (mf->get_access_type() == L2_WRBK_ACC ||
              mf->get_access_type() == L1_WRBK_ACC)) {
@@ -899,7 +971,7 @@ mem_fetch *memory_sub_partition::top() {
   if (mf && (mf->get_access_type() == L2_WRBK_ACC ||
              mf->get_access_type() == L1_WRBK_ACC)) {
     m_L2_icnt_queue->pop();
-    m_request_tracker.erase(mf);
+    untrack_request(mf);
     delete mf;
     mf = NULL;
   }
@@ -907,7 +979,17 @@ mem_fetch *memory_sub_partition::top() {
 }
 
 void memory_sub_partition::set_done(mem_fetch *mf) {
-  m_request_tracker.erase(mf);
+  untrack_request(mf);
+}
+
+void memory_sub_partition::track_request(mem_fetch *mf) {
+  if (m_request_tracker.empty()) m_gpu->sub_partition_busy(true);
+  m_request_tracker.insert(mf);
+}
+
+void memory_sub_partition::untrack_request(mem_fetch *mf) {
+  if (m_request_tracker.erase(mf) && m_request_tracker.empty())
+    m_gpu->sub_partition_busy(false);
 }
 
 void memory_sub_partition::accumulate_L2cache_stats(
@@ -72,10 +72,24 @@ class memory_partition_unit {
   ~memory_partition_unit();
 
   bool busy() const;
+  // true if no request is waiting for or inside the DRAM of this partition
+  bool dram_idle() const;
+  // dram cycles that can pass before a request moves in this channel, not
+  // counting the release of the DRAM latency queue (see dram_ready_cycle())
+  unsigned long long quiet_dram_cycles() const;
+  // cycle at which the oldest request leaves the DRAM latency queue, or
+  // ULLONG_MAX
+  unsigned long long dram_ready_cycle() const;
+  // n dram_cycle() calls within quiet_dram_cycles() and before
+  // dram_ready_cycle()
+  void skip_dram(unsigned long long n);
 
   void cache_cycle(unsigned cycle);
   void dram_cycle();
   void simple_dram_model_cycle();
+  // add the dram counters shared between channels to memory_stats_t; called
+  // serially for every channel after the dram clock edge
+  void flush_dram_stats();
 
   void set_done(mem_fetch *mf);
 
@@ -83,6 +97,7 @@ class memory_partition_unit {
   void print_stat(FILE *fp) { m_dram->print_stat(fp); }
   void visualize() const { m_dram->visualize(); }
   void print(FILE *fp) const;
+  void checkpoint_state(class uarch_checkpoint &cp);
   void handle_memcpy_to_gpu(size_t dst_start_addr, unsigned subpart_id,
                             mem_access_sector_mask_t mask);
 
@@ -166,6 +181,11 @@ class memory_sub_partition {
   bool busy() const;
 
   void cache_cycle(unsigned cycle);
+  // first cycle at which cache_cycle() may move a request: `cycle` if one
+  // can move now, the ROP release of the oldest request, or ULLONG_MAX
+  unsigned long long idle_until(unsigned long long cycle) const;
+  // n cache_cycle() calls of a sub partition that is idle until a later cycle
+  void idle_cycles(unsigned long long n);
 
   bool full() const;
   bool full(unsigned size) const;
@@ -194,6 +214,7 @@ class memory_sub_partition {
   void visualizer_print(gzFile visualizer_file);
   void print_cache_stat(unsigned &accesses, unsigned &misses) const;
   void print(FILE *fp) const;
+  void checkpoint_state(class uarch_checkpoint &cp);
 
   void accumulate_L2cache_stats(class cache_stats &l2_stats) const;
   void get_L2cache_sub_stats(struct cache_sub_stats &css) const;
@@ -237,6 +258,10 @@ class memory_sub_partition {
   class memory_stats_t *m_stats;
 
   std::set<mem_fetch *> m_request_tracker;
+  // insert into / erase from m_request_tracker, telling the gpu when the sub
+  // partition turns busy or idle
+  void track_request(mem_fetch *mf);
+  void untrack_request(mem_fetch *mf);
 
   friend class L2interface;
 
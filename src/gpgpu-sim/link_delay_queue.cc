@@ -10,7 +10,8 @@ link_delay_queue::link_delay_queue(const char* nm,
     unsigned int size, unsigned int latency, 
     gpgpu_context *ctx)
   : m_name(nm), m_size(size), m_latency(latency), m_ctx(ctx),
-    m_wr_ptr(latency - 1), m_rd_ptr(-1), m_arr_size(size + latency)
+    m_wr_ptr(latency - 1), m_rd_ptr(-1), m_arr_size(size + latency),
+    m_n_mf(0)
 {
   assert(latency);
 
@@ -57,6 +58,7 @@ void link_delay_queue::push(bool is_head, bool is_tail, mem_fetch* mf)
   m_wr_ptr = (m_wr_ptr + 1) % m_arr_size;
 
   m_data_array[m_wr_ptr] = mf;
+  if (mf) m_n_mf++;
   m_is_head_array[m_wr_ptr] = is_head;
   m_is_tail_array[m_wr_ptr] = is_tail;
 //  assert ((m_wr_ptr % m_arr_size) != (m_rd_ptr % m_arr_size));
@@ -67,6 +69,7 @@ mem_fetch* link_delay_queue::pop()
   assert (!empty());
   
   mem_fetch *result = NULL;
+  if (m_data_array[m_rd_ptr]) m_n_mf--;
   if (m_is_tail_array[m_rd_ptr]) {
     result = m_data_array[m_rd_ptr];
     //printf("MDQ::pop  %p %d\n", result, m_rd_ptr);
@@ -82,6 +85,34 @@ mem_fetch* link_delay_queue::pop()
   return result;
 }
 
+unsigned link_delay_queue::size() const
+{
+  if (m_rd_ptr == -1) return 0;
+  return (m_wr_ptr - m_rd_ptr + m_arr_size) % m_arr_size + 1;
+}
+
+unsigned long long link_delay_queue::leading_empty() const
+{
+  if (!has_mf()) return (unsigned long long)-1;
+  unsigned long long n = 0;
+  while (!m_data_array[(m_rd_ptr + n) % m_arr_size]) n++;
+  return n;
+}
+
+void link_delay_queue::skip(unsigned long long n)
+{
+  assert(!empty() && n <= leading_empty());
+  const unsigned occupied = size();
+  m_rd_ptr = (m_rd_ptr + n % m_arr_size) % m_arr_size;
+  m_wr_ptr = (m_wr_ptr + n % m_arr_size) % m_arr_size;
+  // the newest entries are the empty flits pushed
+  for (unsigned i=0; i<n && i<occupied; i++) {
+    unsigned ptr = (m_wr_ptr + m_arr_size - i) % m_arr_size;
+    m_data_array[ptr] = NULL;
+    m_is_head_array[ptr] = false;
+    m_is_tail_array[ptr] = false;
+  }
+}
 
 void link_delay_queue::print() const
 {
@@ -26,6 +26,14 @@ public:
 
   bool full();
   bool empty();
+  // true while any flit of a request is still in the queue
+  bool has_mf() const { return m_n_mf != 0; }
+  // flits in the queue
+  unsigned size() const;
+  // flits ahead of the first one that carries a request
+  unsigned long long leading_empty() const;
+  // n pops and n pushes of empty flits, none of which pops a request
+  void skip(unsigned long long n);
 
   void print() const;
 
@@ -38,6 +46,7 @@ protected:
     unsigned int m_latency;
     unsigned int m_size;
     const unsigned int m_arr_size;
+    unsigned int m_n_mf;  // flits in the queue that carry a request
 
     int m_wr_ptr;
     int m_rd_ptr;
@@ -61,6 +70,7 @@ public:
     void push(mem_fetch* mf, unsigned size);
     std::pair<mem_fetch *, unsigned> top();
     void pop();
+    bool empty() const { return m_rd_ptr == m_wr_ptr; }
 
     void print() const;
 
@@ -278,6 +278,14 @@ bool xbar_router::Busy() const {
   return false;
 }
 
+void xbar_router::Skip(unsigned long long n) {
+  assert(!Busy());
+  // an empty crossbar only moves the round robin pointer and the cycle count
+  if (arbit_type == NAIVE_RR)
+    next_node_id = (next_node_id + n % total_nodes) % total_nodes;
+  cycles += n;
+}
+
 ////////////////////////////////////////////////////
 /////////////LocalInterconnect/////////////////////
 
@@ -364,6 +372,16 @@ bool LocalInterconnect::Busy() const {
   return false;
 }
 
+bool LocalInterconnect::Idle() const {
+  return !m_inct_config.verbose && !Busy();
+}
+
+void LocalInterconnect::Skip(unsigned long long n) {
+  for (unsigned i = 0; i < n_subnets; ++i) {
+    net[i]->Skip(n);
+  }
+}
+
 bool LocalInterconnect::HasBuffer(unsigned deviceID, unsigned int size) const {
   bool has_buffer = false;
 
@@ -375,6 +393,14 @@ bool LocalInterconnect::HasBuffer(unsigned deviceID, unsigned int size) const {
   return has_buffer;
 }
 
+unsigned LocalInterconnect::InputSpace(unsigned deviceID) const {
+  const xbar_router* router =
+      (n_subnets > 1) && deviceID >= n_shader ? net[REPLY_NET] : net[REQ_NET];
+  size_t used = router->in_buffers[deviceID].size();
+
+  return used < router->in_buffer_limit ? router->in_buffer_limit - used : 0;
+}
+
 void LocalInterconnect::DisplayStats() const {
   printf("Req_Network_injected_packets_num = %lld\n",
          net[REQ_NET]->packets_num);
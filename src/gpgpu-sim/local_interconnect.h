@@ -61,6 +61,8 @@ class xbar_router {
   void Advance();
 
   bool Busy() const;
+  // n calls to Advance() while !Busy()
+  void Skip(unsigned long long n);
   bool Has_Buffer_In(unsigned input_deviceID, unsigned size,
                      bool update_counter = false);
   bool Has_Buffer_Out(unsigned output_deviceID, unsigned size);
@@ -121,7 +123,12 @@ class LocalInterconnect {
   void* Pop(unsigned ouput_deviceID);
   void Advance();
   bool Busy() const;
+  bool Idle() const;
+  void Skip(unsigned long long n);
   bool HasBuffer(unsigned deviceID, unsigned int size) const;
+  // packets left in the input buffer; every packet takes one
+  unsigned InputSpace(unsigned deviceID) const;
+  unsigned PacketSpace(unsigned int size) const { return 1; }
   void DisplayStats() const;
   void DisplayOverallStats() const;
   unsigned GetFlitSize() const;
@@ -58,7 +58,9 @@ mem_fetch::mem_fetch(const mem_access_t &access, const warp_inst_t *inst,
     : m_access(access)
 
 {
-  m_request_uid = sm_next_mf_request_uid++;
+  // L2 write backs are allocated from worker threads with -gpgpu_sim_threads
+  m_request_uid =
+      __atomic_fetch_add(&sm_next_mf_request_uid, 1, __ATOMIC_RELAXED);
   m_access = access;
   if (inst) {
     m_inst = *inst;
@@ -37,6 +37,7 @@
 #include "mem_fetch.h"
 #include "shader.h"
 #include "stat-tool.h"
+#include "uarch_checkpoint.h"
 #include "visualizer.h"
 
 #include <math.h>
@@ -239,10 +240,7 @@ void memory_stats_t::memlatstat_dram_access(mem_fetch *mf) {
     mem_access_type_stats[mf->get_access_type()][dram_id][bank] +=
         ceil(mf->get_data_size() / m_memory_config->dram_atom_size);
   }
-
-  if (mf->get_pc() != (unsigned)-1)
-    m_gpu->gpgpu_ctx->stats->ptx_file_line_stats_add_dram_traffic(
-        mf->get_pc(), mf->get_data_size());
+  // the ptx line dram traffic is added by dram_t::flush_shared_stats()
 }
 
 void memory_stats_t::memlatstat_icnt2mem_pop(mem_fetch *mf) {
@@ -524,3 +522,66 @@ void memory_stats_t::memlatstat_print(unsigned n_mem, unsigned gpu_mem_n_bk) {
     printf("\naverage position of mrq chosen = %f\n", (float)l / k);
   }
 }
+
+void memory_stats_t::checkpoint_state(uarch_checkpoint &cp) {
+  unsigned n_mem = m_memory_config->m_n_mem;
+  unsigned nbk = m_memory_config->nbk;
+  cp.section("memory_stats",
+             (unsigned long long)m_n_shader << 32 | n_mem << 16 | nbk);
+  cp.io(max_mrq_latency);
+  cp.io(max_dq_latency);
+  cp.io(max_mf_latency);
+  cp.io(max_icnt2mem_latency);
+  cp.io(tot_icnt2mem_latency);
+  cp.io(tot_icnt2sh_latency);
+  cp.io(tot_mrq_latency);
+  cp.io(tot_mrq_num);
+  cp.io(max_icnt2sh_latency);
+  cp.io(mrq_lat_table);
+  cp.io(dq_lat_table);
+  cp.io(mf_lat_table);
+  cp.io(icnt2mem_lat_table);
+  cp.io(icnt2sh_lat_table);
+  cp.io(mf_lat_pw_table);
+  cp.io(mf_num_lat_pw);
+  cp.io(mf_tot_lat_pw);
+  cp.io(mf_total_lat);
+  cp.io(num_mfs);
+  for (unsigned s = 0; s < m_n_shader; s++) {
+    for (unsigned i = 0; i < n_mem; i++) {
+      cp.io(bankwrites[s][i], nbk);
+      cp.io(bankreads[s][i], nbk);
+    }
+  }
+  for (unsigned i = 0; i < n_mem; i++) {
+    cp.io(mf_total_lat_table[i], nbk);
+    cp.io(mf_max_lat_table[i], nbk);
+    cp.io(totalbankwrites[i], nbk);
+    cp.io(totalbankreads[i], nbk);
+    cp.io(totalbankaccesses[i], nbk);
+    cp.io(concurrent_row_access[i], nbk);
+    cp.io(num_activates[i], nbk);
+    cp.io(row_access[i], nbk);
+    cp.io(max_conc_access2samerow[i], nbk);
+    cp.io(max_servicetime2samerow[i], nbk);
+  }
+  cp.io(num_MCBs_accessed, n_mem * nbk);
+  unsigned queue_size = m_memory_config->gpgpu_frfcfs_dram_sched_queue_size;
+  cp.io(position_of_mrq_chosen, queue_size ? queue_size : 1024);
+  for (unsigned t = 0; t < NUM_MEM_ACCESS_TYPE; t++)
+    for (unsigned i = 0; i < n_mem; i++)
+      cp.io(mem_access_type_stats[t][i], nbk + 1);
+  cp.io(L2_read_miss);
+  cp.io(L2_write_miss);
+  cp.io(L2_read_hit);
+  cp.io(L2_write_hit);
+  cp.io(L2_cbtoL2length, n_mem);
+  cp.io(L2_cbtoL2writelength, n_mem);
+  cp.io(L2_L2tocblength, n_mem);
+  cp.io(L2_dramtoL2length, n_mem);
+  cp.io(L2_dramtoL2writelength, n_mem);
+  cp.io(L2_L2todramlength, n_mem);
+  cp.io(total_n_access);
+  cp.io(total_n_reads);
+  cp.io(total_n_writes);
+}
@@ -52,6 +52,8 @@ class memory_stats_t {
   // Reset local L2 stats that are aggregated each sampling window
   void clear_L2_stats_pw();
 
+  void checkpoint_state(class uarch_checkpoint &cp);
+
   unsigned m_n_shader;
 
   const shader_core_config *m_shader_config;
@@ -1,4 +1,5 @@
 #include "memory_link.h"
+#include "uarch_checkpoint.h"
 
 memory_link::memory_link(const char* nm,
     unsigned link_latency,
@@ -90,6 +91,52 @@ void memory_link::uplink_pop(unsigned mem_id)
   m_up->pop(mem_id);
 }
 
+bool memory_link::idle() const
+{
+  return m_dn->idle() && m_up->idle();
+}
+
+unsigned long long memory_link::quiet_edges(double n_flit,
+    unsigned long long max_edges) const
+{
+  unsigned dn_max_step, up_max_step;
+  const unsigned long long dn_quiet = m_dn->quiet_flits(&dn_max_step);
+  const unsigned long long up_quiet = m_up->quiet_flits(&up_max_step);
+  if (!dn_quiet || !up_quiet) return 0;
+
+  // replay the rounding of dnlink_step()/uplink_step()
+  double dn_rem = dnlink_remainder;
+  double up_rem = uplink_remainder;
+  unsigned long long dn_flits = 0, up_flits = 0;
+  unsigned long long n = 0;
+  for (; n < max_edges; n++) {
+    unsigned dn = (unsigned) (n_flit + dn_rem);
+    unsigned up = (unsigned) (n_flit + up_rem);
+    if (dn > dn_max_step || dn > dn_quiet - dn_flits) break;
+    if (up > up_max_step || up > up_quiet - up_flits) break;
+    dn_flits += dn;
+    up_flits += up;
+    dn_rem = (n_flit + dn_rem) - dn;
+    up_rem = (n_flit + up_rem) - up;
+  }
+  return n;
+}
+
+void memory_link::skip(double n_flit, unsigned long long n_edges)
+{
+  unsigned long long dn_flits = 0, up_flits = 0;
+  for (unsigned long long n = 0; n < n_edges; n++) {
+    unsigned dn = (unsigned) (n_flit + dnlink_remainder);
+    unsigned up = (unsigned) (n_flit + uplink_remainder);
+    dn_flits += dn;
+    up_flits += up;
+    dnlink_remainder = (n_flit + dnlink_remainder) - dn;
+    uplink_remainder = (n_flit + uplink_remainder) - up;
+  }
+  m_dn->skip(dn_flits);
+  m_up->skip(up_flits);
+}
+
 void memory_link::print() const
 {
   m_dn->print();
@@ -101,6 +148,23 @@ void memory_link::print_stat() const
   m_up->print_stat();
 }
 
+void memory_link::add_data_size(unsigned long long *data,
+                                unsigned long long *packet) const
+{
+  data[0] += m_dn->data_size();
+  packet[0] += m_dn->data_packet_size();
+  data[1] += m_up->data_size();
+  packet[1] += m_up->data_packet_size();
+}
+
+void memory_link::checkpoint_state(uarch_checkpoint &cp)
+{
+  cp.io(dnlink_remainder);
+  cp.io(uplink_remainder);
+  m_dn->checkpoint_state(cp);
+  m_up->checkpoint_state(cp);
+}
+
 compressed_memory_link::compressed_memory_link(const char* nm,
     unsigned link_latency, unsigned comp_latency, unsigned decomp_latency,
     unsigned n_mem_per_link,
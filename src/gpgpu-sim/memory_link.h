@@ -37,9 +37,24 @@ public:
   mem_fetch *uplink_top(unsigned mem_id);
   void uplink_pop(unsigned mem_id);
 
+  // no request on either link
+  bool idle() const;
+  // edges, up to max_edges, of n_flit flits on both links before a request
+  // is delivered; 0 if one is waiting to be sent or collected
+  unsigned long long quiet_edges(double n_flit,
+                                 unsigned long long max_edges) const;
+  // n_edges calls to dnlink_step(n_flit) and uplink_step(n_flit), within
+  // quiet_edges()
+  void skip(double n_flit, unsigned long long n_edges);
+
   // methods related to the printing
   void print() const;
   void print_stat() const;
+  // payload and wire bits carried so far, added to data[]/packet[] as
+  // {down, up}
+  void add_data_size(unsigned long long *data,
+                     unsigned long long *packet) const;
+  void checkpoint_state(class uarch_checkpoint &cp);
 
 protected:
   double dnlink_remainder;
@@ -1,5 +1,6 @@
 #include "oneway_link.h"
 #include "comp.h"
+#include "uarch_checkpoint.h"
 
 //extern gpgpu_sim* g_the_gpu;
 
@@ -62,6 +63,30 @@ bool oneway_link::empty(unsigned dst_id)
 {
   return (m_complete_list[dst_id].size()==0);
 }
+bool oneway_link::ends_empty() const
+{
+  for (unsigned i=0; i<m_src_cnt; i++)
+    if (!m_ready_list[i].empty()) return false;
+  for (unsigned i=0; i<m_dst_cnt; i++)
+    if (!m_complete_list[i].empty()) return false;
+  return true;
+}
+bool oneway_link::idle() const
+{
+  return !queue->has_mf() && ends_empty();
+}
+unsigned long long oneway_link::quiet_flits(unsigned *max_step) const
+{
+  *max_step = 0;
+  if (queue->size() == 0 || !ends_empty()) return 0;
+  *max_step = queue->size() - 1;
+  return queue->leading_empty();
+}
+void oneway_link::skip(unsigned long long n_flit)
+{
+  m_total_flit_cnt += n_flit;
+  if (n_flit) queue->skip(n_flit);
+}
 mem_fetch* oneway_link::top(unsigned dst_id)
 {
   if (!empty(dst_id)) {
@@ -168,6 +193,18 @@ void oneway_link::print_stat() const
   printf("%s effective compression ratio %lf\n", m_name,
       (double)m_total_data_size / (double)m_total_data_packet_size);
 }
+void oneway_link::checkpoint_state(uarch_checkpoint &cp)
+{
+  cp.section("oneway_link", (unsigned long long)m_src_cnt << 32 | m_dst_cnt);
+  cp.require(idle(), m_name);
+  cp.io(m_cur_src_id);
+  cp.io(m_total_flit_cnt);
+  cp.io(m_transfer_flit_cnt);
+  cp.io(m_transfer_single_flit_cnt);
+  cp.io(m_transfer_multi_flit_cnt);
+  cp.io(m_total_data_size);
+  cp.io(m_total_data_packet_size);
+}
 
 // -------------------------------------------------------------------------
 // Compressed oneway link interface
@@ -198,6 +235,21 @@ void compressed_oneway_link::push(unsigned mem_id, mem_fetch *mf)
   }
 }
 
+bool compressed_oneway_link::ends_empty() const
+{
+  if (!m_ready_compressed->empty()) return false;
+  for (unsigned i=0; i<m_src_cnt; i++)
+    if (!m_ready_long_list[i].empty() || !m_ready_short_list[i].empty())
+      return false;
+  return oneway_link::ends_empty();
+}
+
+void compressed_oneway_link::skip(unsigned long long n_flit)
+{
+  oneway_link::skip(n_flit);
+  if (n_flit) m_leftover = 0;     // every step pushed an empty flit
+}
+
 bool compressed_oneway_link::push(mem_fetch *mf,
     unsigned packet_bit_size, unsigned &n_sent_flit_cnt, unsigned n_flit, bool update)
 {
@@ -7,6 +7,8 @@
 #include "gpu-sim.h"
 #include "link_delay_queue.h"
 
+class uarch_checkpoint;
+
 // -------------------------------------------------------------------------
 // Base oneway link interface
 // -------------------------------------------------------------------------
@@ -24,6 +26,14 @@ public:
 
   bool full(unsigned src_id);
   bool empty(unsigned dst_id);
+  // no request waiting, in flight or delivered; step() only shifts empty flits
+  bool idle() const;
+  // flits step() can shift before a request is delivered, 0 if one is
+  // waiting to be sent or collected; *max_step is the largest single step
+  // that keeps the queue from draining
+  unsigned long long quiet_flits(unsigned *max_step) const;
+  // steps totalling n_flit flits, within quiet_flits()
+  virtual void skip(unsigned long long n_flit);
 
   void step(unsigned n_flit);
   virtual void step_link_pop(unsigned n_flit);
@@ -31,9 +41,16 @@ public:
 
   void print() const;
   void print_stat() const;
+  uint64_t data_size() const { return m_total_data_size; }
+  uint64_t data_packet_size() const { return m_total_data_packet_size; }
+  // arbitration and flit counters; the link must be idle()
+  void checkpoint_state(uarch_checkpoint &cp);
 
   unsigned get_dst_id(mem_fetch *mf);
 protected:
+  // no request waiting to enter the queue or to be collected from it
+  virtual bool ends_empty() const;
+
 //  static const unsigned FLIT_SIZE = 128;      // max packet length in terms of FLIT
 //  static const unsigned HT_OVERHEAD = 128;    // head+tail overheads
   //static const unsigned MAX_FLIT_CNT = 17;
@@ -71,6 +88,10 @@ public:
 
   void push(unsigned mem_id, mem_fetch *mf);
   bool push(mem_fetch *mf, unsigned packet_bit_size, unsigned& n_sent_flit_cnt, unsigned n_flit, bool update = true);
+  void skip(unsigned long long n_flit);
+
+protected:
+  bool ends_empty() const;
 
 public:
   std::queue<mem_fetch *> *m_ready_long_list;
@@ -42,21 +42,27 @@ Scoreboard::Scoreboard(unsigned sid, unsigned n_warps, class gpgpu_t* gpu)
   m_gpu = gpu;
 }
 
+void Scoreboard::reg_set::print() const {
+  for (unsigned r = 0; r < SCOREBOARD_FAST_REGS; r++)
+    if (m_bits.test(r)) printf("%u ", r);
+  std::set<unsigned>::const_iterator it;
+  for (it = m_overflow.begin(); it != m_overflow.end(); it++)
+    printf("%u ", *it);
+}
+
 // Print scoreboard contents
 void Scoreboard::printContents() const {
   printf("scoreboard contents (sid=%d): \n", m_sid);
   for (unsigned i = 0; i < reg_table.size(); i++) {
-    if (reg_table[i].size() == 0) continue;
+    if (reg_table[i].empty()) continue;
     printf("  wid = %2d: ", i);
-    std::set<unsigned>::const_iterator it;
-    for (it = reg_table[i].begin(); it != reg_table[i].end(); it++)
-      printf("%u ", *it);
+    reg_table[i].print();
     printf("\n");
   }
 }
 
 void Scoreboard::reserveRegister(unsigned wid, unsigned regnum) {
-  if (!(reg_table[wid].find(regnum) == reg_table[wid].end())) {
+  if (reg_table[wid].test(regnum)) {
     printf(
         "Error: trying to reserve an already reserved register (sid=%d, "
         "wid=%d, regnum=%d).",
@@ -65,19 +71,19 @@ void Scoreboard::reserveRegister(unsigned wid, unsigned regnum) {
   }
   SHADER_DPRINTF(SCOREBOARD, "Reserved Register - warp:%d, reg: %d\n", wid,
                  regnum);
-  reg_table[wid].insert(regnum);
+  reg_table[wid].set(regnum);
 }
 
 // Unmark register as write-pending
 void Scoreboard::releaseRegister(unsigned wid, unsigned regnum) {
-  if (!(reg_table[wid].find(regnum) != reg_table[wid].end())) return;
+  if (!reg_table[wid].test(regnum)) return;
   SHADER_DPRINTF(SCOREBOARD, "Release register - warp:%d, reg: %d\n", wid,
                  regnum);
-  reg_table[wid].erase(regnum);
+  reg_table[wid].reset(regnum);
 }
 
 const bool Scoreboard::islongop(unsigned warp_id, unsigned regnum) {
-  return longopregs[warp_id].find(regnum) != longopregs[warp_id].end();
+  return longopregs[warp_id].test(regnum);
 }
 
 void Scoreboard::reserveRegisters(const class warp_inst_t* inst) {
@@ -100,7 +106,7 @@ void Scoreboard::reserveRegisters(const class warp_inst_t* inst) {
       if (inst->out[r] > 0) {
         SHADER_DPRINTF(SCOREBOARD, "New longopreg marked - warp:%d, reg: %d\n",
                        inst->warp_id(), inst->out[r]);
-        longopregs[inst->warp_id()].insert(inst->out[r]);
+        longopregs[inst->warp_id()].set(inst->out[r]);
       }
     }
   }
@@ -113,7 +119,7 @@ void Scoreboard::releaseRegisters(const class warp_inst_t* inst) {
       SHADER_DPRINTF(SCOREBOARD, "Register Released - warp:%d, reg: %d\n",
                      inst->warp_id(), inst->out[r]);
       releaseRegister(inst->warp_id(), inst->out[r]);
-      longopregs[inst->warp_id()].erase(inst->out[r]);
+      longopregs[inst->warp_id()].reset(inst->out[r]);
     }
   }
 }
@@ -126,26 +132,21 @@ void Scoreboard::releaseRegisters(const class warp_inst_t* inst) {
  * true if WAW or RAW hazard (no WAR since in-order issue)
  **/
 bool Scoreboard::checkCollision(unsigned wid, const class inst_t* inst) const {
-  // Get list of all input and output registers
-  std::set<int> inst_regs;
+  // Check every input and output register of the instruction against the
+  // reserved registers of the warp; no need to build the register set first
+  const reg_set& reserved = reg_table[wid];
+  if (reserved.empty()) return false;
 
   for (unsigned iii = 0; iii < inst->outcount; iii++)
-    inst_regs.insert(inst->out[iii]);
+    if (reserved.test(inst->out[iii])) return true;
 
   for (unsigned jjj = 0; jjj < inst->incount; jjj++)
-    inst_regs.insert(inst->in[jjj]);
-
-  if (inst->pred > 0) inst_regs.insert(inst->pred);
-  if (inst->ar1 > 0) inst_regs.insert(inst->ar1);
-  if (inst->ar2 > 0) inst_regs.insert(inst->ar2);
-
-  // Check for collision, get the intersection of reserved registers and
-  // instruction registers
-  std::set<int>::const_iterator it2;
-  for (it2 = inst_regs.begin(); it2 != inst_regs.end(); it2++)
-    if (reg_table[wid].find(*it2) != reg_table[wid].end()) {
-      return true;
-    }
+    if (reserved.test(inst->in[jjj])) return true;
+
+  if (inst->pred > 0 && reserved.test(inst->pred)) return true;
+  if (inst->ar1 > 0 && reserved.test(inst->ar1)) return true;
+  if (inst->ar2 > 0 && reserved.test(inst->ar2)) return true;
+
   return false;
 }
 
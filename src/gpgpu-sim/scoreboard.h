@@ -28,6 +28,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <bitset>
 #include <set>
 #include <vector>
 #include "assert.h"
@@ -37,6 +38,10 @@
 
 #include "../abstract_hardware_model.h"
 
+// register numbers tracked by the per-warp bitsets, larger ones fall back to
+// a std::set
+#define SCOREBOARD_FAST_REGS 256
+
 class Scoreboard {
  public:
   Scoreboard(unsigned sid, unsigned n_warps, class gpgpu_t *gpu);
@@ -56,11 +61,39 @@ class Scoreboard {
 
   unsigned m_sid;
 
+  // Per-warp register set: registers below SCOREBOARD_FAST_REGS live in a
+  // fixed-width bitset, the rare larger register numbers in a std::set
+  class reg_set {
+   public:
+    bool test(unsigned regnum) const {
+      if (regnum < SCOREBOARD_FAST_REGS) return m_bits.test(regnum);
+      return m_overflow.find(regnum) != m_overflow.end();
+    }
+    void set(unsigned regnum) {
+      if (regnum < SCOREBOARD_FAST_REGS)
+        m_bits.set(regnum);
+      else
+        m_overflow.insert(regnum);
+    }
+    void reset(unsigned regnum) {
+      if (regnum < SCOREBOARD_FAST_REGS)
+        m_bits.reset(regnum);
+      else
+        m_overflow.erase(regnum);
+    }
+    bool empty() const { return m_bits.none() && m_overflow.empty(); }
+    void print() const;
+
+   private:
+    std::bitset<SCOREBOARD_FAST_REGS> m_bits;
+    std::set<unsigned> m_overflow;
+  };
+
   // keeps track of pending writes to registers
-  // indexed by warp id, reg_id => pending write count
-  std::vector<std::set<unsigned> > reg_table;
+  // indexed by warp id, reg_id => pending write
+  std::vector<reg_set> reg_table;
   // Register that depend on a long operation (global, local or tex memory)
-  std::vector<std::set<unsigned> > longopregs;
+  std::vector<reg_set> longopregs;
 
   class gpgpu_t *m_gpu;
 };
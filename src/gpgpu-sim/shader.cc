@@ -37,6 +37,7 @@
 #include "../cuda-sim/ptx_sim.h"
 #include "../statwrapper.h"
 #include "addrdec.h"
+#include "cta_sampler.h"
 #include "dram.h"
 #include "gpu-misc.h"
 #include "gpu-sim.h"
@@ -46,7 +47,9 @@
 #include "shader_trace.h"
 #include "stat-tool.h"
 #include "traffic_breakdown.h"
+#include "uarch_checkpoint.h"
 #include "visualizer.h"
+#include "warp_trace.h"
 #include <queue>
 #include <set>
 #include "../abstract_hardware_model.h"
@@ -136,7 +139,11 @@ void shader_core_ctx::create_front_pipeline() {
   m_not_completed = 0;
   m_active_threads.reset();
   m_n_active_cta = 0;
-  for (unsigned i = 0; i < MAX_CTA_PER_SHADER; i++) m_cta_status[i] = 0;
+  for (unsigned i = 0; i < MAX_CTA_PER_SHADER; i++) {
+    m_cta_status[i] = 0;
+    m_cta_kernel[i] = NULL;
+    m_cta_ctaid[i] = 0;
+  }
   for (unsigned i = 0; i < m_config->n_thread_per_shader; i++) {
     m_thread[i] = NULL;
     m_threadState[i].m_cta_id = -1;
@@ -475,6 +482,7 @@ shader_core_ctx::shader_core_ctx(class gpgpu_sim *gpu,
 void shader_core_ctx::reinit(unsigned start_thread, unsigned end_thread,
                              bool reset_not_completed) {
   if (reset_not_completed) {
+    m_gpu->add_not_completed(-(int)m_not_completed);
     m_not_completed = 0;
     m_active_threads.reset();
 
@@ -543,6 +551,7 @@ void shader_core_ctx::init_warps(unsigned cta_id, unsigned start_thread,
       m_warp[i]->init(start_pc, cta_id, i, active_threads, m_dynamic_warp_id);
       ++m_dynamic_warp_id;
       m_not_completed += n_active;
+      m_gpu->add_not_completed(n_active);
       ++m_active_warps;
     }
   }
@@ -711,9 +720,106 @@ void shader_core_stats::print(FILE *fout) const {
   m_incoming_traffic_stats->print(fout);
 }
 
+void shader_core_stats::checkpoint_state(uarch_checkpoint &cp) {
+  unsigned n = m_config->num_shader();
+  cp.section("shader_core_stats", (unsigned long long)n << 32 |
+                                      m_config->warp_size << 16 |
+                                      m_config->gpgpu_num_sched_per_core);
+  cp.io(shader_cycles, n);
+  cp.io(m_num_sim_insn, n);
+  cp.io(m_num_sim_winsn, n);
+  cp.io(m_last_num_sim_insn, n);
+  cp.io(m_last_num_sim_winsn, n);
+  cp.io(m_num_decoded_insn, n);
+  cp.io(m_pipeline_duty_cycle, n);
+  cp.io(m_num_FPdecoded_insn, n);
+  cp.io(m_num_INTdecoded_insn, n);
+  cp.io(m_num_storequeued_insn, n);
+  cp.io(m_num_loadqueued_insn, n);
+  cp.io(m_num_ialu_acesses, n);
+  cp.io(m_num_fp_acesses, n);
+  cp.io(m_num_imul_acesses, n);
+  cp.io(m_num_tex_inst, n);
+  cp.io(m_num_fpmul_acesses, n);
+  cp.io(m_num_idiv_acesses, n);
+  cp.io(m_num_fpdiv_acesses, n);
+  cp.io(m_num_sp_acesses, n);
+  cp.io(m_num_sfu_acesses, n);
+  cp.io(m_num_tensor_core_acesses, n);
+  cp.io(m_num_trans_acesses, n);
+  cp.io(m_num_mem_acesses, n);
+  cp.io(m_num_sp_committed, n);
+  cp.io(m_num_tlb_hits, n);
+  cp.io(m_num_tlb_accesses, n);
+  cp.io(m_num_sfu_committed, n);
+  cp.io(m_num_tensor_core_committed, n);
+  cp.io(m_num_mem_committed, n);
+  cp.io(m_read_regfile_acesses, n);
+  cp.io(m_write_regfile_acesses, n);
+  cp.io(m_non_rf_operands, n);
+  cp.io(m_num_imul24_acesses, n);
+  cp.io(m_num_imul32_acesses, n);
+  cp.io(m_active_sp_lanes, n);
+  cp.io(m_active_sfu_lanes, n);
+  cp.io(m_active_tensor_core_lanes, n);
+  cp.io(m_active_fu_lanes, n);
+  cp.io(m_active_fu_mem_lanes, n);
+  cp.io(m_n_diverge, n);
+  cp.io(gpgpu_n_load_insn);
+  cp.io(gpgpu_n_store_insn);
+  cp.io(gpgpu_n_shmem_insn);
+  cp.io(gpgpu_n_sstarr_insn);
+  cp.io(gpgpu_n_tex_insn);
+  cp.io(gpgpu_n_const_insn);
+  cp.io(gpgpu_n_param_insn);
+  cp.io(gpgpu_n_shmem_bkconflict);
+  cp.io(gpgpu_n_cache_bkconflict);
+  cp.io(gpgpu_n_intrawarp_mshr_merge);
+  cp.io(gpgpu_n_cmem_portconflict);
+  cp.io(gpu_stall_shd_mem_breakdown);
+  cp.io(gpu_reg_bank_conflict_stalls);
+  cp.io(shader_cycle_distro, m_config->warp_size + 3);
+  cp.io(last_shader_cycle_distro, m_config->warp_size + 3);
+  cp.io(gpgpu_n_stall_shd_mem);
+  cp.io(single_issue_nums, m_config->gpgpu_num_sched_per_core);
+  cp.io(dual_issue_nums, m_config->gpgpu_num_sched_per_core);
+  cp.io(gpgpu_n_mem_read_local);
+  cp.io(gpgpu_n_mem_write_local);
+  cp.io(gpgpu_n_mem_texture);
+  cp.io(gpgpu_n_mem_const);
+  cp.io(gpgpu_n_mem_read_global);
+  cp.io(gpgpu_n_mem_write_global);
+  cp.io(gpgpu_n_mem_read_inst);
+  cp.io(gpgpu_n_mem_l2_writeback);
+  cp.io(gpgpu_n_mem_l1_write_allocate);
+  cp.io(gpgpu_n_mem_l2_write_allocate);
+  cp.io(made_write_mfs);
+  cp.io(made_read_mfs);
+  cp.io(gpgpu_n_shmem_bank_access, n);
+  cp.io(n_simt_to_mem, n);
+  cp.io(n_mem_to_simt, n);
+  m_outgoing_traffic_stats->checkpoint_state(cp);
+  m_incoming_traffic_stats->checkpoint_state(cp);
+  // warp ids grow as the run goes on, so these lengths are state
+  for (unsigned i = 0; i < n; i++) {
+    cp.io_size(m_shader_dynamic_warp_issue_distro[i]);
+    cp.io(m_shader_dynamic_warp_issue_distro[i]);
+    cp.io_size(m_shader_warp_slot_issue_distro[i]);
+    cp.io(m_shader_warp_slot_issue_distro[i]);
+  }
+  cp.io_size(m_last_shader_dynamic_warp_issue_distro);
+  cp.io(m_last_shader_dynamic_warp_issue_distro);
+  cp.io_size(m_last_shader_warp_slot_issue_distro);
+  cp.io(m_last_shader_warp_slot_issue_distro);
+}
+
 void shader_core_stats::event_warp_issued(unsigned s_id, unsigned warp_id,
                                           unsigned num_issued,
                                           unsigned dynamic_warp_id) {
+  if (m_main) {
+    m_main->event_warp_issued(s_id, warp_id, num_issued, dynamic_warp_id);
+    return;
+  }
   assert(warp_id <= m_config->max_warps_per_shader);
   for (unsigned i = 0; i < num_issued; ++i) {
     if (m_shader_dynamic_warp_issue_distro[s_id].size() <= dynamic_warp_id) {
@@ -727,6 +833,81 @@ void shader_core_stats::event_warp_issued(unsigned s_id, unsigned warp_id,
   }
 }
 
+void shader_core_stats::clear_totals() {
+  gpgpu_n_load_insn = 0;
+  gpgpu_n_store_insn = 0;
+  gpgpu_n_shmem_insn = 0;
+  gpgpu_n_sstarr_insn = 0;
+  gpgpu_n_tex_insn = 0;
+  gpgpu_n_const_insn = 0;
+  gpgpu_n_param_insn = 0;
+  gpgpu_n_shmem_bkconflict = 0;
+  gpgpu_n_cache_bkconflict = 0;
+  gpgpu_n_intrawarp_mshr_merge = 0;
+  gpgpu_n_cmem_portconflict = 0;
+  memset(gpu_stall_shd_mem_breakdown, 0, sizeof(gpu_stall_shd_mem_breakdown));
+  gpu_reg_bank_conflict_stalls = 0;
+  gpgpu_n_stall_shd_mem = 0;
+  gpgpu_n_mem_read_local = 0;
+  gpgpu_n_mem_write_local = 0;
+  gpgpu_n_mem_texture = 0;
+  gpgpu_n_mem_const = 0;
+  gpgpu_n_mem_read_global = 0;
+  gpgpu_n_mem_write_global = 0;
+  gpgpu_n_mem_read_inst = 0;
+  gpgpu_n_mem_l2_writeback = 0;
+  gpgpu_n_mem_l1_write_allocate = 0;
+  gpgpu_n_mem_l2_write_allocate = 0;
+  made_write_mfs = 0;
+  made_read_mfs = 0;
+}
+
+void shader_core_stats::merge() {
+#define MERGE(field) m_main->field += field
+  MERGE(gpgpu_n_load_insn);
+  MERGE(gpgpu_n_store_insn);
+  MERGE(gpgpu_n_shmem_insn);
+  MERGE(gpgpu_n_sstarr_insn);
+  MERGE(gpgpu_n_tex_insn);
+  MERGE(gpgpu_n_const_insn);
+  MERGE(gpgpu_n_param_insn);
+  MERGE(gpgpu_n_shmem_bkconflict);
+  MERGE(gpgpu_n_cache_bkconflict);
+  MERGE(gpgpu_n_intrawarp_mshr_merge);
+  MERGE(gpgpu_n_cmem_portconflict);
+  for (unsigned i = 0; i < N_MEM_STAGE_ACCESS_TYPE; i++)
+    for (unsigned j = 0; j < N_MEM_STAGE_STALL_TYPE; j++)
+      MERGE(gpu_stall_shd_mem_breakdown[i][j]);
+  MERGE(gpu_reg_bank_conflict_stalls);
+  MERGE(gpgpu_n_stall_shd_mem);
+  MERGE(gpgpu_n_mem_read_local);
+  MERGE(gpgpu_n_mem_write_local);
+  MERGE(gpgpu_n_mem_texture);
+  MERGE(gpgpu_n_mem_const);
+  MERGE(gpgpu_n_mem_read_global);
+  MERGE(gpgpu_n_mem_write_global);
+  MERGE(gpgpu_n_mem_read_inst);
+  MERGE(gpgpu_n_mem_l2_writeback);
+  MERGE(gpgpu_n_mem_l1_write_allocate);
+  MERGE(gpgpu_n_mem_l2_write_allocate);
+  MERGE(made_write_mfs);
+  MERGE(made_read_mfs);
+  for (unsigned i = 0; i < m_config->warp_size + 3; i++) {
+    MERGE(shader_cycle_distro[i]);
+    shader_cycle_distro[i] = 0;
+  }
+  for (unsigned i = 0; i < m_config->gpgpu_num_sched_per_core; i++) {
+    MERGE(single_issue_nums[i]);
+    MERGE(dual_issue_nums[i]);
+    single_issue_nums[i] = 0;
+    dual_issue_nums[i] = 0;
+  }
+#undef MERGE
+  clear_totals();
+  m_main->m_outgoing_traffic_stats->merge(*m_outgoing_traffic_stats);
+  m_main->m_incoming_traffic_stats->merge(*m_incoming_traffic_stats);
+}
+
 void shader_core_stats::visualizer_print(gzFile visualizer_file) {
   // warp divergence breakdown
   gzprintf(visualizer_file, "WarpDivergenceBreakdown:");
@@ -912,6 +1093,7 @@ void shader_core_ctx::fetch() {
         if (m_warp[warp_id]->hardware_done() &&
             !m_scoreboard->pendingWrites(warp_id) &&
             !m_warp[warp_id]->done_exit()) {
+          m_cluster->order();
           bool did_exit = false;
           for (unsigned t = 0; t < m_config->warp_size; t++) {
             unsigned tid = warp_id * m_config->warp_size + t;
@@ -925,6 +1107,7 @@ void shader_core_ctx::fetch() {
                                          &(m_thread[tid]->get_kernel()));
               }
               m_not_completed -= 1;
+              m_gpu->add_not_completed(-1);
               m_active_threads.reset(tid);
               did_exit = true;
             }
@@ -987,13 +1170,187 @@ void shader_core_ctx::fetch() {
 }
 
 void exec_shader_core_ctx::func_exec_inst(warp_inst_t &inst) {
-  execute_warp_inst_t(inst);
+  warp_trace *trace = m_gpu->get_warp_trace();
+  if (trace && trace->replaying()) {
+    trace_replay(inst);
+  } else {
+    if (!m_cluster->in_order() &&
+        ptx_touches_shared_state(m_gpu->gpgpu_ctx->ptx_fetch_inst(inst.pc)))
+      m_cluster->order();
+    execute_warp_inst_t(inst);
+    if (trace) trace_capture(inst);
+  }
   if (inst.is_load() || inst.is_store()) {
     inst.generate_mem_accesses();
     // inst.print_m_accessq();
   }
 }
 
+// bytes behind each address of a lane of a global store, 0 for other
+// instructions
+static unsigned trace_store_size(gpgpu_context *ctx, const warp_inst_t &inst,
+                                 unsigned n_addrs) {
+  if (!inst.is_store() || inst.isatomic() || !inst.space.is_global())
+    return 0;
+  if (n_addrs > 1) return inst.data_size;  // split up, e.g. wmma.store
+  return inst.data_size * ptx_vector_elements(ctx->ptx_fetch_inst(inst.pc));
+}
+
+warp_trace::key_t exec_shader_core_ctx::trace_key(unsigned warp_id) const {
+  unsigned cta = m_warp[warp_id]->get_cta_id();
+  const ptx_thread_info *thread = m_thread[warp_id * m_config->warp_size];
+  dim3 tid = thread->get_tid();
+  dim3 ntid = thread->get_ntid();
+  unsigned lane0 = tid.x + ntid.x * (tid.y + ntid.y * tid.z);
+  return warp_trace::key_t(m_cta_kernel[cta]->get_uid(), m_cta_ctaid[cta],
+                           lane0 / m_config->warp_size);
+}
+
+void exec_shader_core_ctx::trace_capture(const warp_inst_t &inst) {
+  warp_trace *trace = m_gpu->get_warp_trace();
+  unsigned warp_id = inst.warp_id();
+  unsigned wtid = warp_id * m_config->warp_size;
+  warp_trace::key_t key = trace_key(warp_id);
+  const simt_mask_t &issued = m_simt_stack[warp_id]->get_active_mask();
+  warp_trace_record &rec = m_trace_rec;
+  rec.pc = inst.pc;
+  rec.active = inst.get_active_mask().to_ulong();
+  rec.done = 0;
+  rec.next_pcs.clear();
+  memset(rec.next_pc, 0, sizeof(rec.next_pc));
+  rec.rpc = inst.reconvergence_pc;
+  // what core_t::updateSIMTStack will hand the SIMT stack
+  for (unsigned t = 0; t < m_config->warp_size; t++) {
+    if (ptx_thread_done(wtid + t)) {
+      if (issued.test(t)) rec.done |= 1u << t;
+      continue;
+    }
+    if (rec.rpc == RECONVERGE_RETURN_PC)
+      rec.rpc = get_return_pc(m_thread[wtid + t]);
+    if (!issued.test(t)) continue;
+    address_type next_pc = m_thread[wtid + t]->get_pc();
+    unsigned i = 0;
+    while (i < rec.next_pcs.size() && rec.next_pcs[i] != next_pc) i++;
+    if (i == rec.next_pcs.size()) rec.next_pcs.push_back(next_pc);
+    rec.next_pc[t] = i;
+  }
+
+  rec.atomic = inst.isatomic();
+  rec.space = inst.space;
+  rec.data_size = inst.data_size;
+  memset(rec.n_addrs, 0, sizeof(rec.n_addrs));
+  rec.addrs.clear();
+  rec.store_data.clear();
+  if (inst.is_load() || inst.is_store() || inst.isatomic()) {
+    for (unsigned t = 0; t < m_config->warp_size; t++) {
+      if (!inst.active(t)) continue;
+      const new_addr_type *addrs = inst.get_addrs(t);
+      unsigned n = MAX_ACCESSES_PER_INSN_PER_THREAD;
+      while (n > 1 && !addrs[n - 1]) n--;
+      rec.n_addrs[t] = n;
+      rec.addrs.insert(rec.addrs.end(), addrs, addrs + n);
+      unsigned size = trace_store_size(m_gpu->gpgpu_ctx, inst, n);
+      for (unsigned i = 0; i < n && size; i++) {
+        unsigned char data[64];
+        assert(size <= sizeof(data));
+        m_gpu->get_global_memory()->read(addrs[i], size, data);
+        rec.store_data.append((const char *)data, size);
+      }
+      if (inst.isatomic() && inst.space.is_global())
+        trace->atomic_word(key.kernel_uid, addrs[0], inst.data_size);
+    }
+  }
+
+  trace->write(key, rec);
+  if (m_warp[warp_id]->functional_done()) trace->warp_done(key);
+}
+
+void exec_shader_core_ctx::trace_replay(warp_inst_t &inst) {
+  warp_trace *trace = m_gpu->get_warp_trace();
+  unsigned warp_id = inst.warp_id();
+  unsigned wtid = warp_id * m_config->warp_size;
+  warp_trace::key_t key = trace_key(warp_id);
+  warp_trace_record &rec = m_trace_rec;
+  trace->read(key, rec);
+  if (rec.pc != inst.pc) {
+    printf(
+        "GPGPU-Sim uArch: ERROR ** trace replay: warp %u of CTA %u of kernel "
+        "%u issued pc %llu, the trace has pc %llu\n",
+        key.warp, key.cta, key.kernel_uid, inst.pc, rec.pc);
+    abort();
+  }
+
+  inst.space = rec.space;
+  inst.data_size = rec.data_size;
+  if (rec.atomic) inst.set_atomic();
+  // the lanes execute_warp_inst_t() would count as atomic
+  unsigned first_active = MAX_WARP_SIZE;
+  if (rec.active) first_active = __builtin_ctz(rec.active);
+  const new_addr_type *addr = rec.addrs.empty() ? NULL : &rec.addrs[0];
+  size_t stored = 0;
+  for (unsigned t = 0; t < m_config->warp_size; t++) {
+    if (!inst.active(t)) continue;
+    if (!(rec.active & (1u << t))) {
+      inst.set_not_active(t);
+    } else if (rec.n_addrs[t]) {
+      unsigned n = rec.n_addrs[t];
+      inst.set_addr(t, const_cast<new_addr_type *>(addr), n);
+      unsigned size = trace_store_size(m_gpu->gpgpu_ctx, inst, n);
+      for (unsigned i = 0; i < n && size; i++) {
+        if (stored + size > rec.store_data.size()) {
+          printf("GPGPU-Sim uArch: ERROR ** trace replay: store data of "
+                 "pc %llu is short\n",
+                 inst.pc);
+          abort();
+        }
+        m_gpu->get_global_memory()->write(
+            addr[i], size, rec.store_data.data() + stored, NULL, NULL);
+        stored += size;
+      }
+      addr += n;
+    }
+
+    // as checkExecutionStatusAndUpdate(), local addresses were recorded
+    // translated
+    if (rec.atomic && t >= first_active) m_warp[warp_id]->inc_n_atomic();
+    if (rec.done & (1u << t)) {
+      ptx_thread_info *thread = m_thread[wtid + t];
+      thread->set_done();
+      thread->exitCore();
+      thread->registerExit();
+      m_warp[warp_id]->set_completed(t);
+      m_warp[warp_id]->ibuffer_flush();
+    }
+    if (inst.active(t)) cflog_update_thread_pc(m_sid, wtid + t, inst.pc);
+  }
+  if (m_warp[warp_id]->functional_done()) trace->warp_done(key);
+}
+
+void exec_shader_core_ctx::updateSIMTStack(unsigned warpId,
+                                           warp_inst_t *inst) {
+  warp_trace *trace = m_gpu->get_warp_trace();
+  if (!trace || !trace->replaying()) {
+    core_t::updateSIMTStack(warpId, inst);
+    return;
+  }
+  simt_mask_t thread_done;
+  addr_vector_t next_pc;
+  unsigned wtid = warpId * m_warp_size;
+  for (unsigned i = 0; i < m_warp_size; i++) {
+    if (ptx_thread_done(wtid + i)) {
+      thread_done.set(i);
+      next_pc.push_back((address_type)-1);
+    } else if (m_trace_rec.next_pcs.empty()) {
+      next_pc.push_back((address_type)-1);
+    } else {
+      next_pc.push_back(m_trace_rec.next_pcs[m_trace_rec.next_pc[i]]);
+    }
+  }
+  inst->reconvergence_pc = m_trace_rec.rpc;
+  m_simt_stack[warpId]->update(thread_done, next_pc, inst->reconvergence_pc,
+                               inst->op, inst->isize, inst->pc);
+}
+
 void shader_core_ctx::issue_warp(register_set &pipe_reg_set,
                                  const warp_inst_t *next_inst,
                                  const active_mask_t &active_mask,
@@ -1011,6 +1368,12 @@ void shader_core_ctx::issue_warp(register_set &pipe_reg_set,
                      sch_id);  // dynamic instruction information
   m_stats->shader_cycle_distro[2 + (*pipe_reg)->active_count()]++;
   func_exec_inst(**pipe_reg);
+  if (m_gpu->get_cta_sampler()) {
+    unsigned cta = m_warp[warp_id]->get_cta_id();
+    m_gpu->get_cta_sampler()->count(m_cta_kernel[cta], m_cta_ctaid[cta],
+                                    next_inst->pc,
+                                    (*pipe_reg)->active_count());
+  }
 
   if (next_inst->op == BARRIER_OP) {
     m_warp[warp_id]->store_info_of_last_inst_at_barrier(*pipe_reg);
@@ -1131,6 +1494,91 @@ void scheduler_unit::order_by_priority(
   }
 }
 
+/**
+ * The oldest-first ordering of order_by_priority with
+ * sort_warps_by_oldest_dynamic_id, without the per-cycle copy and sort.
+ * m_warps_by_age keeps the supervised warps sorted by dynamic warp id across
+ * cycles. Those ids only change when a CTA launches, and the new warps simply
+ * move towards the back, so a linear insertion pass keeps the list sorted.
+ * The warps that can issue are then emitted oldest first, followed by the
+ * done or waiting ones, which the issue loop never acts on.
+ */
+void scheduler_unit::order_by_age(
+    std::vector<shd_warp_t *> &result_list,
+    const std::vector<shd_warp_t *>::const_iterator &last_issued_from_input,
+    unsigned num_warps_to_add, OrderingType ordering) {
+  assert(num_warps_to_add <= m_supervised_warps.size());
+  if (m_warps_by_age.size() != m_supervised_warps.size()) {
+    m_warps_by_age = m_supervised_warps;
+    m_warp_ready.resize(m_supervised_warps.size());
+  }
+  for (unsigned i = 1; i < m_warps_by_age.size(); ++i) {
+    shd_warp_t *w = m_warps_by_age[i];
+    unsigned j = i;
+    for (; j > 0 && w->get_dynamic_warp_id() <
+                        m_warps_by_age[j - 1]->get_dynamic_warp_id();
+         --j) {
+      m_warps_by_age[j] = m_warps_by_age[j - 1];
+    }
+    m_warps_by_age[j] = w;
+  }
+  for (unsigned i = 0; i < m_warps_by_age.size(); ++i) {
+    m_warp_ready[i] =
+        !(m_warps_by_age[i]->done_exit() || m_warps_by_age[i]->waiting());
+  }
+
+  result_list.clear();
+  shd_warp_t *greedy_value = NULL;
+  if (ORDERING_GREEDY_THEN_PRIORITY_FUNC == ordering) {
+    greedy_value = *last_issued_from_input;
+    result_list.push_back(greedy_value);
+  } else if (ORDERED_PRIORITY_FUNC_ONLY != ordering) {
+    fprintf(stderr, "Unknown ordering - %d\n", ordering);
+    abort();
+  }
+  unsigned count = 0;
+  for (unsigned pass = 0; pass < 2; ++pass) {
+    bool ready = (pass == 0);
+    for (unsigned i = 0; i < m_warps_by_age.size() && count < num_warps_to_add;
+         ++i) {
+      if (m_warp_ready[i] != ready) continue;
+      if (m_warps_by_age[i] != greedy_value)
+        result_list.push_back(m_warps_by_age[i]);
+      ++count;
+    }
+  }
+}
+
+// Checks that the warps which can issue this cycle come up in the same order
+// as in the reference ordering; the rest are skipped by cycle() either way.
+void scheduler_unit::check_warp_order() {
+  if (!reference_order(m_reference_order)) return;
+  std::vector<shd_warp_t *>::const_iterator ref = m_reference_order.begin();
+  std::vector<shd_warp_t *>::const_iterator cur =
+      m_next_cycle_prioritized_warps.begin();
+  while (true) {
+    while (ref != m_reference_order.end() &&
+           (*ref == NULL || (*ref)->done_exit() || (*ref)->waiting()))
+      ++ref;
+    while (cur != m_next_cycle_prioritized_warps.end() &&
+           (*cur == NULL || (*cur)->done_exit() || (*cur)->waiting()))
+      ++cur;
+    if (ref == m_reference_order.end() ||
+        cur == m_next_cycle_prioritized_warps.end() || *ref != *cur)
+      break;
+    ++ref;
+    ++cur;
+  }
+  if (ref != m_reference_order.end() ||
+      cur != m_next_cycle_prioritized_warps.end()) {
+    fprintf(stderr,
+            "GPGPU-Sim uArch: shader %d scheduler %d warp order differs from "
+            "the reference order\n",
+            get_sid(), m_id);
+    abort();
+  }
+}
+
 void scheduler_unit::cycle() {
   SCHED_DPRINTF("scheduler_unit::cycle()\n");
   bool valid_inst =
@@ -1141,6 +1589,7 @@ void scheduler_unit::cycle() {
   bool issued_inst = false;  // of these we issued one
 
   order_warps();
+  if (m_shader->m_config->gpgpu_scheduler_order_check) check_warp_order();
   for (std::vector<shd_warp_t *>::const_iterator iter =
            m_next_cycle_prioritized_warps.begin();
        iter != m_next_cycle_prioritized_warps.end(); iter++) {
@@ -1398,18 +1847,13 @@ void scheduler_unit::cycle() {
       checked++;
     }
     if (issued) {
-      // This might be a bit inefficient, but we need to maintain
-      // two ordered list for proper scheduler execution.
-      // We could remove the need for this loop by associating a
-      // supervised_is index with each entry in the
-      // m_next_cycle_prioritized_warps vector. For now, just run through until
-      // you find the right warp_id
-      for (std::vector<shd_warp_t *>::const_iterator supervised_iter =
-               m_supervised_warps.begin();
-           supervised_iter != m_supervised_warps.end(); ++supervised_iter) {
-        if (*iter == *supervised_iter) {
-          m_last_supervised_issued = supervised_iter;
-        }
+      // Keep the two ordered lists in step: find the issued warp in
+      // m_supervised_warps through its slot index
+      unsigned issued_warp_id = (*iter)->get_warp_id();
+      if (issued_warp_id < m_supervised_slot.size() &&
+          m_supervised_slot[issued_warp_id] >= 0) {
+        m_last_supervised_issued =
+            m_supervised_warps.begin() + m_supervised_slot[issued_warp_id];
       }
 
       if (issued == 1)
@@ -1433,6 +1877,37 @@ void scheduler_unit::cycle() {
     m_stats->shader_cycle_distro[2]++;  // pipeline stalled
 }
 
+// The first pass of the issue loop in cycle(): a warp with a valid, in-order
+// instruction that passes the scoreboard might issue, so only scoreboard
+// stalls, empty instruction buffers and waiting warps count as stalled.
+bool scheduler_unit::stalled(unsigned *distro) {
+  if (!stable_order() || m_shader->m_config->gpgpu_scheduler_order_check)
+    return false;
+  bool valid_inst = false;
+  order_warps();
+  for (std::vector<shd_warp_t *>::const_iterator iter =
+           m_next_cycle_prioritized_warps.begin();
+       iter != m_next_cycle_prioritized_warps.end(); iter++) {
+    if ((*iter) == NULL || (*iter)->done_exit()) continue;
+    unsigned warp_id = (*iter)->get_warp_id();
+    if (warp(warp_id).waiting() || warp(warp_id).ibuffer_empty()) continue;
+    const warp_inst_t *pI = warp(warp_id).ibuffer_next_inst();
+    if (!pI) {
+      // a valid empty slot is flushed
+      if (warp(warp_id).ibuffer_next_valid()) return false;
+      continue;
+    }
+    if (pI->m_is_cdp && warp(warp_id).m_cdp_latency > 0) return false;
+    unsigned pc, rpc;
+    m_shader->get_pdom_stack_top_info(warp_id, pI, &pc, &rpc);
+    if (pc != pI->pc) return false;
+    valid_inst = true;
+    if (!m_scoreboard->checkCollision(warp_id, pI)) return false;
+  }
+  *distro = valid_inst ? 1 : 0;
+  return true;
+}
+
 void scheduler_unit::do_on_warp_issued(
     unsigned warp_id, unsigned num_issued,
     const std::vector<shd_warp_t *>::const_iterator &prioritized_iter) {
@@ -1457,22 +1932,44 @@ bool scheduler_unit::sort_warps_by_oldest_dynamic_id(shd_warp_t *lhs,
 }
 
 void lrr_scheduler::order_warps() {
+  if (m_next_cycle_prioritized_warps.size() == m_supervised_warps.size() &&
+      m_ordered_after == m_last_supervised_issued)
+    return;
   order_lrr(m_next_cycle_prioritized_warps, m_supervised_warps,
             m_last_supervised_issued, m_supervised_warps.size());
+  m_ordered_after = m_last_supervised_issued;
+}
+
+bool lrr_scheduler::reference_order(std::vector<shd_warp_t *> &result_list) {
+  order_lrr(result_list, m_supervised_warps, m_last_supervised_issued,
+            m_supervised_warps.size());
+  return true;
 }
 
 void gto_scheduler::order_warps() {
-  order_by_priority(m_next_cycle_prioritized_warps, m_supervised_warps,
-                    m_last_supervised_issued, m_supervised_warps.size(),
+  order_by_age(m_next_cycle_prioritized_warps, m_last_supervised_issued,
+               m_supervised_warps.size(), ORDERING_GREEDY_THEN_PRIORITY_FUNC);
+}
+
+bool gto_scheduler::reference_order(std::vector<shd_warp_t *> &result_list) {
+  order_by_priority(result_list, m_supervised_warps, m_last_supervised_issued,
+                    m_supervised_warps.size(),
                     ORDERING_GREEDY_THEN_PRIORITY_FUNC,
                     scheduler_unit::sort_warps_by_oldest_dynamic_id);
+  return true;
 }
 
 void oldest_scheduler::order_warps() {
-  order_by_priority(m_next_cycle_prioritized_warps, m_supervised_warps,
-                    m_last_supervised_issued, m_supervised_warps.size(),
-                    ORDERED_PRIORITY_FUNC_ONLY,
+  order_by_age(m_next_cycle_prioritized_warps, m_last_supervised_issued,
+               m_supervised_warps.size(), ORDERED_PRIORITY_FUNC_ONLY);
+}
+
+bool oldest_scheduler::reference_order(
+    std::vector<shd_warp_t *> &result_list) {
+  order_by_priority(result_list, m_supervised_warps, m_last_supervised_issued,
+                    m_supervised_warps.size(), ORDERED_PRIORITY_FUNC_ONLY,
                     scheduler_unit::sort_warps_by_oldest_dynamic_id);
+  return true;
 }
 
 void two_level_active_scheduler::do_on_warp_issued(
@@ -1480,10 +1977,12 @@ void two_level_active_scheduler::do_on_warp_issued(
     const std::vector<shd_warp_t *>::const_iterator &prioritized_iter) {
   scheduler_unit::do_on_warp_issued(warp_id, num_issued, prioritized_iter);
   if (SCHEDULER_PRIORITIZATION_LRR == m_inner_level_prioritization) {
-    std::vector<shd_warp_t *> new_active;
-    order_lrr(new_active, m_next_cycle_prioritized_warps, prioritized_iter,
-              m_next_cycle_prioritized_warps.size());
-    m_next_cycle_prioritized_warps = new_active;
+    // Same as order_lrr after prioritized_iter, done in place
+    std::vector<shd_warp_t *>::iterator next =
+        m_next_cycle_prioritized_warps.begin() +
+        (prioritized_iter - m_next_cycle_prioritized_warps.begin()) + 1;
+    std::rotate(m_next_cycle_prioritized_warps.begin(), next,
+                m_next_cycle_prioritized_warps.end());
   } else {
     fprintf(stderr, "Unimplemented m_inner_level_prioritization: %d\n",
             m_inner_level_prioritization);
@@ -1562,17 +2061,23 @@ swl_scheduler::swl_scheduler(shader_core_stats *stats, shader_core_ctx *shader,
 
 void swl_scheduler::order_warps() {
   if (SCHEDULER_PRIORITIZATION_GTO == m_prioritization) {
-    order_by_priority(m_next_cycle_prioritized_warps, m_supervised_warps,
-                      m_last_supervised_issued,
-                      MIN(m_num_warps_to_limit, m_supervised_warps.size()),
-                      ORDERING_GREEDY_THEN_PRIORITY_FUNC,
-                      scheduler_unit::sort_warps_by_oldest_dynamic_id);
+    order_by_age(m_next_cycle_prioritized_warps, m_last_supervised_issued,
+                 MIN(m_num_warps_to_limit, m_supervised_warps.size()),
+                 ORDERING_GREEDY_THEN_PRIORITY_FUNC);
   } else {
     fprintf(stderr, "swl_scheduler m_prioritization = %d\n", m_prioritization);
     abort();
   }
 }
 
+bool swl_scheduler::reference_order(std::vector<shd_warp_t *> &result_list) {
+  order_by_priority(result_list, m_supervised_warps, m_last_supervised_issued,
+                    MIN(m_num_warps_to_limit, m_supervised_warps.size()),
+                    ORDERING_GREEDY_THEN_PRIORITY_FUNC,
+                    scheduler_unit::sort_warps_by_oldest_dynamic_id);
+  return true;
+}
+
 void shader_core_ctx::read_operands() {}
 
 address_type coalesced_segment(address_type addr,
@@ -1705,6 +2210,14 @@ void ldst_unit::get_cache_stats(cache_stats &cs) {
   if (m_L1T) cs += m_L1T->get_stats();
 }
 
+void ldst_unit::checkpoint_state(uarch_checkpoint &cp) {
+  cp.section("ldst_unit", (m_L1D != NULL) | (m_L1C != NULL) << 1 |
+                              (m_L1T != NULL) << 2);
+  if (m_L1D) m_L1D->checkpoint_state(cp);
+  if (m_L1C) m_L1C->checkpoint_state(cp);
+  if (m_L1T) m_L1T->checkpoint_state(cp);
+}
+
 void ldst_unit::get_L1D_sub_stats(struct cache_sub_stats &css) const {
   if (m_L1D) m_L1D->get_sub_stats(css);
 }
@@ -1734,7 +2247,7 @@ void shader_core_ctx::warp_inst_complete(const warp_inst_t &inst) {
     m_stats->m_num_sim_insn[m_sid] += inst.active_count();
 
   m_stats->m_num_sim_winsn[m_sid]++;
-  m_gpu->gpu_sim_insn += inst.active_count();
+  m_cluster->add_sim_insn(inst.active_count());
   inst.completed(m_gpu->gpu_tot_sim_cycle + m_gpu->gpu_sim_cycle);
 }
 
@@ -1775,8 +2288,7 @@ void shader_core_ctx::writeback() {
     m_scoreboard->releaseRegisters(pipe_reg);
     m_warp[warp_id]->dec_inst_in_pipeline();
     warp_inst_complete(*pipe_reg);
-    m_gpu->gpu_sim_insn_last_update_sid = m_sid;
-    m_gpu->gpu_sim_insn_last_update = m_gpu->gpu_sim_cycle;
+    m_cluster->set_last_insn_sid(m_sid);
     m_last_inst_gpu_sim_cycle = m_gpu->gpu_sim_cycle;
     m_last_inst_gpu_tot_sim_cycle = m_gpu->gpu_tot_sim_cycle;
     pipe_reg->clear();
@@ -2465,6 +2977,8 @@ void ldst_unit::writeback() {
         if (!m_pipeline_reg[0]->empty()) {
           m_next_wb = *m_pipeline_reg[0];
           if (m_next_wb.isatomic()) {
+            if (m_next_wb.space.get_type() != shared_space)
+              m_core->get_cluster()->order();
             m_next_wb.do_atomic();
             m_core->decrement_atomic_count(m_next_wb.warp_id(),
                                            m_next_wb.active_count());
@@ -2530,6 +3044,29 @@ unsigned ldst_unit::clock_multiplier() const {
   else
     return m_config->mem_warp_parts;
 }
+
+bool ldst_unit::idle() const {
+  if (!m_dispatch_reg->empty() || !m_next_wb.empty() || m_next_global ||
+      !m_response_fifo.empty() || !m_operand_collector->idle())
+    return false;
+  for (unsigned stage = 0; stage < m_pipeline_depth; stage++)
+    if (!m_pipeline_reg[stage]->empty()) return false;
+  if (!m_L1T->idle() || m_L1T->access_ready() || !m_L1C->idle()) return false;
+  if (m_L1D) {
+    if (!m_L1D->idle()) return false;
+    for (unsigned j = 0; j < l1_latency_queue.size(); j++)
+      for (unsigned s = 0; s < l1_latency_queue[j].size(); s++)
+        if (l1_latency_queue[j][s]) return false;
+  }
+  return true;
+}
+
+// cycle() of an idle() unit only samples the cache ports
+void ldst_unit::skip(unsigned long long n) {
+  m_L1C->idle_cycles(n);
+  if (m_L1D) m_L1D->idle_cycles(n);
+  m_mem_rc = NO_RC_FAIL;
+}
 /*
 void ldst_unit::issue( register_set &reg_set )
 {
@@ -2692,6 +3229,10 @@ void shader_core_ctx::register_cta_thread_exit(unsigned cta_num,
   if (!m_cta_status[cta_num]) {
     // Increment the completed CTAs
     m_gpu->inc_completed_cta();
+    if (m_gpu->get_cta_sampler())
+      m_gpu->get_cta_sampler()->cta_done(
+          kernel, m_cta_ctaid[cta_num],
+          m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle);
     m_n_active_cta--;
     m_barriers.deallocate_barrier(cta_num);
     shader_CTA_count_unlog(m_sid, 1);
@@ -3369,96 +3910,79 @@ void shader_core_ctx::cycle() {
   }
 }
 
-// Flushes all content of the cache to memory
+bool shader_core_ctx::quiet() {
+  if (!isactive() && get_not_completed() == 0) return true;
+  // writeback() would compute a non-zero duty cycle
+  if (m_stats->m_num_sim_insn[m_sid] != m_stats->m_last_num_sim_insn[m_sid])
+    return false;
+  for (unsigned i = 0; i < m_pipeline_reg.size(); i++)
+    if (m_pipeline_reg[i].has_ready()) return false;
+  for (unsigned n = 0; n < m_num_function_units; n++)
+    if (!m_fu[n]->idle()) return false;
+
+  // fetch() would decode, take an instruction, reclaim or fetch for a warp
+  if (m_inst_fetch_buffer.m_valid || !m_L1I->idle()) return false;
+  for (unsigned w = 0; w < m_config->max_warps_per_shader; w++) {
+    const shd_warp_t *warp = m_warp[w];
+    bool pending_writes = m_scoreboard->pendingWrites(w);
+    if (warp->hardware_done() && !pending_writes && !warp->done_exit())
+      return false;
+    if (!warp->functional_done() && !warp->imiss_pending() &&
+        warp->ibuffer_empty())
+      return false;
+    // waiting() would clear the barrier
+    if (warp->get_membar() && !pending_writes) return false;
+  }
 
-void shader_core_ctx::cache_flush() { m_ldst_unit->flush(); }
+  m_quiet_distro.resize(schedulers.size());
+  for (unsigned i = 0; i < schedulers.size(); i++)
+    if (!schedulers[i]->stalled(&m_quiet_distro[i])) return false;
+  return true;
+}
 
-void shader_core_ctx::cache_invalidate() { m_ldst_unit->invalidate(); }
+void shader_core_ctx::skip(unsigned long long n) {
+  if (!isactive() && get_not_completed() == 0) return;
 
-// modifiers
-std::list<opndcoll_rfu_t::op_t> opndcoll_rfu_t::arbiter_t::allocate_reads() {
-  std::list<op_t>
-      result;  // a list of registers that (a) are in different register banks,
-               // (b) do not go to the same operand collector
-
-  int input;
-  int output;
-  int _inputs = m_num_banks;
-  int _outputs = m_num_collectors;
-  int _square = (_inputs > _outputs) ? _inputs : _outputs;
-  assert(_square > 0);
-  int _pri = (int)m_last_cu;
-
-  // Clear matching
-  for (int i = 0; i < _inputs; ++i) _inmatch[i] = -1;
-  for (int j = 0; j < _outputs; ++j) _outmatch[j] = -1;
-
-  for (unsigned i = 0; i < m_num_banks; i++) {
-    for (unsigned j = 0; j < m_num_collectors; j++) {
-      assert(i < (unsigned)_inputs);
-      assert(j < (unsigned)_outputs);
-      _request[i][j] = 0;
-    }
-    if (!m_queue[i].empty()) {
-      const op_t &op = m_queue[i].front();
-      int oc_id = op.get_oc_id();
-      assert(i < (unsigned)_inputs);
-      assert(oc_id < _outputs);
-      _request[i][oc_id] = 1;
-    }
-    if (m_allocated_bank[i].is_write()) {
-      assert(i < (unsigned)_inputs);
-      _inmatch[i] = 0;  // write gets priority
-    }
-  }
+  m_stats->shader_cycles[m_sid] += n;
+  m_stats->m_pipeline_duty_cycle[m_sid] = 0;
+  m_stats->m_last_num_sim_winsn[m_sid] = m_stats->m_num_sim_winsn[m_sid];
+  for (unsigned i = 0; i < num_result_bus; i++)
+    *(m_result_bus[i]) >>= std::min<unsigned long long>(n, MAX_ALU_LATENCY);
+  for (unsigned u = 0; u < m_num_function_units; u++)
+    m_fu[u]->skip(n * m_fu[u]->clock_multiplier());
+  for (unsigned i = 0; i < schedulers.size(); i++)
+    m_stats->shader_cycle_distro[m_quiet_distro[i]] += n;
+  Issue_Prio = (Issue_Prio + n % schedulers.size()) % schedulers.size();
+  m_L1I->idle_cycles(n * m_config->inst_fetch_throughput);
+}
 
-  ///// wavefront allocator from booksim... --->
-
-  // Loop through diagonals of request matrix
-  // printf("####\n");
-
-  for (int p = 0; p < _square; ++p) {
-    output = (_pri + p) % _outputs;
-
-    // Step through the current diagonal
-    for (input = 0; input < _inputs; ++input) {
-      assert(input < _inputs);
-      assert(output < _outputs);
-      if ((output < _outputs) && (_inmatch[input] == -1) &&
-          //( _outmatch[output] == -1 ) &&   //allow OC to read multiple reg
-          // banks at the same cycle
-          (_request[input][output] /*.label != -1*/)) {
-        // Grant!
-        _inmatch[input] = output;
-        _outmatch[output] = input;
-        // printf("Register File: granting bank %d to OC %d, schedid %d, warpid
-        // %d, Regid %d\n", input, output, (m_queue[input].front()).get_sid(),
-        // (m_queue[input].front()).get_wid(),
-        // (m_queue[input].front()).get_reg());
-      }
+// Flushes all content of the cache to memory
 
-      output = (output + 1) % _outputs;
-    }
-  }
+void shader_core_ctx::cache_flush() { m_ldst_unit->flush(); }
 
-  // Round-robin the priority diagonal
-  _pri = (_pri + 1) % _outputs;
+void shader_core_ctx::cache_invalidate() { m_ldst_unit->invalidate(); }
 
-  /// <--- end code from booksim
+// modifiers
 
-  m_last_cu = _pri;
-  for (unsigned i = 0; i < m_num_banks; i++) {
-    if (_inmatch[i] != -1) {
-      if (!m_allocated_bank[i].is_write()) {
-        unsigned bank = (unsigned)i;
-        op_t &op = m_queue[bank].front();
-        result.push_back(op);
-        m_queue[bank].pop_front();
-      }
+// Each bank only ever requests on behalf of the op at the front of its queue,
+// so the booksim wavefront allocator this replaced (which lets a collector
+// unit read several banks in the same cycle) granted every bank that had a
+// request and was not allocated to a writeback. That is done here directly
+// on the bank bitmasks. Grants come out in bank order.
+void opndcoll_rfu_t::arbiter_t::allocate_reads(std::vector<op_t> &result) {
+  result.clear();
+  for (unsigned w = 0; w < m_pending_banks.size(); w++) {
+    // write gets priority
+    unsigned long long grant = m_pending_banks[w] & ~m_write_banks[w];
+    for (; grant; grant &= grant - 1) {
+      unsigned bank = w * 64 + __builtin_ctzll(grant);
+      bank_queue_t &queue = m_queue[bank];
+      assert(queue.front().get_oc_id() < m_num_collectors);
+      result.push_back(queue.front());
+      queue.pop_front();
+      if (queue.empty()) m_pending_banks[w] &= ~(1ULL << (bank % 64));
     }
   }
-
-  return result;
 }
 
 barrier_set_t::barrier_set_t(shader_core_ctx *shader,
@@ -3744,6 +4268,14 @@ void shader_core_ctx::get_cache_stats(cache_stats &cs) {
   m_ldst_unit->get_cache_stats(cs);  // Get L1D, L1C, L1T stats
 }
 
+void shader_core_ctx::checkpoint_state(uarch_checkpoint &cp) {
+  cp.section("shader_core", m_sid);
+  cp.require(!get_n_active_cta(), "active CTAs");
+  cp.io(m_dynamic_warp_id);
+  m_L1I->checkpoint_state(cp);
+  m_ldst_unit->checkpoint_state(cp);
+}
+
 void shader_core_ctx::get_L1I_sub_stats(struct cache_sub_stats &css) const {
   if (m_L1I) m_L1I->get_sub_stats(css);
 }
@@ -3994,22 +4526,16 @@ void opndcoll_rfu_t::allocate_cu(unsigned port_num) {
 
 void opndcoll_rfu_t::allocate_reads() {
   // process read requests that do not have conflicts
-  std::list<op_t> allocated = m_arbiter.allocate_reads();
-  std::map<unsigned, op_t> read_ops;
-  for (std::list<op_t>::iterator r = allocated.begin(); r != allocated.end();
-       r++) {
-    const op_t &rr = *r;
-    unsigned reg = rr.get_reg();
-    unsigned wid = rr.get_wid();
+  m_arbiter.allocate_reads(m_granted_reads);
+  for (std::vector<op_t>::iterator r = m_granted_reads.begin();
+       r != m_granted_reads.end(); r++) {
+    op_t &op = *r;
+    unsigned reg = op.get_reg();
+    unsigned wid = op.get_wid();
     unsigned bank =
         register_bank(reg, wid, m_num_banks, m_bank_warp_shift, sub_core_model,
-                      m_num_banks_per_sched, rr.get_sid());
-    m_arbiter.allocate_for_read(bank, rr);
-    read_ops[bank] = rr;
-  }
-  std::map<unsigned, op_t>::iterator r;
-  for (r = read_ops.begin(); r != read_ops.end(); ++r) {
-    op_t &op = r->second;
+                      m_num_banks_per_sched, op.get_sid());
+    m_arbiter.allocate_for_read(bank, op);
     unsigned cu = op.get_oc_id();
     unsigned operand = op.get_operand();
     m_cu[cu]->collect_operand(operand);
@@ -4129,6 +4655,14 @@ simt_core_cluster::simt_core_cluster(class gpgpu_sim *gpu, unsigned cluster_id,
   m_stats = stats;
   m_memory_stats = mstats;
   m_mem_config = mem_config;
+  m_in_order = true;
+  m_write_log = NULL;
+  m_log_end = LOG_POS_UNKNOWN;
+  m_icnt_staged = false;
+  m_icnt_space = 0;
+  m_sim_insn = 0;
+  m_last_insn_sid = -1;
+  m_ptx_insn = 0;
 }
 
 void simt_core_cluster::core_cycle() {
@@ -4143,6 +4677,59 @@ void simt_core_cluster::core_cycle() {
   }
 }
 
+const size_t simt_core_cluster::LOG_POS_UNKNOWN;
+
+void simt_core_cluster::wait_lower_clusters() {
+  m_gpu->wait_lower_clusters(m_cluster_id);
+  m_in_order = true;
+}
+
+void simt_core_cluster::begin_concurrent_cycle(const mem_write_log &log) {
+  m_in_order = false;
+  m_write_log = &log;
+  m_icnt_staged = true;
+  // nothing else adds to or drains the input until drain_icnt()
+  m_icnt_space = ::icnt_input_space(m_cluster_id);
+}
+
+void simt_core_cluster::end_concurrent_cycle() {
+  m_log_end = m_in_order ? m_write_log->size() : LOG_POS_UNKNOWN;
+}
+
+void simt_core_cluster::drain_icnt(size_t &log_pos) {
+  for (unsigned i = 0; i < m_icnt_requests.size(); i++) {
+    const icnt_staged_t &r = m_icnt_requests[i];
+    if (!r.mf) {
+      // again, for the counters of the network
+      bool has_buffer = ::icnt_has_buffer(m_cluster_id, r.size);
+      assert(has_buffer == r.has_buffer);
+      (void)has_buffer;
+      continue;
+    }
+    // made before the cluster was in order: after the writes of the lower
+    // clusters, before its own
+    size_t pos = r.log_pos == LOG_POS_UNKNOWN ? log_pos : r.log_pos;
+    icnt_push_request(r.mf, r.output, r.size, pos);
+  }
+  m_icnt_requests.clear();
+  if (m_log_end != LOG_POS_UNKNOWN) log_pos = m_log_end;
+  m_icnt_staged = false;
+  m_in_order = true;
+  m_write_log = NULL;
+}
+
+void simt_core_cluster::commit_sim_insn() {
+  m_gpu->gpu_sim_insn += m_sim_insn;
+  m_sim_insn = 0;
+  if (m_last_insn_sid >= 0) {
+    m_gpu->gpu_sim_insn_last_update_sid = m_last_insn_sid;
+    m_gpu->gpu_sim_insn_last_update = m_gpu->gpu_sim_cycle;
+    m_last_insn_sid = -1;
+  }
+  m_gpu->gpgpu_ctx->func_sim->g_ptx_sim_num_insn += m_ptx_insn;
+  m_ptx_insn = 0;
+}
+
 void simt_core_cluster::reinit() {
   for (unsigned i = 0; i < m_config->n_simt_cores_per_cluster; i++)
     m_core[i]->reinit(0, m_config->n_thread_per_shader, true);
@@ -4159,6 +4746,44 @@ unsigned simt_core_cluster::get_not_completed() const {
   return not_completed;
 }
 
+bool simt_core_cluster::quiet() {
+  if (!m_response_fifo.empty()) return false;
+  for (unsigned i = 0; i < m_config->n_simt_cores_per_cluster; i++)
+    if (!m_core[i]->quiet()) return false;
+  return true;
+}
+
+void simt_core_cluster::skip(unsigned long long n) {
+  for (unsigned i = 0; i < m_config->n_simt_cores_per_cluster; i++)
+    m_core[i]->skip(n);
+  if (m_config->simt_core_sim_order == 1) {
+    std::list<unsigned>::iterator it = m_core_sim_order.begin();
+    std::advance(it, n % m_core_sim_order.size());
+    m_core_sim_order.splice(m_core_sim_order.end(), m_core_sim_order,
+                            m_core_sim_order.begin(), it);
+  }
+}
+
+// issue_block2core() without issuing; true if it may change anything
+bool simt_core_cluster::can_issue_block() {
+  for (unsigned i = 0; i < m_config->n_simt_cores_per_cluster; i++) {
+    kernel_info_t *kernel = m_core[i]->get_kernel();
+    if (m_config->gpgpu_concurrent_kernel_sm ||
+        (!m_gpu->kernel_more_cta_left(kernel) &&
+         m_core[i]->get_not_completed() == 0)) {
+      kernel_info_t *selected;
+      if (!m_gpu->select_kernel_stable(&selected)) return true;
+      // the core would be bound to it
+      if (!m_config->gpgpu_concurrent_kernel_sm && selected) return true;
+      kernel = selected;
+    }
+    if (m_gpu->kernel_more_cta_left(kernel) &&
+        m_core[i]->can_issue_1block(*kernel))
+      return true;
+  }
+  return false;
+}
+
 void simt_core_cluster::print_not_completed(FILE *fp) const {
   for (unsigned i = 0; i < m_config->n_simt_cores_per_cluster; i++) {
     unsigned not_completed = m_core[i]->get_not_completed();
@@ -4242,6 +4867,12 @@ void simt_core_cluster::cache_invalidate() {
 bool simt_core_cluster::icnt_injection_buffer_full(unsigned size, bool write) {
   unsigned request_size = size;
   if (!write) request_size = READ_PACKET_SIZE;
+  if (m_icnt_staged) {
+    bool has_buffer = ::icnt_packet_space(request_size) <= m_icnt_space;
+    icnt_staged_t r = {NULL, request_size, has_buffer, 0, 0};
+    m_icnt_requests.push_back(r);
+    return !has_buffer;
+  }
   return !::icnt_has_buffer(m_cluster_id, request_size);
 }
 
@@ -4307,25 +4938,37 @@ void simt_core_cluster::icnt_inject_request_packet(class mem_fetch *mf) {
                  m_gpu->gpu_sim_cycle + m_gpu->gpu_tot_sim_cycle);
 
 
-  unsigned char buffer[128];
-
   unsigned core_local_id =
       mf->get_sid() % m_config->n_simt_cores_per_cluster;  // song
   shader_core_ctx *core = m_core[core_local_id];
 
-  core->get_gpu()->get_global_memory()->read(mf->get_addr(), mf->get_data_size(), buffer);
-  mf->write_data(buffer);//song
-  // core->m_warp[mf->get_wid()];
-
   mf->set_inst_count(core->m_warp[mf->get_wid()]->m_inst_count);  // song
 
   //printf("memory inject\n");
-  if (!mf->get_is_write() && !mf->isatomic())
-    ::icnt_push(m_cluster_id, m_config->mem2device(destination), (void *)mf,
-                mf->get_ctrl_size());
-  else
-    ::icnt_push(m_cluster_id, m_config->mem2device(destination), (void *)mf,
-                mf->size());
+  unsigned size = mf->size();
+  if (!mf->get_is_write() && !mf->isatomic()) size = mf->get_ctrl_size();
+  unsigned output = m_config->mem2device(destination);
+  if (m_icnt_staged) {
+    unsigned n = ::icnt_packet_space(size);
+    m_icnt_space = n < m_icnt_space ? m_icnt_space - n : 0;
+    icnt_staged_t r = {mf, size, true, output,
+                       m_in_order ? m_write_log->size() : LOG_POS_UNKNOWN};
+    m_icnt_requests.push_back(r);
+    return;
+  }
+  icnt_push_request(mf, output, size, 0);
+}
+
+void simt_core_cluster::icnt_push_request(mem_fetch *mf, unsigned output,
+                                          unsigned size, size_t log_pos) {
+  unsigned char buffer[128];
+  m_gpu->get_global_memory()->read(mf->get_addr(), mf->get_data_size(),
+                                   buffer);
+  if (m_icnt_staged)
+    m_write_log->undo(log_pos, mf->get_addr(), mf->get_data_size(), buffer);
+  mf->write_data(buffer);  // song
+
+  ::icnt_push(m_cluster_id, output, (void *)mf, size);
 }
 
 void simt_core_cluster::icnt_cycle() {
@@ -4395,6 +5038,12 @@ void simt_core_cluster::print_cache_stats(FILE *fp, unsigned &dl1_accesses,
   }
 }
 
+void simt_core_cluster::checkpoint_state(uarch_checkpoint &cp) {
+  for (unsigned i = 0; i < m_config->n_simt_cores_per_cluster; ++i) {
+    m_core[i]->checkpoint_state(cp);
+  }
+}
+
 void simt_core_cluster::get_icnt_stats(long &n_simt_to_mem,
                                        long &n_mem_to_simt) const {
   long simt_to_mem = 0;
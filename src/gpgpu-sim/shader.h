@@ -54,6 +54,7 @@
 #include "stack.h"
 #include "stats.h"
 #include "traffic_breakdown.h"
+#include "warp_trace.h"
 
 #define NO_OP_FLAG 0xFF
 
@@ -308,6 +309,7 @@ int register_bank(int regnum, int wid, unsigned num_banks,
 class shader_core_ctx;
 class shader_core_config;
 class shader_core_stats;
+class mem_write_log;
 
 enum scheduler_prioritization_type {
   SCHEDULER_PRIORITIZATION_LRR = 0,   // Loose Round Robin
@@ -356,6 +358,9 @@ class scheduler_unit {  // this can be copied freely, so can be used in std
         m_id(id) {}
   virtual ~scheduler_unit() {}
   virtual void add_supervised_warp_id(int i) {
+    if ((unsigned)i >= m_supervised_slot.size())
+      m_supervised_slot.resize(i + 1, -1);
+    m_supervised_slot[i] = m_supervised_warps.size();
     m_supervised_warps.push_back(&warp(i));
   }
   virtual void done_adding_supervised_warps() {
@@ -367,6 +372,12 @@ class scheduler_unit {  // this can be copied freely, so can be used in std
   // modified by changing the contents of the m_next_cycle_prioritized_warps
   // list.
   void cycle();
+  // True if cycle() would issue nothing and change no warp, only count a
+  // stall in shader_cycle_distro[*distro]. The caller has made sure that no
+  // warp would clear a memory barrier in waiting().
+  bool stalled(unsigned *distro);
+  // order_warps() gives the same order again while nothing issues
+  virtual bool stable_order() const { return true; }
 
   // These are some common ordering fucntions that the
   // higher order schedulers can take advantage of
@@ -393,14 +404,26 @@ class scheduler_unit {  // this can be copied freely, so can be used in std
       unsigned num_warps_to_add, OrderingType age_ordering,
       bool (*priority_func)(U lhs, U rhs));
   static bool sort_warps_by_oldest_dynamic_id(shd_warp_t *lhs, shd_warp_t *rhs);
+  // Same order as order_by_priority with sort_warps_by_oldest_dynamic_id, but
+  // kept incrementally in m_warps_by_age instead of sorted every cycle
+  void order_by_age(
+      std::vector<shd_warp_t *> &result_list,
+      const std::vector<shd_warp_t *>::const_iterator &last_issued_from_input,
+      unsigned num_warps_to_add, OrderingType ordering);
 
   // Derived classes can override this function to populate
   // m_supervised_warps with their scheduling policies
   virtual void order_warps() = 0;
+  // Rebuilds the order from scratch the way order_warps() used to, for
+  // -gpgpu_scheduler_order_check. Returns false if there is no reference.
+  virtual bool reference_order(std::vector<shd_warp_t *> &result_list) {
+    return false;
+  }
 
   int get_schd_id() const { return m_id; }
 
  protected:
+  void check_warp_order();
   virtual void do_on_warp_issued(
       unsigned warp_id, unsigned num_issued,
       const std::vector<shd_warp_t *>::const_iterator &prioritized_iter);
@@ -419,6 +442,13 @@ class scheduler_unit {  // this can be copied freely, so can be used in std
   std::vector<shd_warp_t *> m_supervised_warps;
   // This is the iterator pointer to the last supervised warp you issued
   std::vector<shd_warp_t *>::const_iterator m_last_supervised_issued;
+  // Position of each warp id in m_supervised_warps, -1 if not supervised
+  std::vector<int> m_supervised_slot;
+  // m_supervised_warps sorted by dynamic warp id and whether each of them
+  // could issue this cycle, used by order_by_age
+  std::vector<shd_warp_t *> m_warps_by_age;
+  std::vector<bool> m_warp_ready;
+  std::vector<shd_warp_t *> m_reference_order;
   shader_core_stats *m_stats;
   shader_core_ctx *m_shader;
   // these things should become accessors: but would need a bigger rearchitect
@@ -452,9 +482,15 @@ class lrr_scheduler : public scheduler_unit {
                        mem_out, id) {}
   virtual ~lrr_scheduler() {}
   virtual void order_warps();
+  virtual bool reference_order(std::vector<shd_warp_t *> &result_list);
   virtual void done_adding_supervised_warps() {
     m_last_supervised_issued = m_supervised_warps.end();
+    m_ordered_after = m_supervised_warps.end();
   }
+
+ private:
+  // The round-robin order only changes when a warp issues
+  std::vector<shd_warp_t *>::const_iterator m_ordered_after;
 };
 
 class gto_scheduler : public scheduler_unit {
@@ -471,6 +507,7 @@ class gto_scheduler : public scheduler_unit {
                        mem_out, id) {}
   virtual ~gto_scheduler() {}
   virtual void order_warps();
+  virtual bool reference_order(std::vector<shd_warp_t *> &result_list);
   virtual void done_adding_supervised_warps() {
     m_last_supervised_issued = m_supervised_warps.begin();
   }
@@ -490,6 +527,7 @@ class oldest_scheduler : public scheduler_unit {
                        mem_out, id) {}
   virtual ~oldest_scheduler() {}
   virtual void order_warps();
+  virtual bool reference_order(std::vector<shd_warp_t *> &result_list);
   virtual void done_adding_supervised_warps() {
     m_last_supervised_issued = m_supervised_warps.begin();
   }
@@ -522,6 +560,8 @@ class two_level_active_scheduler : public scheduler_unit {
   }
   virtual ~two_level_active_scheduler() {}
   virtual void order_warps();
+  // order_warps() moves warps between the active and pending sets
+  virtual bool stable_order() const { return false; }
   void add_supervised_warp_id(int i) {
     if (m_next_cycle_prioritized_warps.size() < m_max_active_warps) {
       m_next_cycle_prioritized_warps.push_back(&warp(i));
@@ -557,6 +597,7 @@ class swl_scheduler : public scheduler_unit {
                 register_set *mem_out, int id, char *config_string);
   virtual ~swl_scheduler() {}
   virtual void order_warps();
+  virtual bool reference_order(std::vector<shd_warp_t *> &result_list);
   virtual void done_adding_supervised_warps() {
     m_last_supervised_issued = m_supervised_warps.begin();
   }
@@ -590,6 +631,12 @@ class opndcoll_rfu_t {  // operand collector based register file unit
     for (unsigned p = 0; p < m_in_ports.size(); p++) allocate_cu(p);
     process_banks();
   }
+  // no collector unit holds an instruction, so step() only takes in new ones
+  bool idle() const {
+    for (unsigned n = 0; n < m_cu.size(); n++)
+      if (!m_cu[n]->is_free()) return false;
+    return true;
+  }
 
   void dump(FILE *fp) const {
     fprintf(fp, "\n");
@@ -756,29 +803,22 @@ class opndcoll_rfu_t {  // operand collector based register file unit
    public:
     // constructors
     arbiter_t() {
+      m_num_banks = 0;
+      m_num_collectors = 0;
       m_queue = NULL;
       m_allocated_bank = NULL;
-      m_allocator_rr_head = NULL;
-      _inmatch = NULL;
-      _outmatch = NULL;
-      _request = NULL;
-      m_last_cu = 0;
     }
     void init(unsigned num_cu, unsigned num_banks) {
       assert(num_cu > 0);
       assert(num_banks > 0);
       m_num_collectors = num_cu;
       m_num_banks = num_banks;
-      _inmatch = new int[m_num_banks];
-      _outmatch = new int[m_num_collectors];
-      _request = new int *[m_num_banks];
-      for (unsigned i = 0; i < m_num_banks; i++)
-        _request[i] = new int[m_num_collectors];
-      m_queue = new std::list<op_t>[num_banks];
+      m_queue = new bank_queue_t[num_banks];
       m_allocated_bank = new allocation_t[num_banks];
-      m_allocator_rr_head = new unsigned[num_cu];
-      for (unsigned n = 0; n < num_cu; n++)
-        m_allocator_rr_head[n] = n % num_banks;
+      unsigned num_words = (num_banks + 63) / 64;
+      m_pending_banks.assign(num_words, 0);
+      m_write_banks.assign(num_words, 0);
+      m_allocated_banks.assign(num_words, 0);
       reset_alloction();
     }
 
@@ -789,9 +829,8 @@ class opndcoll_rfu_t {  // operand collector based register file unit
       fprintf(fp, "  requests:\n");
       for (unsigned b = 0; b < m_num_banks; b++) {
         fprintf(fp, "    bank %u : ", b);
-        std::list<op_t>::const_iterator o = m_queue[b].begin();
-        for (; o != m_queue[b].end(); o++) {
-          o->dump(fp);
+        for (unsigned i = 0; i < m_queue[b].size(); i++) {
+          m_queue[b].at(i).dump(fp);
         }
         fprintf(fp, "\n");
       }
@@ -804,7 +843,7 @@ class opndcoll_rfu_t {  // operand collector based register file unit
     }
 
     // modifiers
-    std::list<op_t> allocate_reads();
+    void allocate_reads(std::vector<op_t> &result);
 
     void add_read_requests(collector_unit_t *cu) {
       const op_t *src = cu->get_operands();
@@ -813,6 +852,7 @@ class opndcoll_rfu_t {  // operand collector based register file unit
         if (op.valid()) {
           unsigned bank = op.get_bank();
           m_queue[bank].push_back(op);
+          set_bank(m_pending_banks, bank);
         }
       }
     }
@@ -822,29 +862,75 @@ class opndcoll_rfu_t {  // operand collector based register file unit
     void allocate_bank_for_write(unsigned bank, const op_t &op) {
       assert(bank < m_num_banks);
       m_allocated_bank[bank].alloc_write(op);
+      set_bank(m_write_banks, bank);
+      set_bank(m_allocated_banks, bank);
     }
     void allocate_for_read(unsigned bank, const op_t &op) {
       assert(bank < m_num_banks);
       m_allocated_bank[bank].alloc_read(op);
+      set_bank(m_allocated_banks, bank);
     }
     void reset_alloction() {
-      for (unsigned b = 0; b < m_num_banks; b++) m_allocated_bank[b].reset();
+      for (unsigned w = 0; w < m_allocated_banks.size(); w++) {
+        for (unsigned long long busy = m_allocated_banks[w]; busy;
+             busy &= busy - 1) {
+          m_allocated_bank[w * 64 + __builtin_ctzll(busy)].reset();
+        }
+        m_allocated_banks[w] = 0;
+        m_write_banks[w] = 0;
+      }
     }
 
    private:
+    // FIFO of the read requests to one bank. A power-of-two ring buffer that
+    // only grows, so steady state queueing does not touch the heap.
+    class bank_queue_t {
+     public:
+      bank_queue_t() : m_head(0), m_size(0) {}
+      bool empty() const { return m_size == 0; }
+      unsigned size() const { return m_size; }
+      const op_t &at(unsigned i) const {
+        return m_ring[(m_head + i) & (m_ring.size() - 1)];
+      }
+      const op_t &front() const { return m_ring[m_head]; }
+      void push_back(const op_t &op) {
+        if (m_size == m_ring.size()) grow();
+        m_ring[(m_head + m_size) & (m_ring.size() - 1)] = op;
+        m_size++;
+      }
+      void pop_front() {
+        assert(m_size > 0);
+        m_head = (m_head + 1) & (m_ring.size() - 1);
+        m_size--;
+      }
+
+     private:
+      void grow() {
+        std::vector<op_t> ring(m_ring.empty() ? 8 : 2 * m_ring.size());
+        for (unsigned i = 0; i < m_size; i++) ring[i] = at(i);
+        m_ring.swap(ring);
+        m_head = 0;
+      }
+      std::vector<op_t> m_ring;
+      unsigned m_head;
+      unsigned m_size;
+    };
+
+    static void set_bank(std::vector<unsigned long long> &mask, unsigned bank) {
+      mask[bank / 64] |= 1ULL << (bank % 64);
+    }
+
     unsigned m_num_banks;
     unsigned m_num_collectors;
 
     allocation_t *m_allocated_bank;  // bank # -> register that wins
-    std::list<op_t> *m_queue;
-
-    unsigned *
-        m_allocator_rr_head;  // cu # -> next bank to check for request (rr-arb)
-    unsigned m_last_cu;       // first cu to check while arb-ing banks (rr)
+    bank_queue_t *m_queue;
 
-    int *_inmatch;
-    int *_outmatch;
-    int **_request;
+    // one bit per bank: has queued read requests, is allocated for a write,
+    // is allocated for anything (so reset_alloction only visits those)
+    std::vector<unsigned long long> m_pending_banks;
+    std::vector<unsigned long long> m_write_banks;
+    std::vector<unsigned long long> m_allocated_banks;
   };
 
   class input_port_t {
@@ -896,7 +982,7 @@ class opndcoll_rfu_t {  // operand collector based register file unit
     unsigned get_num_operands() const { return m_warp->get_num_operands(); }
     unsigned get_num_regs() const { return m_warp->get_num_regs(); }
     void dispatch();
-    bool is_free() { return m_free; }
+    bool is_free() const { return m_free; }
 
    private:
     bool m_free;
@@ -952,6 +1038,7 @@ class opndcoll_rfu_t {  // operand collector based register file unit
   unsigned m_warp_size;
   std::vector<collector_unit_t *> m_cu;
   arbiter_t m_arbiter;
+  std::vector<op_t> m_granted_reads;
 
   unsigned m_num_banks_per_sched;
   unsigned m_num_warp_sceds;
@@ -1059,6 +1146,10 @@ class simd_function_unit {
     return m_dispatch_reg->empty() && !occupied.test(inst.latency);
   }
   virtual bool stallable() const = 0;
+  // cycle() would only count down the occupied issue slots
+  virtual bool idle() const { return false; }
+  // n calls to cycle() of an idle() unit
+  virtual void skip(unsigned long long n) {}
   virtual void print(FILE *fp) const {
     fprintf(fp, "%s dispatch= ", m_name.c_str());
     m_dispatch_reg->print(fp);
@@ -1098,6 +1189,12 @@ class pipelined_simd_unit : public simd_function_unit {
   virtual bool can_issue(const warp_inst_t &inst) const {
     return simd_function_unit::can_issue(inst);
   }
+  virtual bool idle() const {
+    return m_dispatch_reg->empty() && !active_insts_in_pipeline;
+  }
+  virtual void skip(unsigned long long n) {
+    occupied >>= std::min<unsigned long long>(n, MAX_ALU_LATENCY);
+  }
   virtual void print(FILE *fp) const {
     simd_function_unit::print(fp);
     for (int s = m_pipeline_depth - 1; s >= 0; s--) {
@@ -1296,6 +1393,9 @@ class ldst_unit : public pipelined_simd_unit {
 
   virtual void active_lanes_in_pipeline();
   virtual bool stallable() const { return true; }
+  // nothing to write back, issue, fill or send, and no operand collection
+  virtual bool idle() const;
+  virtual void skip(unsigned long long n);
   bool response_buffer_full() const;
   void print(FILE *fout) const;
   void print_cache_stats(FILE *fp, unsigned &dl1_accesses,
@@ -1304,6 +1404,7 @@ class ldst_unit : public pipelined_simd_unit {
                        unsigned &read_misses, unsigned &write_misses,
                        unsigned cache_type);
   void get_cache_stats(cache_stats &cs);
+  void checkpoint_state(uarch_checkpoint &cp);
 
   void get_L1D_sub_stats(struct cache_sub_stats &css) const;
   void get_L1C_sub_stats(struct cache_sub_stats &css) const;
@@ -1533,6 +1634,7 @@ class shader_core_config : public core_config {
   unsigned gpgpu_num_sched_per_core;
   int gpgpu_max_insn_issue_per_warp;
   bool gpgpu_dual_issue_diff_exec_units;
+  bool gpgpu_scheduler_order_check;
 
   // op collector
   bool enable_specialized_operand_collector;
@@ -1800,18 +1902,47 @@ class shader_core_stats : public shader_core_stats_pod {
 
     m_shader_dynamic_warp_issue_distro.resize(config->num_shader());
     m_shader_warp_slot_issue_distro.resize(config->num_shader());
+    m_main = NULL;
+  }
+
+  // The stats of one cluster stepped alongside the others: the per-core
+  // arrays are those of main, the totals over the cores its own until
+  // merge() adds them to main.
+  shader_core_stats(shader_core_stats *main) {
+    m_config = main->m_config;
+    memcpy(this->shader_core_stats_pod_start, main->shader_core_stats_pod_start,
+           sizeof(shader_core_stats_pod));
+    clear_totals();
+    shader_cycle_distro =
+        (unsigned *)calloc(m_config->warp_size + 3, sizeof(unsigned));
+    last_shader_cycle_distro = NULL;
+    single_issue_nums = (unsigned *)calloc(m_config->gpgpu_num_sched_per_core,
+                                           sizeof(unsigned));
+    dual_issue_nums = (unsigned *)calloc(m_config->gpgpu_num_sched_per_core,
+                                         sizeof(unsigned));
+    m_outgoing_traffic_stats = new traffic_breakdown("coretomem");
+    m_incoming_traffic_stats = new traffic_breakdown("memtocore");
+    m_main = main;
   }
 
   ~shader_core_stats() {
     delete m_outgoing_traffic_stats;
     delete m_incoming_traffic_stats;
+    free(shader_cycle_distro);
+    if (m_main) {
+      free(single_issue_nums);
+      free(dual_issue_nums);
+      return;
+    }
     free(m_num_sim_insn);
     free(m_num_sim_winsn);
     free(m_n_diverge);
-    free(shader_cycle_distro);
     free(last_shader_cycle_distro);
   }
 
+  // adds the totals of a cluster's stats into the main ones and clears them
+  void merge();
+
   void new_grid() {}
 
   void event_warp_issued(unsigned s_id, unsigned warp_id, unsigned num_issued,
@@ -1821,6 +1952,8 @@ class shader_core_stats : public shader_core_stats_pod {
 
   void print(FILE *fout) const;
 
+  void checkpoint_state(uarch_checkpoint &cp);
+
   const std::vector<std::vector<unsigned>> &get_dynamic_warp_issue() const {
     return m_shader_dynamic_warp_issue_distro;
   }
@@ -1830,7 +1963,10 @@ class shader_core_stats : public shader_core_stats_pod {
   }
 
  private:
+  void clear_totals();
+
   const shader_core_config *m_config;
+  shader_core_stats *m_main;  // NULL unless the stats of a cluster
 
   traffic_breakdown *m_outgoing_traffic_stats;  // core to memory partitions
   traffic_breakdown *m_incoming_traffic_stats;  // memory partition to core
@@ -1888,6 +2024,12 @@ class shader_core_ctx : public core_t {
   // used by simt_core_cluster:
   // modifiers
   void cycle();
+  // True if cycle() would change nothing but the cycle and stall counts: no
+  // warp can be fetched, reclaimed or issued (they wait on registers from
+  // memory, barriers or instruction misses) and no unit has work that moves
+  bool quiet();
+  // n calls to cycle() of a quiet() core
+  void skip(unsigned long long n);
   void reinit(unsigned start_thread, unsigned end_thread,
               bool reset_not_completed);
   void issue_block2core(class kernel_info_t &kernel);
@@ -1919,6 +2061,7 @@ class shader_core_ctx : public core_t {
   }
   kernel_info_t *get_kernel() { return m_kernel; }
   unsigned get_sid() const { return m_sid; }
+  class simt_core_cluster *get_cluster() { return m_cluster; }
 
   // used by functional simulation:
   // modifiers
@@ -1950,6 +2093,7 @@ class shader_core_ctx : public core_t {
                          unsigned &dl1_misses);
 
   void get_cache_stats(cache_stats &cs);
+  void checkpoint_state(uarch_checkpoint &cp);
   void get_L1I_sub_stats(struct cache_sub_stats &css) const;
   void get_L1D_sub_stats(struct cache_sub_stats &css) const;
   void get_L1C_sub_stats(struct cache_sub_stats &css) const;
@@ -2203,6 +2347,9 @@ class shader_core_ctx : public core_t {
   unsigned m_n_active_cta;  // number of Cooperative Thread Arrays (blocks)
                             // currently running on this shader.
   unsigned m_cta_status[MAX_CTA_PER_SHADER];  // CTAs status
+  // kernel and grid-wide id of the CTA in each slot
+  const kernel_info_t *m_cta_kernel[MAX_CTA_PER_SHADER];
+  unsigned m_cta_ctaid[MAX_CTA_PER_SHADER];
   unsigned m_not_completed;  // number of threads to be completed (==0 when all
                              // thread on this core completed)
   std::bitset<MAX_THREAD_PER_SM> m_active_threads;
@@ -2235,6 +2382,8 @@ class shader_core_ctx : public core_t {
 
   // issue
   unsigned int Issue_Prio;
+  // shader_cycle_distro entry each scheduler counts while quiet()
+  std::vector<unsigned> m_quiet_distro;
 
   // execute
   unsigned m_num_function_units;
@@ -2302,6 +2451,16 @@ class exec_shader_core_ctx : public shader_core_ctx {
                                        unsigned *pc, unsigned *rpc);
   virtual const active_mask_t &get_active_mask(unsigned warp_id,
                                                const warp_inst_t *pI);
+  virtual void updateSIMTStack(unsigned warpId, warp_inst_t *inst);
+
+ private:
+  // -gpgpu_trace_capture / -gpgpu_trace_replay
+  warp_trace::key_t trace_key(unsigned warp_id) const;
+  void trace_capture(const warp_inst_t &inst);
+  void trace_replay(warp_inst_t &inst);
+
+  // replay: the record of the instruction being issued
+  warp_trace_record m_trace_rec;
 };
 
 class simt_core_cluster {
@@ -2333,6 +2492,12 @@ class simt_core_cluster {
                                unsigned *rpc) const;
   unsigned max_cta(const kernel_info_t &kernel);
   unsigned get_not_completed() const;
+  // no response to take in and every core quiet()
+  bool quiet();
+  // n calls to core_cycle() of a quiet() cluster
+  void skip(unsigned long long n);
+  // issue_block2core() could issue a CTA or bind a core to a kernel
+  bool can_issue_block();
   void print_not_completed(FILE *fp) const;
   unsigned get_n_active_cta() const;
   unsigned get_n_active_sms() const;
@@ -2343,6 +2508,7 @@ class simt_core_cluster {
                          unsigned &dl1_misses) const;
 
   void get_cache_stats(cache_stats &cs) const;
+  void checkpoint_state(uarch_checkpoint &cp);
   void get_L1I_sub_stats(struct cache_sub_stats &css) const;
   void get_L1D_sub_stats(struct cache_sub_stats &css) const;
   void get_L1C_sub_stats(struct cache_sub_stats &css) const;
@@ -2353,7 +2519,39 @@ class simt_core_cluster {
                               unsigned long long &total) const;
   virtual void create_shader_core_ctx() = 0;
 
+  // With -gpgpu_sim_threads the clusters step a clock edge at once. Before
+  // anything another cluster or the rest of the GPU can see (global memory,
+  // CTA and kernel completion) a cluster calls order(), which waits until
+  // every lower-numbered cluster is done with the edge, so those effects
+  // happen in the order of a serial run. A no-op when stepped serially.
+  void order() {
+    if (!m_in_order) wait_lower_clusters();
+  }
+  bool in_order() const { return m_in_order; }
+  // the next core_cycle() runs alongside the other clusters, which log
+  // their global memory writes into log: its network requests are staged
+  // until drain_icnt()
+  void begin_concurrent_cycle(const mem_write_log &log);
+  // core_cycle() has returned
+  void end_concurrent_cycle();
+  // makes the staged requests, with the packet data global memory held when
+  // they were made; log_pos is where the writes of the clusters drained so
+  // far end in the log, and is moved past the writes of this one
+  void drain_icnt(size_t &log_pos);
+
+  // gpu_sim_insn and the core that last updated it, set by commit_sim_insn()
+  // in cluster order once the clusters have stepped
+  void add_sim_insn(unsigned n) { m_sim_insn += n; }
+  void set_last_insn_sid(unsigned sid) { m_last_insn_sid = sid; }
+  void commit_sim_insn();
+  // counter of the functional instructions of the threads of the cluster
+  unsigned *ptx_insn_counter() { return &m_ptx_insn; }
+
  protected:
+  void wait_lower_clusters();
+  void icnt_push_request(mem_fetch *mf, unsigned output, unsigned size,
+                         size_t log_pos);
+
   unsigned m_cluster_id;
   gpgpu_sim *m_gpu;
   const shader_core_config *m_config;
@@ -2365,6 +2563,26 @@ class simt_core_cluster {
   unsigned m_cta_issue_next_core;
   std::list<unsigned> m_core_sim_order;
   std::list<mem_fetch *> m_response_fifo;
+
+  // concurrent stepping: see order()
+  static const size_t LOG_POS_UNKNOWN = (size_t)-1;
+  bool m_in_order;
+  const mem_write_log *m_write_log;
+  size_t m_log_end;  // writes in the log when the cluster was done
+  struct icnt_staged_t {
+    mem_fetch *mf;  // NULL for a has_buffer query
+    unsigned size;
+    bool has_buffer;
+    unsigned output;
+    size_t log_pos;  // writes made before the request
+  };
+  bool m_icnt_staged;
+  unsigned m_icnt_space;  // left at the input of the cluster
+  std::vector<icnt_staged_t> m_icnt_requests;
+
+  unsigned long long m_sim_insn;
+  int m_last_insn_sid;
+  unsigned m_ptx_insn;
 };
 
 class exec_simt_core_cluster : public simt_core_cluster {
@@ -2410,8 +2628,10 @@ class perfect_memory_interface : public mem_fetch_interface {
     return m_cluster->response_queue_full();
   }
   virtual void push(mem_fetch *mf) {
-    if (mf && mf->isatomic())
+    if (mf && mf->isatomic()) {
+      m_cluster->order();
       mf->do_atomic();  // execute atomic inside the "memory subsystem"
+    }
     m_core->inc_simt_to_mem(mf->get_num_flits(true));
     m_cluster->push_response_fifo(mf);
   }
@@ -0,0 +1,68 @@
+#include "sim_profile.h"
+
+#if SIM_PROFILE_ON
+
+#include <string.h>
+#include <sys/time.h>
+
+static const char *const phase_names[N_PROF_PHASES] = {
+    "cycle",       "icnt_cycle",    "partition_pop", "uplink_step",
+    "dram_cycle",  "dnlink_step",   "cache_cycle",   "icnt_transfer",
+    "core_cycle",  "mcpat_cycle",   "stat_sample"};
+
+static double wall_time() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+sim_profile::sim_profile() {
+  memset(m_ticks, 0, sizeof(m_ticks));
+  memset(m_calls, 0, sizeof(m_calls));
+  memset(m_last_ticks, 0, sizeof(m_last_ticks));
+  m_start_time = wall_time();
+  m_start_ticks = sim_profile_ticks();
+}
+
+double sim_profile::ticks_per_sec() const {
+  double elapsed = wall_time() - m_start_time;
+  if (elapsed <= 0) return 1e9;
+  return (sim_profile_ticks() - m_start_ticks) / elapsed;
+}
+
+void sim_profile::print_interval(FILE *fout) {
+  unsigned long long total = m_ticks[PROF_CYCLE] - m_last_ticks[PROF_CYCLE];
+  fprintf(fout, "GPGPU-Sim uArch: self-profile:");
+  for (unsigned p = PROF_CYCLE + 1; p < N_PROF_PHASES; p++) {
+    unsigned long long ticks = m_ticks[p] - m_last_ticks[p];
+    if (ticks)
+      fprintf(fout, " %s=%.1f%%", phase_names[p],
+              total ? 100.0 * ticks / total : 0);
+  }
+  fprintf(fout, " (%.2f sec in cycle())\n", total / ticks_per_sec());
+  memcpy(m_last_ticks, m_ticks, sizeof(m_ticks));
+}
+
+void sim_profile::print(FILE *fout) const {
+  double tps = ticks_per_sec();
+  unsigned long long total = m_ticks[PROF_CYCLE];
+  unsigned long long phases = 0;
+  fprintf(fout, "gpgpu_self_profile:\n");
+  fprintf(fout, "  %-16s %12s %14s %10s %7s\n", "phase", "sec", "calls",
+          "ns/call", "share");
+  for (unsigned p = 0; p < N_PROF_PHASES; p++) {
+    if (p != PROF_CYCLE) phases += m_ticks[p];
+    fprintf(fout, "  %-16s %12.3f %14llu %10.1f %6.1f%%\n", phase_names[p],
+            m_ticks[p] / tps, m_calls[p],
+            m_calls[p] ? 1e9 * m_ticks[p] / tps / m_calls[p] : 0,
+            total ? 100.0 * m_ticks[p] / total : 0);
+  }
+  // dram stat flushes, cache invalidation, CTA issue and the like
+  unsigned long long other = total > phases ? total - phases : 0;
+  fprintf(fout, "  %-16s %12.3f %14s %10s %6.1f%%\n", "other", other / tps,
+          "", "", total ? 100.0 * other / total : 0);
+  fprintf(fout, "  %-16s %12.3f\n", "wall",
+          (sim_profile_ticks() - m_start_ticks) / tps);
+}
+
+#endif
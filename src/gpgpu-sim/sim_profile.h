@@ -0,0 +1,92 @@
+#ifndef SIM_PROFILE_H
+#define SIM_PROFILE_H
+
+#include <stdio.h>
+
+// Self-profiling of gpgpu_sim::cycle(), built with PROFILE=1. Each phase of
+// a clock edge runs under a SIM_PROFILE_PHASE timer reading the time stamp
+// counter; without SIM_PROFILE_ON the timers compile to nothing.
+#ifndef SIM_PROFILE_ON
+#define SIM_PROFILE_ON 0
+#endif
+
+enum sim_profile_phase {
+  PROF_CYCLE,  // the whole of cycle(), the phases below included
+  PROF_ICNT_CYCLE,
+  PROF_PARTITION_POP,
+  PROF_UPLINK,
+  PROF_DRAM_CYCLE,  // with worker threads, the link steps too
+  PROF_DNLINK,
+  PROF_CACHE_CYCLE,  // the interconnect pops into the partitions too
+  PROF_ICNT_TRANSFER,
+  PROF_CORE_CYCLE,
+  PROF_MCPAT_CYCLE,
+  PROF_STAT_SAMPLE,
+  N_PROF_PHASES
+};
+
+#if SIM_PROFILE_ON
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+inline unsigned long long sim_profile_ticks() { return __rdtsc(); }
+#else
+#include <time.h>
+inline unsigned long long sim_profile_ticks() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+class sim_profile {
+ public:
+  sim_profile();
+
+  void add(sim_profile_phase phase, unsigned long long ticks) {
+    m_ticks[phase] += ticks;
+    m_calls[phase]++;
+  }
+  // share of each phase since the previous call, on one line
+  void print_interval(FILE *fout);
+  // totals since the simulator was built
+  void print(FILE *fout) const;
+
+ private:
+  double ticks_per_sec() const;
+
+  unsigned long long m_ticks[N_PROF_PHASES];
+  unsigned long long m_calls[N_PROF_PHASES];
+  unsigned long long m_last_ticks[N_PROF_PHASES];
+  // calibrates the counter against the wall clock
+  double m_start_time;
+  unsigned long long m_start_ticks;
+};
+
+class sim_profile_timer {
+ public:
+  sim_profile_timer(sim_profile &profile, sim_profile_phase phase)
+      : m_profile(profile), m_phase(phase), m_start(sim_profile_ticks()) {}
+  ~sim_profile_timer() {
+    m_profile.add(m_phase, sim_profile_ticks() - m_start);
+  }
+
+ private:
+  sim_profile &m_profile;
+  sim_profile_phase m_phase;
+  unsigned long long m_start;
+};
+
+#define SIM_PROFILE_CAT2(a, b) a##b
+#define SIM_PROFILE_CAT(a, b) SIM_PROFILE_CAT2(a, b)
+// times the rest of the enclosing scope
+#define SIM_PROFILE_PHASE(profile, phase) \
+  sim_profile_timer SIM_PROFILE_CAT(sim_profile_timer_, __LINE__)(profile, phase)
+
+#else
+
+#define SIM_PROFILE_PHASE(profile, phase)
+
+#endif
+
+#endif
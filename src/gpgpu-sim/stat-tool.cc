@@ -29,6 +29,7 @@
 #include "stat-tool.h"
 
 #include <assert.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <zlib.h>
@@ -112,6 +113,15 @@ void spill_log_to_file(FILE *fout, int final,
       current_cycle + spill_interval;  // WF: stateful testing, maybe bad
 }
 
+unsigned long long next_stat_tool_cycle(unsigned long long current_cycle) {
+  unsigned long long next = ULLONG_MAX;
+  if (min_snap_shot_interval && next_snap_shot_cycle > current_cycle)
+    next = next_snap_shot_cycle;
+  if (spill_interval)
+    next = std::min(next, std::max(next_spill_cycle, current_cycle) + 1);
+  return next;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 static int n_thread_CFloggers = 0;
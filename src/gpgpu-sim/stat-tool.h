@@ -271,6 +271,9 @@ class linear_histogram_logger : public snap_shot_trigger,
 void try_snap_shot(unsigned long long current_cycle);
 void set_spill_interval(unsigned long long interval);
 void spill_log_to_file(FILE *fout, int final, unsigned long long current_cycle);
+// first cycle after current_cycle at which try_snap_shot() or
+// spill_log_to_file() would do anything, ULLONG_MAX if none is set up
+unsigned long long next_stat_tool_cycle(unsigned long long current_cycle);
 
 void create_thread_CFlogger(gpgpu_context *ctx, int n_loggers, int n_threads,
                             address_type start_pc,
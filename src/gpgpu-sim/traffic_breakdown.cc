@@ -1,5 +1,6 @@
 #include "traffic_breakdown.h"
 #include "mem_fetch.h"
+#include "uarch_checkpoint.h"
 
 void traffic_breakdown::print(FILE* fout) {
   for (traffic_stat_t::const_iterator i_stat = m_stats.begin();
@@ -24,6 +25,18 @@ void traffic_breakdown::record_traffic(class mem_fetch* mf, unsigned int size) {
   m_stats[classify_memfetch(mf)][size] += 1;
 }
 
+void traffic_breakdown::merge(traffic_breakdown& other) {
+  for (traffic_stat_t::const_iterator i_stat = other.m_stats.begin();
+       i_stat != other.m_stats.end(); i_stat++) {
+    traffic_class_t& stat = m_stats[i_stat->first];
+    for (traffic_class_t::const_iterator i_class = i_stat->second.begin();
+         i_class != i_stat->second.end(); i_class++) {
+      stat[i_class->first] += i_class->second;
+    }
+  }
+  other.m_stats.clear();
+}
+
 std::string traffic_breakdown::classify_memfetch(class mem_fetch* mf) {
   std::string traffic_name;
 
@@ -52,3 +65,7 @@ std::string traffic_breakdown::classify_memfetch(class mem_fetch* mf) {
   }
   return traffic_name;
 }
+
+void traffic_breakdown::checkpoint_state(uarch_checkpoint& cp) {
+  cp.io(m_stats);
+}
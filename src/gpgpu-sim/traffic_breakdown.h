@@ -16,6 +16,11 @@ class traffic_breakdown {
   // record the amount and type of traffic introduced by this mem_fetch object
   void record_traffic(class mem_fetch* mf, unsigned int size);
 
+  // add the traffic recorded by other into this one and clear other
+  void merge(traffic_breakdown& other);
+
+  void checkpoint_state(class uarch_checkpoint& cp);
+
  protected:
   std::string m_network_name;
 
@@ -0,0 +1,133 @@
+#include "uarch_checkpoint.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char UARCH_CHECKPOINT_MAGIC[8] = "GPGPUSM";
+static const unsigned SECTION_NAME_SIZE = 24;
+
+uarch_checkpoint::uarch_checkpoint(const char *filename, mode_t mode) {
+  m_mode = mode;
+  m_filename = filename;
+  m_section = "header";
+  m_variant_start = -1;
+  m_variant_length = 0;
+  m_variant_skipped = false;
+  m_fp = fopen(filename, mode == SAVE ? "wb" : "rb");
+  if (!m_fp) {
+    printf("GPGPU-Sim uArch: ERROR ** cannot open checkpoint file %s\n",
+           filename);
+    abort();
+  }
+
+  char magic[8];
+  memcpy(magic, UARCH_CHECKPOINT_MAGIC, sizeof(magic));
+  unsigned version = VERSION;
+  io(magic, sizeof(magic));
+  io(version);
+  if (memcmp(magic, UARCH_CHECKPOINT_MAGIC, sizeof(magic))) {
+    printf("GPGPU-Sim uArch: ERROR ** %s is not a timing model checkpoint\n",
+           filename);
+    abort();
+  }
+  if (version != VERSION) mismatch("version", VERSION, version);
+}
+
+uarch_checkpoint::~uarch_checkpoint() {
+  if (m_mode == SAVE && (fflush(m_fp) || ferror(m_fp))) {
+    printf("GPGPU-Sim uArch: ERROR ** writing checkpoint file %s failed\n",
+           m_filename.c_str());
+    abort();
+  }
+  fclose(m_fp);
+}
+
+void uarch_checkpoint::section(const char *name, unsigned long long geometry) {
+  char tag[SECTION_NAME_SIZE];
+  memset(tag, 0, sizeof(tag));
+  strncpy(tag, name, sizeof(tag) - 1);
+  unsigned long long found = geometry;
+  io(tag, sizeof(tag));
+  io(found);
+  if (strncmp(tag, name, sizeof(tag) - 1)) {
+    printf(
+        "GPGPU-Sim uArch: ERROR ** checkpoint %s: expected %s after %s, found "
+        "%.*s\n",
+        m_filename.c_str(), name, m_section.c_str(), (int)sizeof(tag), tag);
+    abort();
+  }
+  m_section = name;
+  if (found != geometry) mismatch("geometry", geometry, found);
+}
+
+bool uarch_checkpoint::variant(const char *name, unsigned long long kind) {
+  section(name, 0);
+  assert(m_variant_start < 0);
+  unsigned long long found = kind;
+  unsigned long long length = 0;
+  io(found);
+  m_variant_start = ftell(m_fp);
+  io(length);
+  m_variant_length = length;
+  m_variant_skipped = found != kind;
+  if (m_variant_skipped &&
+      fseek(m_fp, m_variant_start + sizeof(length) + length, SEEK_SET)) {
+    printf("GPGPU-Sim uArch: ERROR ** checkpoint %s: file is truncated in "
+           "section %s\n",
+           m_filename.c_str(), name);
+    abort();
+  }
+  return !m_variant_skipped;
+}
+
+void uarch_checkpoint::end_variant() {
+  assert(m_variant_start >= 0);
+  long start = m_variant_start + sizeof(unsigned long long);
+  unsigned long long length = ftell(m_fp) - start;
+  if (m_mode == SAVE) {
+    fseek(m_fp, m_variant_start, SEEK_SET);
+    io(length);
+    fseek(m_fp, 0, SEEK_END);
+  } else if (!m_variant_skipped && length != m_variant_length) {
+    mismatch("length", length, m_variant_length);
+  }
+  m_variant_start = -1;
+  m_variant_skipped = false;
+}
+
+void uarch_checkpoint::require(bool drained, const char *what) {
+  if (m_mode == SAVE && !drained) {
+    printf(
+        "GPGPU-Sim uArch: ERROR ** checkpoint %s: %s (%s) is not drained\n",
+        m_filename.c_str(), what, m_section.c_str());
+    abort();
+  }
+}
+
+void uarch_checkpoint::io(std::string &value) {
+  unsigned long long n = value.size();
+  io(n);
+  value.resize(n);
+  if (n) raw(&value[0], n);
+}
+
+void uarch_checkpoint::raw(void *data, size_t size) {
+  size_t done = m_mode == SAVE ? fwrite(data, 1, size, m_fp)
+                               : fread(data, 1, size, m_fp);
+  if (done != size) {
+    printf("GPGPU-Sim uArch: ERROR ** checkpoint %s: %s in section %s\n",
+           m_filename.c_str(),
+           m_mode == SAVE ? "write failed" : "file is truncated",
+           m_section.c_str());
+    abort();
+  }
+}
+
+void uarch_checkpoint::mismatch(const char *what, unsigned long long expected,
+                                unsigned long long found) {
+  printf(
+      "GPGPU-Sim uArch: ERROR ** checkpoint %s: %s of section %s is %llu, "
+      "this simulator expects %llu\n",
+      m_filename.c_str(), what, m_section.c_str(), found, expected);
+  abort();
+}
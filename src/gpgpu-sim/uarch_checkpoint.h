@@ -0,0 +1,100 @@
+#ifndef UARCH_CHECKPOINT_H
+#define UARCH_CHECKPOINT_H
+
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// Versioned binary snapshot of the timing model, taken while the GPU is
+// drained (-gpgpu_uarch_checkpoint_kernel) and loaded into a freshly built
+// simulator (-gpgpu_uarch_restore). Each unit lists its state once in a
+// checkpoint_state(uarch_checkpoint &) method that saves or restores
+// depending on the mode, so the two directions cannot drift apart. Values
+// are stored in host byte order.
+class uarch_checkpoint {
+ public:
+  enum mode_t { SAVE, RESTORE };
+  static const unsigned VERSION = 3;
+
+  uarch_checkpoint(const char *filename, mode_t mode);
+  ~uarch_checkpoint();
+
+  bool restoring() const { return m_mode == RESTORE; }
+
+  // starts the state of one unit; the geometry must match on restore, so a
+  // snapshot loads into any configuration with the same cache, DRAM and link
+  // shapes (latencies and the like may differ)
+  void section(const char *name, unsigned long long geometry);
+  // starts a section whose layout depends on a setting that may change
+  // between the saving and the restoring run, such as the link compressor;
+  // the section records its kind and length. Returns false on restore when
+  // the kind differs: the saved data is skipped and the unit keeps the state
+  // it was built with. Ended by end_variant() either way.
+  bool variant(const char *name, unsigned long long kind);
+  void end_variant();
+  // queues and in-flight state that must be empty when saving
+  void require(bool drained, const char *what);
+
+  // plain data only
+  template <class T>
+  void io(T &value) {
+    raw(&value, sizeof(T));
+  }
+  template <class T>
+  void io(T *values, size_t n) {
+    raw(values, n * sizeof(T));
+  }
+  template <class T>
+  void io(std::vector<T> &values) {
+    unsigned long long n = values.size();
+    io(n);
+    if (n != values.size()) mismatch("vector size", values.size(), n);
+    for (size_t i = 0; i < values.size(); i++) io(values[i]);
+  }
+  // containers whose size is state rather than geometry
+  template <class T>
+  void io_size(std::vector<T> &values) {
+    unsigned long long n = values.size();
+    io(n);
+    values.resize(n);
+  }
+  void io(std::string &value);
+  template <class K, class V>
+  void io(std::map<K, V> &values) {
+    unsigned long long n = values.size();
+    io(n);
+    if (!restoring()) {
+      for (typename std::map<K, V>::iterator i = values.begin();
+           i != values.end(); ++i) {
+        K key = i->first;
+        io(key);
+        io(i->second);
+      }
+      return;
+    }
+    values.clear();
+    for (unsigned long long i = 0; i < n; i++) {
+      K key;
+      io(key);
+      io(values[key]);
+    }
+  }
+
+ private:
+  void raw(void *data, size_t size);
+  void mismatch(const char *what, unsigned long long expected,
+                unsigned long long found);
+
+  FILE *m_fp;
+  mode_t m_mode;
+  std::string m_filename;
+  std::string m_section;
+  // file offset of the open variant's length, the length read on restore,
+  // and whether the variant was skipped
+  long m_variant_start;
+  unsigned long long m_variant_length;
+  bool m_variant_skipped;
+};
+
+#endif
@@ -0,0 +1,277 @@
+#include "warp_trace.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+#include "../cuda-sim/memory.h"
+
+static const char WARP_TRACE_MAGIC[8] = "GPGPUWT";
+static const unsigned WARP_TRACE_VERSION = 2;
+
+enum { RECORD_ATOMIC = 1, RECORD_MEMORY = 2 };
+
+template <class T>
+static void put(std::string &out, T value) {
+  out.append((const char *)&value, sizeof(T));
+}
+
+template <class T>
+static bool get(const std::string &in, size_t &pos, T &value) {
+  if (pos + sizeof(T) > in.size()) return false;
+  memcpy(&value, in.data() + pos, sizeof(T));
+  pos += sizeof(T);
+  return true;
+}
+
+static void encode(const warp_trace_record &rec, std::string &out) {
+  bool memory = !rec.addrs.empty() || !rec.store_data.empty();
+  put<address_type>(out, rec.pc);
+  put<unsigned>(out, rec.active);
+  put<unsigned>(out, rec.done);
+  put<address_type>(out, rec.rpc);
+  put<unsigned char>(out, rec.next_pcs.size());
+  for (size_t i = 0; i < rec.next_pcs.size(); i++)
+    put<address_type>(out, rec.next_pcs[i]);
+  if (rec.next_pcs.size() > 1)
+    out.append((const char *)rec.next_pc, MAX_WARP_SIZE);
+  put<unsigned char>(out, (rec.atomic ? RECORD_ATOMIC : 0) |
+                              (memory ? RECORD_MEMORY : 0));
+  put<unsigned char>(out, rec.space.get_type());
+  put<unsigned>(out, rec.space.get_bank());
+  put<unsigned>(out, rec.data_size);
+  if (!memory) return;
+  for (unsigned i = 0; i < MAX_WARP_SIZE; i++)
+    if (rec.active & (1u << i)) put<unsigned char>(out, rec.n_addrs[i]);
+  for (size_t i = 0; i < rec.addrs.size(); i++)
+    put<unsigned long long>(out, rec.addrs[i]);
+  put<unsigned>(out, rec.store_data.size());
+  out.append(rec.store_data);
+}
+
+static bool decode(const std::string &in, size_t &pos,
+                   warp_trace_record &rec) {
+  unsigned char flags, space_type, n_next_pcs;
+  unsigned bank, n_stored;
+  bool ok = get(in, pos, rec.pc) && get(in, pos, rec.active) &&
+            get(in, pos, rec.done) && get(in, pos, rec.rpc) &&
+            get(in, pos, n_next_pcs);
+  if (!ok) return false;
+  rec.next_pcs.resize(n_next_pcs);
+  for (unsigned i = 0; ok && i < n_next_pcs; i++)
+    ok = get(in, pos, rec.next_pcs[i]);
+  memset(rec.next_pc, 0, sizeof(rec.next_pc));
+  if (ok && n_next_pcs > 1) {
+    if (pos + MAX_WARP_SIZE > in.size()) return false;
+    memcpy(rec.next_pc, in.data() + pos, MAX_WARP_SIZE);
+    pos += MAX_WARP_SIZE;
+    for (unsigned i = 0; i < MAX_WARP_SIZE; i++)
+      ok = ok && rec.next_pc[i] < n_next_pcs;
+  }
+  ok = ok && get(in, pos, flags) && get(in, pos, space_type) &&
+       get(in, pos, bank) && get(in, pos, rec.data_size);
+  if (!ok) return false;
+  rec.atomic = flags & RECORD_ATOMIC;
+  rec.space.set_type((enum _memory_space_t)space_type);
+  rec.space.set_bank(bank);
+  memset(rec.n_addrs, 0, sizeof(rec.n_addrs));
+  rec.addrs.clear();
+  rec.store_data.clear();
+  if (!(flags & RECORD_MEMORY)) return true;
+  unsigned n = 0;
+  for (unsigned i = 0; ok && i < MAX_WARP_SIZE; i++) {
+    if (!(rec.active & (1u << i))) continue;
+    ok = get(in, pos, rec.n_addrs[i]);
+    n += rec.n_addrs[i];
+  }
+  rec.addrs.resize(n);
+  for (unsigned i = 0; ok && i < n; i++) ok = get(in, pos, rec.addrs[i]);
+  if (!ok || !get(in, pos, n_stored) || pos + n_stored > in.size())
+    return false;
+  rec.store_data.assign(in, pos, n_stored);
+  pos += n_stored;
+  return true;
+}
+
+warp_trace::warp_trace(const char *filename, bool replay) {
+  m_replay = replay;
+  m_filename = filename;
+  pthread_mutex_init(&m_lock, NULL);
+  m_fp = fopen(filename, replay ? "rb" : "wb");
+  if (!m_fp) {
+    printf("GPGPU-Sim uArch: ERROR ** cannot open trace file %s\n", filename);
+    abort();
+  }
+  char magic[8];
+  unsigned version = WARP_TRACE_VERSION;
+  if (!replay) {
+    memcpy(magic, WARP_TRACE_MAGIC, sizeof(magic));
+    fwrite(magic, sizeof(magic), 1, m_fp);
+    fwrite(&version, sizeof(version), 1, m_fp);
+    return;
+  }
+  if (fread(magic, sizeof(magic), 1, m_fp) != 1 ||
+      fread(&version, sizeof(version), 1, m_fp) != 1 ||
+      memcmp(magic, WARP_TRACE_MAGIC, sizeof(magic))) {
+    printf("GPGPU-Sim uArch: ERROR ** %s is not a warp trace\n", filename);
+    abort();
+  }
+  if (version != WARP_TRACE_VERSION) {
+    printf("GPGPU-Sim uArch: ERROR ** trace %s has version %u, expected %u\n",
+           filename, version, WARP_TRACE_VERSION);
+    abort();
+  }
+  build_index();
+}
+
+warp_trace::~warp_trace() {
+  if (!m_replay) {
+    std::map<key_t, std::string>::iterator p;
+    for (p = m_pending.begin(); p != m_pending.end(); ++p)
+      write_chunk(RECORDS, p->first, p->second);
+    if (fflush(m_fp) || ferror(m_fp)) error("write failed");
+  }
+  fclose(m_fp);
+  pthread_mutex_destroy(&m_lock);
+}
+
+void warp_trace::error(const char *what) const {
+  printf("GPGPU-Sim uArch: ERROR ** trace %s: %s\n", m_filename.c_str(), what);
+  abort();
+}
+
+void warp_trace::write_chunk(chunk_type_t type, const key_t &key,
+                             const std::string &data) {
+  if (data.empty()) return;
+  uLongf size = compressBound(data.size());
+  std::vector<Bytef> buf(size);
+  if (compress2(&buf[0], &size, (const Bytef *)data.data(), data.size(),
+                Z_BEST_SPEED) != Z_OK)
+    error("compression failed");
+  chunk_header_t header;
+  header.type = type;
+  header.kernel_uid = key.kernel_uid;
+  header.cta = key.cta;
+  header.warp = key.warp;
+  header.raw_size = data.size();
+  header.size = size;
+  if (fwrite(&header, sizeof(header), 1, m_fp) != 1 ||
+      fwrite(&buf[0], 1, size, m_fp) != size)
+    error("write failed");
+}
+
+void warp_trace::read_chunk(const chunk_t &chunk, std::string &data) {
+  std::vector<Bytef> buf(chunk.size);
+  if (fseek(m_fp, chunk.offset, SEEK_SET) ||
+      fread(&buf[0], 1, chunk.size, m_fp) != chunk.size)
+    error("file is truncated");
+  data.resize(chunk.raw_size);
+  uLongf size = chunk.raw_size;
+  if (uncompress((Bytef *)&data[0], &size, &buf[0], chunk.size) != Z_OK ||
+      size != chunk.raw_size)
+    error("damaged chunk");
+}
+
+void warp_trace::build_index() {
+  chunk_header_t header;
+  while (fread(&header, sizeof(header), 1, m_fp) == 1) {
+    chunk_t chunk;
+    chunk.offset = ftell(m_fp);
+    chunk.raw_size = header.raw_size;
+    chunk.size = header.size;
+    key_t key(header.kernel_uid, header.cta, header.warp);
+    if (header.type == MEMORY) key = key_t(header.kernel_uid, -1, -1);
+    m_index[key].push_back(chunk);
+    if (fseek(m_fp, header.size, SEEK_CUR)) error("file is truncated");
+  }
+}
+
+void warp_trace::write(const key_t &warp, const warp_trace_record &rec) {
+  pthread_mutex_lock(&m_lock);
+  std::string &buf = m_pending[warp];
+  encode(rec, buf);
+  if (buf.size() >= CHUNK_SIZE) {
+    write_chunk(RECORDS, warp, buf);
+    buf.clear();
+  }
+  pthread_mutex_unlock(&m_lock);
+}
+
+void warp_trace::atomic_word(unsigned kernel_uid, new_addr_type addr,
+                             unsigned size) {
+  pthread_mutex_lock(&m_lock);
+  unsigned &words = m_atomic_words[kernel_uid][addr];
+  if (size > words) words = size;
+  pthread_mutex_unlock(&m_lock);
+}
+
+void warp_trace::read(const key_t &warp, warp_trace_record &rec) {
+  pthread_mutex_lock(&m_lock);
+  cursor_t &cursor = m_cursors[warp];
+  if (cursor.pos == cursor.data.size()) {
+    std::map<key_t, std::vector<chunk_t> >::const_iterator c =
+        m_index.find(warp);
+    if (c == m_index.end() || cursor.chunk == c->second.size()) {
+      printf(
+          "GPGPU-Sim uArch: ERROR ** trace %s has no more instructions for "
+          "warp %u of CTA %u of kernel %u\n",
+          m_filename.c_str(), warp.warp, warp.cta, warp.kernel_uid);
+      abort();
+    }
+    read_chunk(c->second[cursor.chunk++], cursor.data);
+    cursor.pos = 0;
+  }
+  if (!decode(cursor.data, cursor.pos, rec)) error("damaged record");
+  pthread_mutex_unlock(&m_lock);
+}
+
+void warp_trace::warp_done(const key_t &warp) {
+  pthread_mutex_lock(&m_lock);
+  if (m_replay) {
+    m_cursors.erase(warp);
+  } else {
+    std::map<key_t, std::string>::iterator p = m_pending.find(warp);
+    if (p != m_pending.end()) {
+      write_chunk(RECORDS, warp, p->second);
+      m_pending.erase(p);
+    }
+  }
+  pthread_mutex_unlock(&m_lock);
+}
+
+void warp_trace::kernel_done(unsigned kernel_uid, memory_space *global_mem) {
+  pthread_mutex_lock(&m_lock);
+  key_t key(kernel_uid, -1, -1);
+  std::string data;
+  if (m_replay) {
+    std::map<key_t, std::vector<chunk_t> >::const_iterator c =
+        m_index.find(key);
+    for (size_t i = 0; c != m_index.end() && i < c->second.size(); i++) {
+      read_chunk(c->second[i], data);
+      size_t pos = 0;
+      unsigned long long addr = 0;
+      unsigned size = 0;
+      while (pos < data.size()) {
+        if (!get(data, pos, addr) || !get(data, pos, size) ||
+            pos + size > data.size())
+          error("damaged memory chunk");
+        global_mem->write(addr, size, data.data() + pos, NULL, NULL);
+        pos += size;
+      }
+    }
+  } else {
+    std::map<new_addr_type, unsigned> &words = m_atomic_words[kernel_uid];
+    std::map<new_addr_type, unsigned>::const_iterator w;
+    for (w = words.begin(); w != words.end(); ++w) {
+      unsigned char buf[16];
+      assert(w->second <= sizeof(buf));
+      global_mem->read(w->first, w->second, buf);
+      put<unsigned long long>(data, w->first);
+      put<unsigned>(data, w->second);
+      data.append((const char *)buf, w->second);
+    }
+    write_chunk(MEMORY, key, data);
+    m_atomic_words.erase(kernel_uid);
+    if (fflush(m_fp)) error("write failed");
+  }
+  pthread_mutex_unlock(&m_lock);
+}
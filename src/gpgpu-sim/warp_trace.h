@@ -0,0 +1,119 @@
+#ifndef WARP_TRACE_H
+#define WARP_TRACE_H
+
+#include <pthread.h>
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "../abstract_hardware_model.h"
+
+class memory_space;
+
+// One dynamic warp instruction as the timing model sees it once the
+// functional model has executed it: enough to issue it again and to update
+// the SIMT stack without executing it.
+struct warp_trace_record {
+  address_type pc;
+  unsigned active;  // lanes left active after predication
+  unsigned done;    // lanes that exited on this instruction
+  address_type rpc;  // reconvergence pc, RECONVERGE_RETURN_PC resolved
+  // distinct pcs the issued lanes continue at, in lane order, and the index
+  // into them of each lane (all 0 when there is one)
+  std::vector<address_type> next_pcs;
+  unsigned char next_pc[MAX_WARP_SIZE];
+  bool atomic;
+  memory_space_t space;
+  unsigned data_size;
+  // memory instructions: addresses of each active lane, in lane order
+  unsigned char n_addrs[MAX_WARP_SIZE];
+  std::vector<new_addr_type> addrs;
+  // bytes the global stores left in memory, in address order
+  std::string store_data;
+};
+
+// Instruction and memory trace of the timing simulation
+// (-gpgpu_trace_capture), replayed by later runs with other memory system
+// or link settings (-gpgpu_trace_replay) without executing the kernels. The
+// records of each warp form one stream, cut into zlib compressed chunks;
+// warps are named by kernel launch, CTA and warp within the CTA, so a replay
+// may place them on other cores. Atomics complete in the memory system, so
+// the words they update are saved when their kernel finishes and written
+// back at the same point of the replay.
+class warp_trace {
+ public:
+  struct key_t {
+    key_t(unsigned k, unsigned c, unsigned w)
+        : kernel_uid(k), cta(c), warp(w) {}
+    bool operator<(const key_t &x) const {
+      if (kernel_uid != x.kernel_uid) return kernel_uid < x.kernel_uid;
+      if (cta != x.cta) return cta < x.cta;
+      return warp < x.warp;
+    }
+    unsigned kernel_uid;
+    unsigned cta;
+    unsigned warp;
+  };
+
+  warp_trace(const char *filename, bool replay);
+  ~warp_trace();
+
+  bool replaying() const { return m_replay; }
+
+  // capture
+  void write(const key_t &warp, const warp_trace_record &rec);
+  void atomic_word(unsigned kernel_uid, new_addr_type addr, unsigned size);
+  // replay; aborts when the warp's stream has ended
+  void read(const key_t &warp, warp_trace_record &rec);
+
+  // the last instruction of the warp was written or read
+  void warp_done(const key_t &warp);
+  // saves or restores the words the kernel's atomics updated
+  void kernel_done(unsigned kernel_uid, memory_space *global_mem);
+
+ private:
+  enum chunk_type_t { RECORDS = 0, MEMORY };
+  static const size_t CHUNK_SIZE = 1 << 16;
+
+  struct chunk_header_t {
+    unsigned type;
+    unsigned kernel_uid;
+    unsigned cta;
+    unsigned warp;
+    unsigned raw_size;
+    unsigned size;
+  };
+  struct chunk_t {
+    long offset;
+    unsigned raw_size;
+    unsigned size;
+  };
+  struct cursor_t {
+    cursor_t() : chunk(0), pos(0) {}
+    size_t chunk;
+    std::string data;
+    size_t pos;
+  };
+
+  void write_chunk(chunk_type_t type, const key_t &key,
+                   const std::string &data);
+  void read_chunk(const chunk_t &chunk, std::string &data);
+  void build_index();
+  void error(const char *what) const;
+
+  bool m_replay;
+  std::string m_filename;
+  FILE *m_fp;
+  pthread_mutex_t m_lock;
+
+  // capture: records not yet in a chunk, and the words touched by atomics
+  std::map<key_t, std::string> m_pending;
+  std::map<unsigned, std::map<new_addr_type, unsigned> > m_atomic_words;
+
+  // replay: where the chunks of each warp (or kernel, for the memory
+  // chunks) are, and how far each running warp got
+  std::map<key_t, std::vector<chunk_t> > m_index;
+  std::map<key_t, cursor_t> m_cursors;
+};
+
+#endif
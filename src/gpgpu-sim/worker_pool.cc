@@ -0,0 +1,113 @@
+#include "worker_pool.h"
+#include <assert.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// times a waiting thread yields and re-polls before blocking; yielding keeps
+// an oversubscribed host usable while edges still hand over without a futex
+#define WORKER_POOL_SPIN 1000
+
+worker_pool::worker_pool(unsigned n_workers) {
+  assert(n_workers > 0);
+  m_n_workers = n_workers;
+  m_generation = 0;
+  m_busy = 0;
+  m_shutdown = false;
+  m_task = NULL;
+  m_arg = NULL;
+  m_n_items = 0;
+  pthread_mutex_init(&m_lock, NULL);
+  pthread_cond_init(&m_start, NULL);
+  pthread_cond_init(&m_done, NULL);
+
+  // worker 0 is the thread calling run()
+  m_threads.resize(n_workers - 1);
+  m_thread_args.resize(n_workers - 1);
+  for (unsigned w = 1; w < n_workers; w++) {
+    m_thread_args[w - 1].pool = this;
+    m_thread_args[w - 1].worker = w;
+    if (pthread_create(&m_threads[w - 1], NULL, worker_main,
+                       &m_thread_args[w - 1]) != 0) {
+      fprintf(stderr, "GPGPU-Sim: failed to create simulation worker %u\n", w);
+      abort();
+    }
+  }
+}
+
+worker_pool::~worker_pool() {
+  pthread_mutex_lock(&m_lock);
+  m_shutdown = true;
+  pthread_cond_broadcast(&m_start);
+  pthread_mutex_unlock(&m_lock);
+  for (unsigned t = 0; t < m_threads.size(); t++)
+    pthread_join(m_threads[t], NULL);
+  pthread_cond_destroy(&m_done);
+  pthread_cond_destroy(&m_start);
+  pthread_mutex_destroy(&m_lock);
+}
+
+void worker_pool::run(unsigned n_items, task_t task, void *arg) {
+  if (m_n_workers == 1 || n_items <= 1) {
+    for (unsigned i = 0; i < n_items; i++) task(arg, i, i % m_n_workers);
+    return;
+  }
+
+  pthread_mutex_lock(&m_lock);
+  m_task = task;
+  m_arg = arg;
+  m_n_items = n_items;
+  __atomic_store_n(&m_busy, m_n_workers - 1, __ATOMIC_RELAXED);
+  __atomic_store_n(&m_generation, m_generation + 1, __ATOMIC_RELEASE);
+  pthread_cond_broadcast(&m_start);
+  pthread_mutex_unlock(&m_lock);
+
+  work(0);
+
+  for (unsigned spin = 0; spin < WORKER_POOL_SPIN &&
+                          __atomic_load_n(&m_busy, __ATOMIC_ACQUIRE) != 0;
+       spin++) {
+    sched_yield();
+  }
+  pthread_mutex_lock(&m_lock);
+  while (__atomic_load_n(&m_busy, __ATOMIC_ACQUIRE) != 0)
+    pthread_cond_wait(&m_done, &m_lock);
+  pthread_mutex_unlock(&m_lock);
+}
+
+void worker_pool::work(unsigned worker) {
+  for (unsigned i = worker; i < m_n_items; i += m_n_workers)
+    m_task(m_arg, i, worker);
+}
+
+void *worker_pool::worker_main(void *arg) {
+  thread_arg *self = (thread_arg *)arg;
+  worker_pool *pool = self->pool;
+  unsigned long long seen = 0;
+  while (true) {
+    for (unsigned spin = 0;
+         spin < WORKER_POOL_SPIN &&
+         __atomic_load_n(&pool->m_generation, __ATOMIC_ACQUIRE) == seen;
+         spin++) {
+      sched_yield();
+    }
+    pthread_mutex_lock(&pool->m_lock);
+    while (pool->m_generation == seen && !pool->m_shutdown)
+      pthread_cond_wait(&pool->m_start, &pool->m_lock);
+    if (pool->m_shutdown) {
+      pthread_mutex_unlock(&pool->m_lock);
+      break;
+    }
+    seen = pool->m_generation;
+    pthread_mutex_unlock(&pool->m_lock);
+
+    pool->work(self->worker);
+
+    if (__atomic_sub_fetch(&pool->m_busy, 1, __ATOMIC_ACQ_REL) == 0) {
+      pthread_mutex_lock(&pool->m_lock);
+      pthread_cond_signal(&pool->m_done);
+      pthread_mutex_unlock(&pool->m_lock);
+    }
+  }
+  return NULL;
+}
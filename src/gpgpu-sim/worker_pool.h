@@ -0,0 +1,54 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <pthread.h>
+#include <vector>
+
+// A fixed set of host threads that step parts of the timing model (memory sub
+// partitions and links, SM clusters) within one clock edge.
+//
+// run() hands item i to worker i % size(), with the calling thread acting as
+// worker 0, and only returns once every item is done, so each call is the
+// barrier for that edge. Because the item to worker assignment is fixed,
+// callers can keep per-worker stat shards and merge them in worker order
+// without the result depending on thread timing. Each worker takes its items
+// in increasing order, so an item may wait for lower-numbered ones to finish.
+class worker_pool {
+ public:
+  typedef void (*task_t)(void *arg, unsigned item, unsigned worker);
+
+  explicit worker_pool(unsigned n_workers);
+  ~worker_pool();
+
+  unsigned size() const { return m_n_workers; }
+  void run(unsigned n_items, task_t task, void *arg);
+
+ private:
+  static void *worker_main(void *arg);
+  void work(unsigned worker);
+
+  struct thread_arg {
+    worker_pool *pool;
+    unsigned worker;
+  };
+
+  unsigned m_n_workers;
+  std::vector<pthread_t> m_threads;
+  std::vector<thread_arg> m_thread_args;
+
+  pthread_mutex_t m_lock;
+  pthread_cond_t m_start;  // a new edge was published
+  pthread_cond_t m_done;   // the last helper finished the edge
+
+  // current edge; helpers spin on it for a while before sleeping, since
+  // edges come back to back while a kernel runs
+  unsigned long long m_generation;
+  unsigned m_busy;  // helper threads still working on this edge
+  bool m_shutdown;
+
+  task_t m_task;
+  void *m_arg;
+  unsigned m_n_items;
+};
+
+#endif
@@ -27,7 +27,15 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 #include "gpgpusim_entrypoint.h"
+#include <fcntl.h>
 #include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include "../libcuda/gpgpu_context.h"
 #include "cuda-sim/cuda-sim.h"
@@ -83,13 +91,12 @@ void *gpgpu_sim_thread_concurrent(void *ctx_ptr) {
   do {
     if (g_debug_execution >= 3) {
       printf(
-          "GPGPU-Sim: *** simulation thread starting and spinning waiting for "
-          "work ***\n");
+          "GPGPU-Sim: *** simulation thread starting and waiting for work "
+          "***\n");
       fflush(stdout);
     }
-    while (ctx->the_gpgpusim->g_stream_manager->empty_protected() &&
-           !ctx->the_gpgpusim->g_sim_done)
-      ;
+    ctx->the_gpgpusim->g_stream_manager->wait_for_work(
+        &ctx->the_gpgpusim->g_sim_done);
     if (g_debug_execution >= 3) {
       printf("GPGPU-Sim: ** START simulation thread (detected work) **\n");
       ctx->the_gpgpusim->g_stream_manager->print(stdout);
@@ -154,6 +161,7 @@ void *gpgpu_sim_thread_concurrent(void *ctx_ptr) {
     }
     pthread_mutex_lock(&(ctx->the_gpgpusim->g_sim_lock));
     ctx->the_gpgpusim->g_sim_active = false;
+    pthread_cond_broadcast(&(ctx->the_gpgpusim->g_sim_idle));
     pthread_mutex_unlock(&(ctx->the_gpgpusim->g_sim_lock));
   } while (!ctx->the_gpgpusim->g_sim_done);
 
@@ -176,21 +184,25 @@ void gpgpu_context::synchronize() {
   the_gpgpusim->g_stream_manager->print(stdout);
   fflush(stdout);
   //    sem_wait(&g_sim_signal_finish);
-  bool done = false;
-  do {
-    pthread_mutex_lock(&(the_gpgpusim->g_sim_lock));
-    done = (the_gpgpusim->g_stream_manager->empty() &&
+  // the streams only drain while g_sim_active is set, and the simulation
+  // thread signals g_sim_idle when it clears it
+  pthread_mutex_lock(&(the_gpgpusim->g_sim_lock));
+  while (!((the_gpgpusim->g_stream_manager->empty() &&
             !the_gpgpusim->g_sim_active) ||
-           the_gpgpusim->g_sim_done;
-    pthread_mutex_unlock(&(the_gpgpusim->g_sim_lock));
-  } while (!done);
+           the_gpgpusim->g_sim_done))
+    pthread_cond_wait(&(the_gpgpusim->g_sim_idle), &(the_gpgpusim->g_sim_lock));
+  pthread_mutex_unlock(&(the_gpgpusim->g_sim_lock));
   printf("GPGPU-Sim: detected inactive GPU simulation thread\n");
   fflush(stdout);
   //    sem_post(&g_sim_signal_start);
 }
 
 void gpgpu_context::exit_simulation() {
+  pthread_mutex_lock(&(the_gpgpusim->g_sim_lock));
   the_gpgpusim->g_sim_done = true;
+  pthread_cond_broadcast(&(the_gpgpusim->g_sim_idle));
+  pthread_mutex_unlock(&(the_gpgpusim->g_sim_lock));
+  if (the_gpgpusim->g_stream_manager) the_gpgpusim->g_stream_manager->wake_up();
   printf("GPGPU-Sim: exit_simulation called\n");
   fflush(stdout);
   sem_wait(&(the_gpgpusim->g_sim_signal_exit));
@@ -290,6 +302,121 @@ void key_header_write(FILE *fp) {
 
 }
 
+// Fork-based configuration sweep. The process pauses at the launch of
+// -gpgpu_sweep_kernel with the binary loaded, the PTX parsed and the host
+// program replayed up to that point, and forks one child per sweep point.
+// The children share that state copy-on-write. Each applies its overrides
+// to the parsed options, rebuilds the timing model and goes on with the
+// launch. Everything the simulation thread and the worker pool own is left
+// behind by fork(), so the child starts its own.
+void gpgpu_context::config_sweep() {
+  const gpgpu_sim_config &config = *the_gpgpusim->g_the_gpu_config;
+  std::ifstream sweep(config.sweep_file());
+  if (!sweep.good()) {
+    printf("GPGPU-Sim: ERROR ** cannot open sweep file %s\n",
+           config.sweep_file());
+    abort();
+  }
+  std::vector<std::vector<std::string> > points;
+  std::string line;
+  while (std::getline(sweep, line)) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream tokens(line);
+    std::vector<std::string> argv(1);  // argv[0], skipped by the parser
+    std::string token;
+    while (tokens >> token) argv.push_back(token);
+    if (argv.size() > 1) points.push_back(argv);
+  }
+
+  // no simulation thread in the middle of an operation while forking
+  synchronize();
+  printf("GPGPU-Sim: sweeping %zu configurations from %s\n", points.size(),
+         config.sweep_file());
+  unsigned jobs = config.sweep_jobs() ? config.sweep_jobs() : points.size();
+  unsigned running = 0;
+  unsigned failed = 0;
+  std::map<pid_t, std::string> names;
+  for (unsigned p = 0; p <= points.size(); p++) {
+    while (running && (running >= jobs || p == points.size())) {
+      int status;
+      pid_t pid = wait(&status);
+      if (pid < 0) break;
+      running--;
+      bool ok = WIFEXITED(status) && !WEXITSTATUS(status);
+      if (!ok) failed++;
+      printf("GPGPU-Sim: sweep point %s %s\n", names[pid].c_str(),
+             ok ? "done" : "FAILED");
+      fflush(stdout);
+    }
+    if (p == points.size()) break;
+
+    fflush(NULL);
+    pthread_mutex_lock(&the_gpgpusim->g_sim_lock);
+    the_gpgpusim->g_stream_manager->fork_prepare();
+    pid_t pid = fork();
+    if (pid) {
+      the_gpgpusim->g_stream_manager->fork_parent();
+      pthread_mutex_unlock(&the_gpgpusim->g_sim_lock);
+      if (pid < 0) {
+        perror("GPGPU-Sim: sweep fork");
+        abort();
+      }
+      names[pid] = points[p][1];
+      running++;
+      continue;
+    }
+
+    // child
+    the_gpgpusim->g_stream_manager->fork_child();
+    pthread_mutex_unlock(&the_gpgpusim->g_sim_lock);
+    pthread_cond_init(&the_gpgpusim->g_sim_idle, NULL);
+    sem_init(&the_gpgpusim->g_sim_signal_start, 0, 0);
+    sem_init(&the_gpgpusim->g_sim_signal_finish, 0, 0);
+    sem_init(&the_gpgpusim->g_sim_signal_exit, 0, 0);
+
+    const std::vector<std::string> &point = points[p];
+    std::string log = point[1] + ".log";
+    int fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      perror(log.c_str());
+      _exit(1);
+    }
+    dup2(fd, 1);
+    dup2(fd, 2);
+    close(fd);
+    if (data_trace_output_FP) {
+      std::string trace =
+          std::string(config.data_trace_output_path) + "." + point[1];
+      data_trace_output_FP = fopen(trace.c_str(), "wb");
+      assert(data_trace_output_FP != NULL);
+      key_header_write(data_trace_output_FP);
+    }
+
+    std::vector<const char *> argv;
+    argv.push_back("");
+    for (unsigned a = 2; a < point.size(); a++)
+      argv.push_back(point[a].c_str());
+    printf("GPGPU-Sim: sweep point %s\n", point[1].c_str());
+    option_parser_cmdline(the_gpgpusim->g_the_gpu_options, argv.size(),
+                          &argv[0]);
+    option_parser_print(the_gpgpusim->g_the_gpu_options, stdout);
+    the_gpgpusim->g_the_gpu_config->init();
+    configPath = the_gpgpusim->g_the_gpu_config->mpc_parameter_path;
+    the_gpgpusim->g_the_gpu->rebuild_timing_model();
+    the_gpgpusim->g_simulation_starttime = time((time_t *)NULL);
+
+    the_gpgpusim->g_sim_active = false;
+    the_gpgpusim->g_sim_done = true;
+    start_sim_thread(1);
+    return;
+  }
+
+  printf("GPGPU-Sim: sweep finished, %u of %zu configurations failed\n",
+         failed, points.size());
+  fflush(stdout);
+  exit(failed ? 1 : 0);
+}
+
 gpgpu_sim *gpgpu_context::gpgpu_ptx_sim_init_perf() {
   srand(1);
   print_splash();
@@ -308,6 +435,7 @@ gpgpu_sim *gpgpu_context::gpgpu_ptx_sim_init_perf() {
   option_parser_cmdline(opp, sg_argc, sg_argv);  // parse configuration options
   fprintf(stdout, "GPGPU-Sim: Configuration options:\n\n");
   option_parser_print(opp, stdout);
+  the_gpgpusim->g_the_gpu_options = opp;
   // Set the Numeric locale to a standard locale where a decimal point is a
   // "dot" not a "comma" so it does the parsing correctly independent of the
   // system environment variables
@@ -375,6 +503,7 @@ void gpgpu_context::print_simulation_time() {
   printf("gpgpu_simulation_rate = %u (cycle/sec)\n", cycles_per_sec);
   printf("gpgpu_silicon_slowdown = %ux\n",
          the_gpgpusim->g_the_gpu->shader_clock() * 1000 / cycles_per_sec);
+  the_gpgpusim->g_the_gpu->print_self_profile(stdout);
   fflush(stdout);
 }
 
@@ -47,8 +47,10 @@ class GPGPUsim_ctx {
     g_sim_done = true;
     break_limit = false;
     g_sim_lock = PTHREAD_MUTEX_INITIALIZER;
+    g_sim_idle = PTHREAD_COND_INITIALIZER;
 
     g_the_gpu_config = NULL;
+    g_the_gpu_options = NULL;
     g_the_gpu = NULL;
     g_stream_manager = NULL;
     the_cude_device = NULL;
@@ -65,6 +67,9 @@ class GPGPUsim_ctx {
   pthread_t g_simulation_thread;
 
   class gpgpu_sim_config *g_the_gpu_config;
+  // kept for -gpgpu_sweep_kernel, which applies overrides to the parsed
+  // options
+  class OptionParser *g_the_gpu_options;
   class gpgpu_sim *g_the_gpu;
   class stream_manager *g_stream_manager;
 
@@ -73,6 +78,7 @@ class GPGPUsim_ctx {
   gpgpu_context *gpgpu_ctx;
 
   pthread_mutex_t g_sim_lock;
+  pthread_cond_t g_sim_idle;  // g_sim_active cleared or g_sim_done set
   bool g_sim_active;
   bool g_sim_done;
   bool break_limit;
@@ -66,6 +66,10 @@ public:
   virtual void Evaluate() {}
   virtual void WriteOutputs();
 
+  virtual bool Idle() const {
+    return !_input && !_output && _wait_queue.empty();
+  }
+
 protected:
   int _delay;
   T * _input;
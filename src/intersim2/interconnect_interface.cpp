@@ -257,6 +257,33 @@ bool InterconnectInterface::Busy() const
   return false;
 }
 
+bool InterconnectInterface::Idle() const
+{
+  // the viewer trace prints every step
+  if (gTrace || Busy())
+    return false;
+  for (int s = 0; s < _subnets; ++s) {
+    if (!_net[s]->Idle())
+      return false;
+    for (unsigned n = 0; n < _n_shader+_n_mem; ++n) {
+      if (!_ejected_flit_queue[s][n].empty())
+        return false;
+      for (int vc = 0; vc < _vcs; ++vc) {
+        if (!_ejection_buffer[s][n][vc].empty() ||
+            _boundary_buffer[s][n][vc].Size())
+          return false;
+      }
+    }
+  }
+  return true;
+}
+
+void InterconnectInterface::Skip(unsigned long long n)
+{
+  assert(Idle());
+  _traffic_manager->_time += n;
+}
+
 bool InterconnectInterface::HasBuffer(unsigned deviceID, unsigned int size) const
 {
   bool has_buffer = false;
@@ -271,6 +298,20 @@ bool InterconnectInterface::HasBuffer(unsigned deviceID, unsigned int size) cons
   return has_buffer;
 }
 
+unsigned InterconnectInterface::InputSpace(unsigned deviceID) const
+{
+  int icntID = _node_map.find(deviceID)->second;
+  int subnet = ((_subnets>1) && deviceID >= _n_shader) ? 1 : 0;
+  size_t used = _traffic_manager->_input_queue[subnet][icntID][0].size();
+
+  return used < _input_buffer_capacity ? _input_buffer_capacity - used : 0;
+}
+
+unsigned InterconnectInterface::PacketSpace(unsigned int size) const
+{
+  return size / _flit_size + ((size % _flit_size)? 1:0);
+}
+
 void InterconnectInterface::DisplayStats() const
 {
   _traffic_manager->UpdateStats();
@@ -57,7 +57,14 @@ public:
   virtual void* Pop(unsigned ouput_deviceID);
   virtual void Advance();
   virtual bool Busy() const;
+  // true if Advance() would only move the network time forward
+  virtual bool Idle() const;
+  // n calls to Advance() on an idle network
+  virtual void Skip(unsigned long long n);
   virtual bool HasBuffer(unsigned deviceID, unsigned int size) const;
+  // flits left in the input buffer, and flits taken by a packet
+  virtual unsigned InputSpace(unsigned deviceID) const;
+  unsigned PacketSpace(unsigned int size) const;
   virtual void DisplayStats() const;
   virtual void DisplayOverallStats() const;
   unsigned GetFlitSize() const;
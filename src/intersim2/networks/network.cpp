@@ -206,6 +206,18 @@ void Network::WriteOutputs( )
   }
 }
 
+bool Network::Idle( ) const
+{
+  for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
+      iter != _timed_modules.end();
+      ++iter) {
+    if(!(*iter)->Idle( )) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void Network::WriteFlit( Flit *f, int source )
 {
   assert( ( source >= 0 ) && ( source < _nodes ) );
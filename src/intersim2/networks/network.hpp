@@ -94,6 +94,9 @@ public:
   virtual void Evaluate( );
   virtual void WriteOutputs( );
 
+  // true if no module holds a flit or credit
+  bool Idle( ) const;
+
   void Display( ostream & os = cout ) const;
   void DumpChannelMap( ostream & os = cout, string const & prefix = "" ) const;
   void DumpNodeMap( ostream & os = cout, string const & prefix = "" ) const;
@@ -288,6 +288,26 @@ void IQRouter::WriteOutputs( )
   _SendCredits( );
 }
 
+bool IQRouter::Idle( ) const
+{
+  // an inactive router at unit speedup keeps _partial_internal_cycles at 0
+  if(_active || _internal_speedup != 1.0 || !_in_queue_flits.empty() ||
+     !_proc_credits.empty()) {
+    return false;
+  }
+  for(int output = 0; output < _outputs; ++output) {
+    if(!_output_buffer[output].empty()) {
+      return false;
+    }
+  }
+  for(int input = 0; input < _inputs; ++input) {
+    if(!_credit_buffer[input].empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 
 //------------------------------------------------------------------------------
 // read inputs
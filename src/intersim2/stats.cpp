@@ -114,6 +114,22 @@ void Stats::AddSample( double val )
   _hist[b]++;
 }
 
+void Stats::AddSamples( double val, int n )
+{
+  if ( n <= 0 ) {
+    return;
+  }
+  AddSample( val );
+  _num_samples += n - 1;
+  // exact for the zero samples of idle queues, rounded once otherwise
+  _sample_sum += val * (n - 1);
+
+  int b = (int)fmax(floor( val / _bin_size ), 0.0);
+  b = (b >= _num_bins) ? (_num_bins - 1) : b;
+
+  _hist[b] += n - 1;
+}
+
 void Stats::Display( ostream & os ) const
 {
   os << *this << endl;
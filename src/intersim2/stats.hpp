@@ -65,6 +65,8 @@ public:
   inline void AddSample( unsigned long long val ) {
     AddSample( (double)val );
   }
+  // n samples of the same value
+  void AddSamples( double val, int n );
 
   int GetBin(int b){ return _hist[b];}
 
@@ -39,6 +39,9 @@ public:
   virtual void ReadInputs() = 0;
   virtual void Evaluate() = 0;
   virtual void WriteOutputs() = 0;
+
+  // true if stepping the module would change nothing but the time
+  virtual bool Idle() const { return false; }
 };
 
 #endif
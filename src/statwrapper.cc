@@ -12,6 +12,10 @@ void StatClear(void *st) { ((Stats *)st)->Clear(); }
 
 void StatAddSample(void *st, int val) { ((Stats *)st)->AddSample(val); }
 
+void StatAddSamples(void *st, int val, int n) {
+  ((Stats *)st)->AddSamples(val, n);
+}
+
 double StatAverage(void *st) { return ((Stats *)st)->Average(); }
 
 double StatMax(void *st) { return ((Stats *)st)->Max(); }
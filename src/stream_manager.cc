@@ -235,14 +235,25 @@ stream_manager::stream_manager(gpgpu_sim *gpu, bool cuda_launch_blocking) {
   m_service_stream_zero = false;
   m_cuda_launch_blocking = cuda_launch_blocking;
   pthread_mutex_init(&m_lock, NULL);
+  pthread_cond_init(&m_work_cond, NULL);
   m_last_stream = m_streams.begin();
+  m_generation = 0;
+  m_idle_generation = (unsigned long long)-1;
 }
 
 bool stream_manager::operation(bool *sim) {
   bool check = check_finished_kernel();
+  // Streams only become ready when the host adds something or a kernel
+  // finishes, so if neither happened since the last call found every stream
+  // empty or busy, front() would come back empty again.
+  if (!check && m_idle_generation ==
+                    __atomic_load_n(&m_generation, __ATOMIC_ACQUIRE))
+    return check;
   pthread_mutex_lock(&m_lock);
   //    if(check)m_gpu->print_stats();
+  unsigned long long generation = m_generation;
   stream_operation op = front();
+  m_idle_generation = op.is_noop() ? generation : (unsigned long long)-1;
   if (!op.do_operation(m_gpu))  // not ready to execute
   {
     // cancel operation
@@ -258,6 +269,23 @@ bool stream_manager::operation(bool *sim) {
   return check;
 }
 
+void stream_manager::wait_for_work(const bool *stop) {
+  pthread_mutex_lock(&m_lock);
+  while (empty() && !*stop) pthread_cond_wait(&m_work_cond, &m_lock);
+  pthread_mutex_unlock(&m_lock);
+}
+
+void stream_manager::fork_child() {
+  pthread_mutex_unlock(&m_lock);
+  pthread_cond_init(&m_work_cond, NULL);
+}
+
+void stream_manager::wake_up() {
+  pthread_mutex_lock(&m_lock);
+  pthread_cond_broadcast(&m_work_cond);
+  pthread_mutex_unlock(&m_lock);
+}
+
 bool stream_manager::check_finished_kernel() {
   unsigned grid_uid = m_gpu->finished_kernel();
   bool check = register_finished_kernel(grid_uid);
@@ -299,6 +327,7 @@ bool stream_manager::register_finished_kernel(unsigned grid_uid) {
 
 void stream_manager::stop_all_running_kernels() {
   pthread_mutex_lock(&m_lock);
+  __atomic_add_fetch(&m_generation, 1, __ATOMIC_RELEASE);
 
   // Signal m_gpu to stop all running kernels
   m_gpu->stop_all_running_kernels();
@@ -361,6 +390,7 @@ void stream_manager::add_stream(struct CUstream_st *stream) {
   // called by host thread
   pthread_mutex_lock(&m_lock);
   m_streams.push_back(stream);
+  __atomic_add_fetch(&m_generation, 1, __ATOMIC_RELEASE);
   pthread_mutex_unlock(&m_lock);
 }
 
@@ -378,6 +408,7 @@ void stream_manager::destroy_stream(CUstream_st *stream) {
   }
   delete stream;
   m_last_stream = m_streams.begin();
+  __atomic_add_fetch(&m_generation, 1, __ATOMIC_RELEASE);
   pthread_mutex_unlock(&m_lock);
 }
 
@@ -459,6 +490,8 @@ void stream_manager::push(stream_operation op) {
     printf("\n");
   }
   if (g_debug_execution >= 3) print_impl(stdout);
+  __atomic_add_fetch(&m_generation, 1, __ATOMIC_RELEASE);
+  pthread_cond_broadcast(&m_work_cond);
   pthread_mutex_unlock(&m_lock);
   if (m_cuda_launch_blocking || stream == NULL) {
     unsigned int wait_amount = 100;
@@ -262,6 +262,22 @@ class stream_manager {
   void push(stream_operation op);
   void pushCudaStreamWaitEventToAllStreams(CUevent_st *e, unsigned int flags);
   bool operation(bool *sim);
+  // operation() would start nothing unless a kernel finishes first; called
+  // by the gpu simulation thread
+  bool quiet() const {
+    return m_idle_generation ==
+           __atomic_load_n(&m_generation, __ATOMIC_ACQUIRE);
+  }
+  // called by gpu simulation thread: sleep until an operation is pushed or
+  // *stop is set and wake_up() is called
+  void wait_for_work(const bool *stop);
+  void wake_up();
+  // fork(): m_lock is held across it so the simulation thread is not inside
+  // it, and the child gets a fresh condition variable since the thread
+  // waiting on it stays behind
+  void fork_prepare() { pthread_mutex_lock(&m_lock); }
+  void fork_parent() { pthread_mutex_unlock(&m_lock); }
+  void fork_child();
   void stop_all_running_kernels();
   unsigned size() { return m_streams.size(); };
   bool is_blocking() { return m_cuda_launch_blocking; };
@@ -276,7 +292,14 @@ class stream_manager {
   CUstream_st m_stream_zero;
   bool m_service_stream_zero;
   pthread_mutex_t m_lock;
+  pthread_cond_t m_work_cond;  // signalled by push() and wake_up()
   std::list<struct CUstream_st *>::iterator m_last_stream;
+
+  // bumped under m_lock whenever a host thread adds or removes operations or
+  // streams; operation() reads it without the lock
+  unsigned long long m_generation;
+  // m_generation when operation() last found no operation to start
+  unsigned long long m_idle_generation;
 };
 
 #endif